@@ -1568,6 +1568,57 @@ LIBVLC_API
 int libvlc_video_get_cursor( libvlc_media_player_t *p_mi, unsigned num,
                              int *px, int *py );
 
+/**
+ * Fate of a video frame
+ */
+typedef enum libvlc_video_frame_status_t {
+    libvlc_video_frame_displayed = 1,
+    libvlc_video_frame_dropped_decoder, /**< dropped before the video output */
+    libvlc_video_frame_dropped_late,    /**< too late to be displayed */
+    libvlc_video_frame_dropped_filter,  /**< consumed by a video filter */
+    libvlc_video_frame_dropped_pool,    /**< no display buffer available */
+    libvlc_video_frame_flushed,         /**< discarded by a seek or a stop */
+} libvlc_video_frame_status_t;
+
+/**
+ * Pacing record of a video frame
+ *
+ * The dates are in microseconds, in the libvlc_clock() time base, or 0 if the
+ * frame did not reach the corresponding stage.
+ */
+typedef struct libvlc_video_frame_telemetry_t
+{
+    uint64_t i_id;          /**< monotonic identifier */
+    int64_t  i_pts;         /**< frame timestamp */
+    int64_t  i_decoded;     /**< date the frame was output by the decoder */
+    int64_t  i_prepared;    /**< date the frame went through the filters */
+    int64_t  i_rendered;    /**< date the frame was ready for display */
+    int64_t  i_displayed;   /**< date the frame was displayed */
+    libvlc_video_frame_status_t status;
+} libvlc_video_frame_telemetry_t;
+
+/**
+ * Get the pacing records of the last frames of a video.
+ *
+ * The records are returned in order, starting after the one identified by
+ * the cursor. Frames that are still pending are not returned yet. The number
+ * of frames kept by each video output is set by the "vout-telemetry" option.
+ *
+ * \version LibVLC 4.0.0 or later
+ *
+ * \param p_mi media player
+ * \param num number of the video (starting from, and most commonly 0)
+ * \param p_cursor identifier of the last record read, 0 initially [IN/OUT]
+ * \param p_frames array of records to fill [OUT]
+ * \param i_count size of the array
+ * \return the number of records written
+ */
+LIBVLC_API
+size_t libvlc_video_get_frame_telemetry( libvlc_media_player_t *p_mi,
+                                         unsigned num, uint64_t *p_cursor,
+                                         libvlc_video_frame_telemetry_t *p_frames,
+                                         size_t i_count );
+
 /**
  * Get the current video scaling factor.
  * See also libvlc_video_set_scale().
@@ -231,6 +231,48 @@ static inline block_t *block_Duplicate( const block_t *p_block )
     return p_dup;
 }
 
+/**
+ * Shares a block.
+ *
+ * Turns a block into a reference to read-only, reference-counted payload
+ * storage, so that it can be handed to several owners with block_Clone()
+ * without copying the data.
+ *
+ * The data of a shared block must not be written to. Prepending or
+ * appending data with block_Realloc() or block_TryRealloc() copies it
+ * unless the block is the last reference. Use block_Unshare() to get a
+ * writeable block back.
+ *
+ * @param block block to share (consumed)
+ * @return the shared block (never NULL; on memory error, the block is
+ * returned as is and block_Clone() falls back to block_Duplicate())
+ */
+VLC_API block_t *block_Share(block_t *block) VLC_USED;
+
+/**
+ * Clones a block.
+ *
+ * Creates a new reference to the payload of a block shared with
+ * block_Share(), with its own properties and view of the data. Only a block
+ * header is allocated. A block that is not shared is duplicated.
+ *
+ * @return the clone on success, NULL on error.
+ */
+VLC_API block_t *block_Clone(const block_t *block) VLC_USED;
+
+/**
+ * Makes a block writeable.
+ *
+ * Returns a block with the same data and properties that the caller may
+ * write to: the block itself if it is not shared, the payload if this was
+ * its last reference, or a duplicate otherwise.
+ *
+ * @param block block to make writeable (consumed)
+ * @return the writeable block, or NULL on memory error (the block is then
+ * discarded).
+ */
+VLC_API block_t *block_Unshare(block_t *block) VLC_USED;
+
 /**
  * Wraps heap in a block.
  *
@@ -554,6 +596,14 @@ static inline void vlc_fifo_WaitCond(vlc_fifo_t *fifo, vlc_cond_t *condvar)
     vlc_cond_wait(condvar, &q->lock);
 }
 
+static inline int vlc_fifo_TimedWaitCond(vlc_fifo_t *fifo, vlc_cond_t *condvar,
+                                         vlc_tick_t deadline)
+{
+    vlc_queue_t *q = vlc_fifo_queue(fifo);
+
+    return vlc_cond_timedwait(condvar, &q->lock, deadline);
+}
+
 /**
  * Queues a linked-list of blocks into a locked FIFO.
  *
@@ -379,6 +379,31 @@ VLC_API void decoder_Destroy( decoder_t *p_dec );
  */
 VLC_API void decoder_Clean( decoder_t *p_dec );
 
+/**
+ * Reserves worker threads from the process-wide decoding thread budget.
+ *
+ * Decoder modules spawning their own worker threads (frame or slice
+ * threading) should size them with this function, so that many simultaneous
+ * decoders do not oversubscribe the CPUs. The budget is set with the
+ * "dec-threads" option; there is no limit if it is 0.
+ *
+ * Each decoder gets at most a fair share of the budget and always gets at
+ * least one thread, even if the budget is exhausted.
+ *
+ * The reserved threads must be returned with decoder_ReleaseThreads().
+ *
+ * \param wanted number of threads the module would like to use
+ * \return the number of threads granted, between 1 and wanted
+ */
+VLC_API unsigned decoder_AcquireThreads( decoder_t *dec, unsigned wanted );
+
+/**
+ * Returns threads reserved with decoder_AcquireThreads() to the budget.
+ *
+ * \param count the value returned by decoder_AcquireThreads()
+ */
+VLC_API void decoder_ReleaseThreads( decoder_t *dec, unsigned count );
+
 /**
  * This function queues a single picture to the video output.
  *
@@ -113,6 +113,12 @@ enum es_out_query_e
     ES_OUT_SPU_SET_HIGHLIGHT, /* arg1= es_out_id_t* (spu es),
                                  arg2= const vlc_spu_highlight_t *, res=can fail  */
 
+    /* Account packets lost, re-ordered, received too late or recovered by
+     * the transport (network inputs doing their own packet recovery) */
+    ES_OUT_ADD_TRANSPORT_STATS, /* arg1=unsigned lost, arg2=unsigned reordered,
+                                   arg3=unsigned late, arg4=unsigned recovered,
+                                   res=can fail */
+
     /* First value usable for private control */
     ES_OUT_PRIVATE_START = 0x10000,
 };
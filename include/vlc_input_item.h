@@ -513,11 +513,21 @@ struct input_stats_t
     float f_demux_bitrate;
     int64_t i_demux_corrupted;
     int64_t i_demux_discontinuity;
+    int64_t i_demux_lost; /**< transport packets lost */
+    int64_t i_demux_reordered; /**< transport packets received out of order */
+    int64_t i_demux_late; /**< transport packets received too late */
+    int64_t i_demux_recovered; /**< transport packets rebuilt with FEC */
 
     /* Decoders */
     int64_t i_decoded_audio;
     int64_t i_decoded_video;
 
+    /* Decoder fifos */
+    int64_t i_decoder_fifo_bytes; /**< data currently queued to decoders */
+    int64_t i_decoder_fifo_blocked; /**< times the demuxer was blocked */
+    vlc_tick_t i_decoder_fifo_waited; /**< total time the demuxer was blocked */
+    int64_t i_decoder_fifo_dropped; /**< number of fifo resets */
+
     /* Vout */
     int64_t i_displayed_pictures;
     int64_t i_late_pictures;
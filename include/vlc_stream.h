@@ -168,6 +168,8 @@ enum stream_query_e
     STREAM_GET_CONTENT_TYPE,    /**< arg1= char **         res=can fail */
     STREAM_GET_SIGNAL,      /**< arg1=double *pf_quality, arg2=double *pf_strength   res=can fail */
     STREAM_GET_TAGS,        /**< arg1=const block_t ** res=can fail */
+    STREAM_GET_READAHEAD_STATS, /**< arg1= struct vlc_stream_readahead_stats * res=can fail */
+    STREAM_READ_RANGES,     /**< arg1= struct vlc_stream_range *, arg2= size_t res=can fail */
 
     STREAM_SET_PAUSE_STATE = 0x200, /**< arg1= bool        res=can fail */
     STREAM_SET_TITLE,       /**< arg1= int          res=can fail */
@@ -181,6 +183,30 @@ enum stream_query_e
     STREAM_GET_PRIVATE_ID_STATE,          /* arg1=int i_private_data arg2=bool *          res=can fail */
 };
 
+/**
+ * Read-ahead statistics (see STREAM_GET_READAHEAD_STATS)
+ */
+struct vlc_stream_readahead_stats
+{
+    size_t buffer_size;   /**< current read-ahead buffer size (bytes) */
+    size_t buffer_level;  /**< buffered data not read yet (bytes) */
+    uint64_t rate;        /**< observed consumption rate (bytes/second) */
+    vlc_tick_t latency;   /**< 90th percentile of the upstream read latency */
+    unsigned resizes;     /**< number of buffer resizes */
+    unsigned underruns;   /**< number of reads that waited for data */
+};
+
+/**
+ * Byte range of a vectored read (see vlc_stream_ReadRanges())
+ */
+struct vlc_stream_range
+{
+    uint64_t offset; /**< absolute offset of the first byte to read */
+    void *buf;       /**< buffer to read data into */
+    size_t length;   /**< number of bytes to read */
+    size_t read;     /**< number of bytes actually read [OUT] */
+};
+
 /**
  * Reads data from a byte stream.
  *
@@ -249,6 +275,31 @@ VLC_API ssize_t vlc_stream_Peek(stream_t *, const uint8_t **, size_t) VLC_USED;
  */
 VLC_API block_t *vlc_stream_ReadBlock(stream_t *) VLC_USED;
 
+/**
+ * Reads several byte ranges from a byte stream.
+ *
+ * This function reads a list of ranges at absolute offsets in a single call.
+ * Accesses that support it (STREAM_READ_RANGES) satisfy the ranges
+ * concurrently, e.g. with asynchronous local I/O or parallel HTTP requests.
+ * Otherwise, the ranges are read one after the other with seeks.
+ *
+ * In either case, the current read offset is preserved, so the caller can
+ * keep reading sequentially afterwards.
+ *
+ * \note Accesses that are not fast-seekable can receive STREAM_READ_RANGES
+ * while a read-ahead thread reads from them. Their implementation must not
+ * depend on nor affect the sequential read state.
+ *
+ * \note A range can be read only partially if the end-of-stream is reached.
+ * Check the read field of each range.
+ *
+ * \param ranges table of ranges to read [IN/OUT]
+ * \param count number of ranges in the table
+ * \return VLC_SUCCESS, or an error code if any range could not be read
+ */
+VLC_API int vlc_stream_ReadRanges(stream_t *, struct vlc_stream_range *ranges,
+                                  size_t count) VLC_USED;
+
 /**
  * Tells the current stream position.
  *
@@ -112,6 +112,55 @@ vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
                               input_item_t *input_item, vlc_tick_t timeout,
                               vlc_thumbnailer_cb cb, void* user_data );
 
+/**
+ * \brief vlc_thumbnailer_batch_cb defines a callback invoked for each
+ * thumbnail of a batch request
+ *
+ * This callback is invoked once per requested time, in the order of the
+ * times array, with a NULL thumbnail if that time could not be reached.
+ * The thumbnail ownership is the same as for vlc_thumbnailer_cb.
+ *
+ * \param data Is the opaque pointer passed as vlc_thumbnailer_RequestBatch
+ * last parameter
+ * \param index The index of the thumbnail time in the request times array
+ * \param thumbnail The generated thumbnail, or NULL in case of failure
+ */
+typedef void(*vlc_thumbnailer_batch_cb)( void* data, size_t index,
+                                         picture_t* thumbnail );
+
+/**
+ * \brief vlc_thumbnailer_RequestBatch Requests several thumbnails of a media
+ * \param thumbnailer A thumbnailer object
+ * \param times The times at which the thumbnails should be taken
+ * \param count The number of times
+ * \param speed The seeking speed \sa{enum vlc_thumbnailer_seek_speed}
+ * \param width The maximum thumbnail width, or 0 to keep the video size
+ * \param height The maximum thumbnail height, or 0 to keep the video size
+ * \param input_item The input item to generate the thumbnails for
+ * \param timeout A timeout value for the whole batch, or VLC_TICK_INVALID to
+ * disable timeout
+ * \param cb A user callback to be called for each thumbnail
+ * \param user_data An opaque value, provided as pf_cb's first parameter
+ * \return An opaque request object, or NULL in case of failure
+ *
+ * The media is opened only once and sought to each time in turn, which avoids
+ * the input setup cost of separate requests (e.g. for contact sheets).
+ * Thumbnails are downscaled to fit in the width x height box, preserving the
+ * aspect ratio.
+ *
+ * If this function returns a valid request object, the callback is
+ * guaranteed to be called count times, even in case of later failure.
+ * The request object must not be used after the last callback invocation.
+ * The times array is copied and can be released after calling this function.
+ */
+VLC_API vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestBatch( vlc_thumbnailer_t *thumbnailer,
+                              const vlc_tick_t *times, size_t count,
+                              enum vlc_thumbnailer_seek_speed speed,
+                              unsigned width, unsigned height,
+                              input_item_t *input_item, vlc_tick_t timeout,
+                              vlc_thumbnailer_batch_cb cb, void* user_data );
+
 /**
  * \brief vlc_thumbnailer_Cancel Cancel a thumbnail request
  * \param thumbnailer A thumbnailer object
@@ -122,6 +122,53 @@ VLC_API int vout_GetSnapshot( vout_thread_t *p_vout,
 VLC_API picture_t * vout_GetPicture( vout_thread_t * );
 VLC_API void vout_PutPicture( vout_thread_t *, picture_t * );
 
+/**
+ * Fate of a picture handed to the video output
+ */
+enum vout_frame_status
+{
+    VOUT_FRAME_PENDING,         /**< not displayed nor dropped yet */
+    VOUT_FRAME_DISPLAYED,       /**< displayed */
+    VOUT_FRAME_DROPPED_DECODER, /**< dropped before reaching the vout */
+    VOUT_FRAME_DROPPED_LATE,    /**< dropped by the vout as too late */
+    VOUT_FRAME_DROPPED_FILTER,  /**< consumed by a video filter */
+    VOUT_FRAME_DROPPED_POOL,    /**< no display picture was available */
+    VOUT_FRAME_FLUSHED,         /**< discarded by a flush (seek, stop) */
+};
+
+/**
+ * Per-picture pacing record
+ *
+ * All the dates are system dates (comparable with vlc_tick_now()), or
+ * VLC_TICK_INVALID if the picture did not reach the corresponding stage.
+ */
+typedef struct
+{
+    uint64_t id;           /**< monotonic record identifier */
+    vlc_tick_t pts;        /**< picture timestamp */
+    vlc_tick_t decoded;    /**< date the decoder queued the picture */
+    vlc_tick_t prepared;   /**< date the static filters output the picture */
+    vlc_tick_t rendered;   /**< date the picture was ready for display */
+    vlc_tick_t displayed;  /**< date the picture was displayed */
+    enum vout_frame_status status;
+} vout_frame_telemetry_t;
+
+/**
+ * Reads the per-picture pacing records of a video output.
+ *
+ * Only completed records (displayed or dropped) are returned, in order. The
+ * records older than the telemetry ring ("vout-telemetry") are lost.
+ *
+ * \param cursor identifier of the last record read by the caller (0 to read
+ * all the available records), updated on return
+ * \param frames array to fill
+ * \param count size of the array
+ * \return the number of records written
+ */
+VLC_API size_t vout_GetFrameTelemetry( vout_thread_t *, uint64_t *cursor,
+                                       vout_frame_telemetry_t *frames,
+                                       size_t count );
+
 /* Subpictures channels ID */
 #define VOUT_SPU_CHANNEL_INVALID      (-1) /* Always fails in comparison */
 #define VOUT_SPU_CHANNEL_OSD            0 /* OSD channel is automatically cleared */
@@ -189,6 +189,44 @@ int libvlc_video_get_cursor( libvlc_media_player_t *mp, unsigned num,
     return 0;
 }
 
+size_t libvlc_video_get_frame_telemetry( libvlc_media_player_t *mp,
+                                         unsigned num, uint64_t *cursor,
+                                         libvlc_video_frame_telemetry_t *frames,
+                                         size_t count )
+{
+    vout_thread_t *p_vout = GetVout (mp, num);
+    if (p_vout == NULL)
+        return 0;
+
+    vout_frame_telemetry_t records[32];
+    size_t total = 0;
+
+    while (total < count)
+    {
+        size_t max = __MIN(count - total, ARRAY_SIZE(records));
+        size_t n = vout_GetFrameTelemetry(p_vout, cursor, records, max);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            const vout_frame_telemetry_t *rec = &records[i];
+            libvlc_video_frame_telemetry_t *frame = &frames[total++];
+
+            frame->i_id = rec->id;
+            frame->i_pts = US_FROM_VLC_TICK(rec->pts);
+            frame->i_decoded = US_FROM_VLC_TICK(rec->decoded);
+            frame->i_prepared = US_FROM_VLC_TICK(rec->prepared);
+            frame->i_rendered = US_FROM_VLC_TICK(rec->rendered);
+            frame->i_displayed = US_FROM_VLC_TICK(rec->displayed);
+            /* The statuses are in the same order, without the pending one */
+            frame->status = (libvlc_video_frame_status_t) rec->status;
+        }
+        if (n < max)
+            break;
+    }
+    vout_Release(p_vout);
+    return total;
+}
+
 unsigned libvlc_media_player_has_vout( libvlc_media_player_t *p_mi )
 {
     size_t n;
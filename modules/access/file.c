@@ -296,6 +296,42 @@ static int FileSeek (stream_t *p_access, uint64_t i_pos)
     return VLC_SUCCESS;
 }
 
+#ifdef HAVE_PREAD
+/*****************************************************************************
+ * FileReadRanges: positional reads for STREAM_READ_RANGES
+ *****************************************************************************/
+int FileReadRanges (stream_t *p_access, int fd, va_list args)
+{
+    struct vlc_stream_range *ranges = va_arg (args, struct vlc_stream_range *);
+    size_t count = va_arg (args, size_t);
+
+    /* pread() does not move the file offset used by Read() */
+    for (size_t i = 0; i < count; i++)
+    {
+        struct vlc_stream_range *range = &ranges[i];
+
+        range->read = 0;
+        while (range->read < range->length)
+        {
+            ssize_t val = pread (fd, (char *)range->buf + range->read,
+                                 range->length - range->read,
+                                 range->offset + range->read);
+            if (val < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                msg_Err (p_access, "read error: %s", vlc_strerror_c(errno));
+                return VLC_EGENERIC;
+            }
+            if (val == 0)
+                break; /* end of file */
+            range->read += val;
+        }
+    }
+    return VLC_SUCCESS;
+}
+#endif
+
 /*****************************************************************************
  * Control:
  *****************************************************************************/
@@ -339,6 +375,13 @@ static int FileControl( stream_t *p_access, int i_query, va_list args )
                         var_InheritInteger (p_access, "file-caching") );
             break;
 
+#ifdef HAVE_PREAD
+        case STREAM_READ_RANGES:
+            if (p_access->pf_seek == NULL)
+                return VLC_EGENERIC;
+            return FileReadRanges (p_access, p_sys->fd, args);
+#endif
+
         case STREAM_SET_PAUSE_STATE:
             /* Nothing to do */
             break;
@@ -40,6 +40,20 @@ vlc_module_begin ()
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
 
+#ifdef HAVE_MMAP
+    add_submodule()
+    set_section( N_("Memory-mapped file" ), NULL )
+    set_capability( "access", 70 )
+    add_shortcut( "file" )
+    set_callbacks( MmapOpen, MmapClose )
+
+    add_bool("file-mmap", false, N_("Memory-map files"),
+             N_("Read local files through memory mappings instead of "
+                "copying their content. This saves memory when many files "
+                "are played at once. A file truncated while it is played "
+                "can crash the process."), true)
+#endif
+
     add_submodule()
     set_section( N_("Directory" ), NULL )
     set_capability( "access", 55 )
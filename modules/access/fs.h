@@ -22,6 +22,12 @@
 
 int FileOpen (vlc_object_t *);
 void FileClose (vlc_object_t *);
+#ifdef HAVE_PREAD
+int FileReadRanges (stream_t *, int fd, va_list);
+#endif
+
+int MmapOpen (vlc_object_t *);
+void MmapClose (vlc_object_t *);
 
 int DirOpen (vlc_object_t *);
 int DirInit (stream_t *p_access, DIR *handle);
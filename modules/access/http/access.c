@@ -32,6 +32,8 @@
 
 #include <vlc_common.h>
 #include <vlc_access.h>
+#include <vlc_block.h>
+#include <vlc_interrupt.h>
 #include <vlc_keystore.h>
 #include <vlc_plugin.h>
 #include <vlc_url.h>
@@ -40,29 +42,416 @@
 #include "resource.h"
 #include "file.h"
 #include "live.h"
+#include "probe.h"
+
+/* Index fetched ahead of time over a second request, so that the demuxer
+ * does not wait for a full round trip when it seeks to it. */
+struct http_prefetch
+{
+    struct vlc_http_resource *resource;
+    vlc_thread_t thread;
+    vlc_interrupt_t *interrupt;
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    uint64_t start;
+    size_t length;
+    size_t received;
+    bool done;
+    uint8_t buf[];
+};
 
 typedef struct
 {
     struct vlc_http_mgr *manager;
     struct vlc_http_resource *resource;
+    struct http_prefetch *prefetch;
+    uint64_t offset;
+    bool in_prefetch;
+    bool probed;
 } access_sys_t;
 
+#define PREFETCH_MIN_OFFSET (1 << 20)
+/* Caching stream filters read whole aligned chunks: start a bit earlier */
+#define PREFETCH_ALIGN (256 << 10)
+
+static void PrefetchWakeUp(void *data)
+{
+    struct http_prefetch *pf = data;
+
+    vlc_mutex_lock(&pf->lock);
+    vlc_cond_broadcast(&pf->wait);
+    vlc_mutex_unlock(&pf->lock);
+}
+
+/* Creates a second resource for the same file, to read another range */
+static struct vlc_http_resource *RangeCreate(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    char *ua = var_InheritString(access, "http-user-agent");
+    char *referer = var_InheritString(access, "http-referrer");
+
+    struct vlc_http_resource *res = vlc_http_file_create(sys->manager,
+                                                         access->psz_url,
+                                                         ua, referer);
+    free(referer);
+    free(ua);
+
+    if (res != NULL && sys->resource->username != NULL)
+        vlc_http_res_set_login(res, sys->resource->username,
+                               sys->resource->password);
+    return res;
+}
+
+static bool RangeSeek(struct vlc_http_resource *res, uint64_t offset)
+{
+    return vlc_http_file_seek(res, offset) == 0
+        && vlc_http_res_get_status(res) == 206;
+}
+
+static void *PrefetchThread(void *data)
+{
+    struct http_prefetch *pf = data;
+    size_t received = 0;
+
+    vlc_interrupt_set(pf->interrupt);
+
+    if (RangeSeek(pf->resource, pf->start))
+    {
+        block_t *block;
+
+        while (received < pf->length
+            && (block = vlc_http_file_read(pf->resource)) != NULL)
+        {
+            size_t copy = __MIN(block->i_buffer, pf->length - received);
+
+            memcpy(pf->buf + received, block->p_buffer, copy);
+            block_Release(block);
+            received += copy;
+
+            vlc_mutex_lock(&pf->lock);
+            pf->received = received;
+            vlc_cond_broadcast(&pf->wait);
+            vlc_mutex_unlock(&pf->lock);
+        }
+    }
+
+    vlc_mutex_lock(&pf->lock);
+    pf->done = true;
+    vlc_cond_broadcast(&pf->wait);
+    vlc_mutex_unlock(&pf->lock);
+    return NULL;
+}
+
+static void PrefetchStart(stream_t *access, const block_t *block)
+{
+    access_sys_t *sys = access->p_sys;
+    int64_t limit = var_InheritInteger(access, "http-index-prefetch");
+
+    if (limit <= 0 || !vlc_http_file_can_seek(sys->resource))
+        return;
+
+    uintmax_t size = vlc_http_file_get_size(sys->resource);
+    if (size >= UINT64_MAX)
+        return;
+
+    uint64_t start = vlc_http_probe_mp4(block->p_buffer, block->i_buffer);
+    if (start == 0)
+        start = vlc_http_probe_mkv(block->p_buffer, block->i_buffer);
+    if (start < PREFETCH_MIN_OFFSET || start >= size)
+        return; /* close enough to be read sequentially */
+    start &= ~(uint64_t)(PREFETCH_ALIGN - 1);
+
+    size_t length = __MIN(size - start, (uint64_t)limit << 10);
+    struct http_prefetch *pf = malloc(sizeof (*pf) + length);
+    if (unlikely(pf == NULL))
+        return;
+
+    pf->resource = RangeCreate(access);
+    if (pf->resource == NULL)
+        goto error;
+
+    pf->interrupt = vlc_interrupt_create();
+    if (unlikely(pf->interrupt == NULL))
+        goto error;
+
+    vlc_mutex_init(&pf->lock);
+    vlc_cond_init(&pf->wait);
+    pf->start = start;
+    pf->length = length;
+    pf->received = 0;
+    pf->done = false;
+
+    if (vlc_clone(&pf->thread, PrefetchThread, pf, VLC_THREAD_PRIORITY_LOW))
+    {
+        vlc_interrupt_destroy(pf->interrupt);
+        goto error;
+    }
+
+    msg_Dbg(access, "prefetching index at %" PRIu64 " (%zu bytes)", start,
+            length);
+    sys->prefetch = pf;
+    return;
+
+error:
+    if (pf->resource != NULL)
+        vlc_http_res_destroy(pf->resource);
+    free(pf);
+}
+
+static void PrefetchStop(struct http_prefetch *pf)
+{
+    vlc_interrupt_kill(pf->interrupt);
+    vlc_join(pf->thread, NULL);
+    vlc_interrupt_destroy(pf->interrupt);
+    vlc_http_res_destroy(pf->resource);
+    free(pf);
+}
+
+static block_t *PrefetchRead(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    struct http_prefetch *pf = sys->prefetch;
+    size_t offset = sys->offset - pf->start;
+    block_t *block = NULL;
+
+    vlc_interrupt_register(PrefetchWakeUp, pf);
+    vlc_mutex_lock(&pf->lock);
+    while (pf->received <= offset && !pf->done && !vlc_killed())
+        vlc_cond_wait(&pf->wait, &pf->lock);
+
+    size_t received = pf->received;
+    bool done = pf->done;
+    vlc_mutex_unlock(&pf->lock);
+    vlc_interrupt_unregister();
+
+    if (received > offset)
+    {   /* The buffer is only ever appended to */
+        size_t len = __MIN(received - offset, 65536);
+
+        block = block_Alloc(len);
+        if (likely(block != NULL))
+        {
+            memcpy(block->p_buffer, pf->buf + offset, len);
+            sys->offset += len;
+        }
+    }
+    else if (done)
+        sys->in_prefetch = false; /* end of the range or failure */
+
+    return block;
+}
+
+#define RANGES_MAX 4
+
+/* One of the parallel requests of STREAM_READ_RANGES */
+struct http_range_job
+{
+    struct http_ranges *batch;
+    struct vlc_stream_range *range;
+    struct vlc_http_resource *resource;
+    vlc_interrupt_t *interrupt;
+    vlc_thread_t thread;
+    bool failed;
+};
+
+struct http_ranges
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    unsigned pending;
+};
+
+static void RangesWakeUp(void *data)
+{
+    struct http_ranges *batch = data;
+
+    vlc_mutex_lock(&batch->lock);
+    vlc_cond_broadcast(&batch->wait);
+    vlc_mutex_unlock(&batch->lock);
+}
+
+static void *RangeThread(void *data)
+{
+    struct http_range_job *job = data;
+    struct vlc_stream_range *range = job->range;
+    struct http_ranges *batch = job->batch;
+
+    vlc_interrupt_set(job->interrupt);
+    job->failed = !RangeSeek(job->resource, range->offset);
+
+    while (!job->failed && range->read < range->length)
+    {
+        block_t *block = vlc_http_file_read(job->resource);
+        if (block == NULL)
+            break; /* end of file */
+
+        size_t copy = __MIN(block->i_buffer, range->length - range->read);
+
+        memcpy((char *)range->buf + range->read, block->p_buffer, copy);
+        range->read += copy;
+        block_Release(block);
+    }
+
+    vlc_mutex_lock(&batch->lock);
+    batch->pending--;
+    vlc_cond_signal(&batch->wait);
+    vlc_mutex_unlock(&batch->lock);
+    return NULL;
+}
+
+/* Reads up to RANGES_MAX ranges with as many concurrent requests. With
+ * HTTP/2, these are multiplexed on the connection of the main request. */
+static int ReadRangesBatch(stream_t *access, struct vlc_stream_range *ranges,
+                           size_t count)
+{
+    struct http_ranges batch = { .pending = 0 };
+    struct http_range_job jobs[RANGES_MAX];
+    unsigned started = 0;
+    bool failed = false;
+
+    vlc_mutex_init(&batch.lock);
+    vlc_cond_init(&batch.wait);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        struct http_range_job *job = &jobs[started];
+
+        job->batch = &batch;
+        job->range = &ranges[i];
+        job->failed = false;
+        ranges[i].read = 0;
+
+        job->resource = RangeCreate(access);
+        if (job->resource == NULL)
+        {
+            failed = true;
+            break;
+        }
+
+        job->interrupt = vlc_interrupt_create();
+        if (unlikely(job->interrupt == NULL))
+        {
+            vlc_http_res_destroy(job->resource);
+            failed = true;
+            break;
+        }
+
+        vlc_mutex_lock(&batch.lock);
+        batch.pending++;
+        vlc_mutex_unlock(&batch.lock);
+
+        if (vlc_clone(&job->thread, RangeThread, job,
+                      VLC_THREAD_PRIORITY_INPUT))
+        {
+            vlc_interrupt_destroy(job->interrupt);
+            vlc_http_res_destroy(job->resource);
+            vlc_mutex_lock(&batch.lock);
+            batch.pending--;
+            vlc_mutex_unlock(&batch.lock);
+            failed = true;
+            break;
+        }
+        started++;
+    }
+
+    vlc_interrupt_register(RangesWakeUp, &batch);
+    vlc_mutex_lock(&batch.lock);
+    while (batch.pending > 0 && !vlc_killed())
+        vlc_cond_wait(&batch.wait, &batch.lock);
+    vlc_mutex_unlock(&batch.lock);
+    vlc_interrupt_unregister();
+
+    for (unsigned i = 0; i < started; i++)
+    {
+        struct http_range_job *job = &jobs[i];
+
+        vlc_interrupt_kill(job->interrupt); /* no-op if already done */
+        vlc_join(job->thread, NULL);
+        vlc_interrupt_destroy(job->interrupt);
+        vlc_http_res_destroy(job->resource);
+        failed = failed || job->failed;
+    }
+    return failed ? VLC_EGENERIC : VLC_SUCCESS;
+}
+
+static int FileReadRanges(stream_t *access, struct vlc_stream_range *ranges,
+                          size_t count)
+{
+    /* This can run concurrently with FileRead() and FileSeek() under the
+     * prefetch filter: do not touch the main resource state. If the server
+     * does not support ranges, the requests will fail with status 200. */
+    for (size_t i = 0; i < count; i += RANGES_MAX)
+    {
+        if (vlc_killed())
+            return VLC_EGENERIC;
+
+        int ret = ReadRangesBatch(access, ranges + i,
+                                  __MIN(count - i, RANGES_MAX));
+        if (ret != VLC_SUCCESS)
+            return ret;
+    }
+    return VLC_SUCCESS;
+}
+
 static block_t *FileRead(stream_t *access, bool *restrict eof)
 {
     access_sys_t *sys = access->p_sys;
 
+    if (sys->in_prefetch)
+    {
+        block_t *b = PrefetchRead(access);
+        if (b != NULL || sys->in_prefetch)
+            return b;
+
+        /* Past the prefetched data: resume on the main resource */
+        if (sys->offset >= vlc_http_file_get_size(sys->resource)
+         || vlc_http_file_seek(sys->resource, sys->offset))
+        {
+            *eof = true;
+            return NULL;
+        }
+    }
+
     block_t *b = vlc_http_file_read(sys->resource);
     if (b == NULL)
+    {
         *eof = true;
+        return NULL;
+    }
+
+    if (!sys->probed)
+    {
+        sys->probed = true;
+        if (sys->offset == 0)
+            PrefetchStart(access, b);
+    }
+    sys->offset += b->i_buffer;
     return b;
 }
 
 static int FileSeek(stream_t *access, uint64_t pos)
 {
     access_sys_t *sys = access->p_sys;
+    struct http_prefetch *pf = sys->prefetch;
+
+    if (pf != NULL && pos >= pf->start && pos - pf->start < pf->length)
+    {
+        vlc_mutex_lock(&pf->lock);
+        bool available = !pf->done || pos - pf->start < pf->received;
+        vlc_mutex_unlock(&pf->lock);
+
+        if (available)
+        {
+            sys->in_prefetch = true;
+            sys->offset = pos;
+            return VLC_SUCCESS;
+        }
+    }
 
     if (vlc_http_file_seek(sys->resource, pos))
         return VLC_EGENERIC;
+    sys->in_prefetch = false;
+    sys->offset = pos;
     return VLC_SUCCESS;
 }
 
@@ -104,6 +493,13 @@ static int FileControl(stream_t *access, int query, va_list args)
             *va_arg(args, char **) = vlc_http_file_get_type(sys->resource);
             break;
 
+        case STREAM_READ_RANGES:
+        {
+            struct vlc_stream_range *ranges =
+                va_arg(args, struct vlc_stream_range *);
+            return FileReadRanges(access, ranges, va_arg(args, size_t));
+        }
+
         case STREAM_SET_PAUSE_STATE:
             break;
 
@@ -162,6 +558,10 @@ static int Open(vlc_object_t *obj)
 
     sys->manager = NULL;
     sys->resource = NULL;
+    sys->prefetch = NULL;
+    sys->offset = 0;
+    sys->in_prefetch = false;
+    sys->probed = false;
 
     void *jar = NULL;
     if (var_InheritBool(obj, "http-forward-cookies"))
@@ -275,6 +675,8 @@ static void Close(vlc_object_t *obj)
     stream_t *access = (stream_t *)obj;
     access_sys_t *sys = access->p_sys;
 
+    if (sys->prefetch != NULL)
+        PrefetchStop(sys->prefetch);
     vlc_http_res_destroy(sys->resource);
     vlc_http_mgr_destroy(sys->manager);
     free(sys);
@@ -292,6 +694,11 @@ vlc_module_begin()
     add_bool("http-continuous", false, N_("Continuous stream"),
              N_("Keep reading a resource that keeps being updated."), true)
         change_volatile()
+    add_integer("http-index-prefetch", 8192, N_("Index prefetch (KiB)"),
+                N_("Maximum amount of data to fetch ahead of time from the "
+                   "index at the end of a file (MP4 movie box or Matroska "
+                   "cues), in parallel with the beginning of the file. "
+                   "Zero disables prefetching."), true)
     add_bool("http-forward-cookies", true, N_("Cookies forwarding"),
              N_("Forward cookies across HTTP redirections."), true)
     add_string("http-referrer", NULL, N_("Referrer"),
@@ -23,8 +23,12 @@
 #endif
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 #include <vlc_common.h>
+#include <vlc_list.h>
 #include <vlc_network.h>
+#include <vlc_strings.h>
 #include <vlc_tls.h>
 #include <vlc_url.h>
 #include "transport.h"
@@ -96,54 +100,179 @@ static char *vlc_http_proxy_find(const char *hostname, unsigned port,
 }
 
 
-struct vlc_http_mgr
+/** Maximum number of connections kept by a pool */
+#define VLC_HTTP_POOL_MAX 8
+
+/** Pooled connection */
+struct vlc_http_pool_conn
 {
-    struct vlc_logger *logger;
-    vlc_object_t *obj;
+    struct vlc_http_conn *conn; /**< NULL while being established */
+    char *host;
+    unsigned port;
+    bool secure;
+    bool http2; /**< Whether the connection can be shared */
+    struct vlc_list node;
+};
+
+/**
+ * HTTP connections pool.
+ *
+ * All the HTTP connection managers of a LibVLC instance share one pool. This
+ * way, inputs from a same server reuse idle HTTP/1.x connections, and
+ * multiplex their requests on a single HTTP/2 connection. The pool is
+ * destroyed along with the last manager that uses it.
+ *
+ * This code is linked statically into each plugin using it, so the pool is
+ * looked up through a variable of the LibVLC instance, not a static.
+ */
+struct vlc_http_pool
+{
+    libvlc_int_t *libvlc;
     vlc_tls_client_t *creds;
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /**< Signaled when a connection is established */
+    unsigned refs; /**< Protected by VLC_HTTP_MUTEX */
+    unsigned count;
+    struct vlc_list conns;
+};
+
+struct vlc_http_mgr
+{
+    struct vlc_http_pool *pool;
     struct vlc_http_cookie_jar_t *jar;
-    struct vlc_http_conn *conn;
 };
 
-static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
-                                               const char *host, unsigned port)
+static void *vlc_http_pool_logger(struct vlc_http_pool *pool)
 {
-    (void) host; (void) port;
-    return mgr->conn;
+    /* Connections can outlive the object that established them */
+    return VLC_OBJECT(pool->libvlc)->logger;
 }
 
-static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
-                                 struct vlc_http_conn *conn)
+static void vlc_http_pool_remove(struct vlc_http_pool *pool,
+                                 struct vlc_http_pool_conn *pc)
 {
-    assert(mgr->conn == conn);
-    mgr->conn = NULL;
+    vlc_list_remove(&pc->node);
+    pool->count--;
 
-    vlc_http_conn_release(conn);
+    if (pc->conn != NULL)
+        vlc_http_conn_release(pc->conn);
+    free(pc->host);
+    free(pc);
 }
 
-static
-struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
-                                        const char *host, unsigned port,
-                                        const struct vlc_http_msg *req)
+static struct vlc_http_pool_conn *vlc_http_pool_add(struct vlc_http_pool *pool,
+                                                    bool secure,
+                                                    const char *host,
+                                                    unsigned port)
 {
-    struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
-    if (conn == NULL)
+    struct vlc_http_pool_conn *pc = malloc(sizeof (*pc));
+    if (unlikely(pc == NULL))
         return NULL;
 
-    struct vlc_http_stream *stream = vlc_http_stream_open(conn, req);
-    if (stream != NULL)
+    pc->host = strdup(host);
+    if (unlikely(pc->host == NULL))
     {
-        struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
-        if (m != NULL)
-            return m;
-
-        /* NOTE: If the request were not idempotent, we would not know if it
-         * was processed by the other end. Thus POST is not used/supported so
-         * far, and CONNECT is treated as if it were idempotent (which works
-         * fine here). */
+        free(pc);
+        return NULL;
+    }
+
+    pc->conn = NULL;
+    pc->port = port;
+    pc->secure = secure;
+    pc->http2 = false;
+
+    if (pool->count >= VLC_HTTP_POOL_MAX)
+    {   /* Evict the oldest connection */
+        struct vlc_http_pool_conn *old;
+
+        vlc_list_foreach(old, &pool->conns, node)
+            if (old->conn != NULL)
+            {
+                vlc_http_pool_remove(pool, old);
+                break;
+            }
+    }
+
+    vlc_list_append(&pc->node, &pool->conns);
+    pool->count++;
+    return pc;
+}
+
+/**
+ * Opens a stream on a pooled connection to a given origin.
+ *
+ * Must be called with the pool lock held.
+ *
+ * @param pending set if a connection to the origin is being established
+ *                by another thread [OUT]
+ */
+static struct vlc_http_stream *vlc_http_pool_open(struct vlc_http_pool *pool,
+                                                  bool secure,
+                                                  const char *host,
+                                                  unsigned port,
+                                                  const struct vlc_http_msg *req,
+                                                  struct vlc_http_conn **connp,
+                                                  bool *pending)
+{
+    struct vlc_http_pool_conn *pc;
+
+    *pending = false;
+
+    vlc_list_foreach(pc, &pool->conns, node)
+    {
+        if (pc->secure != secure || pc->port != port
+         || vlc_ascii_strcasecmp(pc->host, host))
+            continue;
+
+        if (pc->conn == NULL)
+        {
+            *pending = true;
+            continue;
+        }
+
+        struct vlc_http_stream *stream = vlc_http_stream_open(pc->conn, req);
+        if (stream != NULL)
+        {
+            *connp = pc->conn;
+            return stream;
+        }
+
+        /* Get rid of closing or reset connection. An HTTP/1.x connection
+         * may merely be busy with another request: keep it. */
+        if (pc->http2)
+            vlc_http_pool_remove(pool, pc);
     }
-    /* Get rid of closing or reset connection */
-    vlc_http_mgr_release(mgr, conn);
+    return NULL;
+}
+
+/**
+ * Waits for the response header of a stream.
+ *
+ * This is called without the pool lock, so that other threads can use the
+ * pool (and open streams on the same HTTP/2 connection) in the mean time.
+ */
+static struct vlc_http_msg *vlc_http_pool_wait(struct vlc_http_pool *pool,
+                                               struct vlc_http_conn *conn,
+                                               struct vlc_http_stream *stream)
+{
+    struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
+    if (m != NULL)
+        return m;
+
+    /* NOTE: If the request were not idempotent, we would not know if it
+     * was processed by the other end. Thus POST is not used/supported so
+     * far, and CONNECT is treated as if it were idempotent (which works
+     * fine here). */
+    struct vlc_http_pool_conn *pc;
+
+    vlc_mutex_lock(&pool->lock);
+    vlc_list_foreach(pc, &pool->conns, node)
+        if (pc->conn == conn)
+        {
+            vlc_http_pool_remove(pool, pc);
+            break;
+        }
+    vlc_mutex_unlock(&pool->lock);
     return NULL;
 }
 
@@ -151,75 +280,121 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
                                               const char *host, unsigned port,
                                               const struct vlc_http_msg *req)
 {
-    vlc_tls_t *tls;
-    bool http2 = true;
-
-    if (mgr->creds == NULL && mgr->conn != NULL)
-        return NULL; /* switch from HTTP to HTTPS not implemented */
+    struct vlc_http_pool *pool = mgr->pool;
+    struct vlc_http_conn *conn;
+    struct vlc_http_stream *stream;
+    bool pending;
 
-    if (mgr->creds == NULL)
+    vlc_mutex_lock(&pool->lock);
+    if (pool->creds == NULL)
     {   /* First TLS connection: load x509 credentials */
-        mgr->creds = vlc_tls_ClientCreate(mgr->obj);
-        if (mgr->creds == NULL)
-            return NULL;
+        pool->creds = vlc_tls_ClientCreate(VLC_OBJECT(pool->libvlc));
+        if (pool->creds == NULL)
+            goto error;
     }
 
-    /* TODO? non-idempotent request support */
-    struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req);
-    if (resp != NULL)
-        return resp; /* existing connection reused */
+    for (;;)
+    {
+        /* TODO? non-idempotent request support */
+        stream = vlc_http_pool_open(pool, true, host, port, req, &conn,
+                                    &pending);
+        if (stream != NULL)
+        {
+            vlc_mutex_unlock(&pool->lock);
+
+            struct vlc_http_msg *resp = vlc_http_pool_wait(pool, conn, stream);
+            if (resp != NULL)
+                return resp; /* existing connection reused */
+
+            vlc_mutex_lock(&pool->lock);
+            continue;
+        }
+
+        if (!pending)
+            break;
+        /* Wait for the connection being established, it may be HTTP/2 */
+        vlc_cond_wait(&pool->wait, &pool->lock);
+    }
+
+    struct vlc_http_pool_conn *pc = vlc_http_pool_add(pool, true, host, port);
+    if (unlikely(pc == NULL))
+        goto error;
+
+    vlc_tls_client_t *creds = pool->creds;
+    vlc_mutex_unlock(&pool->lock);
 
+    vlc_tls_t *tls;
+    bool http2 = true;
     char *proxy = vlc_http_proxy_find(host, port, true);
     if (proxy != NULL)
     {
-        tls = vlc_https_connect_proxy(mgr->creds, mgr->creds,
-                                      host, port, &http2, proxy);
+        tls = vlc_https_connect_proxy(creds, creds, host, port, &http2, proxy);
         free(proxy);
     }
     else
-        tls = vlc_https_connect(mgr->creds, host, port, &http2);
+        tls = vlc_https_connect(creds, host, port, &http2);
 
-    if (tls == NULL)
-        return NULL;
+    conn = NULL;
+    if (tls != NULL)
+    {
+        /* For HTTPS, TLS-ALPN determines whether HTTP version 2.0 ("h2") or
+         * 1.1 ("http/1.1") is used.
+         * NOTE: If the negotiated protocol is explicitly "http/1.1", HTTP 1.0
+         * should not be used. HTTP 1.0 should only be used if ALPN is not
+         * supported by the server.
+         * NOTE: We do not enforce TLS version 1.2 for HTTP 2.0 explicitly.
+         */
+        if (http2)
+            conn = vlc_h2_conn_create(vlc_http_pool_logger(pool), tls);
+        else
+            conn = vlc_h1_conn_create(vlc_http_pool_logger(pool), tls, false);
 
-    struct vlc_http_conn *conn;
+        if (unlikely(conn == NULL))
+            vlc_tls_Close(tls);
+    }
 
-    /* For HTTPS, TLS-ALPN determines whether HTTP version 2.0 ("h2") or 1.1
-     * ("http/1.1") is used.
-     * NOTE: If the negotiated protocol is explicitly "http/1.1", HTTP 1.0
-     * should not be used. HTTP 1.0 should only be used if ALPN is not
-     * supported by the server.
-     * NOTE: We do not enforce TLS version 1.2 for HTTP 2.0 explicitly.
-     */
-    if (http2)
-        conn = vlc_h2_conn_create(mgr->logger, tls);
-    else
-        conn = vlc_h1_conn_create(mgr->logger, tls, false);
+    vlc_mutex_lock(&pool->lock);
+    pc->conn = conn;
+    pc->http2 = http2;
+    vlc_cond_broadcast(&pool->wait);
 
-    if (unlikely(conn == NULL))
+    stream = (conn != NULL) ? vlc_http_stream_open(conn, req) : NULL;
+    if (stream == NULL)
     {
-        vlc_tls_Close(tls);
-        return NULL;
+        vlc_http_pool_remove(pool, pc);
+        goto error;
     }
+    vlc_mutex_unlock(&pool->lock);
 
-    mgr->conn = conn;
-
-    return vlc_http_mgr_reuse(mgr, host, port, req);
+    return vlc_http_pool_wait(pool, conn, stream);
+error:
+    vlc_mutex_unlock(&pool->lock);
+    return NULL;
 }
 
 static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
                                              const char *host, unsigned port,
                                              const struct vlc_http_msg *req)
 {
-    if (mgr->creds != NULL && mgr->conn != NULL)
-        return NULL; /* switch from HTTPS to HTTP not implemented */
-
-    struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req);
-    if (resp != NULL)
-        return resp;
-
+    struct vlc_http_pool *pool = mgr->pool;
     struct vlc_http_conn *conn;
     struct vlc_http_stream *stream;
+    struct vlc_http_msg *resp;
+    bool pending;
+
+    vlc_mutex_lock(&pool->lock);
+    while ((stream = vlc_http_pool_open(pool, false, host, port, req, &conn,
+                                        &pending)) != NULL)
+    {
+        vlc_mutex_unlock(&pool->lock);
+
+        resp = vlc_http_pool_wait(pool, conn, stream);
+        if (resp != NULL)
+            return resp;
+
+        vlc_mutex_lock(&pool->lock);
+    }
+    vlc_mutex_unlock(&pool->lock);
 
     char *proxy = vlc_http_proxy_find(host, port, false);
     if (proxy != NULL)
@@ -230,7 +405,7 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
         free(proxy);
 
         if (url.psz_host != NULL)
-            stream = vlc_h1_request(mgr->logger, url.psz_host,
+            stream = vlc_h1_request(vlc_http_pool_logger(pool), url.psz_host,
                                     url.i_port ? url.i_port : 80, true, req,
                                     true, &conn);
         else
@@ -239,8 +414,8 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
         vlc_UrlClean(&url);
     }
     else
-        stream = vlc_h1_request(mgr->logger, host, port ? port : 80, false,
-                                req, true, &conn);
+        stream = vlc_h1_request(vlc_http_pool_logger(pool), host,
+                                port ? port : 80, false, req, true, &conn);
 
     if (stream == NULL)
         return NULL;
@@ -252,7 +427,13 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    mgr->conn = conn;
+    vlc_mutex_lock(&pool->lock);
+    struct vlc_http_pool_conn *pc = vlc_http_pool_add(pool, false, host, port);
+    if (likely(pc != NULL))
+        pc->conn = conn;
+    else
+        vlc_http_conn_release(conn);
+    vlc_mutex_unlock(&pool->lock);
     return resp;
 }
 
@@ -278,19 +459,60 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
     if (unlikely(mgr == NULL))
         return NULL;
 
-    mgr->logger = obj->logger;
-    mgr->obj = obj;
-    mgr->creds = NULL;
+    libvlc_int_t *libvlc = vlc_object_instance(obj);
+    struct vlc_http_pool *pool;
+
+    vlc_global_lock(VLC_HTTP_MUTEX);
+    pool = var_GetAddress(libvlc, "http-pool");
+    if (pool == NULL)
+    {
+        pool = malloc(sizeof (*pool));
+        if (unlikely(pool == NULL))
+        {
+            vlc_global_unlock(VLC_HTTP_MUTEX);
+            free(mgr);
+            return NULL;
+        }
+
+        pool->libvlc = libvlc;
+        pool->creds = NULL;
+        vlc_mutex_init(&pool->lock);
+        vlc_cond_init(&pool->wait);
+        pool->refs = 0;
+        pool->count = 0;
+        vlc_list_init(&pool->conns);
+        var_Create(libvlc, "http-pool", VLC_VAR_ADDRESS);
+        var_SetAddress(libvlc, "http-pool", pool);
+    }
+    pool->refs++;
+    vlc_global_unlock(VLC_HTTP_MUTEX);
+
+    mgr->pool = pool;
     mgr->jar = jar;
-    mgr->conn = NULL;
     return mgr;
 }
 
 void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr)
 {
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
-    if (mgr->creds != NULL)
-        vlc_tls_ClientDelete(mgr->creds);
+    struct vlc_http_pool *pool = mgr->pool;
+
+    vlc_global_lock(VLC_HTTP_MUTEX);
+    assert(pool->refs > 0);
+    if (--pool->refs == 0)
+        var_Destroy(pool->libvlc, "http-pool");
+    else
+        pool = NULL;
+    vlc_global_unlock(VLC_HTTP_MUTEX);
+
+    if (pool != NULL)
+    {   /* Last manager: nobody can be establishing a connection */
+        struct vlc_http_pool_conn *pc;
+
+        vlc_list_foreach(pc, &pool->conns, node)
+            vlc_http_pool_remove(pool, pc);
+        if (pool->creds != NULL)
+            vlc_tls_ClientDelete(pool->creds);
+        free(pool);
+    }
     free(mgr);
 }
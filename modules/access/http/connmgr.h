@@ -69,7 +69,8 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
  * Destroys an HTTP connection manager
  *
  * Deallocates an HTTP client connections manager created by
- * vlc_http_msg_destroy(). Any remaining connection is closed and destroyed.
+ * vlc_http_msg_destroy(). Connections are shared by all the managers of a
+ * LibVLC instance: they are closed and destroyed with the last manager.
  */
 void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr);
 
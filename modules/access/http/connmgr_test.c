@@ -0,0 +1,250 @@
+/*****************************************************************************
+ * connmgr_test.c: HTTP connections pool test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/types.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#ifndef SOCK_CLOEXEC
+# define SOCK_CLOEXEC 0
+# define accept4(a,b,c,d) accept(a,b,c)
+#endif
+#ifdef _WIN32
+# include <winsock2.h>
+#else
+# include <netinet/in.h>
+#endif
+#ifdef HAVE_ARPA_INET_H
+#include <arpa/inet.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_network.h>
+#include "../../../lib/libvlc_internal.h"
+#include "connmgr.h"
+#include "message.h"
+
+const char vlc_module_name[] = "test_http_connmgr";
+
+static atomic_uint connection_count = 0;
+static atomic_uint request_count = 0;
+
+/* Serves the requests of one connection until the client closes it */
+static void server_client_process(int fd)
+{
+    char buf[1024];
+    size_t buflen = 0;
+
+    for (;;)
+    {
+        char *end;
+
+        while ((end = strnstr(buf, "\r\n\r\n", buflen)) == NULL)
+        {
+            ssize_t val = recv(fd, buf + buflen, sizeof (buf) - buflen - 1, 0);
+            if (val <= 0)
+                return;
+            buflen += val;
+            buf[buflen] = '\0';
+        }
+
+        char path[64];
+        assert(sscanf(buf, "GET %63s HTTP/1.1\r\n", path) == 1);
+        atomic_fetch_add(&request_count, 1);
+
+        bool last = !strcmp(path, "/close");
+        char resp[128];
+        int len = snprintf(resp, sizeof (resp), "HTTP/1.1 200 OK\r\n"
+                           "Content-Length: 5\r\n%s\r\nHello",
+                           last ? "Connection: close\r\n" : "");
+        assert(write(fd, resp, len) == len);
+
+        if (last)
+            return;
+
+        end += 4;
+        buflen -= end - buf;
+        memmove(buf, end, buflen);
+        buf[buflen] = '\0';
+    }
+}
+
+static void *server_thread(void *data)
+{
+    int *lfd = data;
+
+    for (;;)
+    {
+        int cfd = accept4(*lfd, NULL, NULL, SOCK_CLOEXEC);
+        if (cfd == -1)
+            continue;
+
+        int canc = vlc_savecancel();
+        atomic_fetch_add(&connection_count, 1);
+        server_client_process(cfd);
+        vlc_close(cfd);
+        vlc_restorecancel(canc);
+    }
+    vlc_assert_unreachable();
+}
+
+static int server_socket(unsigned *port)
+{
+    int fd = socket(PF_INET6, SOCK_STREAM|SOCK_CLOEXEC, IPPROTO_TCP);
+    if (fd == -1)
+        return -1;
+
+    struct sockaddr_in6 addr = {
+        .sin6_family = AF_INET6,
+#ifdef HAVE_SA_LEN
+        .sin6_len = sizeof (addr),
+#endif
+        .sin6_addr = in6addr_loopback,
+    };
+    socklen_t addrlen = sizeof (addr);
+
+    if (bind(fd, (struct sockaddr *)&addr, addrlen)
+     || getsockname(fd, (struct sockaddr *)&addr, &addrlen)
+     || listen(fd, 255))
+    {
+        vlc_close(fd);
+        return -1;
+    }
+
+    *port = ntohs(addr.sin6_port);
+    return fd;
+}
+
+static struct vlc_http_mgr *mgr;
+static unsigned port;
+
+static struct vlc_http_msg *request(const char *path)
+{
+    char authority[32];
+
+    snprintf(authority, sizeof (authority), "[::1]:%u", port);
+
+    struct vlc_http_msg *req = vlc_http_req_create("GET", "http", authority,
+                                                   path);
+    assert(req != NULL);
+
+    struct vlc_http_msg *resp = vlc_http_mgr_request(mgr, false, "::1", port,
+                                                     req);
+    vlc_http_msg_destroy(req);
+    assert(resp != NULL);
+    resp = vlc_http_msg_get_final(resp);
+    assert(resp != NULL);
+    assert(vlc_http_msg_get_status(resp) == 200);
+    return resp;
+}
+
+static void request_read(const char *path)
+{
+    struct vlc_http_msg *resp = request(path);
+    char body[8];
+    size_t len = 0;
+    block_t *block;
+
+    while ((block = vlc_http_msg_read(resp)) != NULL)
+    {
+        assert(len + block->i_buffer <= sizeof (body));
+        memcpy(body + len, block->p_buffer, block->i_buffer);
+        len += block->i_buffer;
+        block_Release(block);
+    }
+    assert(len == 5 && !memcmp(body, "Hello", 5));
+    vlc_http_msg_destroy(resp);
+}
+
+int main(void)
+{
+    int *lfd = malloc(sizeof (int));
+    assert(lfd != NULL);
+    *lfd = server_socket(&port);
+    if (*lfd == -1)
+    {
+        free(lfd);
+        return 77;
+    }
+
+    unsetenv("http_proxy");
+
+    libvlc_int_t *vlc = libvlc_InternalCreate();
+    assert(vlc != NULL);
+    mgr = vlc_http_mgr_create(VLC_OBJECT(vlc), NULL);
+    assert(mgr != NULL);
+
+    vlc_thread_t th;
+    if (vlc_clone(&th, server_thread, lfd, VLC_THREAD_PRIORITY_LOW))
+        assert(!"Thread error");
+
+    /* Completed response: the connection is reused */
+    request_read("/keep");
+    assert(atomic_load(&connection_count) == 1);
+    request_read("/keep");
+    assert(atomic_load(&connection_count) == 1);
+
+    /* Unread response body: the connection cannot be reused, and the next
+     * request must not be sent (and failed) on it first */
+    vlc_http_msg_destroy(request("/keep"));
+    request_read("/keep");
+    assert(atomic_load(&connection_count) == 2);
+    assert(atomic_load(&request_count) == 4);
+
+    /* Server closing the connection */
+    request_read("/close");
+    assert(atomic_load(&connection_count) == 2);
+    request_read("/keep");
+    assert(atomic_load(&connection_count) == 3);
+    assert(atomic_load(&request_count) == 6);
+
+    /* A second manager of the instance shares the pool */
+    struct vlc_http_mgr *first = mgr;
+
+    mgr = vlc_http_mgr_create(VLC_OBJECT(vlc), NULL);
+    assert(mgr != NULL);
+    request_read("/keep");
+    assert(atomic_load(&connection_count) == 3);
+    assert(atomic_load(&request_count) == 7);
+    vlc_http_mgr_destroy(mgr);
+    vlc_http_mgr_destroy(first);
+
+    vlc_cancel(th);
+    vlc_join(th, NULL);
+    vlc_close(*lfd);
+    free(lfd);
+    libvlc_InternalDestroy(vlc);
+    return 0;
+}
@@ -276,6 +276,10 @@ static void vlc_h1_stream_close(struct vlc_http_stream *stream, bool abort)
 
     if (abort)
         vlc_h1_stream_fatal(conn);
+    /* The connection cannot be reused if the server asked to close it, or if
+     * the end of the response was not reached (or cannot be known). */
+    else if (conn->connection_close || conn->content_length != 0)
+        vlc_h1_stream_fatal(conn);
 
     conn->active = false;
 
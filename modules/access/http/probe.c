@@ -0,0 +1,159 @@
+/*****************************************************************************
+ * probe.c: HTTP file index probing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "probe.h"
+
+static uint32_t GetBE32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+/* ISO base media: moov after a leading mdat */
+uint64_t vlc_http_probe_mp4(const uint8_t *p, size_t len)
+{
+    uint64_t pos = 0;
+
+    if (len < 8 || memcmp(p + 4, "ftyp", 4))
+        return 0;
+
+    while (pos + 16 <= len)
+    {
+        uint64_t size = GetBE32(p + pos);
+
+        if (size == 1)
+            size = ((uint64_t)GetBE32(p + pos + 8) << 32)
+                 | GetBE32(p + pos + 12);
+        if (size < 8)
+            return 0; /* box extends to the end of file or is invalid */
+        if (!memcmp(p + pos + 4, "moov", 4))
+            return 0;
+        if (!memcmp(p + pos + 4, "mdat", 4))
+            return (size <= UINT64_MAX - pos) ? pos + size : 0;
+        if (size > len - pos)
+            return 0; /* next box beyond the probed data */
+        pos += size;
+    }
+    return 0;
+}
+
+/* Reads an EBML variable length integer, returns its length or 0 */
+static size_t GetEBML(const uint8_t *p, size_t len, uint64_t *v, bool id)
+{
+    if (len == 0 || p[0] == 0)
+        return 0;
+
+    size_t n = 1;
+    while (!(p[0] & (0x80 >> (n - 1))))
+        n++;
+    if (n > len)
+        return 0;
+
+    uint64_t val = id ? p[0] : (p[0] & (0xFF >> n));
+    bool unknown = val == (uint64_t)(0xFF >> n);
+
+    for (size_t i = 1; i < n; i++)
+    {
+        val = (val << 8) | p[i];
+        unknown = unknown && p[i] == 0xFF;
+    }
+    *v = (!id && unknown) ? UINT64_MAX : val;
+    return n;
+}
+
+/* Reads an EBML element header, returns the offset of its payload or 0 */
+static size_t GetElement(const uint8_t *p, size_t len, uint32_t *id,
+                         uint64_t *size)
+{
+    uint64_t v;
+    size_t a = GetEBML(p, len, &v, true);
+    if (a == 0 || a > 4)
+        return 0;
+    *id = v;
+
+    size_t b = GetEBML(p + a, len - a, size, false);
+    return b ? a + b : 0;
+}
+
+/* Matroska: Cues position from the SeekHead */
+uint64_t vlc_http_probe_mkv(const uint8_t *p, size_t len)
+{
+    uint32_t id;
+    uint64_t size;
+    size_t pos = GetElement(p, len, &id, &size);
+
+    if (pos == 0 || id != 0x1A45DFA3 || size > len - pos)
+        return 0;
+    pos += size;
+
+    size_t hdr = GetElement(p + pos, len - pos, &id, &size);
+    if (hdr == 0 || id != 0x18538067)
+        return 0;
+    pos += hdr;
+
+    const uint64_t segment = pos;
+
+    /* Skip Void elements until the SeekHead */
+    while ((hdr = GetElement(p + pos, len - pos, &id, &size)) != 0)
+    {
+        if (id == 0x114D9B74)
+            break;
+        if (id != 0xEC || size > len - pos - hdr)
+            return 0;
+        pos += hdr + size;
+    }
+    if (hdr == 0 || size > len - pos - hdr)
+        return 0;
+
+    const uint8_t *seek = p + pos + hdr, *end = seek + size;
+
+    while ((hdr = GetElement(seek, end - seek, &id, &size)) != 0
+        && size <= (uint64_t)(end - seek) - hdr)
+    {
+        const uint8_t *entry = seek + hdr, *entry_end = entry + size;
+        uint64_t target = 0, position = UINT64_MAX;
+
+        while ((hdr = GetElement(entry, entry_end - entry, &id, &size)) != 0
+            && size <= (uint64_t)(entry_end - entry) - hdr && size <= 8)
+        {
+            uint64_t val = 0;
+
+            for (size_t i = 0; i < size; i++)
+                val = (val << 8) | entry[hdr + i];
+            if (id == 0x53AB)
+                target = val;
+            else if (id == 0x53AC)
+                position = val;
+            entry += hdr + size;
+        }
+
+        if (target == 0x1C53BB6B && position <= UINT64_MAX - segment)
+            return segment + position;
+        seek = entry_end;
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+/*****************************************************************************
+ * probe.h: HTTP file index probing declarations
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/**
+ * \defgroup http_probe Index probing
+ * Locates the index of a media file from its first bytes
+ * \ingroup http_res
+ * @{
+ */
+
+/**
+ * Probes an ISO base media file for a trailing index.
+ *
+ * @param p first bytes of the file
+ * @param len number of bytes at @c p
+ * @return the offset of the box following a leading mdat box,
+ *         or 0 if there is none or the data is invalid
+ */
+uint64_t vlc_http_probe_mp4(const uint8_t *p, size_t len);
+
+/**
+ * Probes a Matroska file for its cues.
+ *
+ * @param p first bytes of the file
+ * @param len number of bytes at @c p
+ * @return the offset of the Cues element referenced by the SeekHead,
+ *         or 0 if it was not found or the data is invalid
+ */
+uint64_t vlc_http_probe_mkv(const uint8_t *p, size_t len);
+
+/** @} */
@@ -0,0 +1,134 @@
+/*****************************************************************************
+ * probe_test.c: HTTP file index probing test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "probe.h"
+
+#define BOX(size, type) \
+    (size) >> 24, ((size) >> 16) & 0xFF, ((size) >> 8) & 0xFF, (size) & 0xFF, \
+    type[0], type[1], type[2], type[3]
+#define LARGEBOX(size, type) \
+    BOX(1, type), \
+    (uint8_t)((size) >> 56), (uint8_t)((size) >> 48), \
+    (uint8_t)((size) >> 40), (uint8_t)((size) >> 32), \
+    (uint8_t)((size) >> 24), (uint8_t)((size) >> 16), \
+    (uint8_t)((size) >> 8), (uint8_t)(size)
+#define FTYP \
+    BOX(24, "ftyp"), 'i', 's', 'o', 'm', 0, 0, 2, 0, \
+    'i', 's', 'o', 'm', 'i', 's', 'o', '2'
+
+static void test_mp4(void)
+{
+    static const uint8_t mdat[] = { FTYP, BOX(0x123456, "mdat"), 0, 0, 0, 0,
+                                    0, 0, 0, 0 };
+    assert(vlc_http_probe_mp4(mdat, sizeof (mdat)) == 24 + 0x123456);
+
+    static const uint8_t free_mdat[] = { FTYP, BOX(16, "free"), 0, 0, 0, 0,
+                                         0, 0, 0, 0,
+                                         LARGEBOX(0x123456789, "mdat") };
+    assert(vlc_http_probe_mp4(free_mdat, sizeof (free_mdat))
+           == 40 + 0x123456789);
+
+    static const uint8_t moov[] = { FTYP, BOX(0x123456, "moov"), 0, 0, 0, 0,
+                                    0, 0, 0, 0 };
+    assert(vlc_http_probe_mp4(moov, sizeof (moov)) == 0);
+
+    static const uint8_t no_ftyp[] = { BOX(0x123456, "mdat"), 0, 0, 0, 0,
+                                       0, 0, 0, 0 };
+    assert(vlc_http_probe_mp4(no_ftyp, sizeof (no_ftyp)) == 0);
+
+    static const uint8_t to_eof[] = { FTYP, BOX(0, "mdat"), 0, 0, 0, 0,
+                                      0, 0, 0, 0 };
+    assert(vlc_http_probe_mp4(to_eof, sizeof (to_eof)) == 0);
+
+    /* Boxes beyond the probed data */
+    static const uint8_t truncated[] = { FTYP, BOX(0x123456, "free"),
+                                         0, 0, 0, 0, 0, 0, 0, 0,
+                                         BOX(0x123456, "mdat") };
+    assert(vlc_http_probe_mp4(truncated, sizeof (truncated)) == 0);
+
+    /* Box sizes wrapping the offset around */
+    static const uint8_t wrap[] = { FTYP,
+                                    LARGEBOX(UINT64_C(0) - 24, "free"),
+                                    FTYP };
+    assert(vlc_http_probe_mp4(wrap, sizeof (wrap)) == 0);
+
+    static const uint8_t wrap_mdat[] = { FTYP,
+                                         LARGEBOX(UINT64_MAX, "mdat") };
+    assert(vlc_http_probe_mp4(wrap_mdat, sizeof (wrap_mdat)) == 0);
+}
+
+#define EBML_HEADER 0x1A, 0x45, 0xDF, 0xA3, 0x84, 0x42, 0x86, 0x81, 0x01
+#define SEGMENT 0x18, 0x53, 0x80, 0x67, 0xFF /* unknown size */
+#define SEGMENT_OFFSET 14
+#define VOID 0xEC, 0x82, 0x00, 0x00
+#define SEEK(id, pos) \
+    0x4D, 0xBB, 0x8D, \
+    0x53, 0xAB, 0x84, (id) >> 24, ((id) >> 16) & 0xFF, ((id) >> 8) & 0xFF, \
+    (id) & 0xFF, \
+    0x53, 0xAC, 0x83, (pos) >> 16, ((pos) >> 8) & 0xFF, (pos) & 0xFF
+
+static void test_mkv(void)
+{
+    static const uint8_t cues[] = {
+        EBML_HEADER, SEGMENT, VOID,
+        0x11, 0x4D, 0x9B, 0x74, 0xA0, /* SeekHead */
+        SEEK(0x1549A966, 0x1000), /* Info */
+        SEEK(0x1C53BB6B, 0x200000), /* Cues */
+    };
+    assert(vlc_http_probe_mkv(cues, sizeof (cues))
+           == SEGMENT_OFFSET + 0x200000);
+
+    static const uint8_t no_cues[] = {
+        EBML_HEADER, SEGMENT,
+        0x11, 0x4D, 0x9B, 0x74, 0x90, /* SeekHead */
+        SEEK(0x1654AE6B, 0x1000), /* Tracks */
+    };
+    assert(vlc_http_probe_mkv(no_cues, sizeof (no_cues)) == 0);
+
+    /* Every prefix of a valid file */
+    for (size_t len = 0; len < sizeof (cues); len++)
+        assert(vlc_http_probe_mkv(cues, len) == 0);
+
+    static const uint8_t not_ebml[] = { SEGMENT, EBML_HEADER };
+    assert(vlc_http_probe_mkv(not_ebml, sizeof (not_ebml)) == 0);
+
+    static const uint8_t bad_void[] = {
+        EBML_HEADER, SEGMENT, 0xEC, 0xFF, /* unknown size Void */
+        0x11, 0x4D, 0x9B, 0x74, 0x90, SEEK(0x1C53BB6B, 0x200000),
+    };
+    assert(vlc_http_probe_mkv(bad_void, sizeof (bad_void)) == 0);
+}
+
+int main(void)
+{
+    test_mp4();
+    test_mkv();
+    return 0;
+}
@@ -0,0 +1,406 @@
+/*****************************************************************************
+ * mmap.c: memory-mapped file input
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <vlc_common.h>
+#include "fs.h"
+#include <vlc_access.h>
+#include <vlc_block.h>
+#include <vlc_fs.h>
+
+#ifndef HAVE_POSIX_FADVISE
+# define posix_fadvise(fd, off, len, adv)
+#endif
+#ifndef HAVE_POSIX_MADVISE
+# define posix_madvise(addr, len, adv)
+#endif
+
+/* Size of each mapping: each block handed out is one window. Keep it smaller
+ * on 32-bits systems not to exhaust the address space. */
+#if (SIZE_MAX > UINT32_MAX)
+# define MMAP_WINDOW (8 << 20)
+#else
+# define MMAP_WINDOW (1 << 20)
+#endif
+/* Released windows are kept mapped for reuse, as demuxers often seek back to
+ * data they just read (probing, index parsing). The least recently used one
+ * is unmapped to map another range. */
+#define MMAP_WINDOWS 4
+
+struct mmap_pool;
+
+struct mmap_window
+{
+    block_t block; /* valid while busy */
+    struct mmap_pool *pool;
+    void *addr; /* NULL if not mapped */
+    uint64_t start;
+    size_t length;
+    uint64_t used; /* last use stamp, for recycling */
+    bool busy;
+};
+
+/* The windows outlive the access until their blocks are released */
+struct mmap_pool
+{
+    vlc_mutex_t lock;
+    unsigned refs; /* the access and the busy windows */
+    bool closed;
+    uint64_t stamp;
+    struct mmap_window windows[MMAP_WINDOWS];
+};
+
+typedef struct
+{
+    int fd;
+    uint64_t offset; /* offset of the next byte to hand out */
+    uint64_t size;   /* file size when it was last checked */
+    size_t page_mask;
+    bool fallback;   /* the file is being modified, mapping is not safe */
+    struct mmap_pool *pool;
+} access_sys_t;
+
+static void PoolRelease(struct mmap_pool *pool)
+{
+    vlc_mutex_lock(&pool->lock);
+    bool last = --pool->refs == 0;
+    vlc_mutex_unlock(&pool->lock);
+
+    if (!last)
+        return;
+
+    for (unsigned i = 0; i < MMAP_WINDOWS; i++)
+        if (pool->windows[i].addr != NULL)
+            munmap(pool->windows[i].addr, pool->windows[i].length);
+    free(pool);
+}
+
+static void WindowRelease(block_t *block)
+{
+    struct mmap_window *w = container_of(block, struct mmap_window, block);
+    struct mmap_pool *pool = w->pool;
+
+    vlc_mutex_lock(&pool->lock);
+    w->busy = false;
+    if (pool->closed)
+    {   /* nothing left to reuse it */
+        munmap(w->addr, w->length);
+        w->addr = NULL;
+    }
+    vlc_mutex_unlock(&pool->lock);
+    PoolRelease(pool);
+}
+
+static const struct vlc_block_callbacks window_cbs =
+{
+    WindowRelease,
+};
+
+/* Returns a block of a mapping of the given range, reusing a released window
+ * if possible */
+static block_t *WindowGet(stream_t *access, uint64_t start, size_t length)
+{
+    access_sys_t *sys = access->p_sys;
+    struct mmap_pool *pool = sys->pool;
+    struct mmap_window *w = NULL;
+
+    vlc_mutex_lock(&pool->lock);
+    for (unsigned i = 0; i < MMAP_WINDOWS; i++)
+    {
+        struct mmap_window *cand = &pool->windows[i];
+
+        if (cand->busy)
+            continue;
+        if (cand->addr != NULL && cand->start == start
+         && cand->length == length)
+        {
+            w = cand;
+            break;
+        }
+        /* Otherwise prefer a free slot, then the least recently used */
+        if (w == NULL || (w->addr != NULL
+                       && (cand->addr == NULL || cand->used < w->used)))
+            w = cand;
+    }
+
+    if (w != NULL && (w->addr == NULL || w->start != start
+                   || w->length != length))
+    {
+        if (w->addr != NULL)
+            munmap(w->addr, w->length);
+
+        w->addr = mmap(NULL, length, PROT_READ, MAP_SHARED, sys->fd, start);
+        if (w->addr == MAP_FAILED)
+        {
+            w->addr = NULL;
+            vlc_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        w->start = start;
+        w->length = length;
+
+        posix_madvise(w->addr, length, POSIX_MADV_SEQUENTIAL);
+        posix_madvise(w->addr, length, POSIX_MADV_WILLNEED);
+    }
+
+    if (w != NULL)
+    {
+        w->busy = true;
+        w->used = ++pool->stamp;
+        pool->refs++;
+        vlc_mutex_unlock(&pool->lock);
+        return block_Init(&w->block, &window_cbs, w->addr, w->length);
+    }
+    vlc_mutex_unlock(&pool->lock);
+
+    /* All windows are held: map one that is not recycled */
+    void *addr = mmap(NULL, length, PROT_READ, MAP_SHARED, sys->fd, start);
+    if (addr == MAP_FAILED)
+        return NULL;
+
+    posix_madvise(addr, length, POSIX_MADV_SEQUENTIAL);
+    posix_madvise(addr, length, POSIX_MADV_WILLNEED);
+    return block_mmap_Alloc(addr, length);
+}
+
+/* Checks that the file was not truncated. Accessing mapped pages past the
+ * end of a file raises SIGBUS, so a truncation disables mapping for good.
+ * Blocks that were already handed out, and the windows kept for reuse, are
+ * not protected: that would take a SIGBUS handler, which a library cannot
+ * install, or a file lease, which breaks with a signal as well. */
+static bool CheckFile(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    struct stat st;
+
+    if (sys->fallback)
+        return false;
+
+    if (fstat(sys->fd, &st) || (uint64_t)st.st_size < sys->size)
+    {
+        msg_Warn(access, "file truncated, disabling memory mapping");
+        sys->fallback = true;
+        return false;
+    }
+
+    sys->size = st.st_size; /* growing files are fine */
+    return true;
+}
+
+/* Reads through a heap block (after the file was modified) */
+static block_t *ReadBlock(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+    block_t *block = block_Alloc(MMAP_WINDOW);
+    if (unlikely(block == NULL))
+        return NULL;
+
+    ssize_t val = pread(sys->fd, block->p_buffer, block->i_buffer,
+                        sys->offset);
+    if (val <= 0)
+    {
+        if (val < 0)
+            msg_Err(access, "read error: %s", vlc_strerror_c(errno));
+        block_Release(block);
+        *eof = true;
+        return NULL;
+    }
+
+    block->i_buffer = val;
+    sys->offset += val;
+    return block;
+}
+
+static block_t *Block(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (!CheckFile(access))
+        return ReadBlock(access, eof);
+
+    if (sys->offset >= sys->size)
+    {
+        *eof = true;
+        return NULL;
+    }
+
+    /* Map a window starting from the page containing the offset */
+    uint64_t start = sys->offset & ~(uint64_t)sys->page_mask;
+    size_t skip = sys->offset - start;
+    size_t length = __MIN(MMAP_WINDOW, sys->size - start);
+
+    block_t *block = WindowGet(access, start, length);
+    if (block == NULL)
+    {
+        msg_Err(access, "memory mapping failed: %s", vlc_strerror_c(errno));
+        sys->fallback = true;
+        return ReadBlock(access, eof);
+    }
+
+    /* Read the next window ahead while this one is being consumed */
+    posix_fadvise(sys->fd, start + length, MMAP_WINDOW, POSIX_FADV_WILLNEED);
+
+    block->p_buffer += skip;
+    block->i_buffer -= skip;
+    sys->offset = start + length;
+    return block;
+}
+
+static int Seek(stream_t *access, uint64_t offset)
+{
+    access_sys_t *sys = access->p_sys;
+
+    sys->offset = offset;
+    return VLC_SUCCESS;
+}
+
+static int Control(stream_t *access, int query, va_list args)
+{
+    access_sys_t *sys = access->p_sys;
+
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = true;
+            break;
+
+        case STREAM_GET_SIZE:
+        {
+            struct stat st;
+
+            if (fstat(sys->fd, &st))
+                return VLC_EGENERIC;
+            *va_arg(args, uint64_t *) = st.st_size;
+            break;
+        }
+
+        case STREAM_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) =
+                VLC_TICK_FROM_MS(var_InheritInteger(access, "file-caching"));
+            break;
+
+#ifdef HAVE_PREAD
+        case STREAM_READ_RANGES:
+            /* Not through the mappings: a truncated file would be fatal */
+            return FileReadRanges(access, sys->fd, args);
+#endif
+
+        case STREAM_SET_PAUSE_STATE:
+            break;
+
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+int MmapOpen(vlc_object_t *obj)
+{
+    stream_t *access = (stream_t *)obj;
+
+    if (!var_InheritBool(obj, "file-mmap"))
+        return VLC_EGENERIC;
+    if (access->psz_filepath == NULL)
+        return VLC_EGENERIC;
+
+    int fd = vlc_open(access->psz_filepath, O_RDONLY | O_NONBLOCK);
+    if (fd == -1)
+    {
+        msg_Err(obj, "cannot open file %s (%s)", access->psz_filepath,
+                vlc_strerror_c(errno));
+        return VLC_EGENERIC;
+    }
+
+    /* Only regular files can be mapped safely */
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode))
+        goto error;
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+
+    access_sys_t *sys = vlc_obj_malloc(obj, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        goto error;
+
+    sys->pool = calloc(1, sizeof (*sys->pool));
+    if (unlikely(sys->pool == NULL))
+        goto error;
+
+    vlc_mutex_init(&sys->pool->lock);
+    sys->pool->refs = 1;
+    for (unsigned i = 0; i < MMAP_WINDOWS; i++)
+        sys->pool->windows[i].pool = sys->pool;
+
+    sys->fd = fd;
+    sys->offset = 0;
+    sys->size = st.st_size;
+    sys->page_mask = sysconf(_SC_PAGESIZE) - 1;
+    sys->fallback = false;
+
+    access->pf_read = NULL;
+    access->pf_block = Block;
+    access->pf_seek = Seek;
+    access->pf_control = Control;
+    access->p_sys = sys;
+
+    posix_fadvise(fd, 0, MMAP_WINDOW, POSIX_FADV_WILLNEED);
+    return VLC_SUCCESS;
+
+error:
+    vlc_close(fd);
+    return VLC_EGENERIC;
+}
+
+void MmapClose(vlc_object_t *obj)
+{
+    stream_t *access = (stream_t *)obj;
+    access_sys_t *sys = access->p_sys;
+    struct mmap_pool *pool = sys->pool;
+
+    /* Unmap the idle windows, the others when their blocks are released */
+    vlc_mutex_lock(&pool->lock);
+    pool->closed = true;
+    for (unsigned i = 0; i < MMAP_WINDOWS; i++)
+    {
+        struct mmap_window *w = &pool->windows[i];
+
+        if (!w->busy && w->addr != NULL)
+        {
+            munmap(w->addr, w->length);
+            w->addr = NULL;
+        }
+    }
+    vlc_mutex_unlock(&pool->lock);
+    PoolRelease(pool);
+
+    vlc_close(sys->fd);
+}
@@ -59,6 +59,8 @@
 #define RIST_MAX_RETRIES 10
 /* The rate at which we process and send nack requests */
 #define NACK_INTERVAL 5 /*ms*/
+/* Maximum number of datagrams read per wake-up */
+#define RIST_RECV_BATCH 32
 /* Calculate and print stats once per second */
 #define STATS_INTERVAL 1000 /*ms*/
 
@@ -75,6 +77,12 @@ enum NACK_TYPE {
     NACK_FMT_BITMASK
 };
 
+struct rist_nack
+{
+    uint16_t seq;
+    uint16_t extra; /* following packets: range length or lost bitmask */
+};
+
 typedef struct
 {
     struct rist_flow *flow;
@@ -83,25 +91,29 @@ typedef struct
     uint64_t         last_data_rx;
     uint64_t         last_nack_tx;
     vlc_thread_t     thread;
+    vlc_interrupt_t *interrupt;
     int              i_max_packet_size;
     int              i_poll_timeout;
-    int              i_poll_timeout_current;
     bool             b_ismulticast;
     bool             b_sendnacks;
     bool             b_sendblindnacks;
     bool             b_disablenacks;
     bool             b_flag_discontinuity;
-    bool             dead;
-    vlc_queue_t      queue;
+    vlc_queue_t      queue; /* chains of packets due for output */
+    vlc_sem_t        ready;
+    block_t         *p_out; /* rest of the chain being handed out */
     vlc_mutex_t      lock;
     uint64_t         last_message;
     uint64_t         last_reset;
+    vlc_tick_t       i_reorder_buffer;
+    vlc_tick_t       i_retry_interval;
+    block_t         *recv_blocks[RIST_RECV_BATCH];
+    /* Packets missing from the buffer, in sequence order */
+    uint16_t        *missing;
+    uint32_t         i_missing;
+    vlc_tick_t      *nack_time; /* next request, per sequence number */
     /* stat variables */
-    uint32_t         i_poll_timeout_zero_count;
-    uint32_t         i_poll_timeout_nonzero_count;
     uint64_t         i_last_stat;
-    float            vbr_ratio;
-    uint16_t         vbr_ratio_count;
     uint32_t         i_lost_packets;
     uint32_t         i_nack_packets;
     uint32_t         i_recovered_packets;
@@ -268,7 +280,8 @@ static void send_rtcp_feedback(stream_t *p_access, struct rist_flow *flow)
     buf = NULL;
 }
 
-static void send_bbnack(stream_t *p_access, int fd_nack, block_t *pkt_nacks, uint16_t nack_count)
+static void send_bbnack(stream_t *p_access, int fd_nack, const struct rist_nack *nacks,
+    uint16_t nack_count)
 {
     stream_sys_t *p_sys = p_access->p_sys;
     struct rist_flow *flow = p_sys->flow;
@@ -289,25 +302,22 @@ static void send_bbnack(stream_t *p_access, int fd_nack, block_t *pkt_nacks, uin
     /*uint8_t name[4] = "RIST";*/
     /*rtcp_fb_set_ssrc_media_src(nack, name);*/
     len += RTCP_FB_HEADER_SIZE;
-    /* TODO : group together */
-    uint16_t nacks[MAX_NACKS];
-    memcpy(nacks, pkt_nacks->p_buffer, pkt_nacks->i_buffer);
     for (int i = 0; i < nack_count; i++) {
         uint8_t *nack_record = buf + len + RTCP_FB_FCI_GENERIC_NACK_SIZE*i;
-        rtcp_fb_nack_set_packet_id(nack_record, nacks[i]);
-        rtcp_fb_nack_set_bitmask_lost(nack_record, 0);
+        rtcp_fb_nack_set_packet_id(nack_record, nacks[i].seq);
+        rtcp_fb_nack_set_bitmask_lost(nack_record, nacks[i].extra);
     }
     len += RTCP_FB_FCI_GENERIC_NACK_SIZE * nack_count;
 
     /* Write to Socket */
-    if (p_sys->b_sendnacks && p_sys->b_disablenacks == false)
-        rist_WriteTo_i11e_Locked(p_sys->lock, fd_nack, buf, len,
-            (struct sockaddr *)&flow->peer_sockaddr, flow->peer_socklen);
+    rist_WriteTo_i11e_Locked(p_sys->lock, fd_nack, buf, len,
+        (struct sockaddr *)&flow->peer_sockaddr, flow->peer_socklen);
     free(buf);
     buf = NULL;
 }
 
-static void send_rbnack(stream_t *p_access, int fd_nack, block_t *pkt_nacks, uint16_t nack_count)
+static void send_rbnack(stream_t *p_access, int fd_nack, const struct rist_nack *nacks,
+    uint16_t nack_count)
 {
     stream_sys_t *p_sys = p_access->p_sys;
     struct rist_flow *flow = p_sys->flow;
@@ -328,86 +338,94 @@ static void send_rbnack(stream_t *p_access, int fd_nack, block_t *pkt_nacks, uin
     uint8_t name[4] = "RIST";
     rtcp_fb_set_ssrc_media_src(nack, name);
     len += RTCP_FB_HEADER_SIZE;
-    /* TODO : group together */
-    uint16_t nacks[MAX_NACKS];
-    memcpy(nacks, pkt_nacks->p_buffer, pkt_nacks->i_buffer);
     for (int i = 0; i < nack_count; i++)
     {
         uint8_t *nack_record = buf + len + RTCP_FB_FCI_GENERIC_NACK_SIZE*i;
-        rtcp_fb_nack_set_range_start(nack_record, nacks[i]);
-        rtcp_fb_nack_set_range_extra(nack_record, 0);
+        rtcp_fb_nack_set_range_start(nack_record, nacks[i].seq);
+        rtcp_fb_nack_set_range_extra(nack_record, nacks[i].extra);
     }
     len += RTCP_FB_FCI_GENERIC_NACK_SIZE * nack_count;
 
     /* Write to Socket */
-    if (p_sys->b_sendnacks && p_sys->b_disablenacks == false)
-        rist_WriteTo_i11e_Locked(p_sys->lock, fd_nack, buf, len,
-            (struct sockaddr *)&flow->peer_sockaddr, flow->peer_socklen);
+    rist_WriteTo_i11e_Locked(p_sys->lock, fd_nack, buf, len,
+        (struct sockaddr *)&flow->peer_sockaddr, flow->peer_socklen);
     free(buf);
     buf = NULL;
 }
 
-static void send_nacks(stream_t *p_access, struct rist_flow *flow)
+static void send_nack_records(stream_t *p_access, const struct rist_nack *nacks,
+    uint16_t nack_count)
 {
     stream_sys_t *p_sys = p_access->p_sys;
-    struct rtp_pkt *pkt;
-    uint16_t idx;
-    uint64_t last_ts = 0;
-    uint16_t null_count = 0;
-    int nacks_len = 0;
-    uint16_t nacks[MAX_NACKS];
-
-    idx = flow->ri;
-    while(idx++ != flow->wi)
+
+    switch(p_sys->nack_type) {
+        case NACK_FMT_BITMASK:
+            send_bbnack(p_access, p_sys->flow->fd_nack, nacks, nack_count);
+            break;
+
+        default:
+            send_rbnack(p_access, p_sys->flow->fd_nack, nacks, nack_count);
+    }
+}
+
+static void send_nacks(stream_t *p_access, struct rist_flow *flow, vlc_tick_t now)
+{
+    stream_sys_t *p_sys = p_access->p_sys;
+    struct rist_nack nacks[MAX_NACKS];
+    uint16_t nack_count = 0;
+    uint32_t kept = 0;
+    unsigned total = 0;
+    bool send = p_sys->b_sendnacks && p_sys->b_disablenacks == false;
+
+    /* Only the missing packets are visited. Each one is requested once it
+     * has been missing for the reorder buffer, then again every retry
+     * interval, and the requests due together go out in as few records
+     * as the nack type allows. */
+    for (uint32_t i = 0; i < p_sys->i_missing; i++)
     {
-        pkt = &(flow->buffer[idx]);
-        if (pkt->buffer == NULL)
+        uint16_t seq = p_sys->missing[i];
+
+        /* Forget the packets recovered, handed out as lost or given up */
+        if (!is_index_in_range(flow, seq) || flow->buffer[seq].buffer != NULL
+         || flow->nacks_retries[seq] > flow->max_retries)
+            continue;
+        p_sys->missing[kept++] = seq;
+
+        if (!send || now < p_sys->nack_time[seq])
+            continue;
+
+        flow->nacks_retries[seq]++;
+        p_sys->nack_time[seq] = now + p_sys->i_retry_interval;
+        total++;
+
+        struct rist_nack *last = nack_count > 0 ? &nacks[nack_count - 1] : NULL;
+        if (last != NULL && p_sys->nack_type == NACK_FMT_RANGE
+         && (uint16_t)(seq - last->seq) == last->extra + 1)
+            last->extra++;
+        else if (last != NULL && p_sys->nack_type == NACK_FMT_BITMASK
+         && (uint16_t)(seq - last->seq - 1) < 16)
+            last->extra |= 1 << (uint16_t)(seq - last->seq - 1);
+        else
         {
-            if (nacks_len + 1 >= MAX_NACKS)
-            {
-                break;
-            }
-            else
+            if (nack_count == MAX_NACKS)
             {
-                null_count++;
-                /* TODO: after adding average spacing calculation, change this formula
-                   to extrapolated_ts = last_ts + null_count * avg_delta_ts; */
-                uint64_t extrapolated_ts = last_ts;
-                /* Find out the age and add it only if necessary */
-                int retry_count = flow->nacks_retries[idx];
-                uint64_t age = flow->hi_timestamp - extrapolated_ts;
-                uint64_t expiration;
-                if (retry_count == 0){
-                    expiration = flow->reorder_buffer;
-                } else {
-                    expiration = (uint64_t)flow->nacks_retries[idx] * (uint64_t)flow->retry_interval;
-                }
-                if (age > expiration && retry_count <= flow->max_retries)
-                {
-                    flow->nacks_retries[idx]++;
-                    nacks[nacks_len++] = idx;
-                    msg_Dbg(p_access, "Sending NACK for seq %d, age %"PRId64" ms, retry %u, " \
-                        "expiration %"PRId64" ms", idx, ts_get_from_rtp(age)/1000,
-                        flow->nacks_retries[idx], ts_get_from_rtp(expiration)/1000);
-                }
+                send_nack_records(p_access, nacks, nack_count);
+                nack_count = 0;
             }
-        }
-        else
-        {
-            last_ts = pkt->rtp_ts;
-            null_count = 0;
+            nacks[nack_count].seq = seq;
+            nacks[nack_count].extra = 0;
+            nack_count++;
         }
     }
-    if (nacks_len > 0)
+    p_sys->i_missing = kept;
+
+    if (nack_count > 0)
+        send_nack_records(p_access, nacks, nack_count);
+
+    if (total > 0)
     {
-        p_sys->i_nack_packets += nacks_len;
-        block_t *pkt_nacks = block_Alloc(nacks_len * 2);
-        if (pkt_nacks)
-        {
-            memcpy(pkt_nacks->p_buffer, nacks, nacks_len * 2);
-            pkt_nacks->i_buffer = nacks_len * 2;
-            vlc_queue_Enqueue(&p_sys->queue, pkt_nacks);
-        }
+        p_sys->i_nack_packets += total;
+        msg_Dbg(p_access, "Sent %u NACKs, %u packet(s) missing", total, kept);
     }
 }
 
@@ -593,28 +611,31 @@ static void rtcp_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf_
     }
 }
 
-static bool rist_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf, size_t len)
+static bool rist_input(stream_t *p_access, struct rist_flow *flow, block_t *block)
 {
     stream_sys_t *p_sys = p_access->p_sys;
+    uint8_t *buf = block->p_buffer;
+    size_t len = block->i_buffer;
 
     /* safety checks */
     if ( len < RTP_HEADER_SIZE )
     {
         /* check if packet size >= rtp header size */
         msg_Err(p_access, "Rist rtp packet must have at least 12 bytes, we have %zu", len);
+        block_Release(block);
         return false;
     }
     else if (!rtp_check_hdr(buf))
     {
         /* check for a valid rtp header */
         msg_Err(p_access, "Malformed rtp packet header starting with %02x, ignoring.", buf[0]);
+        block_Release(block);
         return false;
     }
 
     uint16_t idx = rtp_get_seqnum(buf);
     uint32_t pkt_ts = rtp_get_timestamp(buf);
-    bool retrasnmitted = false;
-    bool success = true;
+    vlc_tick_t now = vlc_tick_now();
 
     if (flow->reset == 1)
     {
@@ -622,147 +643,164 @@ static bool rist_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf,
         /* First packet in the queue */
         flow->hi_timestamp = pkt_ts;
         msg_Info(p_access, "ts@%u", flow->hi_timestamp);
-        flow->wi = idx;
-        flow->ri = idx;
+        /* Indexes of the last packets received and handed out */
+        flow->wi = idx - 1;
+        flow->ri = idx - 1;
         flow->reset = 0;
+        p_sys->i_missing = 0;
         p_sys->b_flag_discontinuity = true;
     }
 
     /* Check to see if this is a retransmission or a regular packet */
     if (buf[11] & (1 << 0))
     {
+        if (!is_index_in_range(flow, idx) || flow->buffer[idx].buffer != NULL)
+        {
+            /* Too late, or recovered already */
+            block_Release(block);
+            return true;
+        }
         msg_Dbg(p_access, "Packet %d RECOVERED, Window: [%d:%d-->%d]", idx, flow->ri, flow->wi,
             flow->wi-flow->ri);
         p_sys->i_recovered_packets++;
-        retrasnmitted = true;
     }
-    else if (flow->wi != flow->ri)
+    else
     {
-        /* Reset counter to 0 on incoming holes */
-        /* Regular packets only as retransmits are expected to come in out of order */
-        uint16_t idxnext = (uint16_t)(flow->wi + 1);
-        if (idx != idxnext)
+        p_sys->i_total_packets++;
+
+        uint16_t ahead = idx - flow->wi;
+        if (ahead != 0 && ahead < 0x8000)
         {
-            if (idx > idxnext) {
+            /* Perform discontinuity checks and udpdate counters */
+            if (pkt_ts < flow->hi_timestamp)
+            {
+                /* incoming timestamp just jumped back in time */
+                msg_Info(p_access, "Backwards stream discontinuity idx@%d/%d/%d ts@%u/%u",
+                    flow->ri, idx, flow->wi, pkt_ts, flow->hi_timestamp);
+                flow->reset = 1;
+                block_Release(block);
+                return false;
+            }
+            if ((pkt_ts - flow->hi_timestamp) > flow->hi_timestamp/10)
+            {
+                msg_Info(p_access, "Forward stream discontinuity idx@%d/%d/%d ts@%u/%u",
+                    flow->ri, idx, flow->wi, pkt_ts, flow->hi_timestamp);
+                flow->reset = 1;
+                block_Release(block);
+                return false;
+            }
+
+            if (ahead > 1)
+            {
+                uint16_t idxnext = (uint16_t)(flow->wi + 1);
                 msg_Dbg(p_access, "Gap, got %d, expected %d, %d packet gap, Window: [%d:%d-->%d]",
-                    idx, idxnext, idx - idxnext, flow->ri, flow->wi, (uint16_t)(flow->wi-flow->ri));
-            } else {
-                p_sys->i_reordered_packets++;
-                msg_Dbg(p_access, "Out of order, got %d, expected %d, Window: [%d:%d-->%d]", idx,
-                    idxnext, flow->ri, flow->wi, (uint16_t)(flow->wi-flow->ri));
+                    idx, idxnext, ahead - 1, flow->ri, flow->wi, (uint16_t)(flow->wi-flow->ri));
+
+                /* The missing packets were sent before this one: they take its
+                 * timestamp, to be given up on no later than it is handed out */
+                for (uint16_t seq = idxnext; seq != idx; seq++)
+                {
+                    struct rtp_pkt *hole = &flow->buffer[seq];
+                    if (hole->buffer)
+                    {
+                        block_Release(hole->buffer);
+                        hole->buffer = NULL;
+                    }
+                    hole->rtp_ts = pkt_ts;
+                    flow->nacks_retries[seq] = 0;
+                    p_sys->nack_time[seq] = now + p_sys->i_reorder_buffer;
+                    if (p_sys->i_missing < RIST_QUEUE_SIZE)
+                        p_sys->missing[p_sys->i_missing++] = seq;
+                }
             }
-            uint16_t zero_counter = (uint16_t)(flow->wi + 1);
-            while(zero_counter++ != idx) {
-                flow->nacks_retries[zero_counter] = 0;
+            flow->wi = idx;
+            flow->hi_timestamp = pkt_ts;
+        }
+        else if (is_index_in_range(flow, idx))
+        {
+            if (flow->buffer[idx].buffer == NULL)
+            {
+                p_sys->i_reordered_packets++;
+                msg_Dbg(p_access, "Out of order, got %d, Window: [%d:%d-->%d]", idx,
+                    flow->ri, flow->wi, (uint16_t)(flow->wi-flow->ri));
             }
-            /*msg_Dbg(p_access, "Gap, reseting %d packets as zero nacks %d to %d",
-                idx - flow->wi - 1, (uint16_t)(flow->wi + 1), idx);*/
+        }
+        else
+        {
+            /* index is outside of scope */
+            msg_Info(p_access, "Backwards stream discontinuity idx@%d/%d/%d ts@%u/%u", flow->ri,
+                idx, flow->wi, pkt_ts, flow->hi_timestamp);
+            flow->reset = 1;
+            block_Release(block);
+            return false;
         }
     }
 
     /* Always replace the existing one with the new one */
-    struct rtp_pkt *pkt;
-    pkt = &(flow->buffer[idx]);
-    if (pkt->buffer && pkt->buffer->i_buffer > 0)
-    {
+    struct rtp_pkt *pkt = &flow->buffer[idx];
+    if (pkt->buffer)
         block_Release(pkt->buffer);
-        pkt->buffer = NULL;
-    }
-    pkt->buffer = block_Alloc(len);
-    if (!pkt->buffer)
-        return false;
-
-    pkt->buffer->i_buffer = len;
-    memcpy(pkt->buffer->p_buffer, buf, len);
+    pkt->buffer = block;
     pkt->rtp_ts = pkt_ts;
-    p_sys->last_data_rx = vlc_tick_now();
+    p_sys->last_data_rx = now;
     /* Reset the try counter regardless of wether it was a retransmit or not */
     flow->nacks_retries[idx] = 0;
 
-    if (retrasnmitted)
-        return success;
-
-    p_sys->i_total_packets++;
-    /* Perform discontinuity checks and udpdate counters */
-    if (!is_index_in_range(flow, idx) && pkt_ts >= flow->hi_timestamp)
-    {
-        if ((pkt_ts - flow->hi_timestamp) > flow->hi_timestamp/10)
-        {
-            msg_Info(p_access, "Forward stream discontinuity idx@%d/%d/%d ts@%u/%u", flow->ri, idx,
-                flow->wi, pkt_ts, flow->hi_timestamp);
-            flow->reset = 1;
-            success = false;
-        }
-        else
-        {
-            flow->wi = idx;
-            flow->hi_timestamp = pkt_ts;
-        }
-    }
-    else if (!is_index_in_range(flow, idx))
-    {
-        /* incoming timestamp just jumped back in time or index is outside of scope */
-        msg_Info(p_access, "Backwards stream discontinuity idx@%d/%d/%d ts@%u/%u", flow->ri, idx,
-            flow->wi, pkt_ts, flow->hi_timestamp);
-        flow->reset = 1;
-        success = false;
-    }
-
-    return success;
+    return true;
 }
 
 static block_t *rist_dequeue(stream_t *p_access, struct rist_flow *flow)
 {
     stream_sys_t *p_sys = p_access->p_sys;
-    block_t *pktout = NULL;
-    struct rtp_pkt *pkt;
-    uint16_t idx;
-    if (flow->ri == flow->wi || flow->reset > 0)
+    block_t *pktout = NULL, **pp = &pktout;
+    uint16_t loss_amount = 0;
+
+    if (flow->reset > 0)
         return NULL;
 
-    idx = flow->ri;
-    bool found_data = false;
-    uint16_t loss_amount = 0;
-    while(idx++ != flow->wi) {
+    /* Hand out every packet held for the latency, in sequence order. A
+     * missing packet is lost once the packet that revealed it is due. */
+    while (flow->ri != flow->wi)
+    {
+        uint16_t idx = (uint16_t)(flow->ri + 1);
+        struct rtp_pkt *pkt = &flow->buffer[idx];
 
-        pkt = &(flow->buffer[idx]);
-        if (!pkt->buffer)
+        if (flow->hi_timestamp <= (uint32_t)(pkt->rtp_ts + flow->rtp_latency))
+            break;
+
+        flow->ri = idx;
+        if (pkt->buffer == NULL)
         {
-            /*msg_Info(p_access, "Possible packet loss on index #%d", idx);*/
             loss_amount++;
-            /* We move ahead until we find a timestamp but we do not move the cursor.
-             * None of them are guaranteed packet loss because we do not really
-             * know their timestamps. They might still arrive on the next loop.
-             * We can confirm the loss only if we get a valid packet in the loop below. */
             continue;
         }
 
-        /*printf("IDX=%d, flow->hi_timestamp: %u, (ts + flow->rtp_latency): %u\n", idx,
-            flow->hi_timestamp, (ts - 100 * flow->qdelay));*/
-        if (flow->hi_timestamp > (uint32_t)(pkt->rtp_ts + flow->rtp_latency))
+        if (loss_amount > 0)
         {
-            /* Populate output packet now but remove rtp header from source */
-            int newSize = pkt->buffer->i_buffer - RTP_HEADER_SIZE;
-            pktout = block_Alloc(newSize);
-            if (pktout)
-            {
-                pktout->i_buffer = newSize;
-                memcpy(pktout->p_buffer, pkt->buffer->p_buffer + RTP_HEADER_SIZE, newSize);
-                /* free the buffer and increase the read index */
-                flow->ri = idx;
-                /* TODO: calculate average duration using buffer average (bring from sender) */
-                found_data = true;
-            }
-            block_Release(pkt->buffer);
-            pkt->buffer = NULL;
-            break;
+            msg_Dbg(p_access, "Packet NOT RECOVERED, %d packet(s), Window: [%d:%d]",
+                loss_amount, flow->ri, flow->wi);
+            p_sys->i_lost_packets += loss_amount;
+            p_sys->b_flag_discontinuity = true;
+            loss_amount = 0;
         }
 
+        /* Remove the rtp header in place */
+        block_t *block = pkt->buffer;
+        pkt->buffer = NULL;
+        block->p_buffer += RTP_HEADER_SIZE;
+        block->i_buffer -= RTP_HEADER_SIZE;
+        if (p_sys->b_flag_discontinuity)
+        {
+            block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+            p_sys->b_flag_discontinuity = false;
+        }
+
+        *pp = block;
+        pp = &block->p_next;
     }
 
-    if (loss_amount > 0 && found_data == true)
+    if (loss_amount > 0)
     {
-        /* Packet loss confirmed, we found valid data after the holes */
         msg_Dbg(p_access, "Packet NOT RECOVERED, %d packet(s), Window: [%d:%d]", loss_amount,
             flow->ri, flow->wi);
         p_sys->i_lost_packets += loss_amount;
@@ -772,53 +810,117 @@ static block_t *rist_dequeue(stream_t *p_access, struct rist_flow *flow)
     return pktout;
 }
 
-static void *rist_thread(void *data)
+static void rist_receive(stream_t *p_access, struct rist_flow *flow)
 {
-    stream_t *p_access = data;
     stream_sys_t *p_sys = p_access->p_sys;
-    block_t *pkt_nacks;
-
-    /* Process nacks every 5ms */
-    /* We only ask for the relevant ones */
-    while ((pkt_nacks = vlc_queue_DequeueKillable(&p_sys->queue,
-                                                  &p_sys->dead)) != NULL) {
-        /* there are two bytes per nack */
-        uint16_t nack_count = (uint16_t)pkt_nacks->i_buffer/2;
-        switch(p_sys->nack_type) {
-            case NACK_FMT_BITMASK:
-                send_bbnack(p_access, p_sys->flow->fd_nack, pkt_nacks, nack_count);
+    block_t **blocks = p_sys->recv_blocks;
+    unsigned count;
+
+    /* Refill the blocks handed to rist_input by the previous read */
+    for (count = 0; count < RIST_RECV_BATCH; count++)
+    {
+        if (blocks[count] == NULL)
+        {
+            blocks[count] = block_Alloc(p_sys->i_max_packet_size);
+            if (unlikely(blocks[count] == NULL))
                 break;
+        }
+    }
+    if (unlikely(count == 0))
+        return;
 
-            default:
-                send_rbnack(p_access, p_sys->flow->fd_nack, pkt_nacks, nack_count);
+#ifdef HAVE_RECVMMSG
+    struct mmsghdr msgs[RIST_RECV_BATCH];
+    struct iovec iovecs[RIST_RECV_BATCH];
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        memset(&msgs[i], 0, sizeof (msgs[i]));
+        iovecs[i].iov_base = blocks[i]->p_buffer;
+        iovecs[i].iov_len = blocks[i]->i_buffer;
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int r = recvmmsg(flow->fd_in, msgs, count, MSG_DONTWAIT, NULL);
+    if (unlikely(r == -1)) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            msg_Err(p_access, "socket %d error: %s", flow->fd_in, vlc_strerror_c(errno));
+        return;
+    }
+
+    for (int i = 0; i < r; i++)
+    {
+        block_t *block = blocks[i];
+
+        blocks[i] = NULL;
+        block->i_buffer = msgs[i].msg_len;
+        /* rist_input will process and queue the pkt */
+        rist_input(p_access, flow, block);
+    }
+#else
+    for (unsigned i = 0; i < count; i++)
+    {
+        ssize_t r = recv(flow->fd_in, blocks[i]->p_buffer, blocks[i]->i_buffer, 0);
+        if (r == -1) {
+            if (i == 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                msg_Err(p_access, "socket %d error: %s", flow->fd_in, vlc_strerror_c(errno));
+            break;
         }
 
-        if (nack_count > 1)
-            msg_Dbg(p_access, "Sent %u NACKs !!!", nack_count);
-        block_Release(pkt_nacks);
+        block_t *block = blocks[i];
+
+        blocks[i] = NULL;
+        block->i_buffer = r;
+        /* rist_input will process and queue the pkt */
+        rist_input(p_access, flow, block);
     }
+#endif
+}
 
-    return NULL;
+static void rist_process_stats(stream_t *p_access, vlc_tick_t now)
+{
+    stream_sys_t *p_sys = p_access->p_sys;
+
+    /* We print out the stats once per second */
+    uint64_t interval = (now - p_sys->i_last_stat);
+    if ( interval > VLC_TICK_FROM_MS(STATS_INTERVAL) )
+    {
+        if ( p_sys->i_lost_packets > 0)
+            msg_Err(p_access, "We have %d lost packets", p_sys->i_lost_packets);
+        float quality = 100;
+        if (p_sys->i_total_packets > 0)
+            quality -= (float)100*(float)(p_sys->i_lost_packets + p_sys->i_recovered_packets +
+                p_sys->i_reordered_packets)/(float)p_sys->i_total_packets;
+        if (quality != 100)
+            msg_Info(p_access, "STATS: Total %u, Recovered %u/%u, Reordered %u, Lost %u, " \
+                "Missing %u, Link Quality %.2f%%", p_sys->i_total_packets,
+                p_sys->i_recovered_packets, p_sys->i_nack_packets, p_sys->i_reordered_packets,
+                p_sys->i_lost_packets, p_sys->i_missing, quality);
+        p_sys->i_last_stat = now;
+        p_sys->i_lost_packets = 0;
+        p_sys->i_nack_packets = 0;
+        p_sys->i_recovered_packets = 0;
+        p_sys->i_reordered_packets = 0;
+        p_sys->i_total_packets = 0;
+    }
 }
 
-static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
+static void *rist_thread(void *data)
 {
+    stream_t *p_access = data;
     stream_sys_t *p_sys = p_access->p_sys;
-    uint64_t now;
-    *eof = false;
-    block_t *pktout = NULL;
+    struct rist_flow *flow = p_sys->flow;
     struct pollfd pfd[3];
-    int ret;
-    ssize_t r;
     struct sockaddr_storage peer;
-    socklen_t slen = sizeof(struct sockaddr_storage);
-    struct rist_flow *flow = p_sys->flow;
+    socklen_t slen;
+    ssize_t r;
 
-    if (vlc_killed())
-    {
-        *eof = true;
+    vlc_interrupt_set(p_sys->interrupt);
+
+    uint8_t *buf = malloc(p_sys->i_max_packet_size);
+    if ( unlikely( buf == NULL ) )
         return NULL;
-    }
 
     int poll_sockets = 2;
     pfd[0].fd = flow->fd_in;
@@ -834,178 +936,119 @@ static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
 
     /* The protocol uses a fifo buffer with a fixed time delay.
      * That buffer needs to be emptied at a rate that is determined by the rtp timestamps of the
-     * packets. If I waited indefinitely for data coming in, the rate and delay of output packets
-     * would be wrong. I am calling the rist_dequeue function every time a data packet comes in
-     * and also every time we get a poll timeout. The configurable poll timeout is for controling
-     * the maximum jitter of output data coming out of the buffer. The default 5ms timeout covers
-     * most cases. */
-
-    ret = vlc_poll_i11e(pfd, poll_sockets, p_sys->i_poll_timeout_current);
-    if (unlikely(ret < 0))
-        return NULL;
-    else if (ret == 0)
-    {
-        /* Poll timeout, check the queue for the next packet that needs to be delivered */
-        pktout = rist_dequeue(p_access, flow);
-        /* if there is data, we need to come back faster to finish emptying it */
-        if (pktout) {
-            p_sys->i_poll_timeout_current = 0;
-            p_sys->i_poll_timeout_zero_count++;
-        } else {
-            p_sys->i_poll_timeout_current = p_sys->i_poll_timeout;
-            p_sys->i_poll_timeout_nonzero_count++;
-        }
-    }
-    else
+     * packets. This thread reads the sockets, sends the feedback and the nacks, and hands the
+     * packets due out to the input thread as a chain every time data comes in and every time
+     * the poll times out. The configurable poll timeout is for controling the maximum jitter
+     * of output data coming out of the buffer. The default 5ms timeout covers most cases. */
+    while (!vlc_killed())
     {
+        int ret = vlc_poll_i11e(pfd, poll_sockets, p_sys->i_poll_timeout);
+        if (unlikely(ret < 0))
+            continue;
 
-        uint8_t *buf = malloc(p_sys->i_max_packet_size);
-        if ( unlikely( buf == NULL ) )
-            return NULL;
-
-        /* Process rctp incoming data */
-        if (pfd[1].revents & POLLIN)
+        if (ret > 0)
         {
-            r = rist_ReadFrom_i11e(flow->fd_nack, buf, p_sys->i_max_packet_size,
-                (struct sockaddr *)&peer, &slen);
-            if (unlikely(r == -1)) {
-                msg_Err(p_access, "socket %d error: %s\n", flow->fd_nack, gai_strerror(errno));
+            /* Process rctp incoming data */
+            if (pfd[1].revents & POLLIN)
+            {
+                slen = sizeof(struct sockaddr_storage);
+                r = rist_ReadFrom_i11e(flow->fd_nack, buf, p_sys->i_max_packet_size,
+                    (struct sockaddr *)&peer, &slen);
+                if (unlikely(r == -1)) {
+                    msg_Err(p_access, "socket %d error: %s\n", flow->fd_nack, gai_strerror(errno));
+                }
+                else {
+                    if (p_sys->b_ismulticast == false)
+                        rtcp_input(p_access, flow, buf, r, (struct sockaddr *)&peer, slen);
+                }
             }
-            else {
-                if (p_sys->b_ismulticast == false)
+            if (p_sys->b_ismulticast && pfd[2].revents & POLLIN)
+            {
+                slen = sizeof(struct sockaddr_storage);
+                r = rist_ReadFrom_i11e(flow->fd_rtcp_m, buf, p_sys->i_max_packet_size,
+                    (struct sockaddr *)&peer, &slen);
+                if (unlikely(r == -1)) {
+                    msg_Err(p_access, "mcast socket %d error: %s\n",flow->fd_rtcp_m, gai_strerror(errno));
+                }
+                else {
                     rtcp_input(p_access, flow, buf, r, (struct sockaddr *)&peer, slen);
+                }
             }
+
+            /* Process regular incoming data */
+            if (pfd[0].revents & POLLIN)
+                rist_receive(p_access, flow);
         }
-        if (p_sys->b_ismulticast && pfd[2].revents & POLLIN)
+
+        /* Hand the packets due out to the input thread */
+        block_t *pktout = rist_dequeue(p_access, flow);
+        if (pktout)
         {
-            r = rist_ReadFrom_i11e(flow->fd_rtcp_m, buf, p_sys->i_max_packet_size,
-                (struct sockaddr *)&peer, &slen);
-            if (unlikely(r == -1)) {
-                msg_Err(p_access, "mcast socket %d error: %s\n",flow->fd_rtcp_m, gai_strerror(errno));
-            }
-            else {
-                rtcp_input(p_access, flow, buf, r, (struct sockaddr *)&peer, slen);
-            }
+            vlc_queue_Enqueue(&p_sys->queue, pktout);
+            vlc_sem_post(&p_sys->ready);
         }
 
-        /* Process regular incoming data */
-        if (pfd[0].revents & POLLIN)
+        uint64_t now = vlc_tick_now();
+
+        rist_process_stats(p_access, now);
+
+        /* Send rtcp feedback every RTCP_INTERVAL */
+        uint64_t interval = (now - flow->feedback_time);
+        if ( interval > VLC_TICK_FROM_MS(RTCP_INTERVAL) )
         {
-            r = rist_Read_i11e(flow->fd_in, buf, p_sys->i_max_packet_size);
-            if (unlikely(r == -1)) {
-                msg_Err(p_access, "socket %d error: %s\n", flow->fd_in, gai_strerror(errno));
-            }
-            else
-            {
-                /* rist_input will process and queue the pkt */
-                if (rist_input(p_access, flow, buf, r))
-                {
-                    /* Check the queue for the next packet that needs to be delivered */
-                    pktout = rist_dequeue(p_access, flow);
-                    if (pktout) {
-                        p_sys->i_poll_timeout_current = 0;
-                        p_sys->i_poll_timeout_zero_count++;
-                    } else {
-                        p_sys->i_poll_timeout_current = p_sys->i_poll_timeout;
-                        p_sys->i_poll_timeout_nonzero_count++;
-                    }
-                }
-            }
+            /* msg_Dbg(p_access, "Calling RTCP Feedback %lu<%d ms using timer", interval,
+            VLC_TICK_FROM_MS(RTCP_INTERVAL)); */
+            send_rtcp_feedback(p_access, flow);
+            flow->feedback_time = now;
         }
 
-        free(buf);
-        buf = NULL;
-    }
-
-    now = vlc_tick_now();
+        /* Send nacks every NACK_INTERVAL (only the ones that have matured, if any) */
+        interval = (now - p_sys->last_nack_tx);
+        if ( interval > VLC_TICK_FROM_MS(NACK_INTERVAL) )
+        {
+            send_nacks(p_access, flow, now);
+            p_sys->last_nack_tx = now;
+        }
 
-    /* Process stats and print them out */
-    /* We need to measure some items every 70ms */
-    uint64_t interval = (now - flow->feedback_time);
-    if ( interval > VLC_TICK_FROM_MS(RTCP_INTERVAL) )
-    {
-        if (p_sys->i_poll_timeout_nonzero_count > 0)
+        /* Safety check for when the input stream stalls */
+        if ( p_sys->last_data_rx > 0 && now > p_sys->last_data_rx &&
+            (uint64_t)(now - p_sys->last_data_rx) >  (uint64_t)VLC_TICK_FROM_MS(flow->latency) &&
+            (uint64_t)(now - p_sys->last_reset) > (uint64_t)VLC_TICK_FROM_MS(flow->latency) )
         {
-            float ratio = (float)p_sys->i_poll_timeout_zero_count
-                / (float)p_sys->i_poll_timeout_nonzero_count;
-            if (ratio <= 1)
-                p_sys->vbr_ratio += 1 - ratio;
-            else
-                p_sys->vbr_ratio += ratio - 1;
-            p_sys->vbr_ratio_count++;
-            /*msg_Dbg(p_access, "zero poll %u, non-zero poll %u, ratio %.2f",
-                p_sys->i_poll_timeout_zero_count, p_sys->i_poll_timeout_nonzero_count, ratio);*/
-            p_sys->i_poll_timeout_zero_count = 0;
-            p_sys->i_poll_timeout_nonzero_count =  0;
+            msg_Err(p_access, "No data received for %"PRId64" ms, resetting buffers",
+                (int64_t)(now - p_sys->last_data_rx)/1000);
+            p_sys->last_reset = now;
+            flow->reset = 1;
         }
     }
-    /* We print out the stats once per second */
-    interval = (now - p_sys->i_last_stat);
-    if ( interval > VLC_TICK_FROM_MS(STATS_INTERVAL) )
-    {
-        if ( p_sys->i_lost_packets > 0)
-            msg_Err(p_access, "We have %d lost packets", p_sys->i_lost_packets);
-        float ratio = 1;
-        if (p_sys->vbr_ratio_count > 0)
-            ratio = p_sys->vbr_ratio / (float)p_sys->vbr_ratio_count;
-        float quality = 100;
-        if (p_sys->i_total_packets > 0)
-            quality -= (float)100*(float)(p_sys->i_lost_packets + p_sys->i_recovered_packets +
-                p_sys->i_reordered_packets)/(float)p_sys->i_total_packets;
-        if (quality != 100)
-            msg_Info(p_access, "STATS: Total %u, Recovered %u/%u, Reordered %u, Lost %u, VBR " \
-                "Score %.2f, Link Quality %.2f%%", p_sys->i_total_packets,
-                p_sys->i_recovered_packets, p_sys->i_nack_packets, p_sys->i_reordered_packets,
-                p_sys->i_lost_packets, ratio, quality);
-        p_sys->i_last_stat = now;
-        p_sys->vbr_ratio = 0;
-        p_sys->vbr_ratio_count = 0;
-        p_sys->i_lost_packets = 0;
-        p_sys->i_nack_packets = 0;
-        p_sys->i_recovered_packets = 0;
-        p_sys->i_reordered_packets = 0;
-        p_sys->i_total_packets = 0;
-    }
 
-    /* Send rtcp feedback every RTCP_INTERVAL */
-    interval = (now - flow->feedback_time);
-    if ( interval > VLC_TICK_FROM_MS(RTCP_INTERVAL) )
-    {
-        /* msg_Dbg(p_access, "Calling RTCP Feedback %lu<%d ms using timer", interval,
-        VLC_TICK_FROM_MS(RTCP_INTERVAL)); */
-        send_rtcp_feedback(p_access, flow);
-        flow->feedback_time = now;
-    }
+    free(buf);
+    return NULL;
+}
 
-    /* Send nacks every NACK_INTERVAL (only the ones that have matured, if any) */
-    interval = (now - p_sys->last_nack_tx);
-    if ( interval > VLC_TICK_FROM_MS(NACK_INTERVAL) )
-    {
-        send_nacks(p_access, p_sys->flow);
-        p_sys->last_nack_tx = now;
-    }
+static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
+{
+    stream_sys_t *p_sys = p_access->p_sys;
 
-    /* Safety check for when the input stream stalls */
-    if ( p_sys->last_data_rx > 0 && now > p_sys->last_data_rx &&
-        (uint64_t)(now - p_sys->last_data_rx) >  (uint64_t)VLC_TICK_FROM_MS(flow->latency) &&
-        (uint64_t)(now - p_sys->last_reset) > (uint64_t)VLC_TICK_FROM_MS(flow->latency) )
+    if (vlc_killed())
     {
-        msg_Err(p_access, "No data received for %"PRId64" ms, resetting buffers",
-            (int64_t)(now - p_sys->last_data_rx)/1000);
-        p_sys->last_reset = now;
-        flow->reset = 1;
+        *eof = true;
+        return NULL;
     }
 
-    if (pktout)
+    /* The receiver thread hands out chains: take one, then its packets
+     * one at a time. */
+    while (p_sys->p_out == NULL)
     {
-        if (p_sys->b_flag_discontinuity) {
-            pktout->i_flags |= BLOCK_FLAG_DISCONTINUITY;
-            p_sys->b_flag_discontinuity = false;
-        }
-        return pktout;
+        if (vlc_sem_wait_i11e(&p_sys->ready))
+            return NULL;
+        p_sys->p_out = vlc_queue_DequeueAll(&p_sys->queue);
     }
-    else
-        return NULL;
+
+    block_t *pktout = p_sys->p_out;
+    p_sys->p_out = pktout->p_next;
+    pktout->p_next = NULL;
+    return pktout;
 }
 
 static void Clean( stream_t *p_access )
@@ -1030,6 +1073,12 @@ static void Clean( stream_t *p_access )
         free(p_sys->flow->buffer);
         free(p_sys->flow);
     }
+
+    for (int i = 0; i < RIST_RECV_BATCH; i++)
+        if (p_sys->recv_blocks[i])
+            block_Release(p_sys->recv_blocks[i]);
+    if (p_sys->interrupt)
+        vlc_interrupt_destroy(p_sys->interrupt);
 }
 
 static void Close(vlc_object_t *p_this)
@@ -1037,9 +1086,12 @@ static void Close(vlc_object_t *p_this)
     stream_t     *p_access = (stream_t*)p_this;
     stream_sys_t *p_sys = p_access->p_sys;
 
-    vlc_queue_Kill(&p_sys->queue, &p_sys->dead);
+    vlc_interrupt_kill(p_sys->interrupt);
     vlc_join(p_sys->thread, NULL);
 
+    block_ChainRelease(p_sys->p_out);
+    block_ChainRelease(vlc_queue_DequeueAll(&p_sys->queue));
+
     Clean( p_access );
 }
 
@@ -1094,15 +1146,25 @@ static int Open(vlc_object_t *p_this)
         p_sys->flow->reorder_buffer = var_InheritInteger( p_access, "reorder-buffer" );
     msg_Info(p_access, "Setting queue latency to %d ms", p_sys->flow->latency);
 
-    /* Convert to rtp times */
+    /* Nacks are scheduled on the clock, the buffer runs on rtp times */
+    p_sys->i_retry_interval = VLC_TICK_FROM_MS(p_sys->flow->retry_interval);
+    p_sys->i_reorder_buffer = VLC_TICK_FROM_MS(p_sys->flow->reorder_buffer);
     p_sys->flow->rtp_latency = rtp_get_ts(VLC_TICK_FROM_MS(p_sys->flow->latency));
-    p_sys->flow->retry_interval = rtp_get_ts(VLC_TICK_FROM_MS(p_sys->flow->retry_interval));
-    p_sys->flow->reorder_buffer = rtp_get_ts(VLC_TICK_FROM_MS(p_sys->flow->reorder_buffer));
 
-    p_sys->dead = false;
+    p_sys->missing = vlc_obj_malloc(p_this, RIST_QUEUE_SIZE * sizeof (*p_sys->missing));
+    p_sys->nack_time = vlc_obj_malloc(p_this, RIST_QUEUE_SIZE * sizeof (*p_sys->nack_time));
+    if (unlikely(p_sys->missing == NULL || p_sys->nack_time == NULL))
+        goto failed;
+
     vlc_queue_Init(&p_sys->queue, offsetof (block_t, p_next));
+    vlc_sem_init(&p_sys->ready, 0);
+
+    p_sys->interrupt = vlc_interrupt_create();
+    if (unlikely(p_sys->interrupt == NULL))
+        goto failed;
 
-    /* This extra thread is for sending feedback/nack packets even when no data comes in */
+    /* This thread receives, sends feedback/nack packets even when no data comes in,
+     * and hands the packets out */
     if (vlc_clone(&p_sys->thread, rist_thread, p_access, VLC_THREAD_PRIORITY_INPUT))
     {
         msg_Err(p_access, "Failed to create worker thread.");
@@ -1133,7 +1195,8 @@ vlc_module_begin ()
         N_("RIST demux/decode maximum jitter (default is 5ms)"),
         N_("This controls the maximum jitter that will be passed to the demux/decode chain. "
             "The lower the value, the more CPU cycles the algorithm will consume"), true )
-    add_integer( "latency", RIST_DEFAULT_LATENCY, N_("RIST latency (ms)"), NULL, true )
+    add_integer( "latency", RIST_DEFAULT_LATENCY, N_("RIST latency (ms)"),
+        N_("Depth of the buffer holding the packets for reordering and recovery"), true )
     add_integer( "retry-interval", RIST_DEFAULT_RETRY_INTERVAL, N_("RIST nack retry interval (ms)"),
         NULL, true )
     add_integer( "reorder-buffer", RIST_DEFAULT_REORDER_BUFFER, N_("RIST reorder buffer (ms)"),
@@ -0,0 +1,442 @@
+/**
+ * @file fec.c
+ * @brief SMPTE 2022-1 forward error correction for RTP
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ ****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_cpu.h>
+
+#ifdef HAVE_SSE2_INTRINSICS
+# include <emmintrin.h>
+#endif
+
+#include "fec.h"
+
+/*
+ * A FEC packet is an RTP packet followed by this header (SMPTE 2022-1):
+ *
+ *  0                   1                   2                   3
+ *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |      SNBase low bits          |        Length Recovery        |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |E| PT recovery |                    Mask                       |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                          TS recovery                          |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |N|D|type |index|    Offset     |      NA       |SNBase ext bits|
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *
+ * It protects the NA media packets of sequence SNBase + i * Offset, and its
+ * payload is the exclusive or of their RTP payloads. Column FEC (D = 0) has
+ * Offset = L and NA = D, row FEC (D = 1) has Offset = 1 and NA = L.
+ */
+#define RTP_FEC_HEADER (12 + 16)
+
+#define RTP_FEC_MEDIA   1024 /* media packets kept, must be a power of two */
+
+/* SMPTE 2022-1 matrix limits: L columns and D rows */
+#define RTP_FEC_MAX_L   20
+#define RTP_FEC_MAX_D   20
+#define RTP_FEC_MAX_LD  100
+
+/* All the media packets of a FEC packet must fit in the ring together */
+static_assert(RTP_FEC_MAX_LD < RTP_FEC_MEDIA, "FEC media ring too small");
+#define RTP_FEC_PACKETS 64 /* FEC packets kept */
+#define RTP_FEC_MTU     1500
+
+/* Time for the FEC delay estimate to decay completely */
+#define RTP_FEC_DECAY VLC_TICK_FROM_SEC(30)
+
+struct rtp_fec_packet
+{
+    vlc_tick_t rx; /* reception time */
+    uint16_t len; /* packet length, zero if the slot is free */
+    uint8_t data[RTP_FEC_MTU];
+};
+
+struct rtp_fec
+{
+    struct rtp_fec_packet media[RTP_FEC_MEDIA]; /* indexed by sequence */
+    struct rtp_fec_packet fec[RTP_FEC_PACKETS];
+    unsigned fec_index;
+
+    vlc_tick_t window; /* how long packets are kept */
+    vlc_tick_t delay; /* FEC arrival delay estimate (decaying peak) */
+    vlc_tick_t last_rx; /* last received FEC packet */
+    bool fresh; /* FEC packets received since the last recovery attempt */
+
+    void (*xor_bytes)(uint8_t *restrict, const uint8_t *restrict, size_t);
+};
+
+static void rtp_fec_xor_c(uint8_t *restrict dst, const uint8_t *restrict src,
+                          size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+        dst[i] ^= src[i];
+}
+
+#ifdef HAVE_SSE2_INTRINSICS
+__attribute__ ((__target__ ("sse2")))
+static void rtp_fec_xor_sse2(uint8_t *restrict dst,
+                             const uint8_t *restrict src, size_t len)
+{
+    for (; len >= 64; len -= 64, dst += 64, src += 64)
+    {
+        __m128i a0 = _mm_loadu_si128((const __m128i *)dst);
+        __m128i a1 = _mm_loadu_si128((const __m128i *)(dst + 16));
+        __m128i a2 = _mm_loadu_si128((const __m128i *)(dst + 32));
+        __m128i a3 = _mm_loadu_si128((const __m128i *)(dst + 48));
+        __m128i b0 = _mm_loadu_si128((const __m128i *)src);
+        __m128i b1 = _mm_loadu_si128((const __m128i *)(src + 16));
+        __m128i b2 = _mm_loadu_si128((const __m128i *)(src + 32));
+        __m128i b3 = _mm_loadu_si128((const __m128i *)(src + 48));
+
+        _mm_storeu_si128((__m128i *)dst, _mm_xor_si128(a0, b0));
+        _mm_storeu_si128((__m128i *)(dst + 16), _mm_xor_si128(a1, b1));
+        _mm_storeu_si128((__m128i *)(dst + 32), _mm_xor_si128(a2, b2));
+        _mm_storeu_si128((__m128i *)(dst + 48), _mm_xor_si128(a3, b3));
+    }
+
+    for (; len >= 16; len -= 16, dst += 16, src += 16)
+        _mm_storeu_si128((__m128i *)dst,
+                         _mm_xor_si128(_mm_loadu_si128((const __m128i *)dst),
+                                       _mm_loadu_si128((const __m128i *)src)));
+
+    rtp_fec_xor_c(dst, src, len);
+}
+#endif
+
+struct rtp_fec *rtp_fec_create(vlc_tick_t window)
+{
+    struct rtp_fec *fec = malloc(sizeof (*fec));
+    if (unlikely(fec == NULL))
+        return NULL;
+
+    for (unsigned i = 0; i < RTP_FEC_MEDIA; i++)
+        fec->media[i].len = 0;
+    for (unsigned i = 0; i < RTP_FEC_PACKETS; i++)
+        fec->fec[i].len = 0;
+    fec->fec_index = 0;
+    fec->window = window;
+    fec->delay = 0;
+    fec->last_rx = VLC_TICK_INVALID;
+    fec->fresh = false;
+
+    fec->xor_bytes = rtp_fec_xor_c;
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_SSE2())
+        fec->xor_bytes = rtp_fec_xor_sse2;
+#endif
+    return fec;
+}
+
+void rtp_fec_destroy(struct rtp_fec *fec)
+{
+    free(fec);
+}
+
+static uint16_t rtp_fec_seq(const struct rtp_fec_packet *pkt)
+{
+    return GetWBE(pkt->data + 2);
+}
+
+/**
+ * Looks up a media packet still within the time window.
+ */
+static const struct rtp_fec_packet *
+rtp_fec_find(const struct rtp_fec *fec, uint16_t seq, vlc_tick_t now)
+{
+    const struct rtp_fec_packet *pkt = &fec->media[seq % RTP_FEC_MEDIA];
+
+    if (pkt->len == 0 || rtp_fec_seq(pkt) != seq
+     || pkt->rx + fec->window < now)
+        return NULL;
+    return pkt;
+}
+
+static void rtp_fec_put(struct rtp_fec_packet *pkt, const uint8_t *data,
+                        size_t len, vlc_tick_t rx)
+{
+    assert(len <= RTP_FEC_MTU);
+    memcpy(pkt->data, data, len);
+    pkt->len = len;
+    pkt->rx = rx;
+}
+
+void rtp_fec_store(struct rtp_fec *fec, const block_t *block)
+{
+    if (block->i_buffer > RTP_FEC_MTU)
+        return; /* cannot be protected anyway */
+
+    uint16_t seq = GetWBE(block->p_buffer + 2);
+
+    rtp_fec_put(&fec->media[seq % RTP_FEC_MEDIA], block->p_buffer,
+                block->i_buffer, block->i_pts);
+}
+
+static uint16_t rtp_fec_base(const struct rtp_fec_packet *pkt)
+{
+    return GetWBE(pkt->data + 12);
+}
+
+static uint8_t rtp_fec_offset(const struct rtp_fec_packet *pkt)
+{
+    return pkt->data[12 + 13];
+}
+
+static uint8_t rtp_fec_count(const struct rtp_fec_packet *pkt)
+{
+    return pkt->data[12 + 14];
+}
+
+/**
+ * Checks the Offset and NA fields of a FEC header against the matrix limits.
+ */
+static bool rtp_fec_matrix_valid(const uint8_t *hdr)
+{
+    unsigned offset = hdr[13], count = hdr[14];
+
+    if (count == 0)
+        return false;
+    if (hdr[12] & 0x40) /* row: Offset = 1, NA = L */
+        return offset == 1 && count <= RTP_FEC_MAX_L;
+    /* column: Offset = L, NA = D */
+    return offset > 0 && offset <= RTP_FEC_MAX_L && count <= RTP_FEC_MAX_D
+        && offset * count <= RTP_FEC_MAX_LD;
+}
+
+bool rtp_fec_queue(struct rtp_fec *fec, block_t *block, vlc_tick_t now)
+{
+    const uint8_t *p = block->p_buffer;
+    bool ok = false;
+
+    if (block->i_buffer < RTP_FEC_HEADER || block->i_buffer > RTP_FEC_MTU
+     || (p[0] >> 6) != 2 /* RTP version */
+     || (p[0] & 0x3F) != 0 /* no padding, extension nor CSRC */
+     || !(p[12 + 4] & 0x80) /* E */
+     || ((p[12 + 12] >> 3) & 7) != 0 /* XOR */
+     || !rtp_fec_matrix_valid(p + 12))
+        goto out;
+
+    struct rtp_fec_packet *pkt = &fec->fec[fec->fec_index];
+
+    fec->fec_index = (fec->fec_index + 1) % RTP_FEC_PACKETS;
+    rtp_fec_put(pkt, p, block->i_buffer, now);
+    fec->fresh = true;
+    ok = true;
+
+    /* The FEC packet arrives after the packets it protects: measure how long
+     * to wait for it before giving up on a missing packet. */
+    if (fec->last_rx != VLC_TICK_INVALID)
+    {
+        vlc_tick_t elapsed = now - fec->last_rx;
+        if (elapsed >= RTP_FEC_DECAY)
+            fec->delay = 0;
+        else if (elapsed > 0)
+            fec->delay -= fec->delay * elapsed / RTP_FEC_DECAY;
+    }
+    fec->last_rx = now;
+
+    const struct rtp_fec_packet *first = rtp_fec_find(fec, rtp_fec_base(pkt),
+                                                      now);
+    if (first != NULL && now - first->rx > fec->delay)
+        fec->delay = now - first->rx;
+out:
+    block_Release(block);
+    return ok;
+}
+
+bool rtp_fec_pending(struct rtp_fec *fec)
+{
+    bool fresh = fec->fresh;
+
+    fec->fresh = false;
+    return fresh;
+}
+
+vlc_tick_t rtp_fec_delay(const struct rtp_fec *fec)
+{
+    return fec->delay;
+}
+
+/**
+ * Checks whether a FEC packet protects a given media packet.
+ */
+static bool rtp_fec_covers(const struct rtp_fec_packet *pkt, uint16_t seq)
+{
+    uint16_t delta = seq - rtp_fec_base(pkt);
+    unsigned offset = rtp_fec_offset(pkt);
+
+    return (delta % offset) == 0 && (delta / offset) < rtp_fec_count(pkt);
+}
+
+/**
+ * Counts the media packets protected by a FEC packet that are missing.
+ *
+ * @param missing the first missing sequence [OUT]
+ * @param skip a sequence not to count
+ */
+static unsigned rtp_fec_missing(const struct rtp_fec *fec,
+                                const struct rtp_fec_packet *pkt,
+                                uint16_t skip, uint16_t *missing,
+                                vlc_tick_t now)
+{
+    uint16_t seq = rtp_fec_base(pkt);
+    unsigned count = 0;
+
+    for (unsigned i = 0; i < rtp_fec_count(pkt); i++)
+    {
+        if (seq != skip && rtp_fec_find(fec, seq, now) == NULL)
+        {
+            if (count++ == 0)
+                *missing = seq;
+        }
+        seq += rtp_fec_offset(pkt);
+    }
+    return count;
+}
+
+/**
+ * Rebuilds the only missing media packet protected by a FEC packet.
+ */
+static const struct rtp_fec_packet *
+rtp_fec_rebuild(struct rtp_fec *fec, const struct rtp_fec_packet *pkt,
+                uint16_t missing, vlc_tick_t now)
+{
+    const uint8_t *hdr = pkt->data + 12;
+    size_t fec_len = pkt->len - RTP_FEC_HEADER;
+    uint16_t len = GetWBE(hdr + 2);
+    uint8_t ptype = hdr[4] & 0x7F;
+    uint32_t ts = GetDWBE(hdr + 8);
+    uint32_t ssrc = 0;
+    uint8_t buf[RTP_FEC_MTU];
+
+    if (fec_len > sizeof (buf) - 12)
+        return NULL;
+    memcpy(buf + 12, pkt->data + RTP_FEC_HEADER, fec_len);
+
+    uint16_t seq = rtp_fec_base(pkt);
+    for (unsigned i = 0; i < rtp_fec_count(pkt); i++, seq += rtp_fec_offset(pkt))
+    {
+        if (seq == missing)
+            continue;
+
+        const struct rtp_fec_packet *media = rtp_fec_find(fec, seq, now);
+        if (media == NULL)
+            return NULL; /* expired since it was counted */
+
+        size_t media_len = media->len - 12;
+        if (media_len > fec_len)
+            return NULL; /* FEC payload too short */
+
+        fec->xor_bytes(buf + 12, media->data + 12, media_len);
+        len ^= media_len;
+        ptype ^= media->data[1] & 0x7F;
+        ts ^= GetDWBE(media->data + 4);
+        ssrc = GetDWBE(media->data + 8);
+    }
+
+    if (len > fec_len)
+        return NULL; /* inconsistent FEC and media packets */
+
+    /* The padding, extension, CSRC count and marker are not recoverable.
+     * SMPTE 2022-2 streams do not use them. */
+    buf[0] = 0x80;
+    buf[1] = ptype;
+    SetWBE(buf + 2, missing);
+    SetDWBE(buf + 4, ts);
+    SetDWBE(buf + 8, ssrc);
+
+    struct rtp_fec_packet *media = &fec->media[missing % RTP_FEC_MEDIA];
+    rtp_fec_put(media, buf, 12 + len, now);
+    return media;
+}
+
+block_t *rtp_fec_recover(struct rtp_fec *fec, uint16_t seq, vlc_tick_t now)
+{
+    const struct rtp_fec_packet *media = rtp_fec_find(fec, seq, now);
+
+    if (media == NULL)
+    {
+        /* Look for a FEC packet protecting only this missing packet */
+        for (unsigned i = 0; i < RTP_FEC_PACKETS && media == NULL; i++)
+        {
+            const struct rtp_fec_packet *pkt = &fec->fec[i];
+            uint16_t missing;
+
+            if (pkt->len == 0 || pkt->rx + fec->window < now
+             || !rtp_fec_covers(pkt, seq)
+             || rtp_fec_missing(fec, pkt, seq, &missing, now) > 0)
+                continue;
+
+            media = rtp_fec_rebuild(fec, pkt, seq, now);
+        }
+    }
+
+    if (media == NULL)
+    {
+        /* Otherwise, first rebuild the other missing packet of a row (resp.
+         * column) from its column (resp. row) */
+        for (unsigned i = 0; i < RTP_FEC_PACKETS && media == NULL; i++)
+        {
+            const struct rtp_fec_packet *pkt = &fec->fec[i];
+            uint16_t other;
+
+            if (pkt->len == 0 || pkt->rx + fec->window < now
+             || !rtp_fec_covers(pkt, seq)
+             || rtp_fec_missing(fec, pkt, seq, &other, now) != 1)
+                continue;
+
+            for (unsigned j = 0; j < RTP_FEC_PACKETS; j++)
+            {
+                const struct rtp_fec_packet *cross = &fec->fec[j];
+                uint16_t dummy;
+
+                if (j == i || cross->len == 0
+                 || cross->rx + fec->window < now
+                 || !rtp_fec_covers(cross, other)
+                 || rtp_fec_missing(fec, cross, other, &dummy, now) > 0)
+                    continue;
+
+                if (rtp_fec_rebuild(fec, cross, other, now) != NULL)
+                    media = rtp_fec_rebuild(fec, pkt, seq, now);
+                break;
+            }
+        }
+    }
+
+    if (media == NULL)
+        return NULL;
+
+    block_t *block = block_Alloc(media->len);
+    if (likely(block != NULL))
+        memcpy(block->p_buffer, media->data, media->len);
+    return block;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file fec.h
+ * @brief SMPTE 2022-1 forward error correction for RTP
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ ****************************************************************************/
+
+#ifndef VLC_RTP_FEC_H
+#define VLC_RTP_FEC_H
+
+#include <stdbool.h>
+
+/**
+ * Column and row FEC decoder state.
+ *
+ * Recent media and FEC packets are kept for a bounded time window. Missing
+ * media packets are rebuilt on demand, when they are protected by a FEC
+ * packet whose other media packets are all present, either directly or
+ * after rebuilding them from the crossing row or column.
+ */
+struct rtp_fec;
+
+/**
+ * Creates a FEC decoder.
+ *
+ * @param window how long media and FEC packets are kept
+ */
+struct rtp_fec *rtp_fec_create(vlc_tick_t window);
+void rtp_fec_destroy(struct rtp_fec *);
+
+/**
+ * Keeps a copy of a received media RTP packet.
+ *
+ * @param block RTP packet with its header; i_pts is the reception time
+ */
+void rtp_fec_store(struct rtp_fec *, const block_t *block);
+
+/**
+ * Receives a FEC packet.
+ *
+ * @param block FEC packet with its RTP header (always released)
+ * @return whether the packet was a valid FEC packet
+ */
+bool rtp_fec_queue(struct rtp_fec *, block_t *block, vlc_tick_t now);
+
+/**
+ * Tells whether FEC packets were received since the last call.
+ */
+bool rtp_fec_pending(struct rtp_fec *);
+
+/**
+ * Returns how late FEC packets arrive after the first packet they protect.
+ */
+vlc_tick_t rtp_fec_delay(const struct rtp_fec *);
+
+/**
+ * Tries to rebuild a missing media packet.
+ *
+ * @return the rebuilt RTP packet or NULL if it cannot be recovered
+ */
+block_t *rtp_fec_recover(struct rtp_fec *, uint16_t seq, vlc_tick_t now);
+
+#endif
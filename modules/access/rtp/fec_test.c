@@ -0,0 +1,193 @@
+/**
+ * @file fec_test.c
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ ****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include "fec.h"
+
+#define L 4 /* columns */
+#define D 3 /* rows */
+#define BASE 65530 /* wraps around within the matrix */
+
+static block_t *media[L * D];
+
+static block_t *make_media(unsigned i)
+{
+    size_t len = 12 + 100 + 37 * i; /* different payload sizes */
+    block_t *block = block_Alloc(len);
+    assert(block != NULL);
+
+    block->p_buffer[0] = 0x80;
+    block->p_buffer[1] = 33;
+    SetWBE(block->p_buffer + 2, BASE + i);
+    SetDWBE(block->p_buffer + 4, 90000 + 3000 * i);
+    SetDWBE(block->p_buffer + 8, 0xdeadbeef);
+    for (size_t j = 12; j < len; j++)
+        block->p_buffer[j] = i * 7 + j;
+    block->i_pts = VLC_TICK_0;
+    return block;
+}
+
+static block_t *make_fec(unsigned first, unsigned offset, unsigned count,
+                         bool row)
+{
+    size_t len = 0;
+
+    for (unsigned i = 0; i < count; i++)
+        len = __MAX(len, media[first + i * offset]->i_buffer - 12);
+
+    block_t *block = block_Alloc(12 + 16 + len);
+    assert(block != NULL);
+    memset(block->p_buffer, 0, block->i_buffer);
+
+    uint8_t *hdr = block->p_buffer + 12;
+    uint16_t length = 0;
+    uint32_t ts = 0;
+    uint8_t pt = 0;
+
+    block->p_buffer[0] = 0x80;
+    block->p_buffer[1] = 96;
+    for (unsigned i = 0; i < count; i++)
+    {
+        const block_t *m = media[first + i * offset];
+
+        length ^= m->i_buffer - 12;
+        pt ^= m->p_buffer[1] & 0x7F;
+        ts ^= GetDWBE(m->p_buffer + 4);
+        for (size_t j = 12; j < m->i_buffer; j++)
+            hdr[16 + j - 12] ^= m->p_buffer[j];
+    }
+
+    SetWBE(hdr, BASE + first);
+    SetWBE(hdr + 2, length);
+    hdr[4] = 0x80 | pt;
+    SetDWBE(hdr + 8, ts);
+    hdr[12] = row ? 0x40 : 0x00;
+    hdr[13] = offset;
+    hdr[14] = count;
+    return block;
+}
+
+static void check_recovered(struct rtp_fec *fec, unsigned i)
+{
+    block_t *block = rtp_fec_recover(fec, BASE + i, VLC_TICK_0);
+
+    assert(block != NULL);
+    assert(block->i_buffer == media[i]->i_buffer);
+    assert(memcmp(block->p_buffer, media[i]->p_buffer,
+                  block->i_buffer) == 0);
+    block_Release(block);
+}
+
+/* Feeds the matrix without the missing packets, then all the FEC packets */
+static struct rtp_fec *setup(const bool *missing)
+{
+    struct rtp_fec *fec = rtp_fec_create(VLC_TICK_FROM_SEC(1));
+    assert(fec != NULL);
+
+    for (unsigned i = 0; i < L * D; i++)
+        if (!missing[i])
+            rtp_fec_store(fec, media[i]);
+
+    assert(!rtp_fec_pending(fec));
+    for (unsigned c = 0; c < L; c++)
+        assert(rtp_fec_queue(fec, make_fec(c, L, D, false), VLC_TICK_0));
+    for (unsigned r = 0; r < D; r++)
+        assert(rtp_fec_queue(fec, make_fec(r * L, 1, L, true), VLC_TICK_0));
+    assert(rtp_fec_pending(fec));
+    assert(!rtp_fec_pending(fec));
+    return fec;
+}
+
+int main(void)
+{
+    struct rtp_fec *fec;
+
+    for (unsigned i = 0; i < L * D; i++)
+        media[i] = make_media(i);
+
+    /* Single loss */
+    fec = setup((const bool[L * D]){ [5] = true });
+    check_recovered(fec, 5);
+    rtp_fec_destroy(fec);
+
+    /* Burst loss within a row, recovered by columns */
+    fec = setup((const bool[L * D]){ [4] = true, [5] = true, [6] = true });
+    check_recovered(fec, 4);
+    check_recovered(fec, 5);
+    check_recovered(fec, 6);
+    rtp_fec_destroy(fec);
+
+    /* Neither the row nor the column alone can recover packet 0 */
+    fec = setup((const bool[L * D]){ [0] = true, [1] = true, [4] = true });
+    check_recovered(fec, 0);
+    check_recovered(fec, 1); /* was rebuilt while rebuilding 0 */
+    check_recovered(fec, 4);
+    rtp_fec_destroy(fec);
+
+    /* Unrecoverable square */
+    fec = setup((const bool[L * D]){ [0] = true, [1] = true,
+                                     [4] = true, [5] = true });
+    assert(rtp_fec_recover(fec, BASE + 0, VLC_TICK_0) == NULL);
+    rtp_fec_destroy(fec);
+
+    /* Out of the time window */
+    fec = setup((const bool[L * D]){ [5] = true });
+    assert(rtp_fec_recover(fec, BASE + 5,
+                           VLC_TICK_0 + VLC_TICK_FROM_SEC(2)) == NULL);
+    rtp_fec_destroy(fec);
+
+    /* Not a FEC packet */
+    fec = rtp_fec_create(VLC_TICK_FROM_SEC(1));
+    assert(fec != NULL);
+    assert(!rtp_fec_queue(fec, block_Duplicate(media[0]), VLC_TICK_0));
+
+    /* Matrices beyond the SMPTE 2022-1 limits */
+    static const struct { uint8_t offset, count; bool row; } bad[] = {
+        { 21, 4, false }, /* L > 20 */
+        { 4, 21, false }, /* D > 20 */
+        { 20, 20, false }, /* L x D > 100 */
+        { 255, 255, false }, /* beyond the media ring */
+        { 2, 4, true }, /* row Offset is 1 */
+        { 1, 21, true }, /* L > 20 */
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(bad); i++)
+    {
+        block_t *block = make_fec(0, 1, 1, bad[i].row);
+        block->p_buffer[12 + 13] = bad[i].offset;
+        block->p_buffer[12 + 14] = bad[i].count;
+        assert(!rtp_fec_queue(fec, block, VLC_TICK_0));
+    }
+    assert(!rtp_fec_pending(fec));
+    rtp_fec_destroy(fec);
+
+    for (unsigned i = 0; i < L * D; i++)
+        block_Release(media[i]);
+    return 0;
+}
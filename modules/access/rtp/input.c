@@ -42,6 +42,7 @@
 #include <vlc_dtls.h>
 
 #include "rtp.h"
+#include "fec.h"
 #ifdef HAVE_SRTP
 # include "srtp.h"
 #endif
@@ -87,6 +88,16 @@ drop:
     block_Release (block);
 }
 
+/**
+ * Processes a packet received from a FEC socket.
+ */
+static void rtp_process_fec (demux_t *demux, block_t *block)
+{
+    demux_sys_t *sys = demux->p_sys;
+
+    rtp_fec_queue (sys->fec, block, vlc_tick_now ());
+}
+
 static int rtp_timeout (vlc_tick_t deadline)
 {
     if (deadline == VLC_TICK_INVALID)
@@ -110,16 +121,35 @@ void *rtp_dgram_thread (void *opaque)
     demux_t *demux = opaque;
     demux_sys_t *sys = demux->p_sys;
     vlc_tick_t deadline = VLC_TICK_INVALID;
-    struct vlc_dtls *rtp_sock = sys->rtp_sock;
+    struct vlc_dtls *socks[4];
+    void (*process[4]) (demux_t *, block_t *);
+    unsigned nfds = 0;
+
+    socks[nfds] = sys->rtp_sock;
+    process[nfds++] = rtp_process;
+    if (sys->path_sock != NULL)
+    {   /* Duplicates are removed when queued */
+        socks[nfds] = sys->path_sock;
+        process[nfds++] = rtp_process;
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(sys->fec_socks); i++)
+        if (sys->fec_socks[i] != NULL)
+        {
+            socks[nfds] = sys->fec_socks[i];
+            process[nfds++] = rtp_process_fec;
+        }
 
     for (;;)
     {
-        struct pollfd ufd[1];
+        struct pollfd ufd[4];
 
-        ufd[0].events = POLLIN;
-        ufd[0].fd = vlc_dtls_GetPollFD(rtp_sock, &ufd[0].events);
+        for (unsigned i = 0; i < nfds; i++)
+        {
+            ufd[i].events = POLLIN;
+            ufd[i].fd = vlc_dtls_GetPollFD(socks[i], &ufd[i].events);
+        }
 
-        int n = poll (ufd, 1, rtp_timeout (deadline));
+        int n = poll (ufd, nfds, rtp_timeout (deadline));
         if (n == -1)
             continue;
 
@@ -127,14 +157,17 @@ void *rtp_dgram_thread (void *opaque)
         if (n == 0)
             goto dequeue;
 
-        if (ufd[0].revents)
+        for (unsigned i = 0; i < nfds; i++)
         {
+            if (!ufd[i].revents)
+                continue;
+
             block_t *block = block_Alloc(DEFAULT_MRU);
             if (unlikely(block == NULL))
-                break; /* we are totallly screwed */
+                goto out; /* we are totallly screwed */
 
             bool truncated;
-            ssize_t len = vlc_dtls_Recv(rtp_sock, block->p_buffer,
+            ssize_t len = vlc_dtls_Recv(socks[i], block->p_buffer,
                                        block->i_buffer, &truncated);
             if (len >= 0) {
                 if (truncated) {
@@ -145,18 +178,16 @@ void *rtp_dgram_thread (void *opaque)
                 else
                     block->i_buffer = len;
 
-                rtp_process (demux, block);
+                process[i] (demux, block);
             }
             else
             {
                 if (errno == EPIPE)
-                    break; /* connection terminated */
+                    goto out; /* connection terminated */
                 msg_Warn (demux, "RTP network error: %s",
                           vlc_strerror_c(errno));
                 block_Release (block);
             }
-
-            n--;
         }
 
     dequeue:
@@ -164,5 +195,6 @@ void *rtp_dgram_thread (void *opaque)
             deadline = VLC_TICK_INVALID;
         vlc_restorecancel (canc);
     }
+out:
     return NULL;
 }
@@ -34,6 +34,7 @@
 #include <vlc_dtls.h>
 
 #include "rtp.h"
+#include "fec.h"
 #ifdef HAVE_SRTP
 # include "srtp.h"
 # include <gcrypt.h>
@@ -133,6 +134,88 @@ static int Control (demux_t *demux, int query, va_list args)
     return VLC_EGENERIC;
 }
 
+/**
+ * Opens the SMPTE 2022-7 redundant path and the SMPTE 2022-1 FEC sockets.
+ */
+static int rtp_open_protection(vlc_object_t *obj, demux_sys_t *sys,
+                               const char *dhost, int dport,
+                               const char *shost, int sport, int tp)
+{
+    char *path = var_InheritString(obj, "rtp-redundant");
+    if (path != NULL)
+    {
+        /* Same syntax as the MRL: [source[:port]@][group][:port] */
+        char *shost2 = NULL, *dhost2 = strchr(path, '@');
+        if (dhost2 != NULL)
+        {
+            *(dhost2++) = '\0';
+            shost2 = path;
+        }
+        else
+            dhost2 = path;
+
+        int sport2 = 0, dport2;
+        if (shost2 != NULL)
+            sport2 = extract_port(&shost2);
+        dport2 = extract_port(&dhost2);
+        if (dport2 == 0)
+            dport2 = dport;
+
+        int fd = net_OpenDgram(obj, dhost2, dport2, shost2, sport2, tp);
+        free(path);
+        if (fd == -1)
+            return -1;
+
+        sys->path_sock = vlc_datagram_CreateFD(fd);
+        if (unlikely(sys->path_sock == NULL))
+        {
+            net_Close(fd);
+            return -1;
+        }
+        msg_Dbg(obj, "receiving a redundant path on port %d", dport2);
+    }
+
+    if (var_InheritBool(obj, "rtp-fec"))
+    {
+        sys->fec = rtp_fec_create(sys->max_latency);
+        if (unlikely(sys->fec == NULL))
+            return -1;
+
+        /* Column FEC is sent to the media port + 2, row FEC to port + 4 */
+        for (int i = 0; i < 2; i++)
+        {
+            int offset = 2 * (i + 1);
+            int fd = net_OpenDgram(obj, dhost, dport + offset, shost,
+                                   sport ? (sport + offset) : 0, tp);
+            if (fd == -1)
+                return -1;
+
+            sys->fec_socks[i] = vlc_datagram_CreateFD(fd);
+            if (unlikely(sys->fec_socks[i] == NULL))
+            {
+                net_Close(fd);
+                return -1;
+            }
+        }
+        msg_Dbg(obj, "receiving FEC on ports %d and %d", dport + 2, dport + 4);
+    }
+    return 0;
+}
+
+/**
+ * Closes the SMPTE 2022-7 redundant path and the SMPTE 2022-1 FEC sockets.
+ */
+static void rtp_close_protection(demux_sys_t *sys)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(sys->fec_socks); i++)
+        if (sys->fec_socks[i] != NULL)
+            vlc_dtls_Close(sys->fec_socks[i]);
+    if (sys->fec != NULL)
+        rtp_fec_destroy(sys->fec);
+    if (sys->path_sock != NULL)
+        vlc_dtls_Close(sys->path_sock);
+}
+
 /**
  * Releases resources
  */
@@ -148,11 +231,26 @@ static void Close (vlc_object_t *obj)
         srtp_destroy (p_sys->srtp);
 #endif
     rtp_session_destroy (demux, p_sys->session);
+    rtp_close_protection(p_sys);
     if (p_sys->rtcp_sock != NULL)
         vlc_dtls_Close(p_sys->rtcp_sock);
     vlc_dtls_Close(p_sys->rtp_sock);
 }
 
+/**
+ * Reads the re-ordering buffer limits.
+ */
+static void rtp_init_buffer(vlc_object_t *obj, demux_sys_t *sys)
+{
+    sys->min_latency = VLC_TICK_FROM_MS(var_InheritInteger(obj,
+                                                           "rtp-min-latency"));
+    sys->max_latency = VLC_TICK_FROM_MS(var_InheritInteger(obj,
+                                                           "rtp-max-latency"));
+    if (sys->max_latency < sys->min_latency)
+        sys->max_latency = sys->min_latency;
+    sys->max_buffer = var_InheritInteger(obj, "rtp-max-buffer") * 1024;
+}
+
 static int OpenSDP(vlc_object_t *obj)
 {
     demux_t *demux = (demux_t *)obj;
@@ -182,6 +280,9 @@ static int OpenSDP(vlc_object_t *obj)
 
     sys->rtp_sock = NULL;
     sys->rtcp_sock = NULL;
+    sys->path_sock = NULL;
+    sys->fec_socks[0] = sys->fec_socks[1] = NULL;
+    sys->fec = NULL;
     sys->session = NULL;
 #ifdef HAVE_SRTP
     sys->srtp = NULL;
@@ -302,6 +403,7 @@ static int OpenSDP(vlc_object_t *obj)
     sys->timeout = vlc_tick_from_sec(var_InheritInteger(obj, "rtp-timeout"));
     sys->max_dropout  = var_InheritInteger(obj, "rtp-max-dropout");
     sys->max_misorder = var_InheritInteger(obj, "rtp-max-misorder");
+    rtp_init_buffer(obj, sys);
     sys->autodetect = true;
 
     demux->pf_demux = NULL;
@@ -355,6 +457,11 @@ static int OpenURL(vlc_object_t *obj)
     if (unlikely(p_sys == NULL))
         return VLC_ENOMEM;
 
+    p_sys->path_sock = NULL;
+    p_sys->fec_socks[0] = p_sys->fec_socks[1] = NULL;
+    p_sys->fec = NULL;
+    rtp_init_buffer (obj, p_sys);
+
     char *tmp = strdup (demux->psz_location);
     if (tmp == NULL)
         return VLC_ENOMEM;
@@ -396,6 +503,15 @@ static int OpenURL(vlc_object_t *obj)
                 break;
             if (rtcp_dport > 0) /* XXX: source port is unknown */
                 rtcp_fd = net_OpenDgram (obj, dhost, rtcp_dport, shost, 0, tp);
+            if (rtp_open_protection (obj, p_sys, dhost, dport, shost, sport,
+                                     tp))
+            {
+                rtp_close_protection (p_sys);
+                if (rtcp_fd != -1)
+                    net_Close (rtcp_fd);
+                net_Close (fd);
+                fd = rtcp_fd = -1;
+            }
             break;
 
          case IPPROTO_DCCP:
@@ -416,10 +532,15 @@ static int OpenURL(vlc_object_t *obj)
     }
 
     free (tmp);
+    if (fd == -1)
+        return VLC_EGENERIC;
+
     p_sys->rtp_sock = (co ? vlc_dccp_CreateFD : vlc_datagram_CreateFD)(fd);
-    if (p_sys->rtcp_sock == NULL) {
+    if (p_sys->rtp_sock == NULL) {
+        net_Close(fd);
         if (rtcp_fd != -1)
             net_Close(rtcp_fd);
+        rtp_close_protection(p_sys);
         return VLC_EGENERIC;
     }
     net_SetCSCov (fd, -1, 12);
@@ -488,6 +609,7 @@ error:
 #endif
     if (p_sys->session != NULL)
         rtp_session_destroy(demux, p_sys->session);
+    rtp_close_protection(p_sys);
     if (p_sys->rtcp_sock != NULL)
         vlc_dtls_Close(p_sys->rtcp_sock);
     vlc_dtls_Close(p_sys->rtp_sock);
@@ -528,6 +650,33 @@ error:
     "RTP packets will be discarded if they are too far behind (i.e. in the " \
     "past) by this many packets from the last received packet." )
 
+#define RTP_MIN_LATENCY_TEXT N_("Minimum RTP re-ordering delay (ms)")
+#define RTP_MIN_LATENCY_LONGTEXT N_( \
+    "How long to wait at least for a missing RTP packet before giving up on " \
+    "it. The actual delay adapts to the jitter and the re-ordering observed " \
+    "on each source.")
+
+#define RTP_MAX_LATENCY_TEXT N_("Maximum RTP re-ordering delay (ms)")
+#define RTP_MAX_LATENCY_LONGTEXT N_( \
+    "How long to wait at most for a missing RTP packet before giving up on " \
+    "it, however large the jitter and the re-ordering are.")
+
+#define RTP_MAX_BUFFER_TEXT N_("Maximum RTP re-ordering buffer (KiB)")
+#define RTP_MAX_BUFFER_LONGTEXT N_( \
+    "Missing RTP packets are given up on if more than this much data from " \
+    "the same source is waiting for them.")
+
+#define RTP_REDUNDANT_TEXT N_("Redundant RTP path (SMPTE 2022-7)")
+#define RTP_REDUNDANT_LONGTEXT N_( \
+    "The same RTP stream is also received from this address, with the same " \
+    "syntax as the main one ([source[:port]@][group][:port]). Packets lost " \
+    "on one path are taken from the other.")
+
+#define RTP_FEC_TEXT N_("RTP forward error correction (SMPTE 2022-1)")
+#define RTP_FEC_LONGTEXT N_( \
+    "Column and row FEC packets are received on the RTP port plus 2 and " \
+    "plus 4 respectively, and used to rebuild lost RTP packets.")
+
 #define RTP_DYNAMIC_PT_TEXT N_("RTP payload format assumed for dynamic " \
                                "payloads")
 #define RTP_DYNAMIC_PT_LONGTEXT N_( \
@@ -576,6 +725,18 @@ vlc_module_begin()
     add_integer("rtp-max-misorder", 100, RTP_MAX_MISORDER_TEXT,
                 RTP_MAX_MISORDER_LONGTEXT, true)
         change_integer_range (0, 32767)
+    add_integer("rtp-min-latency", 25, RTP_MIN_LATENCY_TEXT,
+                RTP_MIN_LATENCY_LONGTEXT, true)
+        change_integer_range (0, 60000)
+    add_integer("rtp-max-latency", 1000, RTP_MAX_LATENCY_TEXT,
+                RTP_MAX_LATENCY_LONGTEXT, true)
+        change_integer_range (0, 60000)
+    add_integer("rtp-max-buffer", 4096, RTP_MAX_BUFFER_TEXT,
+                RTP_MAX_BUFFER_LONGTEXT, true)
+        change_integer_range (1, 1 << 20)
+    add_string("rtp-redundant", NULL, RTP_REDUNDANT_TEXT,
+               RTP_REDUNDANT_LONGTEXT, true)
+    add_bool("rtp-fec", false, RTP_FEC_TEXT, RTP_FEC_LONGTEXT, true)
     add_string("rtp-dynamic-pt", NULL, RTP_DYNAMIC_PT_TEXT,
                RTP_DYNAMIC_PT_LONGTEXT, true)
         change_string_list(dynamic_pt_list, dynamic_pt_list_text)
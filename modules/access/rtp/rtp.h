@@ -69,9 +69,15 @@ typedef struct
 #endif
     struct vlc_dtls *rtp_sock;
     struct vlc_dtls *rtcp_sock;
+    struct vlc_dtls *path_sock; /**< SMPTE 2022-7 redundant path */
+    struct vlc_dtls *fec_socks[2]; /**< SMPTE 2022-1 column and row FEC */
+    struct rtp_fec *fec;
     vlc_thread_t  thread;
 
     vlc_tick_t    timeout;
+    vlc_tick_t    min_latency; /**< Min wait for a missing packet */
+    vlc_tick_t    max_latency; /**< Max wait for a missing packet */
+    size_t        max_buffer; /**< Max re-ordering queue size per source */
     uint16_t      max_dropout; /**< Max packet forward misordering */
     uint16_t      max_misorder; /**< Max packet backward misordering */
     uint8_t       max_src; /**< Max simultaneous RTP sources */
@@ -25,6 +25,7 @@
 #endif
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <errno.h>
 
@@ -32,6 +33,7 @@
 #include <vlc_demux.h>
 
 #include "rtp.h"
+#include "fec.h"
 
 typedef struct rtp_source_t rtp_source_t;
 
@@ -134,6 +136,28 @@ int rtp_add_type (demux_t *demux, rtp_session_t *ses, const rtp_pt_t *pt)
     return 0;
 }
 
+/* Number of given up sequence gaps remembered to recognize late packets */
+#define RTP_MAX_GAPS 8
+
+/** Sequence gap given up on */
+struct rtp_gap
+{
+    vlc_tick_t rx; /* reception time of the packet after the gap */
+    uint16_t seq; /* first missing sequence */
+    uint16_t end; /* sequence of the packet after the gap */
+};
+
+/* Sequences remembered to merge a SMPTE 2022-7 redundant path. This bounds
+ * the skew between the paths, in packets (about 400ms at 100 Mbit/s). */
+#define RTP_PATH_HISTORY 4096
+
+/** Packet received from either path */
+struct rtp_seen
+{
+    vlc_tick_t rx; /* reception time of the first copy */
+    uint16_t seq;
+};
+
 /** State for an RTP source */
 struct rtp_source_t
 {
@@ -150,6 +174,25 @@ struct rtp_source_t
 
     uint16_t last_seq; /* sequence of the next dequeued packet */
     block_t *blocks; /* re-ordered blocks queue */
+    size_t   queued; /* bytes in the re-ordered blocks queue */
+
+    vlc_tick_t reorder; /* re-ordering delay estimate (decaying peak) */
+    vlc_tick_t reorder_peak; /* worst re-ordering delay recently seen */
+    vlc_tick_t reorder_time; /* when the peak was seen */
+    struct rtp_gap gaps[RTP_MAX_GAPS]; /* last gaps given up on */
+    unsigned gap_index;
+    struct rtp_seen *seen; /* recent sequences, with a redundant path */
+
+    struct
+    {
+        uint64_t received;
+        uint64_t lost;
+        uint64_t reordered;
+        uint64_t late;
+        uint64_t duplicate;
+        uint64_t recovered;
+    } stats, reported;
+
     void    *opaque[]; /* Per-source private payload data */
 };
 
@@ -166,6 +209,17 @@ rtp_source_create (demux_t *demux, const rtp_session_t *session,
     if (source == NULL)
         return NULL;
 
+    source->seen = NULL;
+    if (((const demux_sys_t *)demux->p_sys)->path_sock != NULL)
+    {
+        source->seen = calloc (RTP_PATH_HISTORY, sizeof (*source->seen));
+        if (unlikely(source->seen == NULL))
+        {
+            free (source);
+            return NULL;
+        }
+    }
+
     source->ssrc = ssrc;
     source->jitter = 0;
     source->ref_rtp = 0;
@@ -173,6 +227,14 @@ rtp_source_create (demux_t *demux, const rtp_session_t *session,
     source->max_seq = source->bad_seq = init_seq;
     source->last_seq = init_seq - 1;
     source->blocks = NULL;
+    source->queued = 0;
+    source->reorder = 0;
+    source->reorder_peak = 0;
+    source->reorder_time = 0;
+    memset (source->gaps, 0, sizeof (source->gaps));
+    source->gap_index = 0;
+    memset (&source->stats, 0, sizeof (source->stats));
+    source->reported = source->stats;
 
     /* Initializes all payload */
     for (unsigned i = 0; i < session->ptc; i++)
@@ -190,11 +252,17 @@ static void
 rtp_source_destroy (demux_t *demux, const rtp_session_t *session,
                     rtp_source_t *source)
 {
-    msg_Dbg (demux, "removing RTP source (%08x)", source->ssrc);
+    msg_Dbg (demux, "removing RTP source (%08x): %"PRIu64" packet(s) "
+             "received, %"PRIu64" lost, %"PRIu64" re-ordered, %"PRIu64" late, "
+             "%"PRIu64" duplicate(s), %"PRIu64" recovered", source->ssrc,
+             source->stats.received, source->stats.lost,
+             source->stats.reordered, source->stats.late,
+             source->stats.duplicate, source->stats.recovered);
 
     for (unsigned i = 0; i < session->ptc; i++)
         session->ptv[i].destroy (demux, source->opaque[i]);
     block_ChainRelease (source->blocks);
+    free (source->seen);
     free (source);
 }
 
@@ -228,6 +296,95 @@ rtp_find_ptype (const rtp_session_t *session, rtp_source_t *source,
     return NULL;
 }
 
+/**
+ * Merges the SMPTE 2022-7 paths: recognizes the second copy of a packet.
+ *
+ * This is done before any other sequence check, as the copies from the
+ * late path can lag more than the tolerated misordering.
+ *
+ * @return whether the packet was already received from the other path
+ */
+static bool rtp_source_seen (const demux_sys_t *sys, rtp_source_t *src,
+                             uint16_t seq, vlc_tick_t now)
+{
+    struct rtp_seen *seen = &src->seen[seq % RTP_PATH_HISTORY];
+
+    if (seen->seq == seq && now - seen->rx <= sys->max_latency)
+        return true;
+
+    seen->seq = seq;
+    seen->rx = now;
+    return false;
+}
+
+/* Time for the re-ordering delay estimate to decay completely */
+#define RTP_REORDER_DECAY VLC_TICK_FROM_SEC(30)
+
+/**
+ * Accounts for a packet that arrived after a packet of higher sequence.
+ *
+ * @param now reception time of the packet
+ * @param delay how long after the higher sequence packet it arrived
+ */
+static void rtp_source_reorder (const demux_sys_t *sys, rtp_source_t *src,
+                                vlc_tick_t now, vlc_tick_t delay)
+{
+    if (delay > sys->max_latency)
+        delay = sys->max_latency;
+    if (delay > src->reorder)
+    {
+        src->reorder = src->reorder_peak = delay;
+        src->reorder_time = now;
+    }
+}
+
+/**
+ * Forgets about past re-ordering, linearly from the time of the peak.
+ * This is computed from the peak rather than the previous estimate, so that
+ * frequent packets do not round each decrement down to nothing.
+ */
+static void rtp_source_reorder_decay (rtp_source_t *src, vlc_tick_t now)
+{
+    vlc_tick_t elapsed = now - src->reorder_time;
+
+    if (elapsed >= RTP_REORDER_DECAY)
+        src->reorder = 0;
+    else if (elapsed > 0)
+        src->reorder = src->reorder_peak
+                     - src->reorder_peak * elapsed / RTP_REORDER_DECAY;
+}
+
+/**
+ * Computes how long to wait for missing packets of an RTP source.
+ *
+ * This is the smallest delay that should cover both the network jitter and
+ * the re-ordering observed for this source so far, within the configured
+ * latency bounds.
+ */
+static vlc_tick_t rtp_source_latency (const demux_sys_t *sys,
+                                      const rtp_source_t *src,
+                                      const rtp_pt_t *pt)
+{
+    /* Wait for 3 times the inter-arrival delay variance (about 99.7%
+     * match for random gaussian jitter). */
+    vlc_tick_t latency = 0;
+    if (pt != NULL)
+        latency = vlc_tick_from_samples (3 * src->jitter, pt->frequency);
+    /* else no jitter estimate with no frequency :( */
+
+    /* Re-ordering is not gaussian: it comes in bursts (e.g. on multipath
+     * links). FEC packets come after the packets they protect. Wait a bit
+     * longer than the worst delay recently seen. */
+    vlc_tick_t reorder = src->reorder;
+    if (sys->fec != NULL && reorder < rtp_fec_delay (sys->fec))
+        reorder = rtp_fec_delay (sys->fec);
+    reorder += reorder / 4;
+    if (latency < reorder)
+        latency = reorder;
+
+    return VLC_CLIP (latency, sys->min_latency, sys->max_latency);
+}
+
 /**
  * Receives an RTP packet and queues it. Not a cancellation point.
  *
@@ -300,10 +457,17 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
             goto drop;
 
         tab[session->srcc++] = src;
+        if (src->seen != NULL)
+            rtp_source_seen (p_sys, src, seq, now);
         /* Cannot compute jitter yet */
     }
     else
     {
+        /* The redundant copy is expected: it is not a duplicate, and it
+         * must not skew the jitter and sequence tracking. */
+        if (src->seen != NULL && rtp_source_seen (p_sys, src, seq, now))
+            goto drop;
+
         const rtp_pt_t *pt = rtp_find_ptype (session, src, block, NULL);
 
         if (pt != NULL)
@@ -318,7 +482,10 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
             if (d < 0) d = -d;
             src->jitter += ((d - src->jitter) + 8) >> 4;
         }
+
+        rtp_source_reorder_decay (src, now);
     }
+    src->stats.received++;
     src->last_rx = now;
     block->i_pts = now; /* store reception time until dequeued */
     src->last_ts = rtp_timestamp (block);
@@ -326,19 +493,26 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
     /* Check sequence number */
     /* NOTE: the sequence number is per-source,
      * but is independent from the payload type. */
+    /* With a redundant path, the late path fills the gaps of the other one
+     * from as far back as the merge history goes. */
+    const int max_misorder = (src->seen != NULL) ? RTP_PATH_HISTORY
+                                                 : p_sys->max_misorder;
     int16_t delta_seq = seq - src->max_seq;
     if ((delta_seq > 0) ? (delta_seq > p_sys->max_dropout)
-                        : (-delta_seq > p_sys->max_misorder))
+                        : (-delta_seq > max_misorder))
     {
         msg_Dbg (demux, "sequence discontinuity"
                  " (got: %"PRIu16", expected: %"PRIu16")", seq, src->max_seq);
         if (seq == src->bad_seq)
         {
             src->max_seq = src->bad_seq = seq + 1;
-            src->last_seq = seq - 0x7fffe; /* hack for rtp_decode() */
+            src->last_seq = seq - 1;
+            memset (src->gaps, 0, sizeof (src->gaps));
             msg_Warn (demux, "sequence resynchronized");
             block_ChainRelease (src->blocks);
             src->blocks = NULL;
+            src->queued = 0;
+            block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
         }
         else
         {
@@ -349,6 +523,24 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
     else
     if (delta_seq >= 0)
         src->max_seq = seq + 1;
+    else
+    if ((int16_t)(seq - src->last_seq) <= 0)
+    {   /* Already dequeued past this sequence */
+        for (unsigned i = 0; i < RTP_MAX_GAPS; i++)
+        {
+            const struct rtp_gap *gap = &src->gaps[i];
+
+            if ((uint16_t)(seq - gap->seq) < (uint16_t)(gap->end - gap->seq))
+            {   /* It was given up for lost: we should have waited longer. */
+                msg_Dbg (demux, "late packet (sequence: %"PRIu16")", seq);
+                rtp_source_reorder (p_sys, src, now, now - gap->rx);
+                src->stats.late++;
+                goto drop;
+            }
+        }
+        src->stats.duplicate++;
+        goto drop;
+    }
 
     /* Queues the block in sequence order,
      * hence there is a single queue for all payload types. */
@@ -361,12 +553,23 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
         if (delta_seq == 0)
         {
             msg_Dbg (demux, "duplicate packet (sequence: %"PRIu16")", seq);
+            src->stats.duplicate++;
             goto drop; /* duplicate */
         }
         pp = &prev->p_next;
     }
+
+    if (*pp != NULL)
+    {   /* Fills a gap: measure how long it was waited for */
+        rtp_source_reorder (p_sys, src, now, now - (*pp)->i_pts);
+        src->stats.reordered++;
+    }
     block->p_next = *pp;
     *pp = block;
+    src->queued += block->i_buffer;
+
+    if (p_sys->fec != NULL)
+        rtp_fec_store (p_sys->fec, block);
 
     /*rtp_decode (demux, session, src);*/
     return;
@@ -378,6 +581,52 @@ drop:
 
 static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
 
+/**
+ * Rebuilds the missing packets before the first queued one with FEC.
+ *
+ * @return whether any packet was rebuilt
+ */
+static bool rtp_recover (demux_t *demux, rtp_source_t *src, vlc_tick_t now)
+{
+    const demux_sys_t *sys = demux->p_sys;
+    const uint16_t end = rtp_seq (src->blocks);
+    bool recovered = false, progress;
+
+    /* Rebuilding a packet can make another one of the same gap recoverable */
+    do
+    {
+        block_t **pp = &src->blocks;
+
+        progress = false;
+        for (uint16_t seq = src->last_seq + 1; seq != end; seq++)
+        {
+            while ((int16_t)(rtp_seq (*pp) - seq) < 0)
+                pp = &(*pp)->p_next;
+            if (rtp_seq (*pp) == seq)
+                continue; /* rebuilt already */
+
+            block_t *block = rtp_fec_recover (sys->fec, seq, now);
+            if (block == NULL)
+                continue;
+            if (GetDWBE (block->p_buffer + 8) != src->ssrc)
+            {
+                block_Release (block);
+                continue;
+            }
+
+            block->i_pts = now;
+            block->p_next = *pp;
+            *pp = block;
+            src->queued += block->i_buffer;
+            src->stats.recovered++;
+            progress = recovered = true;
+        }
+    }
+    while (progress);
+
+    return recovered;
+}
+
 /**
  * Dequeues RTP packets and pass them to decoder. Not cancellation-safe(?).
  * A packet is decoded if it is the next in sequence order, or if we have
@@ -393,8 +642,11 @@ static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
 bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
                   vlc_tick_t *restrict deadlinep)
 {
+    const demux_sys_t *sys = demux->p_sys;
     vlc_tick_t now = vlc_tick_now ();
     bool pending = false;
+    /* Try FEC again only when new FEC packets arrived, or before giving up */
+    const bool fec = sys->fec != NULL && rtp_fec_pending (sys->fec);
 
     *deadlinep = INT64_MAX;
 
@@ -427,19 +679,8 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
                 continue;
             }
 
-            /* Wait for 3 times the inter-arrival delay variance (about 99.7%
-             * match for random gaussian jitter).
-             */
-            vlc_tick_t deadline;
             const rtp_pt_t *pt = rtp_find_ptype (session, src, block, NULL);
-            if (pt)
-                deadline = vlc_tick_from_samples(3 * src->jitter, pt->frequency);
-            else
-                deadline = 0; /* no jitter estimate with no frequency :( */
-
-            /* Make sure we wait at least for 25 msec */
-            if (deadline < VLC_TICK_FROM_MS(25))
-                deadline = VLC_TICK_FROM_MS(25);
+            vlc_tick_t deadline = rtp_source_latency (sys, src, pt);
 
             /* Additionnaly, we implicitly wait for the packetization time
              * multiplied by the number of missing packets. block is the first
@@ -447,7 +688,16 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
              * estimated time of arrival, as we do not know the RTP timestamp
              * of not yet received packets. */
             deadline += block->i_pts;
-            if (now >= deadline)
+
+            /* Give up on the missing packets when it is too late or when
+             * out of buffer space. */
+            bool expired = now >= deadline || src->queued > sys->max_buffer;
+
+            if ((fec || (expired && sys->fec != NULL))
+             && rtp_recover (demux, src, now))
+                continue;
+
+            if (expired)
             {
                 rtp_decode (demux, session, src);
                 continue;
@@ -457,6 +707,21 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
             pending = true; /* packet pending in buffer */
             break;
         }
+
+        if (src->stats.lost != src->reported.lost
+         || src->stats.reordered != src->reported.reordered
+         || src->stats.late != src->reported.late
+         || src->stats.recovered != src->reported.recovered)
+        {
+            es_out_Control (demux->out, ES_OUT_ADD_TRANSPORT_STATS,
+                            (unsigned)(src->stats.lost - src->reported.lost),
+                            (unsigned)(src->stats.reordered
+                                       - src->reported.reordered),
+                            (unsigned)(src->stats.late - src->reported.late),
+                            (unsigned)(src->stats.recovered
+                                       - src->reported.recovered));
+            src->reported = src->stats;
+        }
     }
     return pending;
 }
@@ -472,6 +737,8 @@ rtp_decode (demux_t *demux, const rtp_session_t *session, rtp_source_t *src)
     assert (block);
     src->blocks = block->p_next;
     block->p_next = NULL;
+    assert (src->queued >= block->i_buffer);
+    src->queued -= block->i_buffer;
 
     /* Discontinuity detection */
     uint16_t delta_seq = rtp_seq (block) - (src->last_seq + 1);
@@ -485,6 +752,12 @@ rtp_decode (demux_t *demux, const rtp_session_t *session, rtp_source_t *src)
         }
         msg_Warn (demux, "%"PRIu16" packet(s) lost", delta_seq);
         block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+        src->stats.lost += delta_seq;
+        /* Remember the gap to recognize late packets */
+        src->gaps[src->gap_index].seq = src->last_seq + 1;
+        src->gaps[src->gap_index].end = rtp_seq (block);
+        src->gaps[src->gap_index].rx = block->i_pts;
+        src->gap_index = (src->gap_index + 1) % RTP_MAX_GAPS;
     }
     src->last_seq = rtp_seq (block);
 
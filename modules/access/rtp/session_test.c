@@ -0,0 +1,142 @@
+/**
+ * @file session_test.c
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ ****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include "../../../lib/libvlc_internal.h"
+#include "rtp.h"
+
+const char vlc_module_name[] = "test_rtp_session";
+
+#define PACKETS 2000
+#define SKEW 300 /* packets, more than the tolerated misordering */
+#define BASE 65000 /* wraps around */
+
+static uint16_t decoded[PACKETS];
+static unsigned decoded_count;
+static unsigned discontinuities;
+
+static void decode(demux_t *demux, void *opaque, block_t *block)
+{
+    (void) demux; (void) opaque;
+    assert(block->i_buffer == 2);
+    assert(decoded_count < PACKETS);
+    decoded[decoded_count++] = GetWBE(block->p_buffer);
+    if (block->i_flags & BLOCK_FLAG_DISCONTINUITY)
+        discontinuities++;
+    block_Release(block);
+}
+
+static int es_out_control(es_out_t *out, input_source_t *in, int query,
+                          va_list args)
+{
+    (void) out; (void) in; (void) query; (void) args;
+    return VLC_SUCCESS;
+}
+
+static const struct es_out_callbacks es_out_cbs = {
+    .control = es_out_control,
+};
+
+static block_t *make_packet(unsigned i)
+{
+    block_t *block = block_Alloc(12 + 2);
+    assert(block != NULL);
+
+    block->p_buffer[0] = 0x80;
+    block->p_buffer[1] = 33;
+    SetWBE(block->p_buffer + 2, BASE + i);
+    SetDWBE(block->p_buffer + 4, 90 * i);
+    SetDWBE(block->p_buffer + 8, 0xdeadbeef);
+    SetWBE(block->p_buffer + 12, i);
+    return block;
+}
+
+/* Is the packet lost on the first path? */
+static bool lost(unsigned i)
+{
+    return (i % 50) == 7 || (i >= 1000 && i < 1040);
+}
+
+int main(void)
+{
+    libvlc_int_t *vlc = libvlc_InternalCreate();
+    assert(vlc != NULL);
+
+    demux_t *demux = vlc_object_create(vlc, sizeof (*demux));
+    assert(demux != NULL);
+
+    es_out_t out = { .cbs = &es_out_cbs };
+    demux_sys_t sys;
+
+    memset(&sys, 0, sizeof (sys));
+    /* Never used as a socket, but tells that there are two paths */
+    sys.path_sock = (struct vlc_dtls *)&sys;
+    sys.timeout = VLC_TICK_FROM_SEC(5);
+    sys.min_latency = VLC_TICK_FROM_MS(25);
+    sys.max_latency = VLC_TICK_FROM_SEC(1);
+    sys.max_buffer = 4 << 20;
+    sys.max_dropout = 3000;
+    sys.max_misorder = 100;
+    sys.max_src = 1;
+    demux->p_sys = &sys;
+    demux->out = &out;
+
+    rtp_session_t *session = rtp_session_create(demux);
+    assert(session != NULL);
+    assert(rtp_add_type(demux, session, &(const rtp_pt_t) {
+        .decode = decode, .frequency = 90000, .number = 33,
+    }) == 0);
+
+    /* The second path lags behind the first one, and delivers the packets
+     * lost on the first path. */
+    vlc_tick_t deadline;
+    for (unsigned i = 0; i < PACKETS + SKEW; i++)
+    {
+        if (i < PACKETS && !lost(i))
+            rtp_queue(demux, session, make_packet(i));
+        if (i >= SKEW)
+            rtp_queue(demux, session, make_packet(i - SKEW));
+        rtp_dequeue(demux, session, &deadline);
+    }
+
+    /* Each packet is decoded once and in order */
+    assert(!rtp_dequeue(demux, session, &deadline));
+    assert(decoded_count == PACKETS);
+    for (unsigned i = 0; i < PACKETS; i++)
+        assert(decoded[i] == i);
+    assert(discontinuities == 0);
+
+    rtp_session_destroy(demux, session);
+    vlc_object_delete(demux);
+    libvlc_InternalDestroy(vlc);
+    return 0;
+}
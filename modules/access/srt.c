@@ -42,6 +42,8 @@ typedef struct
     char       *psz_host;
     int         i_port;
     int         i_chunks; /* Number of chunks to allocate in the next read */
+    vlc_tick_t  i_stats_interval;
+    vlc_tick_t  i_stats_next;
 } stream_sys_t;
 
 
@@ -125,7 +127,7 @@ static bool srt_schedule_reconnect(stream_t *p_stream)
         srt_close( p_sys->sock );
     }
 
-    p_sys->sock = srt_socket( res->ai_family, SOCK_DGRAM, 0 );
+    p_sys->sock = srt_create_link( strm_obj, res->ai_family );
     if ( p_sys->sock == SRT_INVALID_SOCK )
     {
         msg_Err( p_stream, "Failed to open socket." );
@@ -189,7 +191,7 @@ static bool srt_schedule_reconnect(stream_t *p_stream)
     msg_Dbg( p_stream, "Schedule SRT connect (dest addresss: %s, port: %d).",
         p_sys->psz_host, p_sys->i_port);
 
-    stat = srt_connect( p_sys->sock, res->ai_addr, res->ai_addrlen );
+    stat = srt_connect_link( strm_obj, p_sys->sock, res );
     if (stat == SRT_ERROR) {
         msg_Err( p_stream, "Failed to connect to server (reason: %s)",
                 srt_getlasterror_str() );
@@ -313,6 +315,9 @@ static block_t *BlockSRT(stream_t *p_stream, bool *restrict eof)
             }
         }
 
+        srt_report_stats( VLC_OBJECT(p_stream), p_stream->out, p_sys->sock,
+                          p_sys->i_stats_interval, &p_sys->i_stats_next );
+
         goto out;
     }
 
@@ -370,6 +375,10 @@ static int Open(vlc_object_t *p_this)
 
     vlc_UrlClean( &parsed_url );
 
+    p_sys->i_stats_interval = VLC_TICK_FROM_MS(
+        var_InheritInteger( p_stream, SRT_PARAM_STATS_INTERVAL ) );
+    p_sys->i_stats_next = 0;
+
     p_sys->i_poll_id = srt_epoll_create();
     if ( p_sys->i_poll_id == -1 )
     {
@@ -429,6 +438,15 @@ vlc_module_begin ()
     add_integer( SRT_PARAM_KEY_LENGTH, SRT_DEFAULT_KEY_LENGTH,
             SRT_KEY_LENGTH_TEXT, SRT_KEY_LENGTH_TEXT, false )
     change_integer_list( srt_key_lengths, srt_key_length_names )
+#ifdef SRT_HAVE_GROUPS
+    add_string( SRT_PARAM_GROUP, "", SRT_GROUP_TEXT, SRT_GROUP_LONGTEXT,
+            true )
+    change_string_list( srt_group_values, srt_group_names )
+    add_string( SRT_PARAM_GROUP_LINKS, NULL, SRT_GROUP_LINKS_TEXT,
+            SRT_GROUP_LINKS_LONGTEXT, true )
+#endif
+    add_integer( SRT_PARAM_STATS_INTERVAL, SRT_DEFAULT_STATS_INTERVAL,
+            SRT_STATS_INTERVAL_TEXT, SRT_STATS_INTERVAL_LONGTEXT, true )
 
     set_capability("access", 0)
     add_shortcut("srt")
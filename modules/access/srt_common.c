@@ -26,6 +26,9 @@
 const char * const srt_key_length_names[] = { N_( "16 bytes" ), N_(
         "24 bytes" ), N_( "32 bytes" ), };
 
+const char * const srt_group_names[] = { N_( "None" ), N_( "Broadcast" ),
+        N_( "Backup" ), };
+
 typedef struct parsed_param {
     char *key;
     char *val;
@@ -166,3 +169,174 @@ int srt_set_socket_option(vlc_object_t *this, const char *srt_param,
     return stat;
 }
 
+
+SRTSOCKET srt_create_link(vlc_object_t *this, int family)
+{
+#ifdef SRT_HAVE_GROUPS
+    char *psz_group = var_InheritString( this, SRT_PARAM_GROUP );
+
+    if (psz_group != NULL && psz_group[0] != '\0') {
+        SRT_GROUP_TYPE type = strcmp( psz_group, "backup" ) == 0
+            ? SRT_GTYPE_BACKUP : SRT_GTYPE_BROADCAST;
+        SRTSOCKET u = srt_create_group( type );
+
+        if (u == SRT_INVALID_SOCK)
+            msg_Err( this, "Failed to create %s socket group (reason: %s)",
+                    psz_group, srt_getlasterror_str() );
+        free( psz_group );
+        return u;
+    }
+    free( psz_group );
+#else
+    VLC_UNUSED(this);
+#endif
+    return srt_socket( family, SOCK_DGRAM, 0 );
+}
+
+#ifdef SRT_HAVE_GROUPS
+/**
+ * Connect a socket group to the given address and to every group link.
+ *
+ * The links are "host:port" endpoints separated by commas, IPv6 hosts
+ * being enclosed in brackets. Unresolvable links are skipped, libsrt
+ * switches over to the remaining ones.
+ */
+static int srt_connect_group_links(vlc_object_t *this, SRTSOCKET u,
+        const struct addrinfo *res)
+{
+    SRT_SOCKGROUPCONFIG links[SRT_MAX_GROUP_LINKS];
+    int i_links = 0;
+    char *psz_links = var_InheritString( this, SRT_PARAM_GROUP_LINKS );
+
+    links[i_links++] = srt_prepare_endpoint( NULL, res->ai_addr,
+            res->ai_addrlen );
+
+    if (psz_links != NULL) {
+        char *saveptr;
+
+        for (char *psz_host = strtok_r( psz_links, ",", &saveptr );
+             psz_host != NULL && i_links < SRT_MAX_GROUP_LINKS;
+             psz_host = strtok_r( NULL, ",", &saveptr )) {
+            struct addrinfo hints = {
+                .ai_socktype = SOCK_DGRAM,
+            }, *link;
+            int i_port = SRT_DEFAULT_PORT;
+
+            psz_host = srt_split_endpoint( psz_host, &i_port );
+
+            int stat = vlc_getaddrinfo( psz_host, i_port, &hints, &link );
+            if (stat) {
+                msg_Warn( this, "Cannot resolve group link [%s]:%d "
+                        "(reason: %s)", psz_host, i_port, gai_strerror( stat ) );
+                continue;
+            }
+
+            links[i_links++] = srt_prepare_endpoint( NULL, link->ai_addr,
+                    link->ai_addrlen );
+            freeaddrinfo( link );
+        }
+        free( psz_links );
+    }
+
+    msg_Dbg( this, "Connecting socket group over %d link(s)", i_links );
+
+    return srt_connect_group( u, links, i_links );
+}
+#endif
+
+int srt_connect_link(vlc_object_t *this, SRTSOCKET u,
+        const struct addrinfo *res)
+{
+#ifdef SRT_HAVE_GROUPS
+    if (u & SRTGROUP_MASK)
+        return srt_connect_group_links( this, u, res );
+#else
+    VLC_UNUSED(this);
+#endif
+    return srt_connect( u, res->ai_addr, res->ai_addrlen );
+}
+
+/**
+ * Splits a "host:port" endpoint in place, IPv6 hosts being enclosed in
+ * brackets.
+ *
+ * \param port set to the port if the endpoint has one, unchanged otherwise
+ * \return the host, without brackets
+ */
+char *srt_split_endpoint(char *endpoint, int *port)
+{
+    char *psz_host = endpoint, *psz_port = endpoint;
+
+    if (psz_host[0] == '[') {
+        char *psz_end = strchr( psz_host, ']' );
+
+        if (psz_end != NULL) {
+            *psz_end = '\0';
+            psz_host++;
+            psz_port = psz_end + 1;
+        }
+    }
+
+    psz_port = strchr( psz_port, ':' );
+    if (psz_port != NULL) {
+        *psz_port++ = '\0';
+        *port = atoi( psz_port );
+    }
+    return psz_host;
+}
+
+/**
+ * Updates the SRT connection statistics.
+ *
+ * The receiver losses are accounted into the input statistics through the
+ * ES output of the input. Without one, the sender totals are exposed as
+ * the "srt-packets-sent", "srt-packets-lost" and "srt-packets-retransmitted"
+ * variables of the object, if it created them. The statistics are also
+ * logged if an interval is set.
+ */
+void srt_report_stats(vlc_object_t *this, es_out_t *out, SRTSOCKET u,
+        vlc_tick_t interval, vlc_tick_t *next)
+{
+    SRT_TRACEBSTATS stats;
+    vlc_tick_t now = vlc_tick_now();
+
+    if (now < *next)
+        return;
+    *next = now + (interval > 0 ? interval : SRT_STATS_PERIOD);
+
+    /* Get the counters of the elapsed interval and clear them */
+    if (srt_bstats( u, &stats, 1 ) == SRT_ERROR)
+        return;
+
+    if (out != NULL) {
+        /* Dropped packets were given up on, belated ones arrived after
+         * their play time. Retransmitted packets are not counted as
+         * recovered, which is for FEC: the ARQ repairs are not losses. */
+        if (stats.pktRcvDrop || stats.pktRcvBelated)
+            es_out_Control( out, ES_OUT_ADD_TRANSPORT_STATS,
+                            (unsigned) stats.pktRcvDrop, 0u,
+                            (unsigned) stats.pktRcvBelated, 0u );
+    } else {
+        int64_t i_sent = stats.pktSentTotal;
+#ifdef SRT_HAVE_GROUPS
+        /* Groups only count the packets, not the per link losses */
+        if (u & SRTGROUP_MASK)
+            i_sent = stats.pktSentUniqueTotal;
+#endif
+        var_SetInteger( this, "srt-packets-sent", i_sent );
+        var_SetInteger( this, "srt-packets-lost", stats.pktSndLossTotal );
+        var_SetInteger( this, "srt-packets-retransmitted",
+                        stats.pktRetransTotal );
+    }
+
+    if (interval <= 0)
+        return;
+
+    msg_Dbg( this, "SRT stats: sent %"PRId64" packets (%d lost, "
+            "%d retransmitted), received %"PRId64" packets (%d lost, "
+            "%d dropped), RTT %.2f ms, bandwidth %.2f Mb/s, "
+            "rate %.2f/%.2f Mb/s out/in", stats.pktSent, stats.pktSndLoss,
+            stats.pktRetrans, stats.pktRecv, stats.pktRcvLoss,
+            stats.pktRcvDrop, stats.msRTT, stats.mbpsBandwidth,
+            stats.mbpsSendRate, stats.mbpsRecvRate );
+}
@@ -28,6 +28,8 @@
 #endif
 
 #include <vlc_common.h>
+#include <vlc_es_out.h>
+#include <vlc_network.h>
 #include <srt/srt.h>
 
 
@@ -39,6 +41,9 @@
 #define SRT_PARAM_CHUNK_SIZE                  "chunk-size"
 #define SRT_PARAM_POLL_TIMEOUT                "poll-timeout"
 #define SRT_PARAM_KEY_LENGTH                  "key-length"
+#define SRT_PARAM_GROUP                       "group"
+#define SRT_PARAM_GROUP_LINKS                 "group-links"
+#define SRT_PARAM_STATS_INTERVAL              "stats-interval"
 
 
 #define SRT_DEFAULT_BANDWIDTH_OVERHEAD_LIMIT 25
@@ -62,6 +67,31 @@ static const int srt_key_lengths[] = { 16, 24, 32, };
 
 extern const char * const srt_key_length_names[];
 
+/* Socket groups (bonding) appeared in libsrt 1.5.0 */
+#if SRT_VERSION_VALUE >= SRT_MAKE_VERSION_VALUE(1, 5, 0)
+# define SRT_HAVE_GROUPS 1
+#endif
+#define SRT_GROUP_TEXT N_("Socket group")
+#define SRT_GROUP_LONGTEXT N_("Bond the links to the destination and to " \
+    "the group links: broadcast sends every packet over all links, backup " \
+    "sends over one link and switches to another one when it fails.")
+#define SRT_GROUP_LINKS_TEXT N_("Group links")
+#define SRT_GROUP_LINKS_LONGTEXT N_("Comma-separated list of additional " \
+    "host:port endpoints of the socket group.")
+#define SRT_STATS_INTERVAL_TEXT N_("Statistics interval (ms)")
+#define SRT_STATS_INTERVAL_LONGTEXT N_("Log the SRT connection statistics " \
+    "(packets, losses, retransmissions, round-trip time) at this interval, " \
+    "0 to disable.")
+#define SRT_DEFAULT_STATS_INTERVAL 0
+/* Period of the statistics counters update when they are not logged */
+#define SRT_STATS_PERIOD VLC_TICK_FROM_SEC(1)
+/* Maximum number of links in a socket group */
+#define SRT_MAX_GROUP_LINKS 8
+
+static const char * const srt_group_values[] = { "", "broadcast", "backup", };
+
+extern const char * const srt_group_names[];
+
 typedef struct srt_params {
     int latency;
     const char* passphrase;
@@ -72,7 +102,17 @@ typedef struct srt_params {
 
 bool srt_parse_url(char* url, srt_params_t* params);
 
+char *srt_split_endpoint(char *endpoint, int *port);
+
 int srt_set_socket_option(vlc_object_t *this, const char *srt_param,
         SRTSOCKET u, SRT_SOCKOPT opt, const void *optval, int optlen);
 
+SRTSOCKET srt_create_link(vlc_object_t *this, int family);
+
+int srt_connect_link(vlc_object_t *this, SRTSOCKET u,
+        const struct addrinfo *res);
+
+void srt_report_stats(vlc_object_t *this, es_out_t *out, SRTSOCKET u,
+        vlc_tick_t interval, vlc_tick_t *next);
+
 #endif
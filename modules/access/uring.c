@@ -0,0 +1,773 @@
+/*****************************************************************************
+ * uring.c: asynchronous file input using Linux io_uring
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#include <vlc_common.h>
+#include <vlc_access.h>
+#include <vlc_block.h>
+#include <vlc_fs.h>
+#include <vlc_interrupt.h>
+#include <vlc_plugin.h>
+
+/* Memory alignment of the read buffers, as required by O_DIRECT */
+#define URING_ALIGN 4096
+/* Completion tag of the cancellation requests */
+#define URING_CANCEL UINT64_MAX
+/* How long to wait for cancelled reads, in 100 ms steps */
+#define URING_CANCEL_POLLS 20
+
+/*****************************************************************************
+ * Minimal io_uring wrapper (liburing is not required)
+ *****************************************************************************/
+struct uring
+{
+    int fd;
+
+    void *sq_ptr;
+    size_t sq_len;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    size_t sqes_len;
+
+    void *cq_ptr;
+    size_t cq_len;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+};
+
+static int uring_Init(struct uring *ring, unsigned entries)
+{
+    struct io_uring_params p;
+
+    memset(&p, 0, sizeof (p));
+    ring->fd = syscall(__NR_io_uring_setup, entries, &p);
+    if (ring->fd == -1)
+        return -1;
+
+    ring->sq_len = p.sq_off.array + p.sq_entries * sizeof (unsigned);
+    ring->cq_len = p.cq_off.cqes + p.cq_entries * sizeof (struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        ring->sq_len = ring->cq_len = __MAX(ring->sq_len, ring->cq_len);
+
+    ring->sq_ptr = mmap(NULL, ring->sq_len, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring->fd,
+                        IORING_OFF_SQ_RING);
+    if (ring->sq_ptr == MAP_FAILED)
+        goto error;
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        ring->cq_ptr = ring->sq_ptr;
+    else
+    {
+        ring->cq_ptr = mmap(NULL, ring->cq_len, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring->fd,
+                            IORING_OFF_CQ_RING);
+        if (ring->cq_ptr == MAP_FAILED)
+        {
+            munmap(ring->sq_ptr, ring->sq_len);
+            goto error;
+        }
+    }
+
+    ring->sqes_len = p.sq_entries * sizeof (struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        if (ring->cq_ptr != ring->sq_ptr)
+            munmap(ring->cq_ptr, ring->cq_len);
+        munmap(ring->sq_ptr, ring->sq_len);
+        goto error;
+    }
+
+    char *sq = ring->sq_ptr, *cq = ring->cq_ptr;
+    ring->sq_head = (unsigned *)(sq + p.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + p.sq_off.array);
+    ring->cq_head = (unsigned *)(cq + p.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return 0;
+
+error:
+    vlc_close(ring->fd);
+    return -1;
+}
+
+static void uring_Clean(struct uring *ring)
+{
+    munmap(ring->sqes, ring->sqes_len);
+    if (ring->cq_ptr != ring->sq_ptr)
+        munmap(ring->cq_ptr, ring->cq_len);
+    munmap(ring->sq_ptr, ring->sq_len);
+    vlc_close(ring->fd);
+}
+
+/* Queues and submits one request */
+static int uring_Submit(struct uring *ring, const struct io_uring_sqe *req)
+{
+    unsigned tail = *ring->sq_tail;
+    unsigned index = tail & *ring->sq_mask;
+
+    ring->sqes[index] = *req;
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    if (syscall(__NR_io_uring_enter, ring->fd, 1, 0, 0, NULL, 0) != 1)
+    {   /* Take the entry back */
+        __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+        return -1;
+    }
+    return 0;
+}
+
+/* Queues and submits one vectored read */
+static int uring_SubmitRead(struct uring *ring, int fd, const struct iovec *iov,
+                            uint64_t offset, uint64_t user_data)
+{
+    struct io_uring_sqe sqe;
+
+    memset(&sqe, 0, sizeof (sqe));
+    sqe.opcode = IORING_OP_READV;
+    sqe.fd = fd;
+    sqe.addr = (uintptr_t)iov;
+    sqe.len = 1;
+    sqe.off = offset;
+    sqe.user_data = user_data;
+    return uring_Submit(ring, &sqe);
+}
+
+/* Requests the cancellation of a request, which still completes */
+static int uring_SubmitCancel(struct uring *ring, uint64_t user_data)
+{
+    struct io_uring_sqe sqe;
+
+    memset(&sqe, 0, sizeof (sqe));
+    sqe.opcode = IORING_OP_ASYNC_CANCEL;
+    sqe.fd = -1;
+    sqe.addr = user_data;
+    sqe.user_data = URING_CANCEL;
+    return uring_Submit(ring, &sqe);
+}
+
+/* Pops one completion if available */
+static bool uring_Reap(struct uring *ring, uint64_t *user_data, int *res)
+{
+    unsigned head = *ring->cq_head;
+
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+        return false;
+
+    const struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+    *user_data = cqe->user_data;
+    *res = cqe->res;
+    __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static int uring_WaitUninterruptible(struct uring *ring)
+{
+    return syscall(__NR_io_uring_enter, ring->fd, 0, 1,
+                   IORING_ENTER_GETEVENTS, NULL, 0);
+}
+
+/*****************************************************************************
+ * Access
+ *****************************************************************************/
+struct uring_read
+{
+    block_t *block;     /* NULL if the slot is idle */
+    struct iovec iov;
+    uint64_t offset;
+    int result;         /* bytes read, negated errno, or 1 if in flight */
+    bool done;
+};
+
+typedef struct
+{
+    int fd;
+    struct uring ring;
+
+    uint64_t size;      /* file size, refreshed at the end */
+    uint64_t pos;       /* offset of the next byte to hand out */
+    uint64_t ahead;     /* offset of the next read to submit */
+    size_t block_size;
+
+    unsigned depth;
+    unsigned head;      /* index of the read covering pos */
+    unsigned inflight;
+    bool direct;
+
+    /* STREAM_READ_RANGES batch, completions tagged depth + index */
+    struct vlc_stream_range *ranges;
+    bool *ranges_done;
+    size_t ranges_submitted;
+    unsigned ranges_pending;
+    bool ranges_error;
+
+    /* reads could neither complete nor be cancelled */
+    bool broken;
+
+    struct uring_read reads[];
+} access_sys_t;
+
+static struct uring_read *SlotAt(access_sys_t *sys, unsigned n)
+{
+    return &sys->reads[(sys->head + n) % sys->depth];
+}
+
+static void RefreshSize(access_sys_t *sys)
+{
+    struct stat st;
+
+    if (fstat(sys->fd, &st) == 0)
+        sys->size = st.st_size;
+}
+
+static int Submit(stream_t *access, struct uring_read *rd, uint64_t offset,
+                  size_t length)
+{
+    access_sys_t *sys = access->p_sys;
+    size_t alloc = (length + URING_ALIGN - 1) & ~(size_t)(URING_ALIGN - 1);
+    void *buf = aligned_alloc(URING_ALIGN, alloc);
+    if (unlikely(buf == NULL))
+        return -1;
+
+    rd->block = block_heap_Alloc(buf, alloc);
+    if (unlikely(rd->block == NULL))
+        return -1;
+
+    rd->iov.iov_base = buf;
+    rd->iov.iov_len = alloc;
+    rd->offset = offset;
+    rd->result = 1;
+    rd->done = false;
+
+    if (uring_SubmitRead(&sys->ring, sys->fd, &rd->iov, offset,
+                         rd - sys->reads))
+    {
+        msg_Err(access, "cannot submit read: %s", vlc_strerror_c(errno));
+        block_Release(rd->block);
+        rd->block = NULL;
+        return -1;
+    }
+    sys->inflight++;
+    return 0;
+}
+
+/* Keeps the read-ahead window full */
+static void FillWindow(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+
+    for (unsigned n = 0; n < sys->depth; n++)
+    {
+        struct uring_read *rd = SlotAt(sys, n);
+        if (rd->block != NULL)
+            continue;
+
+        if (sys->ahead >= sys->size)
+        {
+            RefreshSize(sys);
+            if (sys->ahead >= sys->size)
+                break;
+        }
+
+        if (Submit(access, rd, sys->ahead, sys->block_size))
+            break;
+        sys->ahead += sys->block_size;
+    }
+}
+
+static void ReapAll(access_sys_t *sys)
+{
+    uint64_t index;
+    int res;
+
+    while (uring_Reap(&sys->ring, &index, &res))
+    {
+        if (index == URING_CANCEL)
+            continue; /* the cancelled read completes on its own */
+
+        if (index >= sys->depth)
+        {   /* Part of a ranges batch */
+            if (sys->ranges == NULL)
+                continue; /* given up on */
+            if (res >= 0)
+                sys->ranges[index - sys->depth].read = res;
+            else
+                sys->ranges_error = true;
+            sys->ranges_done[index - sys->depth] = true;
+            sys->ranges_pending--;
+            continue;
+        }
+
+        struct uring_read *rd = &sys->reads[index];
+        rd->result = res;
+        rd->done = true;
+        sys->inflight--;
+    }
+}
+
+/**
+ * Cancels all the reads in flight, once waiting for them failed, and reaps
+ * them for a while. The ring is polled, as io_uring_enter() may well fail
+ * again. Reads that still do not complete must not have their buffers freed.
+ */
+static void Cancel(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+
+    msg_Err(access, "cannot wait for reads: %s", vlc_strerror_c(errno));
+
+    for (unsigned i = 0; i < sys->depth; i++)
+        if (sys->reads[i].block != NULL && !sys->reads[i].done)
+            uring_SubmitCancel(&sys->ring, i);
+    if (sys->ranges != NULL)
+        for (size_t i = 0; i < sys->ranges_submitted; i++)
+            if (!sys->ranges_done[i])
+                uring_SubmitCancel(&sys->ring, sys->depth + i);
+
+    for (unsigned i = 0; i < URING_CANCEL_POLLS; i++)
+    {
+        ReapAll(sys);
+        if (sys->inflight == 0 && sys->ranges_pending == 0)
+            return;
+
+        struct pollfd ufd = { .fd = sys->ring.fd, .events = POLLIN };
+        poll(&ufd, 1, 100);
+    }
+
+    msg_Err(access, "%u reads stuck in flight, leaking their buffers",
+            sys->inflight + sys->ranges_pending);
+    sys->broken = true;
+}
+
+/* Waits for and discards all the pending reads */
+static void Drain(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+
+    while (sys->inflight > 0)
+    {
+        ReapAll(sys);
+        if (sys->inflight > 0 && uring_WaitUninterruptible(&sys->ring) < 0
+         && errno != EINTR)
+        {
+            Cancel(access);
+            break;
+        }
+    }
+
+    for (unsigned i = 0; i < sys->depth; i++)
+    {
+        struct uring_read *rd = &sys->reads[i];
+        if (rd->block != NULL && (rd->done || sys->inflight == 0))
+        {
+            block_Release(rd->block);
+            rd->block = NULL;
+        }
+    }
+}
+
+/* Discards the read-ahead window and restarts reading from offset */
+static int Restart(stream_t *access, uint64_t offset)
+{
+    access_sys_t *sys = access->p_sys;
+
+    Drain(access);
+    if (sys->inflight > 0)
+        return -1;
+
+    sys->head = 0;
+    sys->pos = offset;
+    /* O_DIRECT requires aligned offsets */
+    sys->ahead = offset & ~(uint64_t)(URING_ALIGN - 1);
+    return 0;
+}
+
+static block_t *Block(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->broken)
+    {
+        *eof = true;
+        return NULL;
+    }
+
+    FillWindow(access);
+
+    struct uring_read *rd = SlotAt(sys, 0);
+    if (rd->block == NULL)
+    {   /* Nothing left to read */
+        *eof = true;
+        return NULL;
+    }
+
+    while (!rd->done)
+    {
+        ReapAll(sys);
+        if (rd->done)
+            break;
+
+        struct pollfd ufd = { .fd = sys->ring.fd, .events = POLLIN };
+        if (vlc_poll_i11e(&ufd, 1, -1) < 0)
+            return NULL; /* interrupted, the read stays in flight */
+    }
+
+    block_t *block = rd->block;
+    int res = rd->result;
+    rd->block = NULL;
+
+    if (res < 0)
+    {
+        msg_Err(access, "read error: %s", vlc_strerror_c(-res));
+        block_Release(block);
+        *eof = true;
+        return NULL;
+    }
+
+    /* The read may start before pos after a seek to an unaligned offset */
+    size_t skip = sys->pos - rd->offset;
+    if ((size_t)res <= skip)
+    {   /* End of file */
+        block_Release(block);
+        RefreshSize(sys);
+        if (sys->pos >= sys->size)
+        {
+            *eof = true;
+            return NULL;
+        }
+        /* Short read in the middle of the file: read the rest again */
+        if (Restart(access, sys->pos))
+            *eof = true;
+        return NULL;
+    }
+
+    block->p_buffer += skip;
+    block->i_buffer = res - skip;
+    sys->pos += block->i_buffer;
+
+    if ((size_t)res < rd->iov.iov_len && sys->pos < sys->size)
+    {   /* Short read: the next reads do not start at pos anymore */
+        if (Restart(access, sys->pos))
+            *eof = true;
+    }
+    else
+        sys->head = (sys->head + 1) % sys->depth;
+    return block;
+}
+
+static int Seek(stream_t *access, uint64_t offset)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->broken)
+        return VLC_EGENERIC;
+
+    /* Keep the in-flight reads if the target is within the window */
+    for (unsigned n = 0; n < sys->depth; n++)
+    {
+        struct uring_read *rd = SlotAt(sys, n);
+        if (rd->block == NULL)
+            break;
+        if (offset >= rd->offset && offset < rd->offset + rd->iov.iov_len)
+        {
+            for (unsigned i = 0; i < n; i++)
+            {
+                struct uring_read *old = SlotAt(sys, i);
+                while (!old->done)
+                {
+                    ReapAll(sys);
+                    if (!old->done && uring_WaitUninterruptible(&sys->ring) < 0
+                     && errno != EINTR)
+                    {
+                        Cancel(access);
+                        return VLC_EGENERIC;
+                    }
+                }
+                block_Release(old->block);
+                old->block = NULL;
+            }
+            sys->head = (sys->head + n) % sys->depth;
+            sys->pos = offset;
+            return VLC_SUCCESS;
+        }
+    }
+
+    return Restart(access, offset) ? VLC_EGENERIC : VLC_SUCCESS;
+}
+
+/* Submits all the ranges at once, along with the read-ahead window */
+static int ReadRanges(stream_t *access, struct vlc_stream_range *ranges,
+                      size_t count)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->direct || sys->broken)
+        return VLC_EGENERIC; /* O_DIRECT would need aligned buffers */
+
+    struct iovec *iov = vlc_alloc(count, sizeof (*iov));
+    bool *done = calloc(count, sizeof (*done));
+    if (unlikely(iov == NULL || done == NULL))
+    {
+        free(done);
+        free(iov);
+        return VLC_ENOMEM;
+    }
+
+    sys->ranges = ranges;
+    sys->ranges_done = done;
+    sys->ranges_submitted = 0;
+    sys->ranges_pending = 0;
+    sys->ranges_error = false;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        /* Do not overflow the completion queue */
+        while (sys->ranges_pending + sys->inflight >= sys->depth)
+        {
+            ReapAll(sys);
+            if (sys->ranges_pending + sys->inflight >= sys->depth
+             && uring_WaitUninterruptible(&sys->ring) < 0 && errno != EINTR)
+            {
+                sys->ranges_error = true;
+                goto out;
+            }
+        }
+
+        iov[i].iov_base = ranges[i].buf;
+        iov[i].iov_len = ranges[i].length;
+        ranges[i].read = 0;
+
+        if (uring_SubmitRead(&sys->ring, sys->fd, &iov[i], ranges[i].offset,
+                             sys->depth + i))
+        {
+            msg_Err(access, "cannot submit read: %s", vlc_strerror_c(errno));
+            sys->ranges_error = true;
+            break;
+        }
+        sys->ranges_submitted++;
+        sys->ranges_pending++;
+    }
+
+out:
+    /* The buffers belong to the caller: wait for all the reads to complete */
+    while (sys->ranges_pending > 0)
+    {
+        ReapAll(sys);
+        if (sys->ranges_pending > 0
+         && uring_WaitUninterruptible(&sys->ring) < 0 && errno != EINTR)
+        {
+            Cancel(access);
+            sys->ranges_error = true;
+            break;
+        }
+    }
+
+    sys->ranges = NULL;
+    free(done);
+    if (sys->ranges_pending > 0)
+        /* The kernel may still use the vectors: leak them */
+        return VLC_EGENERIC;
+
+    free(iov);
+    return sys->ranges_error ? VLC_EGENERIC : VLC_SUCCESS;
+}
+
+static int Control(stream_t *access, int query, va_list args)
+{
+    access_sys_t *sys = access->p_sys;
+
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = true;
+            break;
+
+        case STREAM_GET_SIZE:
+            RefreshSize(sys);
+            *va_arg(args, uint64_t *) = sys->size;
+            break;
+
+        case STREAM_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) =
+                VLC_TICK_FROM_MS(var_InheritInteger(access, "file-caching"));
+            break;
+
+        case STREAM_READ_RANGES:
+        {
+            struct vlc_stream_range *ranges =
+                va_arg(args, struct vlc_stream_range *);
+            return ReadRanges(access, ranges, va_arg(args, size_t));
+        }
+
+        case STREAM_SET_PAUSE_STATE:
+            break;
+
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    stream_t *access = (stream_t *)obj;
+
+    if (access->psz_filepath == NULL)
+        return VLC_EGENERIC;
+
+    int flags = O_RDONLY | O_NONBLOCK;
+    if (var_InheritBool(obj, "iouring-direct"))
+        flags |= O_DIRECT;
+
+    int fd = vlc_open(access->psz_filepath, flags);
+    if (fd == -1 && (flags & O_DIRECT))
+    {
+        msg_Warn(obj, "direct I/O not supported, using the page cache");
+        fd = vlc_open(access->psz_filepath, O_RDONLY | O_NONBLOCK);
+    }
+    if (fd == -1)
+    {
+        msg_Err(obj, "cannot open file %s (%s)", access->psz_filepath,
+                vlc_strerror_c(errno));
+        return VLC_EGENERIC;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode))
+        goto error; /* leave directories and devices to the file plugin */
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+
+    unsigned depth = var_InheritInteger(obj, "iouring-depth");
+    access_sys_t *sys = vlc_obj_malloc(obj, sizeof (*sys)
+                                            + depth * sizeof (sys->reads[0]));
+    if (unlikely(sys == NULL))
+        goto error;
+
+    if (uring_Init(&sys->ring, depth))
+    {
+        msg_Dbg(obj, "io_uring not available: %s", vlc_strerror_c(errno));
+        goto error;
+    }
+
+    sys->fd = fd;
+    sys->size = st.st_size;
+    sys->pos = 0;
+    sys->ahead = 0;
+    sys->block_size = (var_InheritInteger(obj, "iouring-block-size") * 1024
+                       + URING_ALIGN - 1) & ~(size_t)(URING_ALIGN - 1);
+    sys->depth = depth;
+    sys->head = 0;
+    sys->inflight = 0;
+    sys->direct = (fcntl(fd, F_GETFL) & O_DIRECT) != 0;
+    sys->ranges = NULL;
+    sys->ranges_done = NULL;
+    sys->ranges_submitted = 0;
+    sys->ranges_pending = 0;
+    sys->ranges_error = false;
+    sys->broken = false;
+    for (unsigned i = 0; i < depth; i++)
+        sys->reads[i].block = NULL;
+
+    access->pf_read = NULL;
+    access->pf_block = Block;
+    access->pf_seek = Seek;
+    access->pf_control = Control;
+    access->p_sys = sys;
+
+    msg_Dbg(obj, "%u reads of %zu bytes in flight%s", depth, sys->block_size,
+            sys->direct ? ", direct I/O" : "");
+    return VLC_SUCCESS;
+
+error:
+    vlc_close(fd);
+    return VLC_EGENERIC;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    stream_t *access = (stream_t *)obj;
+    access_sys_t *sys = access->p_sys;
+
+    /* Blocks of the reads still in flight are leaked, not released: closing
+     * the ring does not wait for the kernel to give up on them. */
+    Drain(access);
+    uring_Clean(&sys->ring);
+    vlc_close(sys->fd);
+}
+
+#define HELP_TEXT N_( \
+    "This input is used only when selected explicitly, with an " \
+    "iouring:///path/to/file MRL.")
+#define DEPTH_TEXT N_("Reads in flight")
+#define DEPTH_LONGTEXT N_( \
+    "Number of reads queued ahead of the current position.")
+#define BLOCK_SIZE_TEXT N_("Read size (kB)")
+#define BLOCK_SIZE_LONGTEXT N_( \
+    "Size of each read. Larger reads reduce the per-request overhead.")
+#define DIRECT_TEXT N_("Direct I/O")
+#define DIRECT_LONGTEXT N_( \
+    "Bypass the operating system page cache (O_DIRECT). This avoids " \
+    "polluting the cache when playing very large files.")
+
+vlc_module_begin()
+    set_shortname(N_("io_uring"))
+    set_description(N_("Asynchronous file input (io_uring)"))
+    set_help(HELP_TEXT)
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_ACCESS)
+    set_capability("access", 0)
+    add_shortcut("iouring")
+    set_callbacks(Open, Close)
+
+    add_integer_with_range("iouring-depth", 8, 1, 256,
+                           DEPTH_TEXT, DEPTH_LONGTEXT, true)
+    add_integer_with_range("iouring-block-size", 1024, 4, 65536,
+                           BLOCK_SIZE_TEXT, BLOCK_SIZE_LONGTEXT, true)
+    add_bool("iouring-direct", false, DIRECT_TEXT, DIRECT_LONGTEXT, true)
+vlc_module_end()
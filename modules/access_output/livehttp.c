@@ -951,6 +951,11 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
     {
         if( p_sys->key_uri && !crypted )
         {
+            /* Encryption is done in place */
+            output = block_Unshare( output );
+            if( unlikely(!output) )
+                return VLC_ENOMEM;
+
             if( p_sys->stuffing_size )
             {
                 output = block_Realloc( output, p_sys->stuffing_size, output->i_buffer );
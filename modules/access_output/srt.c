@@ -37,6 +37,11 @@ typedef struct
     int           i_poll_id;
     bool          b_interrupted;
     vlc_mutex_t   lock;
+    int           i_poll_timeout;
+    vlc_tick_t    i_stats_interval;
+    vlc_tick_t    i_stats_next;
+    size_t        i_chunk_size;
+    uint8_t      *p_msg; /* TS packets coalesced into one SRT message */
 } sout_access_out_sys_t;
 
 static void srt_wait_interrupted(void *p_data)
@@ -80,28 +85,20 @@ static bool srt_schedule_reconnect(sout_access_out_t *p_access)
     bool failed = false;
 
     i_dst_port = SRT_DEFAULT_PORT;
-    char *psz_parser = psz_dst_addr = strdup( p_access->psz_path );
+    psz_dst_addr = strdup( p_access->psz_path );
     if( !psz_dst_addr )
     {
         failed = true;
         goto out;
     }
 
-    if ( psz_parser[0] == '[' )
-        psz_parser = strchr( psz_parser, ']' );
+    char *psz_host = srt_split_endpoint( psz_dst_addr, &i_dst_port );
 
-    psz_parser = strchr( psz_parser ? psz_parser : psz_dst_addr, ':' );
-    if ( psz_parser != NULL )
-    {
-        *psz_parser++ = '\0';
-        i_dst_port = atoi( psz_parser );
-    }
-
-    stat = vlc_getaddrinfo( psz_dst_addr, i_dst_port, &hints, &res );
+    stat = vlc_getaddrinfo( psz_host, i_dst_port, &hints, &res );
     if ( stat )
     {
         msg_Err( p_access, "Cannot resolve [%s]:%d (reason: %s)",
-                 psz_dst_addr,
+                 psz_host,
                  i_dst_port,
                  gai_strerror( stat ) );
 
@@ -116,7 +113,7 @@ static bool srt_schedule_reconnect(sout_access_out_t *p_access)
         srt_close( p_sys->sock );
     }
 
-    p_sys->sock = srt_socket( res->ai_family, SOCK_DGRAM, 0 );
+    p_sys->sock = srt_create_link( access_obj, res->ai_family );
     if ( p_sys->sock == SRT_INVALID_SOCK )
     {
         msg_Err( p_access, "Failed to open socket." );
@@ -125,7 +122,7 @@ static bool srt_schedule_reconnect(sout_access_out_t *p_access)
     }
 
     if (psz_dst_addr) {
-        url = strdup( psz_dst_addr );
+        url = strdup( psz_host );
         if (srt_parse_url( url, &params )) {
             if (params.latency != -1)
                 i_latency = params.latency;
@@ -184,9 +181,9 @@ static bool srt_schedule_reconnect(sout_access_out_t *p_access)
 
     /* Schedule a connect */
     msg_Dbg( p_access, "Schedule SRT connect (dest addresss: %s, port: %d).",
-        psz_dst_addr, i_dst_port );
+        psz_host, i_dst_port );
 
-    stat = srt_connect( p_sys->sock, res->ai_addr, res->ai_addrlen );
+    stat = srt_connect_link( access_obj, p_sys->sock, res );
     if ( stat == SRT_ERROR )
     {
         msg_Err( p_access, "Failed to connect to server (reason: %s)",
@@ -211,16 +208,90 @@ out:
     return !failed;
 }
 
+/* Sends one message, waiting only while the sender buffer is full */
+static int SendMsg( sout_access_out_t *p_access, const uint8_t *p_data,
+                    size_t i_data, bool *b_interrupted )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    for( ;; )
+    {
+        if ( vlc_killed() )
+        {
+            /* We are told to stop. Stop. */
+            return VLC_EGENERIC;
+        }
+
+        switch( srt_getsockstate( p_sys->sock ) )
+        {
+            case SRTS_CONNECTED:
+                /* Good to go */
+                break;
+            case SRTS_BROKEN:
+            case SRTS_NONEXIST:
+            case SRTS_CLOSED:
+                /* Failed. Schedule recovery. */
+                if ( !srt_schedule_reconnect( p_access ) )
+                    msg_Err( p_access, "Failed to schedule connect");
+                /* Fall-through */
+            default:
+                /* Not ready */
+                return VLC_EGENERIC;
+        }
+
+        if ( srt_sendmsg2( p_sys->sock, (const char *)p_data, i_data,
+                           NULL ) != SRT_ERROR )
+            return VLC_SUCCESS;
+
+        if ( srt_getlasterror( NULL ) != SRT_EASYNCSND )
+        {
+            msg_Warn( p_access, "send error: %s", srt_getlasterror_str() );
+            return VLC_EGENERIC;
+        }
+
+        SRTSOCKET ready[1];
+        int readycnt = 1;
+        if ( srt_epoll_wait( p_sys->i_poll_id,
+            0, 0, &ready[0], &readycnt,
+            p_sys->i_poll_timeout, NULL, 0, NULL, 0 ) < 0)
+        {
+            if ( vlc_killed() )
+            {
+                /* We are told to stop. Stop. */
+                return VLC_EGENERIC;
+            }
+
+            /* if 'srt_epoll_wait' is interrupted, we still need to
+            *  finish sending current block or it may be sent only
+            *  partially. TODO: this delay can be prevented,
+            *  possibly with a FIFO and an additional thread.
+            */
+            vlc_mutex_lock( &p_sys->lock );
+            if ( p_sys->b_interrupted )
+            {
+                srt_epoll_add_usock( p_sys->i_poll_id, p_sys->sock,
+                    &(int) { SRT_EPOLL_ERR | SRT_EPOLL_OUT });
+                p_sys->b_interrupted = false;
+                *b_interrupted = true;
+                msg_Dbg( p_access, "srt_epoll_wait was interrupted");
+            }
+            vlc_mutex_unlock( &p_sys->lock );
+        }
+    }
+}
+
 static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 {
     sout_access_out_sys_t *p_sys = p_access->p_sys;
-    int i_len = 0;
-    size_t i_chunk_size = var_InheritInteger( p_access, SRT_PARAM_CHUNK_SIZE);
-    int i_poll_timeout = var_InheritInteger( p_access, SRT_PARAM_POLL_TIMEOUT );
+    ssize_t i_len = 0;
+    size_t i_msg = 0;
     bool b_interrupted = false;
 
     vlc_interrupt_register( srt_wait_interrupted, p_access);
 
+    /* Small blocks (a TS mux writes single packets) are coalesced into
+     * messages of chunk size, larger ones are sent from the block. Only the
+     * last message of the chain may be short. */
     while( p_buffer )
     {
         block_t *p_next;
@@ -229,84 +300,37 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 
         while( p_buffer->i_buffer )
         {
-            if ( vlc_killed() )
-            {
-                /* We are told to stop. Stop. */
-                i_len = VLC_EGENERIC;
-                goto out;
-            }
+            size_t i_write = __MIN( p_buffer->i_buffer,
+                                    p_sys->i_chunk_size - i_msg );
 
-            switch( srt_getsockstate( p_sys->sock ) )
+            if ( i_msg == 0 && i_write == p_sys->i_chunk_size )
             {
-                case SRTS_CONNECTED:
-                    /* Good to go */
-                    break;
-                case SRTS_BROKEN:
-                case SRTS_NONEXIST:
-                case SRTS_CLOSED:
-                    /* Failed. Schedule recovery. */
-                    if ( !srt_schedule_reconnect( p_access ) )
-                        msg_Err( p_access, "Failed to schedule connect");
-                    /* Fall-through */
-                default:
-                    /* Not ready */
-                    i_len = VLC_EGENERIC;
-                    goto out;
-            }
-
-            SRTSOCKET ready[1];
-            int readycnt = 1;
-            if ( srt_epoll_wait( p_sys->i_poll_id,
-                0, 0, &ready[0], &readycnt,
-                i_poll_timeout, NULL, 0, NULL, 0 ) < 0)
-            {
-                if ( vlc_killed() )
+                if ( SendMsg( p_access, p_buffer->p_buffer, i_write,
+                              &b_interrupted ) )
                 {
-                    /* We are told to stop. Stop. */
                     i_len = VLC_EGENERIC;
                     goto out;
                 }
-
-                /* if 'srt_epoll_wait' is interrupted, we still need to
-                *  finish sending current block or it may be sent only
-                *  partially. TODO: this delay can be prevented,
-                *  possibly with a FIFO and an additional thread.
-                */
-                vlc_mutex_lock( &p_sys->lock );
-                if ( p_sys->b_interrupted )
-                {
-                    srt_epoll_add_usock( p_sys->i_poll_id, p_sys->sock,
-                        &(int) { SRT_EPOLL_ERR | SRT_EPOLL_OUT });
-                    p_sys->b_interrupted = false;
-                    b_interrupted = true;
-                }
-                vlc_mutex_unlock( &p_sys->lock );
-
-                if ( !b_interrupted )
-                {
-                    continue;
-                }
-                else if ( (true) )
-                {
-                    msg_Dbg( p_access, "srt_epoll_wait was interrupted");
-                }
             }
-
-            if ( readycnt > 0  && ready[0] == p_sys->sock
-                && srt_getsockstate( p_sys->sock ) == SRTS_CONNECTED)
+            else
             {
-                size_t i_write = __MIN( p_buffer->i_buffer, i_chunk_size );
-                if (srt_sendmsg2( p_sys->sock,
-                    (char *)p_buffer->p_buffer, i_write, 0 ) == SRT_ERROR )
+                memcpy( p_sys->p_msg + i_msg, p_buffer->p_buffer, i_write );
+                i_msg += i_write;
+
+                if ( i_msg == p_sys->i_chunk_size )
                 {
-                    msg_Warn( p_access, "send error: %s", srt_getlasterror_str() );
-                    i_len = VLC_EGENERIC;
-                    goto out;
+                    if ( SendMsg( p_access, p_sys->p_msg, i_msg,
+                                  &b_interrupted ) )
+                    {
+                        i_len = VLC_EGENERIC;
+                        goto out;
+                    }
+                    i_msg = 0;
                 }
-
-                p_buffer->p_buffer += i_write;
-                p_buffer->i_buffer -= i_write;
             }
+
+            p_buffer->p_buffer += i_write;
+            p_buffer->i_buffer -= i_write;
         }
 
         p_next = p_buffer->p_next;
@@ -315,10 +339,17 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 
         if ( b_interrupted )
         {
-            goto out;
+            break;
         }
     }
 
+    if ( i_msg > 0
+      && SendMsg( p_access, p_sys->p_msg, i_msg, &b_interrupted ) )
+        i_len = VLC_EGENERIC;
+
+    srt_report_stats( VLC_OBJECT(p_access), NULL, p_sys->sock,
+                      p_sys->i_stats_interval, &p_sys->i_stats_next );
+
 out:
     vlc_interrupt_unregister();
 
@@ -332,7 +363,7 @@ out:
     }
     vlc_mutex_unlock( &p_sys->lock );
 
-    if ( i_len <= 0 ) block_ChainRelease( p_buffer );
+    block_ChainRelease( p_buffer );
     return i_len;
 }
 
@@ -374,11 +405,28 @@ static int Open( vlc_object_t *p_this )
     if( unlikely( p_sys == NULL ) )
         return VLC_ENOMEM;
 
+    int i_chunk_size = var_InheritInteger( p_access, SRT_PARAM_CHUNK_SIZE );
+    p_sys->i_chunk_size = ( i_chunk_size > 0 )
+        ? (size_t)i_chunk_size : SRT_DEFAULT_CHUNK_SIZE;
+    p_sys->p_msg = vlc_obj_malloc( p_this, p_sys->i_chunk_size );
+    if( unlikely( p_sys->p_msg == NULL ) )
+        return VLC_ENOMEM;
+
     srt_startup();
 
     vlc_mutex_init( &p_sys->lock );
 
     p_access->p_sys = p_sys;
+    p_sys->sock = SRT_INVALID_SOCK;
+
+    p_sys->i_poll_timeout = var_InheritInteger( p_access,
+                                                SRT_PARAM_POLL_TIMEOUT );
+    p_sys->i_stats_interval = VLC_TICK_FROM_MS(
+        var_InheritInteger( p_access, SRT_PARAM_STATS_INTERVAL ) );
+    p_sys->i_stats_next = 0;
+    var_Create( p_access, "srt-packets-sent", VLC_VAR_INTEGER );
+    var_Create( p_access, "srt-packets-lost", VLC_VAR_INTEGER );
+    var_Create( p_access, "srt-packets-retransmitted", VLC_VAR_INTEGER );
 
     p_sys->i_poll_id = srt_epoll_create();
     if ( p_sys->i_poll_id == -1 )
@@ -444,6 +492,15 @@ vlc_module_begin()
     add_integer( SRT_PARAM_KEY_LENGTH, SRT_DEFAULT_KEY_LENGTH, SRT_KEY_LENGTH_TEXT,
             SRT_KEY_LENGTH_TEXT, false )
     change_integer_list( srt_key_lengths, srt_key_length_names )
+#ifdef SRT_HAVE_GROUPS
+    add_string( SRT_PARAM_GROUP, "", SRT_GROUP_TEXT, SRT_GROUP_LONGTEXT,
+            true )
+    change_string_list( srt_group_values, srt_group_names )
+    add_string( SRT_PARAM_GROUP_LINKS, NULL, SRT_GROUP_LINKS_TEXT,
+            SRT_GROUP_LINKS_LONGTEXT, true )
+#endif
+    add_integer( SRT_PARAM_STATS_INTERVAL, SRT_DEFAULT_STATS_INTERVAL,
+            SRT_STATS_INTERVAL_TEXT, SRT_STATS_INTERVAL_LONGTEXT, true )
 
     set_capability( "sout access", 0 )
     add_shortcut( "srt" )
@@ -49,6 +49,10 @@
 
 #include <vlc_network.h>
 
+#ifdef __linux__
+#   include <sys/prctl.h>
+#endif
+
 #define MAX_EMPTY_BLOCKS 200
 
 /*****************************************************************************
@@ -71,6 +75,12 @@ static void Close( vlc_object_t * );
                           "helps reducing the scheduling load on " \
                           "heavily-loaded systems." )
 
+#define SPIN_TEXT N_("Busy-wait time (us)")
+#define SPIN_LONGTEXT N_("Packets are sent at their date by sleeping until " \
+                         "shortly before it, then busy-waiting for the given " \
+                         "time. This reduces the jitter of constant bitrate " \
+                         "streams at the expense of CPU time. 0 only sleeps." )
+
 vlc_module_begin ()
     set_description( N_("UDP stream output") )
     set_shortname( "UDP" )
@@ -79,6 +89,8 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "caching", DEFAULT_PTS_DELAY / 1000, CACHING_TEXT, CACHING_LONGTEXT, true )
     add_integer( SOUT_CFG_PREFIX "group", 1, GROUP_TEXT, GROUP_LONGTEXT,
                                  true )
+    add_integer( SOUT_CFG_PREFIX "spin", 0, SPIN_TEXT, SPIN_LONGTEXT, true )
+        change_integer_range( 0, 10000 )
 
     set_capability( "sout access", 0 )
     add_shortcut( "udp" )
@@ -92,6 +104,7 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "caching",
     "group",
+    "spin",
     NULL
 };
 
@@ -346,6 +359,22 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
     return i_len;
 }
 
+/* Sleeps until shortly before the date then spins, as the sleep alone may
+ * wake up late by the timer slack and the scheduling latency. */
+static void WaitPrecise( vlc_tick_t i_date, vlc_tick_t i_spin )
+{
+    if( i_spin == 0 )
+    {
+        vlc_tick_wait( i_date );
+        return;
+    }
+
+    if( i_date - i_spin > vlc_tick_now() )
+        vlc_tick_wait( i_date - i_spin );
+    while( vlc_tick_now() < i_date )
+        ;
+}
+
 /*****************************************************************************
  * ThreadWrite: Write a packet on the network at the good time.
  *****************************************************************************/
@@ -356,10 +385,18 @@ static void* ThreadWrite( void *data )
     vlc_tick_t i_date_last = -1;
     const unsigned i_group = var_GetInteger( p_access,
                                              SOUT_CFG_PREFIX "group" );
+    const vlc_tick_t i_spin = VLC_TICK_FROM_US(
+                    var_GetInteger( p_access, SOUT_CFG_PREFIX "spin" ) );
     int i_to_send = i_group;
     unsigned i_dropped_packets = 0;
     block_t *p_pk;
 
+#ifdef PR_SET_TIMERSLACK
+    /* The default 50us timer slack would dominate the pacing jitter */
+    if( i_spin > 0 )
+        prctl( PR_SET_TIMERSLACK, 1UL );
+#endif
+
     while ((p_pk = vlc_queue_DequeueKillable(&p_sys->queue,
                                              &p_sys->dead)) != NULL)
     {
@@ -391,7 +428,7 @@ static void* ThreadWrite( void *data )
         i_to_send--;
         if( !i_to_send || (p_pk->i_flags & BLOCK_FLAG_CLOCK) )
         {
-            vlc_tick_wait( i_date );
+            WaitPrecise( i_date, i_spin );
             i_to_send = i_group;
         }
         if ( send( p_sys->i_handle, p_pk->p_buffer, p_pk->i_buffer, 0 ) == -1 )
@@ -1216,6 +1216,10 @@ static block_t *EncodeVideo( encoder_t *p_enc, picture_t *p_pict )
         if ( p_sys->b_hurry_up && frame->pts != AV_NOPTS_VALUE )
             check_hurry_up( p_sys, frame, p_enc );
 
+        /* Requested keyframes override the hurry up mode */
+        if( p_pict->b_keyframe )
+            frame->pict_type = AV_PICTURE_TYPE_I;
+
         if ( ( frame->pts != AV_NOPTS_VALUE ) && ( frame->pts != VLC_TICK_INVALID ) )
         {
             if ( p_sys->i_last_pts == FROM_AV_TS(frame->pts) )
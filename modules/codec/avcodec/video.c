@@ -90,6 +90,9 @@ typedef struct
     int64_t i_last_output_frame;
     vlc_tick_t i_last_late_delay;
 
+    /* threads reserved from the decoding budget */
+    unsigned i_threads;
+
     /* for direct rendering */
     bool        b_direct_rendering;
     atomic_bool b_dr_failure;
@@ -631,10 +634,16 @@ int InitVideoDec( vlc_object_t *obj )
 #endif
     }
     i_thread_count = __MIN( i_thread_count, p_codec->id == AV_CODEC_ID_HEVC ? 32 : 16 );
+    p_sys->i_threads = decoder_AcquireThreads( p_dec, i_thread_count );
+    i_thread_count = p_sys->i_threads;
     msg_Dbg( p_dec, "allowing %d thread(s) for decoding", i_thread_count );
     p_context->thread_count = i_thread_count;
     p_context->thread_safe_callbacks = true;
 
+    /* No worker threads left in the budget: decode in the decoder thread */
+    if( i_thread_count == 1 )
+        p_context->thread_type = 0;
+
     switch( p_codec->id )
     {
         case AV_CODEC_ID_MPEG4:
@@ -690,6 +699,7 @@ int InitVideoDec( vlc_object_t *obj )
     /* ***** Open the codec ***** */
     if( OpenVideoCodec( p_dec ) < 0 )
     {
+        decoder_ReleaseThreads( p_dec, p_sys->i_threads );
         free( p_sys );
         avcodec_free_context( &p_context );
         return VLC_EGENERIC;
@@ -1388,6 +1398,7 @@ void EndVideoDec( vlc_object_t *obj )
     if( p_sys->p_va )
         vlc_va_Delete( p_sys->p_va );
 
+    decoder_ReleaseThreads( p_dec, p_sys->i_threads );
     free( p_sys );
 }
 
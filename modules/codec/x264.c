@@ -1490,6 +1490,8 @@ static block_t *Encode( encoder_t *p_enc, picture_t *p_pict )
     x264_picture_init( &pic );
     if( likely(p_pict) ) {
        pic.i_pts = p_pict->date;
+       if( p_pict->b_keyframe )
+           pic.i_type = X264_TYPE_IDR;
        pic.img.i_csp = p_sys->i_colorspace;
        pic.img.i_plane = p_pict->i_planes;
        for( i = 0; i < p_pict->i_planes; i++ )
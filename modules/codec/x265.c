@@ -71,6 +71,8 @@ static block_t *Encode(encoder_t *p_enc, picture_t *p_pict)
 
     if (likely(p_pict)) {
         pic.pts = p_pict->date;
+        if (p_pict->b_keyframe)
+            pic.sliceType = X265_TYPE_IDR;
         if (unlikely(p_sys->initial_date == VLC_TICK_INVALID)) {
             p_sys->initial_date = p_pict->date;
 #ifndef NDEBUG
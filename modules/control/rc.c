@@ -1207,6 +1207,14 @@ static void Statistics(intf_thread_t *intf)
                   item->p_stats->i_demux_corrupted);
         msg_print(intf, _("| discontinuities  :    %5"PRIi64),
                   item->p_stats->i_demux_discontinuity);
+        msg_print(intf, _("| packets lost     :    %5"PRIi64),
+                  item->p_stats->i_demux_lost);
+        msg_print(intf, _("| packets reordered:    %5"PRIi64),
+                  item->p_stats->i_demux_reordered);
+        msg_print(intf, _("| packets late     :    %5"PRIi64),
+                  item->p_stats->i_demux_late);
+        msg_print(intf, _("| packets recovered:    %5"PRIi64),
+                  item->p_stats->i_demux_recovered);
         msg_print(intf, "|");
 
         /* Video */
@@ -31,6 +31,14 @@
 #include <sstream>
 #include <algorithm>
 #include <vlc_stream.h>
+#include <vlc_block.h>
+
+extern "C"
+{
+    #include "../../../access/http/message.h"
+    #include "../../../access/http/resource.h"
+    #include "../../../access/http/connmgr.h"
+}
 
 using namespace adaptive::http;
 
@@ -66,6 +74,11 @@ const std::string & AbstractConnection::getContentType() const
     return contentType;
 }
 
+const ConnectionParams & AbstractConnection::getRedirection() const
+{
+    return locationparams;
+}
+
 HTTPConnection::HTTPConnection(vlc_object_t *p_object_, AuthStorage *auth,
                                Transport *socket_, const ConnectionParams &proxy, bool persistent)
     : AbstractConnection( p_object_ )
@@ -469,11 +482,6 @@ std::string HTTPConnection::extraRequestHeaders() const
     return ss.str();
 }
 
-const ConnectionParams & HTTPConnection::getRedirection() const
-{
-    return locationparams;
-}
-
 StreamUrlConnection::StreamUrlConnection(vlc_object_t *p_object)
     : AbstractConnection(p_object)
 {
@@ -589,6 +597,210 @@ void StreamUrlConnection::setUsed( bool b )
        reset();
 }
 
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_,
+                                           struct vlc_http_mgr *mgr)
+    : AbstractConnection(p_object_)
+{
+    manager = mgr;
+    resource = NULL;
+    p_pending = NULL;
+    char *psz_useragent = var_InheritString(p_object_, "http-user-agent");
+    useragent = psz_useragent ? std::string(psz_useragent) : std::string("");
+    free(psz_useragent);
+    char *psz_referer = var_InheritString(p_object_, "http-referrer");
+    referer = psz_referer ? std::string(psz_referer) : std::string("");
+    free(psz_referer);
+}
+
+LibVLCHTTPConnection::~LibVLCHTTPConnection()
+{
+    reset();
+}
+
+void LibVLCHTTPConnection::reset()
+{
+    if(p_pending)
+        block_Release(p_pending);
+    p_pending = NULL;
+    /* Closes the HTTP/2 stream, not the connection */
+    if(resource)
+        vlc_http_res_destroy(resource);
+    resource = NULL;
+    bytesRead = 0;
+    contentLength = 0;
+    contentType = std::string();
+    bytesRange = BytesRange();
+}
+
+bool LibVLCHTTPConnection::canReuse(const ConnectionParams &params_) const
+{
+    if( !available )
+        return false;
+    return (params.getHostname() == params_.getHostname() &&
+            params.getScheme() == params_.getScheme() &&
+            params.getPort() == params_.getPort());
+}
+
+int LibVLCHTTPConnection::formatRequest(const struct vlc_http_resource *,
+                                        struct vlc_http_msg *req, void *opaque)
+{
+    const LibVLCHTTPConnection *conn =
+            static_cast<const LibVLCHTTPConnection *>(opaque);
+    const BytesRange &range = conn->bytesRange;
+
+    vlc_http_msg_add_header(req, "Cache-Control", "no-cache");
+    if(range.isValid())
+    {
+        if(range.getEndByte())
+            return vlc_http_msg_add_header(req, "Range", "bytes=%zu-%zu",
+                                           range.getStartByte(), range.getEndByte());
+        return vlc_http_msg_add_header(req, "Range", "bytes=%zu-",
+                                       range.getStartByte());
+    }
+    return 0;
+}
+
+int LibVLCHTTPConnection::validateResponse(const struct vlc_http_resource *,
+                                           const struct vlc_http_msg *, void *)
+{
+    /* status is checked in request() */
+    return 0;
+}
+
+const struct vlc_http_resource_cbs LibVLCHTTPConnection::callbacks =
+{
+    LibVLCHTTPConnection::formatRequest,
+    LibVLCHTTPConnection::validateResponse,
+};
+
+enum RequestStatus
+    LibVLCHTTPConnection::request(const std::string &path, const BytesRange &range)
+{
+    reset();
+
+    /* Set new path for this query */
+    params.setPath(path);
+    locationparams = ConnectionParams();
+
+    msg_Dbg(p_object, "Retrieving %s @%zu", params.getUrl().c_str(),
+                      range.isValid() ? range.getStartByte() : 0);
+
+    resource = static_cast<struct vlc_http_resource *>(malloc(sizeof(*resource)));
+    if(!resource)
+        return RequestStatus::GenericError;
+
+    if(vlc_http_res_init(resource, &callbacks, manager,
+                         params.getUrl().c_str(),
+                         useragent.empty() ? NULL : useragent.c_str(),
+                         referer.empty() ? NULL : referer.c_str()))
+    {
+        free(resource);
+        resource = NULL;
+        return RequestStatus::GenericError;
+    }
+
+    bytesRange = range;
+    resource->response = vlc_http_res_open(resource, this);
+    if(!resource->response)
+    {
+        resource->failure = true;
+        return RequestStatus::GenericError;
+    }
+
+    const struct vlc_http_msg *resp = resource->response;
+    int status = vlc_http_msg_get_status(resp);
+    if(status / 100 == 3)
+    {
+        char *psz_location = vlc_http_res_get_redirect(resource);
+        if(psz_location)
+        {
+            locationparams = ConnectionParams(psz_location);
+            free(psz_location);
+            msg_Info(p_object, "%d redirection to %s", status, locationparams.getUrl().c_str());
+            if(locationparams.isLocal() && !params.isLocal())
+            {
+                msg_Err(p_object, "redirection to local rejected");
+                return RequestStatus::GenericError;
+            }
+            return RequestStatus::Redirection;
+        }
+    }
+
+    if(status != 200 && status != 206)
+    {
+        msg_Err(p_object, "Failed reading %s: status %d", params.getUrl().c_str(), status);
+        return RequestStatus::NotFound;
+    }
+
+    uintmax_t size = vlc_http_msg_get_size(resp);
+    if(size != (uintmax_t) -1)
+        contentLength = size;
+    else if(range.isValid() && range.getEndByte() > 0)
+        contentLength = range.getEndByte() - range.getStartByte() + 1;
+
+    const char *psz_type = vlc_http_msg_get_header(resp, "Content-Type");
+    if(psz_type)
+        contentType = std::string(psz_type);
+
+    return RequestStatus::Success;
+}
+
+ssize_t LibVLCHTTPConnection::read(void *p_buffer, size_t len)
+{
+    if( !resource || !resource->response )
+        return VLC_EGENERIC;
+
+    if(len == 0)
+        return VLC_SUCCESS;
+
+    const size_t toRead = (contentLength) ? contentLength - bytesRead : len;
+    if (toRead == 0)
+        return VLC_SUCCESS;
+
+    if(len > toRead)
+        len = toRead;
+
+    size_t copied = 0;
+    while(copied < len)
+    {
+        if(!p_pending)
+        {
+            block_t *p_block = vlc_http_res_read(resource);
+            if(p_block == NULL) /* EOF */
+                break;
+            if(p_block == vlc_http_error)
+            {
+                if(copied == 0)
+                    return -1;
+                break;
+            }
+            p_pending = p_block;
+        }
+
+        size_t tocopy = std::min(p_pending->i_buffer, len - copied);
+        memcpy(&((uint8_t *)p_buffer)[copied], p_pending->p_buffer, tocopy);
+        copied += tocopy;
+        p_pending->p_buffer += tocopy;
+        p_pending->i_buffer -= tocopy;
+        if(p_pending->i_buffer == 0)
+        {
+            block_Release(p_pending);
+            p_pending = NULL;
+        }
+    }
+
+    bytesRead += copied;
+    return copied;
+}
+
+void LibVLCHTTPConnection::setUsed( bool b )
+{
+    available = !b;
+    /* Unfinished streams are simply reset, the connection is kept */
+    if(available)
+        reset();
+}
+
 NativeConnectionFactory::NativeConnectionFactory( AuthStorage *auth )
     : AbstractConnectionFactory()
 {
@@ -646,23 +858,66 @@ AbstractConnection * StreamUrlConnectionFactory::createConnection(vlc_object_t *
     return new (std::nothrow) StreamUrlConnection(p_object);
 }
 
+LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory( AuthStorage *auth )
+    : AbstractConnectionFactory()
+{
+    authStorage = auth;
+}
+
+LibVLCHTTPConnectionFactory::~LibVLCHTTPConnectionFactory()
+{
+    std::map<std::string, struct vlc_http_mgr *>::const_iterator it;
+    for(it = managers.begin(); it != managers.end(); ++it)
+        vlc_http_mgr_destroy((*it).second);
+}
+
+AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t *p_object,
+                                                                   const ConnectionParams &params)
+{
+    if(params.getScheme() != "https" || params.getHostname().empty())
+        return NULL;
+
+    std::string origin = params.getHostname() + ":" + std::to_string(params.getPort());
+    struct vlc_http_mgr *mgr;
+    std::map<std::string, struct vlc_http_mgr *>::const_iterator it = managers.find(origin);
+    if(it == managers.end())
+    {
+        mgr = vlc_http_mgr_create(p_object, authStorage ? authStorage->getCookieJar()
+                                                        : NULL);
+        if(!mgr)
+            return NULL;
+        managers.insert(std::pair<std::string, struct vlc_http_mgr *>(origin, mgr));
+    }
+    else mgr = (*it).second;
+
+    return new (std::nothrow) LibVLCHTTPConnection(p_object, mgr);
+}
+
 ConnectionFactory::ConnectionFactory( AuthStorage *authstorage )
 {
     native = new NativeConnectionFactory( authstorage );
     streamurl = new StreamUrlConnectionFactory();
+    libvlchttp = new LibVLCHTTPConnectionFactory( authstorage );
 }
 
 ConnectionFactory::~ConnectionFactory()
 {
     delete native;
     delete streamurl;
+    delete libvlchttp;
 }
 
 AbstractConnection * ConnectionFactory::createConnection(vlc_object_t *p_object,
                                                          const ConnectionParams &params)
 {
     bool b_streamurl = var_InheritBool(p_object, "adaptive-use-access");
-    if(!b_streamurl && !params.usesAccess())
+    if(!b_streamurl && params.getScheme() == "https" &&
+       var_InheritBool(p_object, "adaptive-http2"))
+    {
+        /* playlists and segments share the same connection */
+        return libvlchttp->createConnection(p_object, params);
+    }
+    else if(!b_streamurl && !params.usesAccess())
     {
         return native->createConnection(p_object, params);
     }
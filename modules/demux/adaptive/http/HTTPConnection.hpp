@@ -29,6 +29,12 @@
 #include "BytesRange.hpp"
 #include <vlc_common.h>
 #include <string>
+#include <map>
+
+struct vlc_http_mgr;
+struct vlc_http_msg;
+struct vlc_http_resource;
+struct vlc_http_resource_cbs;
 
 namespace adaptive
 {
@@ -52,11 +58,13 @@ namespace adaptive
 
                 virtual size_t  getContentLength() const;
                 virtual const std::string & getContentType() const;
+                virtual const ConnectionParams & getRedirection() const;
                 virtual void    setUsed( bool ) = 0;
 
             protected:
                 vlc_object_t      *p_object;
                 ConnectionParams   params;
+                ConnectionParams   locationparams;
                 bool               available;
                 size_t             contentLength;
                 std::string        contentType;
@@ -77,7 +85,6 @@ namespace adaptive
                 virtual ssize_t read        (void *p_buffer, size_t len);
 
                 void setUsed( bool );
-                const ConnectionParams &getRedirection() const;
                 static const unsigned MAX_REDIRECTS = 3;
 
             protected:
@@ -99,7 +106,6 @@ namespace adaptive
                 std::string referer;
 
                 AuthStorage        *authStorage;
-                ConnectionParams    locationparams;
                 ConnectionParams    proxyparams;
                 bool                connectionClose;
                 bool                chunked;
@@ -132,6 +138,38 @@ namespace adaptive
                 stream_t *p_streamurl;
        };
 
+       /* Uses the libvlc HTTP stack, which keeps the connections to a same
+        * origin open between requests (HTTP/2 if negotiated with TLS-ALPN).
+        * This only saves the TCP and TLS setup of each request: segments
+        * are still requested one after the other, not in parallel. */
+       class LibVLCHTTPConnection : public AbstractConnection
+       {
+            public:
+                LibVLCHTTPConnection(vlc_object_t *, struct vlc_http_mgr *);
+                virtual ~LibVLCHTTPConnection();
+
+                virtual bool    canReuse     (const ConnectionParams &) const;
+
+                virtual enum RequestStatus
+                                request     (const std::string& path, const BytesRange & = BytesRange());
+                virtual ssize_t read        (void *p_buffer, size_t len);
+
+                virtual void    setUsed( bool );
+
+            protected:
+                void reset();
+                static int formatRequest(const struct vlc_http_resource *,
+                                         struct vlc_http_msg *, void *);
+                static int validateResponse(const struct vlc_http_resource *,
+                                            const struct vlc_http_msg *, void *);
+                static const struct vlc_http_resource_cbs callbacks;
+                std::string useragent;
+                std::string referer;
+                struct vlc_http_mgr *manager;
+                struct vlc_http_resource *resource;
+                block_t *p_pending;
+       };
+
        class AbstractConnectionFactory
        {
            public:
@@ -158,6 +196,18 @@ namespace adaptive
                virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &);
        };
 
+       class LibVLCHTTPConnectionFactory : public AbstractConnectionFactory
+       {
+           public:
+               LibVLCHTTPConnectionFactory( AuthStorage * );
+               virtual ~LibVLCHTTPConnectionFactory();
+               virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &);
+           private:
+               AuthStorage *authStorage;
+               /* one manager per origin */
+               std::map<std::string, struct vlc_http_mgr *> managers;
+       };
+
        class ConnectionFactory : public AbstractConnectionFactory
        {
            public:
@@ -167,6 +217,7 @@ namespace adaptive
            private:
                NativeConnectionFactory *native;
                StreamUrlConnectionFactory *streamurl;
+               LibVLCHTTPConnectionFactory *libvlchttp;
        };
     }
 }
@@ -72,8 +72,9 @@ HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_, AuthSt
 HTTPConnectionManager::~HTTPConnectionManager   ()
 {
     delete downloader;
-    delete factory;
+    /* connections can share state owned by the factory */
     this->closeAllConnections();
+    delete factory;
 }
 
 void HTTPConnectionManager::closeAllConnections      ()
@@ -614,8 +614,16 @@ static int vlclua_input_item_stats( lua_State *L )
         STATS_FLOAT( demux_bitrate )
         STATS_INT( demux_corrupted )
         STATS_INT( demux_discontinuity )
+        STATS_INT( demux_lost )
+        STATS_INT( demux_reordered )
+        STATS_INT( demux_late )
+        STATS_INT( demux_recovered )
         STATS_INT( decoded_audio )
         STATS_INT( decoded_video )
+        STATS_INT( decoder_fifo_bytes )
+        STATS_INT( decoder_fifo_blocked )
+        STATS_INT( decoder_fifo_waited )
+        STATS_INT( decoder_fifo_dropped )
         STATS_INT( displayed_pictures )
         STATS_INT( late_pictures )
         STATS_INT( lost_pictures )
@@ -29,6 +29,9 @@
  *  $ vlc movie.avi --sout="#transcode{aenc=dummy,venc=stats}:\
  *                          std{access=http,mux=dummy,dst=0.0.0.0:8081}"
  *  $ vlc -vv http://127.0.0.1:8081 --demux=stats --vout=stats --codec=stats
+ *
+ * Video frames pacing summary:
+ *  $ vlc -vv --extraintf=stats movie.mkv
  */
 
 #define kBufferSize 0x500
@@ -38,6 +41,11 @@
 #include <vlc_plugin.h>
 #include <vlc_codec.h>
 #include <vlc_demux.h>
+#include <vlc_interface.h>
+#include <vlc_player.h>
+#include <vlc_playlist.h>
+#include <vlc_vector.h>
+#include <vlc_vout.h>
 
 /*** Decoder ***/
 static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
@@ -209,6 +217,198 @@ static void CloseDemux ( vlc_object_t *p_this )
     free( p_demux->p_sys );
 }
 
+/*** Video frames telemetry interface ***/
+struct vout_stats
+{
+    vout_thread_t *vout;
+    uint64_t       cursor;
+    unsigned       count[VOUT_FRAME_FLUSHED + 1];
+    vlc_tick_t     latency;     /* decoded to displayed, summed */
+    vlc_tick_t     latency_max;
+    vlc_tick_t     render;      /* prepared to rendered, summed */
+};
+
+struct intf_sys_t
+{
+    vlc_playlist_t         *playlist;
+    vlc_player_listener_id *listener;
+    vlc_timer_t             timer;
+    vlc_mutex_t             lock;
+    struct VLC_VECTOR(struct vout_stats) vouts;
+};
+
+static void CollectFrames( struct vout_stats *st )
+{
+    vout_frame_telemetry_t frames[64];
+    size_t count;
+
+    do
+    {
+        count = vout_GetFrameTelemetry( st->vout, &st->cursor, frames,
+                                        ARRAY_SIZE(frames) );
+        for( size_t i = 0; i < count; i++ )
+        {
+            const vout_frame_telemetry_t *f = &frames[i];
+
+            st->count[f->status]++;
+            if( f->status != VOUT_FRAME_DISPLAYED )
+                continue;
+
+            vlc_tick_t latency = f->displayed - f->decoded;
+            st->latency += latency;
+            if( latency > st->latency_max )
+                st->latency_max = latency;
+            if( f->prepared != VLC_TICK_INVALID
+             && f->rendered != VLC_TICK_INVALID )
+                st->render += f->rendered - f->prepared;
+        }
+    }
+    while( count == ARRAY_SIZE(frames) );
+}
+
+static void ReportFrames( intf_thread_t *p_intf, struct vout_stats *st )
+{
+    CollectFrames( st );
+
+    unsigned displayed = st->count[VOUT_FRAME_DISPLAYED];
+    unsigned total = 0;
+    for( size_t i = 0; i < ARRAY_SIZE(st->count); i++ )
+        total += st->count[i];
+    if( total == 0 )
+        return;
+
+    msg_Info( p_intf, "video frames: %u displayed, %u late, %u dropped by "
+              "decoder, %u by filters, %u by pool starvation, %u flushed",
+              displayed, st->count[VOUT_FRAME_DROPPED_LATE],
+              st->count[VOUT_FRAME_DROPPED_DECODER],
+              st->count[VOUT_FRAME_DROPPED_FILTER],
+              st->count[VOUT_FRAME_DROPPED_POOL],
+              st->count[VOUT_FRAME_FLUSHED] );
+    if( displayed > 0 )
+        msg_Info( p_intf, "video frames: queue to display %"PRId64" ms "
+                  "average, %"PRId64" ms max, render %"PRId64" us average",
+                  MS_FROM_VLC_TICK(st->latency / displayed),
+                  MS_FROM_VLC_TICK(st->latency_max),
+                  US_FROM_VLC_TICK(st->render / displayed) );
+
+    memset( st->count, 0, sizeof( st->count ) );
+    st->latency = st->latency_max = st->render = 0;
+}
+
+static void ReportTimer( void *data )
+{
+    intf_thread_t *p_intf = data;
+    intf_sys_t *p_sys = p_intf->p_sys;
+
+    vlc_mutex_lock( &p_sys->lock );
+    for( size_t i = 0; i < p_sys->vouts.size; ++i )
+        ReportFrames( p_intf, &p_sys->vouts.data[i] );
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+static void player_on_vout_changed( vlc_player_t *player,
+                                    enum vlc_player_vout_action action,
+                                    vout_thread_t *vout,
+                                    enum vlc_vout_order order,
+                                    vlc_es_id_t *es_id, void *data )
+{
+    VLC_UNUSED(player); VLC_UNUSED(order); VLC_UNUSED(es_id);
+    intf_thread_t *p_intf = data;
+    intf_sys_t *p_sys = p_intf->p_sys;
+
+    vlc_mutex_lock( &p_sys->lock );
+    switch( action )
+    {
+        case VLC_PLAYER_VOUT_STARTED:
+        {
+            struct vout_stats st = { .vout = vout };
+            if( vlc_vector_push( &p_sys->vouts, st ) )
+                vout_Hold( vout );
+            break;
+        }
+        case VLC_PLAYER_VOUT_STOPPED:
+            for( size_t i = 0; i < p_sys->vouts.size; ++i )
+            {
+                struct vout_stats *st = &p_sys->vouts.data[i];
+                if( st->vout == vout )
+                {
+                    ReportFrames( p_intf, st );
+                    vout_Release( vout );
+                    vlc_vector_remove( &p_sys->vouts, i );
+                    break;
+                }
+            }
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+static int OpenIntf( vlc_object_t *p_this )
+{
+    intf_thread_t *p_intf = (intf_thread_t *)p_this;
+
+    intf_sys_t *p_sys = p_intf->p_sys = malloc( sizeof( *p_sys ) );
+    if( unlikely(p_sys == NULL) )
+        return VLC_ENOMEM;
+
+    p_sys->playlist = vlc_intf_GetMainPlaylist( p_intf );
+    vlc_mutex_init( &p_sys->lock );
+    vlc_vector_init( &p_sys->vouts );
+
+    if( vlc_timer_create( &p_sys->timer, ReportTimer, p_intf ) )
+    {
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
+
+    static const struct vlc_player_cbs cbs =
+    {
+        .on_vout_changed = player_on_vout_changed,
+    };
+    vlc_player_t *player = vlc_playlist_GetPlayer( p_sys->playlist );
+    vlc_player_Lock( player );
+    p_sys->listener = vlc_player_AddListener( player, &cbs, p_intf );
+    vlc_player_Unlock( player );
+    if( !p_sys->listener )
+    {
+        vlc_timer_destroy( p_sys->timer );
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
+
+    vlc_tick_t period =
+        vlc_tick_from_sec( var_InheritInteger( p_intf, "stats-frames-period" ) );
+    vlc_timer_schedule( p_sys->timer, false, period, period );
+    return VLC_SUCCESS;
+}
+
+static void CloseIntf( vlc_object_t *p_this )
+{
+    intf_thread_t *p_intf = (intf_thread_t *)p_this;
+    intf_sys_t *p_sys = p_intf->p_sys;
+
+    vlc_player_t *player = vlc_playlist_GetPlayer( p_sys->playlist );
+    vlc_player_Lock( player );
+    vlc_player_RemoveListener( player, p_sys->listener );
+    vlc_player_Unlock( player );
+
+    vlc_timer_destroy( p_sys->timer );
+
+    for( size_t i = 0; i < p_sys->vouts.size; ++i )
+    {
+        ReportFrames( p_intf, &p_sys->vouts.data[i] );
+        vout_Release( p_sys->vouts.data[i].vout );
+    }
+    vlc_vector_clear( &p_sys->vouts );
+    free( p_sys );
+}
+
+#define FRAMES_PERIOD_TEXT N_("Report period")
+#define FRAMES_PERIOD_LONGTEXT N_( \
+    "Interval in seconds between two video frames pacing reports." )
+
 vlc_module_begin ()
     set_shortname( N_("Stats"))
 #ifdef ENABLE_SOUT
@@ -241,4 +441,13 @@ vlc_module_begin ()
         set_capability( "demux", 0 )
         add_shortcut( "stats" )
         set_callbacks( OpenDemux, CloseDemux )
+    add_submodule ()
+        set_section( N_( "Stats interface" ), NULL )
+        set_description( N_("Video frames pacing statistics") )
+        set_capability( "interface", 0 )
+        add_shortcut( "stats" )
+        add_integer_with_range( "stats-frames-period", 10, 1, 3600,
+                                FRAMES_PERIOD_TEXT, FRAMES_PERIOD_LONGTEXT,
+                                true )
+        set_callbacks( OpenIntf, CloseIntf )
 vlc_module_end ()
@@ -616,7 +616,10 @@ static block_t * BlockDequeue(sout_input_t *p_input, mp4_stream_t *p_stream)
     switch(mp4mux_track_GetFmt(p_stream->tinfo)->i_codec)
     {
         case VLC_CODEC_AV1:
-            p_block = AV1_Pack_Sample(p_block);
+            /* packed in place */
+            p_block = block_Unshare(p_block);
+            if(likely(p_block))
+                p_block = AV1_Pack_Sample(p_block);
             break;
         case VLC_CODEC_H264:
         case VLC_CODEC_HEVC:
@@ -289,6 +289,14 @@ static inline int PESHeader( uint8_t *p_hdr, int64_t i_pts, int64_t i_dts,
     }
 }
 
+/* Byte of the ES data as prefixed with i_extra bytes of extradata */
+static inline uint8_t ESByte( const es_format_t *p_fmt, size_t i_extra,
+                              const block_t *p_es, size_t i )
+{
+    return ( i < i_extra ) ? ((const uint8_t *)p_fmt->p_extra)[i]
+                           : p_es->p_buffer[i - i_extra];
+}
+
 /** EStoPES, encapsulate an elementary stream block into PES packet(s)
  * each with a maximal payload size of @i_max_pes_size@.
  *
@@ -334,6 +342,14 @@ void EStoPES ( block_t **pp_pes,
 
     int     i_pes_count = 1;
 
+    static const uint8_t aud[6] = {
+        /* Make similar AUD as libavformat does */
+        0x00, 0x00, 0x00, 0x01,
+        0x09, 0xf0, /* FIXME: primary_pic_type from SPS/PPS */
+    };
+    size_t  i_extra = 0;
+    size_t  i_aud = 0;
+
     assert( i_max_pes_size >= 0 );
     assert( i_header_size >= 0 );
 
@@ -344,6 +360,8 @@ void EStoPES ( block_t **pp_pes,
         i_max_pes_size = PES_PAYLOAD_SIZE_MAX;
     }
 
+    p_es->i_flags &= ~BLOCK_FLAG_PES_CONTINUED;
+
     if( ( p_fmt->i_codec == VLC_CODEC_MP4V ||
           p_fmt->i_codec == VLC_CODEC_H264 ||
           p_fmt->i_codec == VLC_CODEC_HEVC) &&
@@ -351,36 +369,25 @@ void EStoPES ( block_t **pp_pes,
     {
         /* For MPEG4 video, add VOL before I-frames,
            for H264 add SPS/PPS before keyframes*/
-        p_es = block_Realloc( p_es, p_fmt->i_extra, p_es->i_buffer );
-
-        memcpy( p_es->p_buffer, p_fmt->p_extra, p_fmt->i_extra );
+        i_extra = p_fmt->i_extra;
     }
 
     if( p_fmt->i_codec == VLC_CODEC_H264 )
     {
+        size_t i_nal = i_extra + p_es->i_buffer;
         unsigned offset=2;
-        while(offset < p_es->i_buffer )
+        while(offset < i_nal )
         {
-            if( p_es->p_buffer[offset-2] == 0 &&
-                p_es->p_buffer[offset-1] == 0 &&
-                p_es->p_buffer[offset] == 1 )
+            if( ESByte( p_fmt, i_extra, p_es, offset-2 ) == 0 &&
+                ESByte( p_fmt, i_extra, p_es, offset-1 ) == 0 &&
+                ESByte( p_fmt, i_extra, p_es, offset ) == 1 )
                 break;
             offset++;
         }
         offset++;
-        if( offset+4 <= p_es->i_buffer &&
-            ((p_es->p_buffer[offset] & 0x1f) != 9) ) /* Not AUD */
-        {
-            /* Make similar AUD as libavformat does */
-            p_es = block_Realloc( p_es, 6, p_es->i_buffer );
-            p_es->p_buffer[0] = 0x00;
-            p_es->p_buffer[1] = 0x00;
-            p_es->p_buffer[2] = 0x00;
-            p_es->p_buffer[3] = 0x01;
-            p_es->p_buffer[4] = 0x09; /* FIXME: primary_pic_type from SPS/PPS */
-            p_es->p_buffer[5] = 0xf0;
-        }
-
+        if( offset+4 <= i_nal &&
+            ((ESByte( p_fmt, i_extra, p_es, offset ) & 0x1f) != 9) ) /* Not AUD */
+            i_aud = sizeof (aud);
     }
 
     int64_t i_dts = 0;
@@ -390,6 +397,48 @@ void EStoPES ( block_t **pp_pes,
     if (p_es->i_dts != VLC_TICK_INVALID)
         i_dts = TO_SCALE_NZ(p_es->i_dts - ts_offset);
 
+    i_size = i_aud + i_extra + p_es->i_buffer;
+    if( i_size <= i_max_pes_size && p_es->i_buffer > 0 )
+    {
+        /* A single PES packet: if there is no room to prepend its header
+         * (like in shared blocks), send that header in a block of its own
+         * rather than copying the payload. */
+        i_pes_header = PESHeader( header, i_pts, i_dts, i_size,
+                                  p_fmt, i_stream_id, b_mpeg2,
+                                  b_data_alignment, i_header_size );
+        size_t i_prefix = i_pes_header + i_aud + i_extra;
+
+        block_t *p_prefix = NULL;
+        if( (size_t)(p_es->p_buffer - p_es->p_start) < i_prefix )
+            p_prefix = block_Alloc( i_prefix );
+        if( p_prefix != NULL )
+        {
+            block_CopyProperties( p_prefix, p_es );
+            p_prefix->i_length = 0;
+            memcpy( p_prefix->p_buffer, header, i_pes_header );
+            memcpy( p_prefix->p_buffer + i_pes_header, aud, i_aud );
+            if( i_extra )
+                memcpy( p_prefix->p_buffer + i_pes_header + i_aud,
+                        p_fmt->p_extra, i_extra );
+
+            p_es->i_flags |= BLOCK_FLAG_PES_CONTINUED;
+            p_prefix->p_next = p_es;
+            *pp_pes = p_prefix;
+            return;
+        }
+    }
+
+    if( i_extra )
+    {
+        p_es = block_Realloc( p_es, i_extra, p_es->i_buffer );
+        memcpy( p_es->p_buffer, p_fmt->p_extra, i_extra );
+    }
+    if( i_aud )
+    {
+        p_es = block_Realloc( p_es, i_aud, p_es->i_buffer );
+        memcpy( p_es->p_buffer, aud, i_aud );
+    }
+
     i_size = p_es->i_buffer;
     p_data = p_es->p_buffer;
 
@@ -34,6 +34,10 @@
 
 #define PES_PAYLOAD_SIZE_MAX 65500
 
+/* Set by EStoPES on a block carrying the payload of the PES packet started
+ * in the previous block of the chain. */
+#define BLOCK_FLAG_PES_CONTINUED (2 << BLOCK_FLAG_PRIVATE_SHIFT)
+
 void EStoPES ( block_t **pp_pes,
                    const es_format_t *p_fmt, int i_stream_id,
                    int b_mpeg2, int b_data_alignment, int i_header_size,
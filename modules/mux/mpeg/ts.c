@@ -159,6 +159,12 @@ static const char *const ts_standards_list_text[] =
 #define BMAX_TEXT N_( "Maximum B (deprecated)")
 #define BMAX_LONGTEXT N_( "This setting is deprecated and not used anymore")
 
+#define MUXRATE_TEXT N_("Mux rate (bits/s)")
+#define MUXRATE_LONGTEXT N_("Produce a constant bitrate multiplex at the " \
+  "given rate, by inserting null packets and dating each packet (and PCR) " \
+  "from its position in the stream. The PCR interval is then at most " \
+  "40ms. 0 produces a variable bitrate multiplex.")
+
 #define DTS_TEXT N_("DTS delay (ms)")
 #define DTS_LONGTEXT N_("Delay the DTS (decoding time " \
   "stamps) and PTS (presentation timestamps) of the data in the " \
@@ -190,6 +196,7 @@ static const char *const ts_standards_list_text[] =
 #define SOUT_CFG_PREFIX "sout-ts-"
 #define MAX_PMT 64       /* Maximum number of programs. FIXME: I just chose an arbitrary number. Where is the maximum in the spec? */
 #define MAX_PMT_PID 64       /* Maximum pids in each pmt.  FIXME: I just chose an arbitrary number. Where is the maximum in the spec? */
+#define TS_CBR_PCR_MAX VLC_TICK_FROM_MS(40) /* ETSI TR 101 290 PCR interval */
 #if MAX_SDT_DESC < MAX_PMT
   #error "MAX_SDT_DESC < MAX_PMT"
 #endif
@@ -229,6 +236,8 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "bmin", 0, BMIN_TEXT, BMIN_LONGTEXT, true)
     add_integer( SOUT_CFG_PREFIX "bmax", 0, BMAX_TEXT, BMAX_LONGTEXT, true)
     add_integer( SOUT_CFG_PREFIX "dts-delay", 400, DTS_TEXT, DTS_LONGTEXT, true)
+    add_integer( SOUT_CFG_PREFIX "muxrate", 0, MUXRATE_TEXT, MUXRATE_LONGTEXT, true)
+        change_integer_range( 0, INT64_MAX )
 
     add_bool( SOUT_CFG_PREFIX "crypt-audio", true, ACRYPT_TEXT, ACRYPT_LONGTEXT, true)
     add_bool( SOUT_CFG_PREFIX "crypt-video", true, VCRYPT_TEXT, VCRYPT_LONGTEXT, true)
@@ -249,7 +258,7 @@ static const char *const ppsz_sout_options[] = {
     "netid", "sdtdesc",
     "es-id-pid", "shaping", "pcr", "bmin", "bmax", "use-key-frames",
     "dts-delay", "csa-ck", "csa2-ck", "csa-use", "csa-pkt", "crypt-audio", "crypt-video",
-    "muxpmt", "program-pmt", "alignment",
+    "muxpmt", "program-pmt", "alignment", "muxrate",
     NULL
 };
 
@@ -381,6 +390,18 @@ typedef struct
 
     vlc_tick_t      i_pcr;  /* last PCR emited */
 
+    /* constant bitrate: packets are dated from their position in the
+     * stream, kept in 27 MHz units plus a remainder in 1/i_mux_rate units */
+    uint64_t        i_mux_rate; /* bits/s, 0 for VBR */
+    vlc_tick_t      i_cbr_origin;
+    int64_t         i_cbr_origin_pcr;
+    uint64_t        i_cbr_pos;
+    uint64_t        i_cbr_frac;
+    vlc_tick_t      i_cbr_last_pcr;
+    int             i_cbr_pcr_pid; /* last packet seen on the PCR PID */
+    int             i_cbr_pcr_cc;
+    bool            b_cbr_discontinuity;
+
     csa_t           *csa;
     int             i_csa_pkt_size;
     bool            b_crypt_audio;
@@ -477,11 +498,20 @@ static void TSSchedule  ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
                           vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
 static void TSDate      ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
                           vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
+static void TSDateCBR   ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+                          vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
 static void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
 static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
 
 static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr );
-static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts );
+static void TSSetPCR( block_t *p_ts, int64_t i_pcr );
+
+/* The 27 MHz system clock is a multiple of CLOCK_FREQ: a plain product does
+ * not overflow, unlike samples_from_vlc_tick() past 95 hours */
+static inline int64_t TSTickTo27M( vlc_tick_t i_tick )
+{
+    return i_tick * ( 27000000 / CLOCK_FREQ );
+}
 
 static csa_t *csaSetup( vlc_object_t *p_this )
 {
@@ -735,8 +765,19 @@ static int Open( vlc_object_t *p_this )
     var_Get( p_mux, SOUT_CFG_PREFIX "dts-delay", &val );
     p_sys->i_dts_delay = VLC_TICK_FROM_MS(val.i_int);
 
-    msg_Dbg( p_mux, "shaping=%"PRId64" pcr=%"PRId64" dts_delay=%"PRId64,
-             p_sys->i_shaping_delay, p_sys->i_pcr_delay, p_sys->i_dts_delay );
+    p_sys->i_mux_rate = var_GetInteger( p_mux, SOUT_CFG_PREFIX "muxrate" );
+    p_sys->i_cbr_origin = VLC_TICK_INVALID;
+    if( p_sys->i_mux_rate > 0 && p_sys->i_pcr_delay > TS_CBR_PCR_MAX )
+    {
+        /* Constant bitrate receivers check the PCR repetition */
+        msg_Warn( p_mux, "pcr delay reduced to %"PRId64" ms for muxrate",
+                  MS_FROM_VLC_TICK(TS_CBR_PCR_MAX) );
+        p_sys->i_pcr_delay = TS_CBR_PCR_MAX;
+    }
+
+    msg_Dbg( p_mux, "shaping=%"PRId64" pcr=%"PRId64" dts_delay=%"PRId64
+             " muxrate=%"PRIu64, p_sys->i_shaping_delay, p_sys->i_pcr_delay,
+             p_sys->i_dts_delay, p_sys->i_mux_rate );
 
     p_sys->b_use_key_frames = var_GetBool( p_mux, SOUT_CFG_PREFIX "use-key-frames" );
 
@@ -1097,7 +1138,14 @@ static void SetBlockDuration( sout_input_t *p_input, block_t *p_data )
             }
             /* Try a previous duration */
             else if( p_stream->state.chain_pes.p_first )
-                p_data->i_length = p_stream->state.chain_pes.p_first->i_length;
+            {
+                const block_t *p_prev = p_stream->state.chain_pes.p_first;
+                /* skip the header block of a split PES (see EStoPES) */
+                if( p_prev->p_next &&
+                    (p_prev->p_next->i_flags & BLOCK_FLAG_PES_CONTINUED) )
+                    p_prev = p_prev->p_next;
+                p_data->i_length = p_prev->i_length;
+            }
             /* Or next */
             else if( p_next->i_length > 0 )
                 p_data->i_length = p_next->i_length;
@@ -1142,6 +1190,11 @@ static block_t *Encap_J2K( block_t *p_data, const es_format_t *p_fmt )
         return NULL;
     }
 
+    /* The header is written in place */
+    p_data = block_Unshare( p_data );
+    if( unlikely(!p_data) )
+        return NULL;
+
     if( i_offset < 38 )
     {
         block_t *p_realloc = block_Realloc( p_data, 38 - i_offset, p_data->i_buffer );
@@ -1570,7 +1623,10 @@ static bool MuxStreams(sout_mux_t *p_mux )
     }
 
     /* 4: date and send */
-    TSSchedule( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
+    if( p_sys->i_mux_rate )
+        TSDateCBR( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
+    else
+        TSSchedule( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
     return false;
 }
 
@@ -1795,7 +1851,7 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
         if( p_ts->i_flags & BLOCK_FLAG_CLOCK )
         {
             /* msg_Dbg( p_mux, "pcr=%lld ms", p_ts->i_dts / 1000 ); */
-            TSSetPCR( p_ts, p_ts->i_dts - p_sys->first_dts );
+            TSSetPCR( p_ts, TSTickTo27M( p_ts->i_dts - p_sys->first_dts ) );
         }
         if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
         {
@@ -1811,6 +1867,159 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
     }
 }
 
+/* Null packet (PID 0x1FFF) */
+static block_t *TSNewNull( void )
+{
+    block_t *p_ts = block_Alloc( 188 );
+    if( unlikely(p_ts == NULL) )
+        return NULL;
+
+    p_ts->p_buffer[0] = 0x47;
+    p_ts->p_buffer[1] = 0x1f;
+    p_ts->p_buffer[2] = 0xff;
+    p_ts->p_buffer[3] = 0x10;
+    memset( &p_ts->p_buffer[4], 0xff, 184 );
+    return p_ts;
+}
+
+/* Adaptation field only packet, carrying a PCR. The continuity counter is
+ * the one of the previous packet of the PID, as there is no payload. */
+static block_t *TSNewPCR( int i_pid, int i_continuity_counter )
+{
+    block_t *p_ts = block_Alloc( 188 );
+    if( unlikely(p_ts == NULL) )
+        return NULL;
+
+    p_ts->p_buffer[0] = 0x47;
+    p_ts->p_buffer[1] = ( i_pid >> 8 )&0x1f;
+    p_ts->p_buffer[2] = i_pid & 0xff;
+    p_ts->p_buffer[3] = 0x20 | i_continuity_counter;
+    p_ts->p_buffer[4] = 183;
+    p_ts->p_buffer[5] = 1 << 4; /* PCR_flag */
+    memset( &p_ts->p_buffer[12], 0xff, 176 );
+    p_ts->i_flags |= BLOCK_FLAG_CLOCK;
+    return p_ts;
+}
+
+/* Constant bitrate dating: the slice gets as many packet slots as the mux
+ * rate allows up to its end, the free ones are filled with null packets (or
+ * PCR packets when the PCR interval would be exceeded), and every packet is
+ * dated from its position in the stream. */
+static void TSDateCBR( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+                       vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts )
+{
+    sout_mux_sys_t  *p_sys = p_mux->p_sys;
+    sout_input_sys_t *p_pcr_stream = (sout_input_sys_t*)p_sys->p_pcr_input->p_sys;
+    const uint64_t i_rate = p_sys->i_mux_rate;
+    const uint64_t i_step = UINT64_C(188 * 8 * 27000000);
+    const vlc_tick_t i_end = i_pcr_dts + i_pcr_length;
+
+    if( p_sys->i_cbr_origin != VLC_TICK_INVALID )
+    {
+        vlc_tick_t i_date = p_sys->i_cbr_origin +
+                            vlc_tick_from_frac( p_sys->i_cbr_pos, 27000000 );
+
+        if( i_date + p_sys->i_dts_delay + p_sys->i_shaping_delay < i_pcr_dts )
+        {
+            msg_Warn( p_mux, "input gap of %"PRId64" us, restarting the "
+                      "constant bitrate timeline", i_pcr_dts - i_date );
+            p_sys->i_cbr_origin = VLC_TICK_INVALID;
+            p_sys->b_cbr_discontinuity = true;
+        }
+    }
+    if( p_sys->i_cbr_origin == VLC_TICK_INVALID )
+    {
+        p_sys->i_cbr_origin = i_pcr_dts;
+        p_sys->i_cbr_origin_pcr = TSTickTo27M( i_pcr_dts - p_sys->first_dts );
+        p_sys->i_cbr_pos = 0;
+        p_sys->i_cbr_frac = 0;
+        p_sys->i_cbr_last_pcr = VLC_TICK_INVALID;
+    }
+
+    /* Count the slots left before the end of the slice */
+    uint64_t i_slots = 0;
+    int64_t i_left = TSTickTo27M( i_end - p_sys->i_cbr_origin )
+                   - p_sys->i_cbr_pos;
+    if( i_left > 0 )
+        i_slots = ( i_left * i_rate - p_sys->i_cbr_frac + i_step - 1 ) / i_step;
+
+    const uint64_t i_packet_count = p_chain_ts->i_depth;
+    if( i_packet_count > i_slots )
+        msg_Warn( p_mux, "mux rate exceeded (%"PRIu64" packets for %"PRIu64
+                  " slots in %"PRId64" us)", i_packet_count, i_slots,
+                  i_pcr_length );
+
+    const vlc_tick_t i_packet_length = VLC_TICK_FROM_SEC(188 * 8) / i_rate;
+    uint64_t i_sent = 0;
+
+    for( uint64_t i = 0; i_sent < i_packet_count || i < i_slots; i++ )
+    {
+        vlc_tick_t i_date = p_sys->i_cbr_origin +
+                            vlc_tick_from_frac( p_sys->i_cbr_pos, 27000000 );
+        block_t *p_next = BufferChainPeek( p_chain_ts );
+        block_t *p_ts;
+
+        /* The PCR interval is kept even if it delays the data */
+        if( p_sys->i_cbr_pcr_pid == p_pcr_stream->ts.i_pid &&
+            ( p_next == NULL || !(p_next->i_flags & BLOCK_FLAG_CLOCK) ) &&
+            ( p_sys->i_cbr_last_pcr == VLC_TICK_INVALID ||
+              i_date >= p_sys->i_cbr_last_pcr + p_sys->i_pcr_delay ) )
+            p_ts = TSNewPCR( p_sys->i_cbr_pcr_pid, p_sys->i_cbr_pcr_cc );
+        /* Spread the packets evenly among the slots */
+        else if( p_next != NULL &&
+                 ( i >= i_slots || ( i + 1 ) * i_packet_count / i_slots > i_sent ) )
+        {
+            p_ts = BufferChainGet( p_chain_ts );
+            i_sent++;
+
+            int i_pid = ( ( p_ts->p_buffer[1] & 0x1f ) << 8 ) | p_ts->p_buffer[2];
+            if( i_pid == p_pcr_stream->ts.i_pid )
+            {
+                p_sys->i_cbr_pcr_pid = i_pid;
+                p_sys->i_cbr_pcr_cc = p_ts->p_buffer[3] & 0x0f;
+            }
+        }
+        else
+            p_ts = TSNewNull();
+
+        if( likely(p_ts != NULL) )
+        {
+            p_ts->i_dts    = i_date;
+            p_ts->i_length = i_packet_length;
+
+            if( p_ts->i_flags & BLOCK_FLAG_CLOCK )
+            {
+                TSSetPCR( p_ts, p_sys->i_cbr_origin_pcr + p_sys->i_cbr_pos );
+                if( p_sys->b_cbr_discontinuity )
+                {
+                    p_ts->p_buffer[5] |= 0x80; /* discontinuity_indicator */
+                    p_sys->b_cbr_discontinuity = false;
+                }
+                p_sys->i_cbr_last_pcr = i_date;
+            }
+            if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
+            {
+                vlc_mutex_lock( &p_sys->csa_lock );
+                csa_Encrypt( p_sys->csa, p_ts->p_buffer, p_sys->i_csa_pkt_size );
+                vlc_mutex_unlock( &p_sys->csa_lock );
+            }
+
+            /* latency */
+            p_ts->i_dts += p_sys->i_shaping_delay * 3 / 2;
+
+            sout_AccessOutWrite( p_mux->p_access, p_ts );
+        }
+
+        p_sys->i_cbr_pos += i_step / i_rate;
+        p_sys->i_cbr_frac += i_step % i_rate;
+        if( p_sys->i_cbr_frac >= i_rate )
+        {
+            p_sys->i_cbr_frac -= i_rate;
+            p_sys->i_cbr_pos++;
+        }
+    }
+}
+
 static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
                        bool b_pcr )
 {
@@ -1822,12 +2031,19 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
 
     int i_payload_max = 184 - ( b_pcr ? 8 : 0 );
 
-    if( p_stream->state.i_pes_used <= 0 )
+    if( p_stream->state.i_pes_used <= 0 &&
+        !(p_pes->i_flags & BLOCK_FLAG_PES_CONTINUED) )
     {
         b_new_pes = true;
     }
-    int i_payload = __MIN( (int)p_pes->i_buffer - p_stream->state.i_pes_used,
-                       i_payload_max );
+    /* The PES packet may go on in the next blocks (see EStoPES) */
+    int i_payload = (int)p_pes->i_buffer - p_stream->state.i_pes_used;
+    for( block_t *p_next = p_pes->p_next;
+         i_payload < i_payload_max && p_next != NULL &&
+         (p_next->i_flags & BLOCK_FLAG_PES_CONTINUED);
+         p_next = p_next->p_next )
+        i_payload += p_next->i_buffer;
+    i_payload = __MIN( i_payload, i_payload_max );
 
     if( b_pcr || i_payload < i_payload_max )
     {
@@ -1881,50 +2097,62 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
     }
 
     /* copy payload */
-    memcpy( &p_ts->p_buffer[188 - i_payload],
-            &p_pes->p_buffer[p_stream->state.i_pes_used], i_payload );
+    uint8_t *p_dst = &p_ts->p_buffer[188 - i_payload];
+    do
+    {
+        p_pes = p_stream->state.chain_pes.p_first;
 
-    p_stream->state.i_pes_used += i_payload;
-    p_stream->state.i_pes_dts = p_pes->i_dts + p_pes->i_length *
-        p_stream->state.i_pes_used / p_pes->i_buffer;
-    p_stream->state.i_pes_length -= p_pes->i_length * i_payload / p_pes->i_buffer;
+        int i_copy = __MIN( (int)p_pes->i_buffer - p_stream->state.i_pes_used,
+                            i_payload );
+        memcpy( p_dst, &p_pes->p_buffer[p_stream->state.i_pes_used], i_copy );
+        p_dst += i_copy;
+        i_payload -= i_copy;
 
-    if( p_stream->state.i_pes_used >= (int)p_pes->i_buffer )
-    {
-        block_Release(BufferChainGet( &p_stream->state.chain_pes ));
+        p_stream->state.i_pes_used += i_copy;
+        p_stream->state.i_pes_dts = p_pes->i_dts + p_pes->i_length *
+            p_stream->state.i_pes_used / p_pes->i_buffer;
+        p_stream->state.i_pes_length -= p_pes->i_length * i_copy / p_pes->i_buffer;
 
-        p_pes = p_stream->state.chain_pes.p_first;
-        p_stream->state.i_pes_length = 0;
-        if( p_pes )
+        if( p_stream->state.i_pes_used >= (int)p_pes->i_buffer )
         {
-            p_stream->state.i_pes_dts = p_pes->i_dts;
-            while( p_pes )
+            block_Release(BufferChainGet( &p_stream->state.chain_pes ));
+
+            p_pes = p_stream->state.chain_pes.p_first;
+            p_stream->state.i_pes_length = 0;
+            if( p_pes )
             {
-                p_stream->state.i_pes_length += p_pes->i_length;
-                p_pes = p_pes->p_next;
+                p_stream->state.i_pes_dts = p_pes->i_dts;
+                while( p_pes )
+                {
+                    p_stream->state.i_pes_length += p_pes->i_length;
+                    p_pes = p_pes->p_next;
+                }
             }
+            else
+            {
+                p_stream->state.i_pes_dts = 0;
+            }
+            p_stream->state.i_pes_used = 0;
         }
-        else
-        {
-            p_stream->state.i_pes_dts = 0;
-        }
-        p_stream->state.i_pes_used = 0;
     }
+    while( i_payload > 0 );
 
     return p_ts;
 }
 
-static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts )
+/* i_pcr is in 27 MHz units */
+static void TSSetPCR( block_t *p_ts, int64_t i_pcr )
 {
-    int64_t i_pcr = TO_SCALE_NZ(i_dts);
-
-    p_ts->p_buffer[6]  = ( i_pcr >> 25 )&0xff;
-    p_ts->p_buffer[7]  = ( i_pcr >> 17 )&0xff;
-    p_ts->p_buffer[8]  = ( i_pcr >> 9  )&0xff;
-    p_ts->p_buffer[9]  = ( i_pcr >> 1  )&0xff;
-    p_ts->p_buffer[10] = ( i_pcr << 7  )&0x80;
-    p_ts->p_buffer[10] |= 0x7e;
-    p_ts->p_buffer[11] = 0; /* we don't set PCR extension */
+    int64_t i_base = i_pcr / 300;
+    int i_ext = i_pcr % 300;
+
+    p_ts->p_buffer[6]  = ( i_base >> 25 )&0xff;
+    p_ts->p_buffer[7]  = ( i_base >> 17 )&0xff;
+    p_ts->p_buffer[8]  = ( i_base >> 9  )&0xff;
+    p_ts->p_buffer[9]  = ( i_base >> 1  )&0xff;
+    p_ts->p_buffer[10] = ( i_base << 7  )&0x80;
+    p_ts->p_buffer[10] |= 0x7e | ( i_ext >> 8 );
+    p_ts->p_buffer[11] = i_ext & 0xff;
 }
 
 void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
@@ -108,7 +108,13 @@ block_t *hxxx_AnnexB_to_xVC( block_t *p_block, uint8_t i_nal_length_size )
         block_t *p_newblock = block_Realloc( p_block, p_list[0].move, p_block->i_buffer );
         if( unlikely(!p_newblock) )
             goto error;
-        p_block = p_newblock;
+        /* The prefix is written in place if the data did not move */
+        p_block = block_Unshare( p_newblock );
+        if( unlikely(!p_block) )
+        {
+            free( p_list );
+            return NULL;
+        }
         hxxx_WritePrefix( i_nal_length_size, p_block->p_buffer , i_payload );
         free( p_list );
         return p_block;
@@ -135,6 +141,17 @@ block_t *hxxx_AnnexB_to_xVC( block_t *p_block, uint8_t i_nal_length_size )
     }
     else
     {
+        /* Converted in place: the data may be shared with other owners */
+        const uint8_t *p_old = p_block->p_buffer;
+        p_block = block_Unshare( p_block );
+        if( unlikely(!p_block) )
+        {
+            free( p_list );
+            return NULL;
+        }
+        for( unsigned i = 0; i < i_nalcount; i++ )
+            p_list[i].p = &p_block->p_buffer[p_list[i].p - p_old];
+
         p_source = p_dest = p_block->p_buffer;
         p_sourceend = &p_block->p_buffer[p_block->i_buffer];
     }
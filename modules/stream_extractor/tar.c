@@ -0,0 +1,451 @@
+/*****************************************************************************
+ * tar.c: tar archive stream directory and extractor
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Tar members are stored as is, so they are served straight from the byte
+ * range they occupy in the source, without copying nor decoding. Other
+ * archive formats are left to the libarchive module. */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_block.h>
+#include <vlc_stream.h>
+#include <vlc_stream_extractor.h>
+#include <vlc_input_item.h>
+
+static  int ExtractorOpen( vlc_object_t* );
+static void ExtractorClose( vlc_object_t* );
+
+static  int DirectoryOpen( vlc_object_t* );
+
+vlc_module_begin()
+    set_category( CAT_INPUT )
+    set_subcategory( SUBCAT_INPUT_STREAM_FILTER )
+    set_capability( "stream_directory", 100 )
+    set_description( N_( "tar stream directory" ) )
+    set_callback( DirectoryOpen )
+
+    add_submodule()
+        set_description( N_( "tar stream extractor" ) )
+        set_capability( "stream_extractor", 100 )
+        set_callbacks( ExtractorOpen, ExtractorClose )
+
+vlc_module_end()
+
+#define TAR_BLOCK_SIZE 512
+#define TAR_NAME_MAX   65536 /* longest GNU or pax name accepted */
+
+typedef struct
+{
+    uint64_t base;   /* offset of the member data within the source */
+    uint64_t size;   /* size of the member */
+    uint64_t offset; /* current offset within the member */
+} private_sys_t;
+
+struct tar_entry
+{
+    char* name;
+    uint64_t offset;
+    uint64_t size;
+    char type;
+};
+
+/* Parses a numeric header field: NUL or space terminated octal, or the GNU
+ * base-256 encoding for values that do not fit. */
+static uint64_t tar_number( const uint8_t* p, size_t len )
+{
+    uint64_t val = 0;
+
+    if( p[0] & 0x80 )
+    {
+        val = p[0] & 0x3F;
+        for( size_t i = 1; i < len; i++ )
+            val = ( val << 8 ) | p[i];
+        return val;
+    }
+
+    size_t i = 0;
+    while( i < len && p[i] == ' ' )
+        i++;
+    for( ; i < len && p[i] >= '0' && p[i] <= '7'; i++ )
+        val = ( val << 3 ) | ( p[i] - '0' );
+    return val;
+}
+
+static bool tar_check_header( const uint8_t* header )
+{
+    unsigned sum = 0;
+
+    /* the checksum field itself counts as spaces */
+    for( size_t i = 0; i < TAR_BLOCK_SIZE; i++ )
+        sum += ( i >= 148 && i < 156 ) ? ' ' : header[i];
+
+    return sum == tar_number( header + 148, 8 )
+        && memcmp( header + 257, "ustar", 5 ) == 0;
+}
+
+/* Extracts the path from pax extended header records ("<len> key=value\n") */
+static char* tar_pax_path( const char* buf, size_t size )
+{
+    const char* end = buf + size;
+
+    while( buf < end )
+    {
+        char* key;
+        unsigned long len = strtoul( buf, &key, 10 );
+
+        if( len == 0 || len > (size_t)( end - buf ) || *key != ' ' )
+            break;
+
+        const char* record_end = buf + len - 1; /* the trailing newline */
+
+        key++;
+        if( record_end - key > 5 && !strncmp( key, "path=", 5 ) )
+            return strndup( key + 5, record_end - ( key + 5 ) );
+
+        buf += len;
+    }
+    return NULL;
+}
+
+static int tar_skip( stream_t* s, uint64_t pos )
+{
+    uint64_t cur = vlc_stream_Tell( s );
+
+    if( cur == pos )
+        return VLC_SUCCESS;
+
+    bool b_seekable;
+    if( vlc_stream_Control( s, STREAM_CAN_SEEK, &b_seekable ) )
+        b_seekable = false;
+
+    if( b_seekable || pos < cur )
+        return vlc_stream_Seek( s, pos );
+
+    return vlc_stream_Read( s, NULL, pos - cur ) == (ssize_t)( pos - cur )
+         ? VLC_SUCCESS : VLC_EGENERIC;
+}
+
+/* Reads the entry whose header is at *pos, and moves *pos to the header of
+ * the following entry. Fails at the end of the archive. */
+static int tar_next( stream_t* s, uint64_t* pos, struct tar_entry* entry )
+{
+    char* name = NULL;
+
+    for( ;; )
+    {
+        uint8_t header[TAR_BLOCK_SIZE];
+
+        if( tar_skip( s, *pos )
+         || vlc_stream_Read( s, header, TAR_BLOCK_SIZE ) != TAR_BLOCK_SIZE
+         || !tar_check_header( header ) )
+            break; /* end of archive, or trailing garbage */
+
+        uint64_t size = tar_number( header + 124, 12 );
+        uint64_t data = *pos + TAR_BLOCK_SIZE;
+        char type = header[156];
+
+        if( size > UINT64_MAX - 2 * TAR_BLOCK_SIZE - data )
+            break;
+        *pos = data + ( ( size + TAR_BLOCK_SIZE - 1 )
+                      & ~(uint64_t)( TAR_BLOCK_SIZE - 1 ) );
+
+        if( type == 'L' || type == 'x' )
+        {   /* GNU long name or pax extended header of the next entry */
+            if( size > TAR_NAME_MAX )
+                break;
+
+            char* buf = malloc( size + 1 );
+            if( unlikely( buf == NULL ) )
+                break;
+
+            if( vlc_stream_Read( s, buf, size ) != (ssize_t)size )
+            {
+                free( buf );
+                break;
+            }
+            buf[size] = '\0';
+
+            if( type == 'x' )
+            {
+                char* path = tar_pax_path( buf, size );
+
+                free( buf );
+                if( path == NULL )
+                    continue;
+                buf = path;
+            }
+            free( name );
+            name = buf;
+            continue;
+        }
+
+        if( name == NULL )
+        {
+            /* POSIX ustar splits long names in a prefix and a name, whereas
+             * GNU tar stores other fields in place of the prefix. */
+            const char* prefix = (const char*)header + 345;
+
+            if( !memcmp( header + 257, "ustar\0", 6 ) && prefix[0] != '\0' )
+            {
+                if( asprintf( &name, "%.155s/%.100s", prefix,
+                              (const char*)header ) == -1 )
+                    name = NULL;
+            }
+            else
+                name = strndup( (const char*)header, 100 );
+
+            if( unlikely( name == NULL ) )
+                break;
+        }
+
+        entry->name = name;
+        entry->offset = data;
+        entry->size = size;
+        entry->type = type;
+        return VLC_SUCCESS;
+    }
+
+    free( name );
+    return VLC_EGENERIC;
+}
+
+static bool tar_is_file( const struct tar_entry* entry )
+{
+    /* regular, pre-POSIX regular and contiguous files */
+    return entry->type == '0' || entry->type == '\0' || entry->type == '7';
+}
+
+static int probe( stream_t* source )
+{
+    const uint8_t* peek;
+
+    if( vlc_stream_Peek( source, &peek, TAR_BLOCK_SIZE ) < TAR_BLOCK_SIZE )
+        return VLC_EGENERIC;
+
+    return tar_check_header( peek ) ? VLC_SUCCESS : VLC_EGENERIC;
+}
+
+static int ReadDir( stream_directory_t* p_directory, input_item_node_t* p_node )
+{
+    stream_t* source = p_directory->source;
+    struct vlc_readdir_helper rdh;
+    struct tar_entry entry;
+    uint64_t pos = 0;
+
+    vlc_readdir_helper_init( &rdh, p_directory, p_node );
+
+    while( tar_next( source, &pos, &entry ) == VLC_SUCCESS )
+    {
+        if( !tar_is_file( &entry ) )
+        {
+            free( entry.name );
+            continue;
+        }
+
+        char* mrl = vlc_stream_extractor_CreateMRL( p_directory, entry.name );
+        if( unlikely( mrl == NULL ) )
+        {
+            free( entry.name );
+            break;
+        }
+
+        if( vlc_readdir_helper_additem( &rdh, mrl, entry.name, NULL,
+                                        ITEM_TYPE_FILE, ITEM_LOCAL ) )
+        {
+            free( mrl );
+            free( entry.name );
+            break;
+        }
+
+        free( mrl );
+        free( entry.name );
+    }
+
+    vlc_readdir_helper_finish( &rdh, true );
+    return VLC_SUCCESS;
+}
+
+static block_t* Block( stream_extractor_t* p_extractor, bool* eof )
+{
+    private_sys_t* p_sys = p_extractor->p_sys;
+
+    if( p_sys->offset >= p_sys->size )
+    {
+        *eof = true;
+        return NULL;
+    }
+
+    /* Hand the blocks of the source out as they are, cut at the end of the
+     * member: there is no intermediate buffer. */
+    block_t* p_block = vlc_stream_ReadBlock( p_extractor->source );
+    if( p_block == NULL )
+    {
+        *eof = vlc_stream_Eof( p_extractor->source );
+        return NULL;
+    }
+
+    uint64_t left = p_sys->size - p_sys->offset;
+    if( p_block->i_buffer > left )
+        p_block->i_buffer = left;
+
+    p_sys->offset += p_block->i_buffer;
+    return p_block;
+}
+
+static int Seek( stream_extractor_t* p_extractor, uint64_t i_req )
+{
+    private_sys_t* p_sys = p_extractor->p_sys;
+
+    if( i_req < p_sys->size
+     && vlc_stream_Seek( p_extractor->source, p_sys->base + i_req ) )
+        return VLC_EGENERIC;
+
+    p_sys->offset = i_req;
+    return VLC_SUCCESS;
+}
+
+static int ReadRanges( stream_extractor_t* p_extractor,
+                       struct vlc_stream_range* ranges, size_t count )
+{
+    private_sys_t* p_sys = p_extractor->p_sys;
+    struct vlc_stream_range* sub = vlc_alloc( count, sizeof( *sub ) );
+
+    if( unlikely( sub == NULL ) )
+        return VLC_ENOMEM;
+
+    for( size_t i = 0; i < count; i++ )
+    {
+        uint64_t offset = __MIN( ranges[i].offset, p_sys->size );
+
+        sub[i].offset = p_sys->base + offset;
+        sub[i].buf = ranges[i].buf;
+        sub[i].length = __MIN( ranges[i].length, p_sys->size - offset );
+    }
+
+    int ret = vlc_stream_ReadRanges( p_extractor->source, sub, count );
+
+    for( size_t i = 0; i < count; i++ )
+        ranges[i].read = sub[i].read;
+
+    free( sub );
+    return ret;
+}
+
+static int Control( stream_extractor_t* p_extractor, int i_query, va_list args )
+{
+    private_sys_t* p_sys = p_extractor->p_sys;
+
+    switch( i_query )
+    {
+        case STREAM_GET_SIZE:
+            *va_arg( args, uint64_t* ) = p_sys->size;
+            break;
+
+        case STREAM_READ_RANGES:
+        {
+            struct vlc_stream_range* ranges =
+                va_arg( args, struct vlc_stream_range* );
+            size_t count = va_arg( args, size_t );
+
+            return ReadRanges( p_extractor, ranges, count );
+        }
+
+        default:
+            return vlc_stream_vaControl( p_extractor->source, i_query, args );
+    }
+
+    return VLC_SUCCESS;
+}
+
+static int DirectoryOpen( vlc_object_t* p_obj )
+{
+    stream_directory_t* p_directory = (void*)p_obj;
+
+    if( probe( p_directory->source ) )
+        return VLC_EGENERIC;
+
+    p_directory->pf_readdir = ReadDir;
+    return VLC_SUCCESS;
+}
+
+static int ExtractorOpen( vlc_object_t* p_obj )
+{
+    stream_extractor_t* p_extractor = (void*)p_obj;
+    stream_t* source = p_extractor->source;
+    struct tar_entry entry;
+    uint64_t pos = 0;
+
+    if( probe( source ) )
+        return VLC_EGENERIC;
+
+    for( ;; )
+    {
+        if( tar_next( source, &pos, &entry ) )
+        {
+            msg_Err( p_extractor, "unable to find member %s",
+                     p_extractor->identifier );
+            return VLC_EGENERIC;
+        }
+
+        bool found = tar_is_file( &entry )
+                  && !strcmp( entry.name, p_extractor->identifier );
+        free( entry.name );
+        if( found )
+            break;
+    }
+
+    private_sys_t* p_sys = malloc( sizeof( *p_sys ) );
+    if( unlikely( p_sys == NULL ) )
+        return VLC_ENOMEM;
+
+    p_sys->base = entry.offset;
+    p_sys->size = entry.size;
+    p_sys->offset = 0;
+
+    /* tar_next() read the header: the source is at the member data */
+    if( vlc_stream_Tell( source ) != p_sys->base
+     && vlc_stream_Seek( source, p_sys->base ) )
+    {
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
+
+    p_extractor->p_sys = p_sys;
+    p_extractor->pf_read = NULL;
+    p_extractor->pf_block = Block;
+    p_extractor->pf_seek = Seek;
+    p_extractor->pf_control = Control;
+
+    return VLC_SUCCESS;
+}
+
+static void ExtractorClose( vlc_object_t* p_obj )
+{
+    stream_extractor_t* p_extractor = (void*)p_obj;
+
+    free( p_extractor->p_sys );
+}
@@ -45,6 +45,9 @@ vlc_module_end()
 
 static int Control( stream_t *p_stream, int i_query, va_list args )
 {
+    /* Ranges read from the source would not be unscrambled */
+    if( i_query == STREAM_READ_RANGES )
+        return VLC_EGENERIC;
     return vlc_stream_vaControl( p_stream->s, i_query, args );
 }
 
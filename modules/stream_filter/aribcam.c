@@ -244,6 +244,9 @@ static int Seek( stream_t *p_stream, uint64_t i_pos )
  */
 static int Control( stream_t *p_stream, int i_query, va_list args )
 {
+    /* Ranges read from the source would not be descrambled */
+    if( i_query == STREAM_READ_RANGES )
+        return VLC_EGENERIC;
     return vlc_stream_vaControl( p_stream->s, i_query, args );
 }
 
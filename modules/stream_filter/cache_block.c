@@ -67,6 +67,7 @@
 typedef struct
 {
     block_bytestream_t cache; /* bytestream chain for storing cache */
+    uint64_t offset; /* stream offset of the cache read pointer */
 
     struct
     {
@@ -138,7 +139,7 @@ static void AStreamPrebufferBlock(stream_t *s)
             sys->stat.read_bytes = cache_size;
             sys->stat.read_time = now - start;
             byterate = (CLOCK_FREQ * sys->stat.read_bytes ) /
-                        (sys->stat.read_time -1);
+                        __MAX(sys->stat.read_time, 1);
 
             msg_Dbg(s, "prebuffering done %zu bytes "
                     "in %"PRIu64"s - %"PRIu64"u KiB/s", cache_size,
@@ -174,6 +175,7 @@ static void AStreamControlReset(stream_t *s)
     stream_sys_t *sys = s->p_sys;
 
     block_BytestreamEmpty( &sys->cache );
+    sys->offset = vlc_stream_Tell(s->s);
 
     /* Do the prebuffering */
     AStreamPrebufferBlock(s);
@@ -183,14 +185,19 @@ static int AStreamSeekBlock(stream_t *s, uint64_t i_pos)
 {
     stream_sys_t *sys = s->p_sys;
 
-    if( block_SkipBytes( &sys->cache, i_pos) == VLC_SUCCESS )
+    if( i_pos >= sys->offset &&
+        block_SkipBytes( &sys->cache, i_pos - sys->offset ) == VLC_SUCCESS )
+    {
+        sys->offset = i_pos;
         return VLC_SUCCESS;
+    }
 
     /* Not enought bytes, empty and seek */
     /* Do the access seek */
     if (vlc_stream_Seek(s->s, i_pos)) return VLC_EGENERIC;
 
     block_BytestreamEmpty( &sys->cache );
+    sys->offset = i_pos;
 
     /* Refill a block */
     if (AStreamRefillBlock(s))
@@ -222,6 +229,7 @@ static ssize_t AStreamReadBlock(stream_t *s, void *buf, size_t len)
     /* Copy data */
     if( block_GetBytes( &sys->cache, buf, i_copy ) )
         return -1;
+    sys->offset += i_copy;
 
 
     /* If we ended up on refill, try to read refilled cache */
@@ -251,6 +259,8 @@ static int AStreamControl(stream_t *s, int i_query, va_list args)
         case STREAM_GET_CONTENT_TYPE:
         case STREAM_GET_SIGNAL:
         case STREAM_GET_TAGS:
+        case STREAM_GET_READAHEAD_STATS:
+        case STREAM_READ_RANGES:
         case STREAM_SET_PAUSE_STATE:
         case STREAM_SET_PRIVATE_ID_STATE:
         case STREAM_SET_PRIVATE_ID_CA:
@@ -289,6 +299,7 @@ static int Open(vlc_object_t *obj)
 
     /* Init all fields of sys->block */
     block_BytestreamInit( &sys->cache );
+    sys->offset = vlc_stream_Tell(s->s);
 
     s->p_sys = sys;
     /* Do the prebuffering */
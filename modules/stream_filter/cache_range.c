@@ -0,0 +1,465 @@
+/*****************************************************************************
+ * cache_range.c: byte range cache for seekable network streams
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_stream.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include <vlc_list.h>
+#include <vlc_vector.h>
+
+/* The stream is cached in fixed-size chunks, indexed by their offset. A chunk
+ * is always filled from its start, so that sequential reads never seek the
+ * upstream stream. The least recently used chunks are spilled to a temporary
+ * file if enabled (only complete chunks), or discarded. */
+#define CHUNK_SIZE (256 << 10)
+
+struct chunk
+{
+    uint64_t index; /* offset / CHUNK_SIZE */
+    size_t length; /* valid bytes from the start of the chunk */
+    char *data; /* NULL if spilled */
+    size_t slot; /* spill file slot if spilled */
+    struct vlc_list node; /* in the memory or disk list, most recent last */
+};
+
+typedef struct
+{
+    struct VLC_VECTOR(struct chunk *) chunks; /* sorted by index */
+    struct vlc_list memory;
+    struct vlc_list disk;
+    size_t memory_count;
+    size_t memory_max;
+    size_t disk_count;
+    size_t disk_next; /* first spill file slot never used */
+    size_t disk_max;
+    int fd; /* spill file */
+
+    uint64_t offset; /* read offset */
+    uint64_t upstream; /* offset of the upstream stream */
+
+    struct
+    {
+        uint64_t hit_bytes;
+        uint64_t miss_bytes;
+        unsigned seeks;
+    } stat;
+} stream_sys_t;
+
+/**
+ * Looks up a chunk.
+ *
+ * \param pos index of the chunk in the vector, or where to insert it
+ */
+static struct chunk *ChunkFind(stream_sys_t *sys, uint64_t index, size_t *pos)
+{
+    size_t lo = 0, hi = sys->chunks.size;
+
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        struct chunk *chunk = sys->chunks.data[mid];
+
+        if (chunk->index == index)
+        {
+            *pos = mid;
+            return chunk;
+        }
+        if (chunk->index < index)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    *pos = lo;
+    return NULL;
+}
+
+static void ChunkDelete(stream_sys_t *sys, struct chunk *chunk)
+{
+    size_t pos;
+
+    if (ChunkFind(sys, chunk->index, &pos) == chunk)
+        vlc_vector_remove(&sys->chunks, pos);
+    vlc_list_remove(&chunk->node);
+    if (chunk->data != NULL)
+    {
+        free(chunk->data);
+        sys->memory_count--;
+    }
+    else
+        sys->disk_count--;
+    free(chunk);
+}
+
+static void ChunkSpill(stream_t *s, struct chunk *chunk)
+{
+    stream_sys_t *sys = s->p_sys;
+
+#ifdef HAVE_PREAD
+    if (sys->disk_max > 0 && chunk->length == CHUNK_SIZE)
+    {
+        struct chunk *old = vlc_list_first_entry_or_null(&sys->disk,
+                                                         struct chunk, node);
+        size_t slot;
+
+        if (sys->disk_next < sys->disk_max)
+            slot = sys->disk_next++;
+        else if (old != NULL)
+        {   /* Reuse the slot of the least recently used spilled chunk */
+            slot = old->slot;
+            ChunkDelete(sys, old);
+        }
+        else
+            goto drop;
+
+        if (pwrite(sys->fd, chunk->data, CHUNK_SIZE,
+                   (off_t)slot * CHUNK_SIZE) == CHUNK_SIZE)
+        {
+            free(chunk->data);
+            chunk->data = NULL;
+            chunk->slot = slot;
+            sys->memory_count--;
+            sys->disk_count++;
+            vlc_list_remove(&chunk->node);
+            vlc_list_append(&chunk->node, &sys->disk);
+            return;
+        }
+        msg_Warn(s, "cannot spill cached data: %s", vlc_strerror_c(errno));
+    }
+drop:
+#endif
+    ChunkDelete(sys, chunk);
+}
+
+static struct chunk *ChunkNew(stream_t *s, uint64_t index)
+{
+    stream_sys_t *sys = s->p_sys;
+    struct chunk *chunk = malloc(sizeof (*chunk));
+    if (unlikely(chunk == NULL))
+        return NULL;
+
+    chunk->data = malloc(CHUNK_SIZE);
+    if (unlikely(chunk->data == NULL))
+    {
+        free(chunk);
+        return NULL;
+    }
+
+    size_t pos;
+    struct chunk *dup = ChunkFind(sys, index, &pos);
+    assert(dup == NULL); (void) dup;
+
+    if (!vlc_vector_insert(&sys->chunks, pos, chunk))
+    {
+        free(chunk->data);
+        free(chunk);
+        return NULL;
+    }
+
+    chunk->index = index;
+    chunk->length = 0;
+    vlc_list_append(&chunk->node, &sys->memory);
+    sys->memory_count++;
+
+    /* Make room, but never evict the new chunk */
+    while (sys->memory_count > sys->memory_max)
+    {
+        struct chunk *old = vlc_list_first_entry_or_null(&sys->memory,
+                                                         struct chunk, node);
+        assert(old != NULL && old != chunk);
+        ChunkSpill(s, old);
+    }
+    return chunk;
+}
+
+static void Flush(stream_sys_t *sys)
+{
+    while (sys->chunks.size > 0)
+        ChunkDelete(sys, sys->chunks.data[sys->chunks.size - 1]);
+    assert(sys->memory_count == 0 && sys->disk_count == 0);
+    sys->disk_next = 0;
+}
+
+static ssize_t Read(stream_t *s, void *buf, size_t len)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    for (;;)
+    {
+        uint64_t index = sys->offset / CHUNK_SIZE;
+        size_t offset = sys->offset % CHUNK_SIZE;
+        size_t pos;
+        struct chunk *chunk = ChunkFind(sys, index, &pos);
+
+        if (chunk != NULL && chunk->length > offset)
+        {   /* Cache hit */
+            size_t copy = chunk->length - offset;
+            if (copy > len)
+                copy = len;
+
+            if (chunk->data != NULL)
+            {
+                memcpy(buf, chunk->data + offset, copy);
+                vlc_list_remove(&chunk->node);
+                vlc_list_append(&chunk->node, &sys->memory);
+            }
+#ifdef HAVE_PREAD
+            else
+            {
+                ssize_t val = pread(sys->fd, buf, copy,
+                                    (off_t)chunk->slot * CHUNK_SIZE + offset);
+                if (val <= 0)
+                {
+                    msg_Warn(s, "cannot read cached data: %s",
+                             vlc_strerror_c(errno));
+                    ChunkDelete(sys, chunk);
+                    continue;
+                }
+                copy = val;
+                vlc_list_remove(&chunk->node);
+                vlc_list_append(&chunk->node, &sys->disk);
+            }
+#endif
+            sys->offset += copy;
+            sys->stat.hit_bytes += copy;
+            return copy;
+        }
+
+        /* Cache miss: extend the chunk from upstream */
+        if (chunk == NULL)
+        {
+            chunk = ChunkNew(s, index);
+            if (unlikely(chunk == NULL))
+                return -1;
+        }
+        assert(chunk->data != NULL); /* only complete chunks are spilled */
+
+        uint64_t upstream = index * CHUNK_SIZE + chunk->length;
+        if (sys->upstream != upstream)
+        {
+            if (vlc_stream_Seek(s->s, upstream))
+            {
+                msg_Err(s, "cannot seek (to offset %"PRIu64")", upstream);
+                return -1;
+            }
+            sys->upstream = upstream;
+            sys->stat.seeks++;
+        }
+
+        ssize_t val = vlc_stream_ReadPartial(s->s, chunk->data + chunk->length,
+                                             CHUNK_SIZE - chunk->length);
+        if (val <= 0)
+        {
+            if (chunk->length == 0)
+                ChunkDelete(sys, chunk);
+            return val;
+        }
+
+        chunk->length += val;
+        sys->upstream += val;
+        sys->stat.miss_bytes += val;
+    }
+}
+
+static int Seek(stream_t *s, uint64_t offset)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    sys->offset = offset;
+    return VLC_SUCCESS;
+}
+
+static int Control(stream_t *s, int query, va_list args)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+        case STREAM_GET_SIZE:
+        case STREAM_GET_PTS_DELAY:
+        case STREAM_GET_TITLE_INFO:
+        case STREAM_GET_TITLE:
+        case STREAM_GET_SEEKPOINT:
+        case STREAM_GET_META:
+        case STREAM_GET_CONTENT_TYPE:
+        case STREAM_GET_SIGNAL:
+        case STREAM_GET_TAGS:
+        case STREAM_GET_READAHEAD_STATS:
+        case STREAM_READ_RANGES:
+        case STREAM_SET_PAUSE_STATE:
+        case STREAM_SET_PRIVATE_ID_STATE:
+        case STREAM_SET_PRIVATE_ID_CA:
+        case STREAM_GET_PRIVATE_ID_STATE:
+            return vlc_stream_vaControl(s->s, query, args);
+
+        case STREAM_SET_TITLE:
+        case STREAM_SET_SEEKPOINT:
+        {
+            int ret = vlc_stream_vaControl(s->s, query, args);
+            if (ret == VLC_SUCCESS)
+            {   /* The cached data belongs to another title */
+                Flush(sys);
+                sys->offset = 0;
+                sys->upstream = vlc_stream_Tell(s->s);
+            }
+            return ret;
+        }
+
+        case STREAM_SET_RECORD_STATE:
+        default:
+            msg_Err(s, "unimplemented query (%d) in control", query);
+            return VLC_EGENERIC;
+    }
+}
+
+#ifdef HAVE_PREAD
+/* Creates an anonymous file in the user cache directory */
+static int SpillOpen(vlc_object_t *obj)
+{
+    char *dir = config_GetUserDir(VLC_CACHE_DIR);
+    char *path;
+
+    if (unlikely(dir == NULL))
+        return -1;
+    vlc_mkdir(dir, 0700);
+
+    int ret = asprintf(&path, "%s"DIR_SEP"range-XXXXXX", dir);
+    free(dir);
+    if (unlikely(ret == -1))
+        return -1;
+
+    int fd = vlc_mkstemp(path);
+    if (fd != -1)
+        vlc_unlink(path);
+    else
+        msg_Warn(obj, "cannot create %s: %s", path, vlc_strerror_c(errno));
+    free(path);
+    return fd;
+}
+#endif
+
+static int Open(vlc_object_t *obj)
+{
+    stream_t *s = (stream_t *)obj;
+    bool can_seek, fast_seek;
+
+    /* Block streams are cached by cache_block already */
+    if (s->s->pf_block != NULL)
+        return VLC_EGENERIC;
+    /* Local files are cached by the operating system already */
+    if (vlc_stream_Control(s->s, STREAM_CAN_FASTSEEK, &fast_seek) || fast_seek)
+        return VLC_EGENERIC;
+    vlc_stream_Control(s->s, STREAM_CAN_SEEK, &can_seek);
+    if (!can_seek)
+        return VLC_EGENERIC;
+
+    size_t memory_max = (var_InheritInteger(obj, "cache-range-size") << 20)
+                        / CHUNK_SIZE;
+    if (memory_max == 0)
+        return VLC_EGENERIC;
+
+    stream_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    vlc_vector_init(&sys->chunks);
+    vlc_list_init(&sys->memory);
+    vlc_list_init(&sys->disk);
+    sys->memory_count = 0;
+    sys->memory_max = memory_max;
+    sys->disk_count = 0;
+    sys->disk_next = 0;
+    sys->disk_max = (var_InheritInteger(obj, "cache-range-disk-size") << 20)
+                    / CHUNK_SIZE;
+    sys->fd = -1;
+#ifdef HAVE_PREAD
+    if (sys->disk_max > 0)
+        sys->fd = SpillOpen(obj);
+#endif
+    if (sys->fd == -1)
+        sys->disk_max = 0;
+
+    sys->offset = vlc_stream_Tell(s->s);
+    sys->upstream = sys->offset;
+    sys->stat.hit_bytes = 0;
+    sys->stat.miss_bytes = 0;
+    sys->stat.seeks = 0;
+
+    s->p_sys = sys;
+    s->pf_read = Read;
+    s->pf_seek = Seek;
+    s->pf_control = Control;
+
+    msg_Dbg(s, "caching up to %zu bytes in memory and %zu bytes on disk",
+            sys->memory_max * CHUNK_SIZE, sys->disk_max * CHUNK_SIZE);
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    stream_t *s = (stream_t *)obj;
+    stream_sys_t *sys = s->p_sys;
+
+    msg_Dbg(s, "%"PRIu64" bytes read from cache, %"PRIu64" bytes fetched, "
+            "%u upstream seeks", sys->stat.hit_bytes, sys->stat.miss_bytes,
+            sys->stat.seeks);
+
+    Flush(sys);
+    vlc_vector_destroy(&sys->chunks);
+    if (sys->fd != -1)
+        vlc_close(sys->fd);
+    free(sys);
+}
+
+vlc_module_begin()
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_STREAM_FILTER)
+    set_capability("stream_filter", 0)
+
+    set_description(N_("Byte range stream cache"))
+    set_callbacks(Open, Close)
+
+    add_integer("cache-range-size", 32, N_("Memory cache size"),
+                N_("Size of the data kept in memory for backward seeks in "
+                   "network streams (MiB). 0 disables the cache."), true)
+        change_integer_range(0, 1 << 14)
+    add_integer("cache-range-disk-size", 0, N_("Disk cache size"),
+                N_("Size of the data spilled to a temporary file in the user "
+                   "cache directory when the memory cache is full (MiB)."),
+                true)
+        change_integer_range(0, 1 << 20)
+vlc_module_end()
@@ -35,6 +35,21 @@
 #include <vlc_fs.h>
 #include <vlc_interrupt.h>
 
+/* The buffer size follows the consumption rate of the stream: it covers
+ * PREFETCH_MIN_DURATION or four times the 90th percentile of the upstream
+ * read latency, whichever is longer, within the "prefetch-buffer-size" and
+ * "prefetch-memory-budget" limits. */
+#define PREFETCH_MIN_SIZE     (256 << 10)
+#define PREFETCH_INITIAL_SIZE (4 << 20)
+#define PREFETCH_MIN_DURATION VLC_TICK_FROM_SEC(2)
+#define PREFETCH_MAX_DURATION VLC_TICK_FROM_SEC(30)
+#define PREFETCH_ADAPT_PERIOD VLC_TICK_FROM_SEC(1)
+#define PREFETCH_LATENCY_SAMPLES 64
+
+/* Total size of the buffers of all the prefetch filters of the process */
+static vlc_mutex_t budget_lock = VLC_STATIC_MUTEX;
+static size_t budget_used;
+
 struct stream_ctrl
 {
     struct stream_ctrl *next;
@@ -72,12 +87,56 @@ typedef struct
     uint64_t     stream_offset;
     size_t       buffer_length;
     size_t       buffer_size;
+    size_t       readahead; /* maximum unread data in the buffer */
     char        *buffer;
     size_t       seek_threshold;
+    size_t       buffer_min;
+    size_t       buffer_max;
+    size_t       budget;
+
+    vlc_tick_t   rate_date; /* start of the current measurement period */
+    uint64_t     rate_bytes; /* bytes read during the current period */
+    uint64_t     rate; /* smoothed consumption rate (bytes/second) */
+    vlc_tick_t   latencies[PREFETCH_LATENCY_SAMPLES];
+    unsigned     latency_count;
+    vlc_tick_t   latency;
+    unsigned     resizes;
+    unsigned     underruns;
 
     struct stream_ctrl *controls;
 } stream_sys_t;
 
+/**
+ * Accounts for a buffer size change against the memory budget.
+ *
+ * \return the granted size, between min and wanted (min is always granted)
+ */
+static size_t BudgetGrant(size_t old, size_t wanted, size_t min,
+                          size_t budget)
+{
+    vlc_mutex_lock(&budget_lock);
+    assert(budget_used >= old);
+
+    size_t others = budget_used - old;
+    size_t size = (others < budget) ? budget - others : 0;
+
+    if (size > wanted)
+        size = wanted;
+    if (size < min)
+        size = min;
+    budget_used = others + size;
+    vlc_mutex_unlock(&budget_lock);
+    return size;
+}
+
+static void BudgetRelease(size_t size)
+{
+    vlc_mutex_lock(&budget_lock);
+    assert(budget_used >= size);
+    budget_used -= size;
+    vlc_mutex_unlock(&budget_lock);
+}
+
 static ssize_t ThreadRead(stream_t *stream, void *buf, size_t length)
 {
     stream_sys_t *sys = stream->p_sys;
@@ -123,6 +182,163 @@ static int ThreadControl(stream_t *stream, int query, ...)
     return ret;
 }
 
+static size_t BufferLevel(const stream_t *stream, bool *eof)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    *eof = false;
+
+    if (sys->stream_offset < sys->buffer_offset)
+        return 0;
+    if ((sys->stream_offset - sys->buffer_offset) >= sys->buffer_length)
+    {
+        *eof = sys->eof;
+        return 0;
+    }
+    return sys->buffer_offset + sys->buffer_length - sys->stream_offset;
+}
+
+/**
+ * Reallocates the circular buffer, keeping the most recent data.
+ */
+static int BufferResize(stream_t *stream, size_t size)
+{
+    stream_sys_t *sys = stream->p_sys;
+    char *buffer = malloc(size);
+    if (unlikely(buffer == NULL))
+        return -1;
+
+    uint64_t offset = sys->buffer_offset;
+    size_t length = sys->buffer_length;
+
+    if (length > size)
+    {   /* Discard the oldest historical data */
+        offset += length - size;
+        length = size;
+    }
+
+    for (size_t done = 0; done < length;)
+    {
+        size_t from = (offset + done) % sys->buffer_size;
+        size_t to = (offset + done) % size;
+        size_t len = length - done;
+
+        /* Do not step past the sharp edge of either circular buffer */
+        if (from + len > sys->buffer_size)
+            len = sys->buffer_size - from;
+        if (to + len > size)
+            len = size - to;
+
+        memcpy(buffer + to, sys->buffer + from, len);
+        done += len;
+    }
+
+    free(sys->buffer);
+    sys->buffer = buffer;
+    sys->buffer_size = size;
+    sys->buffer_offset = offset;
+    sys->buffer_length = length;
+    return 0;
+}
+
+static int CompareTicks(const void *a, const void *b)
+{
+    vlc_tick_t ta = *(const vlc_tick_t *)a, tb = *(const vlc_tick_t *)b;
+
+    return (ta > tb) - (ta < tb);
+}
+
+static void LatencyAdd(stream_t *stream, vlc_tick_t latency)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    sys->latencies[sys->latency_count++ % PREFETCH_LATENCY_SAMPLES] = latency;
+}
+
+/**
+ * Updates the consumption rate and resizes the buffer accordingly.
+ */
+static void Adapt(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+    vlc_tick_t now = vlc_tick_now();
+
+    if (sys->rate_date == VLC_TICK_INVALID)
+    {
+        sys->rate_date = now;
+        return;
+    }
+
+    vlc_tick_t elapsed = now - sys->rate_date;
+    if (elapsed < PREFETCH_ADAPT_PERIOD)
+        return;
+
+    uint64_t rate = sys->rate_bytes * CLOCK_FREQ / elapsed;
+
+    sys->rate = (sys->rate == 0) ? rate : (3 * sys->rate + rate) / 4;
+    sys->rate_date = now;
+    sys->rate_bytes = 0;
+
+    unsigned count = __MIN(sys->latency_count, PREFETCH_LATENCY_SAMPLES);
+    if (count > 0)
+    {
+        vlc_tick_t latencies[PREFETCH_LATENCY_SAMPLES];
+
+        memcpy(latencies, sys->latencies, count * sizeof (latencies[0]));
+        qsort(latencies, count, sizeof (latencies[0]), CompareTicks);
+        sys->latency = latencies[count * 9 / 10];
+    }
+
+    vlc_tick_t duration = 4 * sys->latency;
+    if (duration < PREFETCH_MIN_DURATION)
+        duration = PREFETCH_MIN_DURATION;
+    if (duration > PREFETCH_MAX_DURATION)
+        duration = PREFETCH_MAX_DURATION;
+
+    uint64_t target = sys->rate * duration / CLOCK_FREQ;
+
+    /* Grow as soon as the target exceeds the buffer, but only shrink if it
+     * is much smaller, so as not to reallocate all the time. */
+    if (target <= sys->buffer_size && target * 4 >= sys->buffer_size)
+    {
+        sys->readahead = sys->buffer_size;
+        return;
+    }
+
+    size_t wanted = (target < sys->buffer_max / 2) ? target * 2
+                                                   : sys->buffer_max;
+    if (wanted < sys->buffer_min)
+        wanted = sys->buffer_min;
+
+    /* Before shrinking, stop reading ahead and wait for the excess unread
+     * data to be consumed. */
+    sys->readahead = __MIN(wanted, sys->buffer_size);
+
+    bool eof;
+    size_t unread = BufferLevel(stream, &eof);
+    if (wanted < unread)
+        return;
+
+    size_t size = BudgetGrant(sys->buffer_size, wanted,
+                              __MAX(sys->buffer_min, unread), sys->budget);
+    if (size < sys->readahead)
+        sys->readahead = size;
+    if (size == sys->buffer_size)
+        return;
+
+    if (BufferResize(stream, size))
+    {
+        BudgetGrant(size, sys->buffer_size, sys->buffer_size, sys->budget);
+        return;
+    }
+
+    msg_Dbg(stream, "using %zu bytes buffer (%"PRIu64" bytes/s, "
+            "latency %"PRId64" us)", size, sys->rate,
+            US_FROM_VLC_TICK(sys->latency));
+    sys->readahead = size;
+    sys->resizes++;
+}
+
 static void *Thread(void *data)
 {
     stream_t *stream = data;
@@ -150,6 +366,9 @@ static void *Thread(void *data)
             msg_Dbg(stream, paused ? "resuming" : "pausing");
             paused = sys->paused;
             ThreadControl(stream, STREAM_SET_PAUSE_STATE, paused);
+            /* Do not account for the pause in the consumption rate */
+            sys->rate_date = vlc_tick_now();
+            sys->rate_bytes = 0;
             continue;
         }
 
@@ -159,6 +378,8 @@ static void *Thread(void *data)
             continue;
         }
 
+        Adapt(stream);
+
         uint_fast64_t stream_offset = sys->stream_offset;
 
         if (stream_offset < sys->buffer_offset)
@@ -220,6 +441,15 @@ static void *Thread(void *data)
 
         assert(sys->buffer_size >= sys->buffer_length);
 
+        /* Do not read further ahead than the consumption rate requires */
+        size_t unread = (history < sys->buffer_length)
+                        ? sys->buffer_length - history : 0;
+        if (unread >= sys->readahead)
+        {
+            vlc_cond_wait(&sys->wait_space, &sys->lock);
+            continue;
+        }
+
         size_t len = sys->buffer_size - sys->buffer_length;
         if (len == 0)
         {   /* Buffer is full */
@@ -236,15 +466,20 @@ static void *Thread(void *data)
             sys->buffer_length -= len;
         }
 
+        if (len > sys->readahead - unread)
+            len = sys->readahead - unread;
+
         size_t offset = (sys->buffer_offset + sys->buffer_length)
                         % sys->buffer_size;
          /* Do not step past the sharp edge of the circular buffer */
         if (offset + len > sys->buffer_size)
             len = sys->buffer_size - offset;
 
+        vlc_tick_t start = vlc_tick_now();
         ssize_t val = ThreadRead(stream, sys->buffer + offset, len);
         if (val < 0)
             continue;
+        LatencyAdd(stream, vlc_tick_now() - start);
         if (val == 0)
         {
             assert(len > 0);
@@ -278,22 +513,6 @@ static int Seek(stream_t *stream, uint64_t offset)
     return 0;
 }
 
-static size_t BufferLevel(const stream_t *stream, bool *eof)
-{
-    stream_sys_t *sys = stream->p_sys;
-
-    *eof = false;
-
-    if (sys->stream_offset < sys->buffer_offset)
-        return 0;
-    if ((sys->stream_offset - sys->buffer_offset) >= sys->buffer_length)
-    {
-        *eof = sys->eof;
-        return 0;
-    }
-    return sys->buffer_offset + sys->buffer_length - sys->stream_offset;
-}
-
 static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 {
     stream_sys_t *sys = stream->p_sys;
@@ -311,6 +530,8 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
         vlc_cond_signal(&sys->wait_space);
     }
 
+    bool underrun = false;
+
     while ((copy = BufferLevel(stream, &eof)) == 0 && !eof)
     {
         void *data[2];
@@ -321,6 +542,12 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
             return 0;
         }
 
+        if (!underrun)
+        {
+            underrun = true;
+            sys->underruns++;
+        }
+
         vlc_interrupt_forward_start(sys->interrupt, data);
         vlc_cond_wait(&sys->wait_data, &sys->lock);
         vlc_interrupt_forward_stop(data);
@@ -335,6 +562,7 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 
     memcpy(buf, sys->buffer + offset, copy);
     sys->stream_offset += copy;
+    sys->rate_bytes += copy;
     vlc_cond_signal(&sys->wait_space);
     vlc_mutex_unlock(&sys->lock);
     return copy;
@@ -379,6 +607,22 @@ static int Control(stream_t *stream, int query, va_list args)
         case STREAM_GET_SIGNAL:
         case STREAM_GET_TAGS:
             return VLC_EGENERIC;
+        case STREAM_GET_READAHEAD_STATS:
+        {
+            struct vlc_stream_readahead_stats *stats =
+                va_arg(args, struct vlc_stream_readahead_stats *);
+            bool eof;
+
+            vlc_mutex_lock(&sys->lock);
+            stats->buffer_size = sys->buffer_size;
+            stats->buffer_level = BufferLevel(stream, &eof);
+            stats->rate = sys->rate;
+            stats->latency = sys->latency;
+            stats->resizes = sys->resizes;
+            stats->underruns = sys->underruns;
+            vlc_mutex_unlock(&sys->lock);
+            break;
+        }
         case STREAM_SET_PAUSE_STATE:
         {
             bool paused = va_arg(args, unsigned);
@@ -412,6 +656,9 @@ static int Control(stream_t *stream, int query, va_list args)
         case STREAM_SET_PRIVATE_ID_CA:
         case STREAM_GET_PRIVATE_ID_STATE:
             return VLC_EGENERIC;
+        case STREAM_READ_RANGES:
+            /* Positional reads do not interfere with the thread */
+            return vlc_stream_vaControl(stream->s, query, args);
         default:
             msg_Err(stream, "unimplemented query (%d) in control", query);
             return VLC_EGENERIC;
@@ -462,24 +709,43 @@ static int Open(vlc_object_t *obj)
     sys->buffer_offset = 0;
     sys->stream_offset = 0;
     sys->buffer_length = 0;
-    sys->buffer_size = var_InheritInteger(obj, "prefetch-buffer-size") << 10u;
+    sys->buffer_max = var_InheritInteger(obj, "prefetch-buffer-size") << 10u;
     sys->seek_threshold = var_InheritInteger(obj, "prefetch-seek-threshold");
+    sys->budget = var_InheritInteger(obj, "prefetch-memory-budget") << 20u;
+    sys->rate_date = VLC_TICK_INVALID;
+    sys->rate_bytes = 0;
+    sys->rate = 0;
+    sys->latency_count = 0;
+    sys->latency = 0;
+    sys->resizes = 0;
+    sys->underruns = 0;
     sys->controls = NULL;
 
     uint64_t size = stream_Size(stream->s);
     if (size > 0)
     {   /* No point allocating a buffer larger than the source stream */
-        if (sys->buffer_size > size)
-            sys->buffer_size = size;
+        if (sys->buffer_max > size)
+            sys->buffer_max = size;
     }
 
+    sys->buffer_min = __MIN(PREFETCH_MIN_SIZE, sys->buffer_max);
+    sys->buffer_size = BudgetGrant(0, __MIN(PREFETCH_INITIAL_SIZE,
+                                            sys->buffer_max),
+                                   sys->buffer_min, sys->budget);
+    sys->readahead = sys->buffer_size;
     sys->buffer = malloc(sys->buffer_size);
     if (sys->buffer == NULL)
+    {
+        BudgetRelease(sys->buffer_size);
         goto error;
+    }
 
     sys->interrupt = vlc_interrupt_create();
     if (unlikely(sys->interrupt == NULL))
+    {
+        BudgetRelease(sys->buffer_size);
         goto error;
+    }
 
     vlc_mutex_init(&sys->lock);
     vlc_cond_init(&sys->wait_data);
@@ -490,6 +756,7 @@ static int Open(vlc_object_t *obj)
     if (vlc_clone(&sys->thread, Thread, stream, VLC_THREAD_PRIORITY_LOW))
     {
         vlc_interrupt_destroy(sys->interrupt);
+        BudgetRelease(sys->buffer_size);
         goto error;
     }
 
@@ -529,6 +796,7 @@ static void Close (vlc_object_t *obj)
         sys->controls = ctrl->next;
         free(ctrl);
     }
+    BudgetRelease(sys->buffer_size);
     free(sys->buffer);
     free(sys->content_type);
     free(sys);
@@ -543,8 +811,14 @@ vlc_module_begin()
     set_callbacks(Open, Close)
 
     add_integer("prefetch-buffer-size", 1 << 14, N_("Buffer size"),
-                N_("Prefetch buffer size (KiB)"), false)
+                N_("Maximum prefetch buffer size (KiB). The buffer grows up "
+                   "to this size depending on the stream bitrate and "
+                   "latency."), false)
         change_integer_range(4, 1 << 20)
+    add_integer("prefetch-memory-budget", 256, N_("Memory budget"),
+                N_("Total size of the prefetch buffers of all the open "
+                   "streams (MiB)"), true)
+        change_integer_range(1, 1 << 20)
     add_obsolete_integer("prefetch-read-size") /* since 4.0.0 */
     add_integer("prefetch-seek-threshold", 1 << 14, N_("Seek threshold"),
                 N_("Prefetch forward seek threshold (bytes)"), true)
@@ -0,0 +1,190 @@
+/*****************************************************************************
+ * xz.c: XZ decompression stream filter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <lzma.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_stream.h>
+
+typedef struct
+{
+    lzma_stream lzma;
+    bool eof;
+    uint8_t buffer[65536];
+} stream_sys_t;
+
+static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    if (sys->eof || unlikely(buflen == 0))
+        return 0;
+
+    sys->lzma.next_out = buf;
+    sys->lzma.avail_out = buflen;
+
+    for (;;)
+    {
+        lzma_action action = LZMA_RUN;
+
+        if (sys->lzma.avail_in == 0)
+        {
+            ssize_t val = vlc_stream_Read(stream->s, sys->buffer,
+                                          sizeof (sys->buffer));
+            if (val < 0)
+                return -1;
+            if (val == 0)
+                action = LZMA_FINISH;
+
+            sys->lzma.next_in = sys->buffer;
+            sys->lzma.avail_in = val;
+        }
+
+        lzma_ret ret = lzma_code(&sys->lzma, action);
+        size_t len = buflen - sys->lzma.avail_out;
+
+        switch (ret)
+        {
+            case LZMA_STREAM_END:
+                msg_Dbg(stream, "end of stream");
+                sys->eof = true;
+                return len;
+            case LZMA_OK:
+                if (len > 0)
+                    return len;
+                continue;
+            case LZMA_BUF_ERROR:
+                msg_Err(stream, "unexpected end of stream");
+                sys->eof = true;
+                return len;
+            case LZMA_MEM_ERROR:
+            case LZMA_MEMLIMIT_ERROR:
+                msg_Err(stream, "out of memory");
+                break;
+            case LZMA_FORMAT_ERROR:
+            case LZMA_DATA_ERROR:
+            case LZMA_OPTIONS_ERROR:
+                msg_Err(stream, "corrupt stream");
+                break;
+            default:
+                msg_Err(stream, "unhandled decompression error (%d)", ret);
+                break;
+        }
+
+        sys->eof = true;
+        return (len > 0) ? (ssize_t)len : -1;
+    }
+}
+
+static int Seek(stream_t *stream, uint64_t offset)
+{
+    (void) stream; (void) offset;
+    return -1;
+}
+
+static int Control(stream_t *stream, int query, va_list args)
+{
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+            *va_arg(args, bool *) = false;
+            break;
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+        case STREAM_GET_PTS_DELAY:
+        case STREAM_GET_META:
+        case STREAM_GET_CONTENT_TYPE:
+        case STREAM_GET_SIGNAL:
+        case STREAM_SET_PAUSE_STATE:
+            return vlc_stream_vaControl(stream->s, query, args);
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    stream_t *stream = (stream_t *)obj;
+    const uint8_t *peek;
+
+    if (vlc_stream_Peek(stream->s, &peek, 6) < 6
+     || memcmp(peek, "\xFD" "7zXZ\x00", 6))
+        return VLC_EGENERIC;
+
+    stream_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->lzma = (lzma_stream)LZMA_STREAM_INIT;
+    sys->eof = false;
+
+#if LZMA_VERSION >= UINT32_C(50040002)
+    /* Blocks are decoded in parallel when the encoder recorded their sizes
+     * (multi-threaded encoding does); otherwise this is single-threaded. */
+    lzma_mt mt = {
+        .flags = LZMA_CONCATENATED,
+        .threads = vlc_GetCPUCount(),
+        .memlimit_threading = lzma_physmem() / 4,
+        .memlimit_stop = UINT64_MAX,
+    };
+    lzma_ret ret = lzma_stream_decoder_mt(&sys->lzma, &mt);
+#else
+    lzma_ret ret = lzma_stream_decoder(&sys->lzma, UINT64_MAX,
+                                       LZMA_CONCATENATED);
+#endif
+    if (ret != LZMA_OK)
+    {
+        free(sys);
+        return (ret == LZMA_MEM_ERROR) ? VLC_ENOMEM : VLC_EGENERIC;
+    }
+
+    stream->p_sys = sys;
+    stream->pf_read = Read;
+    stream->pf_seek = Seek;
+    stream->pf_control = Control;
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    stream_t *stream = (stream_t *)obj;
+    stream_sys_t *sys = stream->p_sys;
+
+    lzma_end(&sys->lzma);
+    free(sys);
+}
+
+vlc_module_begin()
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_STREAM_FILTER)
+    set_capability("stream_filter", 330)
+
+    set_description(N_("XZ decompression filter"))
+    set_callbacks(Open, Close)
+vlc_module_end()
@@ -0,0 +1,166 @@
+/*****************************************************************************
+ * zstd.c: Zstandard decompression stream filter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <zstd.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_stream.h>
+
+typedef struct
+{
+    ZSTD_DStream *zstream;
+    ZSTD_inBuffer in;
+    bool eof;
+    bool frame_end; /* whether the input stopped at a frame boundary */
+    uint8_t buffer[];
+} stream_sys_t;
+
+static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
+{
+    stream_sys_t *sys = stream->p_sys;
+    ZSTD_outBuffer out = { .dst = buf, .size = buflen, .pos = 0 };
+
+    if (sys->eof || unlikely(buflen == 0))
+        return 0;
+
+    for (;;)
+    {
+        if (sys->in.pos == sys->in.size)
+        {
+            ssize_t val = vlc_stream_Read(stream->s, sys->buffer,
+                                          ZSTD_DStreamInSize());
+            if (val < 0)
+                return -1;
+            if (val == 0)
+            {
+                /* Frames may be concatenated: the end of the input is only
+                 * fine at the end of one of them. */
+                if (!sys->frame_end)
+                    msg_Err(stream, "unexpected end of stream");
+                else
+                    msg_Dbg(stream, "end of stream");
+                sys->eof = true;
+                return out.pos;
+            }
+
+            sys->in.pos = 0;
+            sys->in.size = val;
+        }
+
+        size_t ret = ZSTD_decompressStream(sys->zstream, &out, &sys->in);
+        if (ZSTD_isError(ret))
+        {
+            msg_Err(stream, "corrupt stream (%s)", ZSTD_getErrorName(ret));
+            sys->eof = true;
+            return (out.pos > 0) ? (ssize_t)out.pos : -1;
+        }
+
+        sys->frame_end = ret == 0;
+        if (out.pos > 0)
+            return out.pos;
+    }
+}
+
+static int Seek(stream_t *stream, uint64_t offset)
+{
+    (void) stream; (void) offset;
+    return -1;
+}
+
+static int Control(stream_t *stream, int query, va_list args)
+{
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+            *va_arg(args, bool *) = false;
+            break;
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+        case STREAM_GET_PTS_DELAY:
+        case STREAM_GET_META:
+        case STREAM_GET_CONTENT_TYPE:
+        case STREAM_GET_SIGNAL:
+        case STREAM_SET_PAUSE_STATE:
+            return vlc_stream_vaControl(stream->s, query, args);
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    stream_t *stream = (stream_t *)obj;
+    const uint8_t *peek;
+
+    if (vlc_stream_Peek(stream->s, &peek, 4) < 4
+     || GetDWLE(peek) != ZSTD_MAGICNUMBER)
+        return VLC_EGENERIC;
+
+    stream_sys_t *sys = malloc(sizeof (*sys) + ZSTD_DStreamInSize());
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->zstream = ZSTD_createDStream();
+    if (unlikely(sys->zstream == NULL))
+    {
+        free(sys);
+        return VLC_ENOMEM;
+    }
+
+    ZSTD_initDStream(sys->zstream);
+    sys->in.src = sys->buffer;
+    sys->in.size = 0;
+    sys->in.pos = 0;
+    sys->eof = false;
+    sys->frame_end = false;
+
+    stream->p_sys = sys;
+    stream->pf_read = Read;
+    stream->pf_seek = Seek;
+    stream->pf_control = Control;
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    stream_t *stream = (stream_t *)obj;
+    stream_sys_t *sys = stream->p_sys;
+
+    ZSTD_freeDStream(sys->zstream);
+    free(sys);
+}
+
+vlc_module_begin()
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_STREAM_FILTER)
+    set_capability("stream_filter", 330)
+
+    set_description(N_("Zstandard decompression filter"))
+    set_callbacks(Open, Close)
+vlc_module_end()
@@ -186,7 +186,10 @@ static int Send( sout_stream_t *p_stream, void *id, block_t *p_buffer )
             else
                 p_buffer->i_pts += p_sys->i_delay;
 
-            vlc_input_decoder_Decode( id, p_buffer, false );
+            /* decoders may write to their input */
+            p_buffer = block_Unshare( p_buffer );
+            if( p_buffer != NULL )
+                vlc_input_decoder_Decode( id, p_buffer, false );
         }
 
         p_buffer = p_next;
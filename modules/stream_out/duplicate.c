@@ -298,6 +298,9 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
         block_t *p_next = p_buffer->p_next;
 
         p_buffer->p_next = NULL;
+        /* All branches read the same payload, only the headers are copied */
+        if( p_sys->i_nb_streams > 1 )
+            p_buffer = block_Share( p_buffer );
 
         for( i_stream = 0; i_stream < p_sys->i_nb_streams - 1; i_stream++ )
         {
@@ -305,7 +308,7 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
 
             if( id->pp_ids[i_stream] )
             {
-                block_t *p_dup = block_Duplicate( p_buffer );
+                block_t *p_dup = block_Clone( p_buffer );
 
                 if( p_dup )
                     sout_StreamIdSend( p_dup_stream, id->pp_ids[i_stream], p_dup );
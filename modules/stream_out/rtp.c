@@ -313,6 +313,31 @@ typedef struct rtp_sink_t
     rtcp_sender_t *rtcp;
 } rtp_sink_t;
 
+/* Recycled RTP packets, shared by the packetizer and the sender thread */
+typedef struct rtp_pool_t
+{
+    vlc_mutex_t lock;
+    block_t    *free;
+    unsigned    freec;
+    unsigned    refs; /* owner ES and packets in use */
+    size_t      size;
+} rtp_pool_t;
+
+typedef struct
+{
+    block_t     self;
+    rtp_pool_t *pool;
+} rtp_packet_t;
+
+/* Maximum count of packets kept for reuse per ES */
+#define RTP_POOL_MAX 256
+
+/* Maximum count of due packets sent to each sink at once */
+#define RTP_BATCH_MAX 32
+
+static rtp_pool_t *rtp_pool_New( size_t );
+static void rtp_pool_Release( rtp_pool_t * );
+
 struct sout_stream_id_sys_t
 {
     sout_stream_t *p_stream;
@@ -333,6 +358,7 @@ struct sout_stream_id_sys_t
 
     /* Packetizer specific fields */
     int                 i_mtu;
+    rtp_pool_t         *pool;
 #ifdef HAVE_SRTP
     srtp_session_t     *srtp;
 #endif
@@ -917,6 +943,7 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
     id->sinkc = 0;
     id->sinkv = NULL;
     id->rtsp_id = NULL;
+    id->pool = NULL;
     vlc_queue_Init(&id->queue, offsetof (block_t, p_next));
     id->dead = true;
     id->listen.fd = NULL;
@@ -942,6 +969,12 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
             goto error;
     }
 
+    /* Packets are allocated once the MTU is final (see rtp_set_ptime()),
+     * with room for the SRTP authentication tag. */
+    id->pool = rtp_pool_New( id->i_mtu + 10 );
+    if( unlikely(id->pool == NULL) )
+        goto error;
+
 #ifdef HAVE_SRTP
     char *key = var_GetNonEmptyString (p_stream, SOUT_CFG_PREFIX"key");
     if (key)
@@ -1167,6 +1200,8 @@ static void Del( sout_stream_t *p_stream, void *_id )
     if( id->srtp != NULL )
         srtp_destroy( id->srtp );
 #endif
+    if( id->pool != NULL )
+        rtp_pool_Release( id->pool );
 
     /* Update SDP (sap/file) */
     if( p_sys->b_export_sap ) SapSetup( p_stream );
@@ -1302,42 +1337,233 @@ static int  HttpCallback( httpd_file_sys_t *p_args,
 }
 
 /****************************************************************************
- * RTP send
+ * RTP packets pool
  ****************************************************************************/
-static void* ThreadSend( void *data )
+static rtp_pool_t *rtp_pool_New( size_t size )
+{
+    rtp_pool_t *pool = malloc( sizeof( *pool ) );
+    if( unlikely(pool == NULL) )
+        return NULL;
+
+    vlc_mutex_init( &pool->lock );
+    pool->free = NULL;
+    pool->freec = 0;
+    pool->refs = 1;
+    pool->size = size;
+    return pool;
+}
+
+static void rtp_pool_Release( rtp_pool_t *pool )
+{
+    vlc_mutex_lock( &pool->lock );
+    bool last = --pool->refs == 0;
+    vlc_mutex_unlock( &pool->lock );
+
+    if( !last )
+        return;
+
+    for( block_t *b = pool->free, *next; b != NULL; b = next )
+    {
+        next = b->p_next;
+        free( container_of( b, rtp_packet_t, self ) );
+    }
+    free( pool );
+}
+
+static void rtp_packet_Release( block_t *block )
 {
+    rtp_packet_t *pkt = container_of( block, rtp_packet_t, self );
+    rtp_pool_t *pool = pkt->pool;
+
+    vlc_mutex_lock( &pool->lock );
+    if( pool->freec < RTP_POOL_MAX )
+    {
+        block->p_next = pool->free;
+        pool->free = block;
+        pool->freec++;
+        pkt = NULL;
+    }
+    vlc_mutex_unlock( &pool->lock );
+
+    free( pkt );
+    rtp_pool_Release( pool );
+}
+
+static const struct vlc_block_callbacks rtp_packet_cbs =
+{
+    rtp_packet_Release,
+};
+
+block_t *rtp_packetize_alloc( sout_stream_id_sys_t *id, size_t size )
+{
+    rtp_pool_t *pool = id->pool;
+    rtp_packet_t *pkt = NULL;
+
+    if( size > pool->size )
+        return block_Alloc( size );
+
+    vlc_mutex_lock( &pool->lock );
+    if( pool->free != NULL )
+    {
+        pkt = container_of( pool->free, rtp_packet_t, self );
+        pool->free = pool->free->p_next;
+        pool->freec--;
+    }
+    pool->refs++;
+    vlc_mutex_unlock( &pool->lock );
+
+    if( pkt == NULL )
+    {
+        pkt = malloc( sizeof( *pkt ) + pool->size );
+        if( unlikely(pkt == NULL) )
+        {
+            rtp_pool_Release( pool );
+            return NULL;
+        }
+        pkt->pool = pool;
+    }
+
+    block_Init( &pkt->self, &rtp_packet_cbs, pkt + 1, pool->size );
+    pkt->self.i_buffer = size;
+    return &pkt->self;
+}
+
+/****************************************************************************
+ * RTP send
+ ****************************************************************************/
 #ifdef _WIN32
 # define ENOBUFS      WSAENOBUFS
 # define EAGAIN       WSAEWOULDBLOCK
 # define EWOULDBLOCK  WSAEWOULDBLOCK
 #endif
+
+#ifdef HAVE_SRTP
+static block_t *rtp_protect( sout_stream_id_sys_t *id, block_t *out )
+{
+    /* Pooled packets have room for the tag */
+    size_t len = out->i_buffer;
+    out = block_Realloc( out, 0, len + 10 );
+    if( unlikely(out == NULL) )
+        return NULL;
+    out->i_buffer = len;
+
+    int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
+    if( val )
+    {
+        msg_Dbg( id->p_stream, "SRTP sending error: %s",
+                 vlc_strerror_c(val) );
+        block_Release( out );
+        return NULL;
+    }
+    out->i_buffer = len;
+    return out;
+}
+#endif
+
+/**
+ * Sends packets to a sink, with a single system call where supported.
+ * @return false if the connection is broken
+ */
+static bool rtp_sink_write( int fd, block_t *const *pktv, unsigned pktc )
+{
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgv[RTP_BATCH_MAX];
+    struct iovec iovv[RTP_BATCH_MAX];
+
+    assert( pktc <= RTP_BATCH_MAX );
+    for( unsigned i = 0; i < pktc; i++ )
+    {
+        iovv[i].iov_base = pktv[i]->p_buffer;
+        iovv[i].iov_len = pktv[i]->i_buffer;
+        memset( &msgv[i], 0, sizeof( msgv[i] ) );
+        msgv[i].msg_hdr.msg_iov = &iovv[i];
+        msgv[i].msg_hdr.msg_iovlen = 1;
+    }
+#endif
+
+    for( unsigned i = 0; i < pktc; )
+    {
+#ifdef HAVE_SENDMMSG
+        int val = sendmmsg( fd, msgv + i, pktc - i, 0 );
+        if( val > 0 )
+        {
+            i += val;
+            continue;
+        }
+#else
+        if( send( fd, pktv[i]->p_buffer, pktv[i]->i_buffer, 0 ) != -1 )
+        {
+            i++;
+            continue;
+        }
+#endif
+        /* Packet i failed */
+        switch( net_errno )
+        {
+            case EAGAIN:
+#if (EAGAIN != EWOULDBLOCK)
+            case EWOULDBLOCK:
+#endif
+            case ENOBUFS:
+            case ENOMEM:
+                break;
+            default:
+            {
+                int type;
+                getsockopt( fd, SOL_SOCKET, SO_TYPE,
+                            &type, &(socklen_t){ sizeof(type) });
+                if( type != SOCK_DGRAM )
+                    /* Broken connection */
+                    return false;
+                /* ICMP soft error: ignore and retry */
+                send( fd, pktv[i]->p_buffer, pktv[i]->i_buffer, 0 );
+            }
+        }
+        i++;
+    }
+    return true;
+}
+
+static void* ThreadSend( void *data )
+{
     sout_stream_id_sys_t *id = data;
     vlc_tick_t i_caching = id->i_caching;
+    block_t *pktv[RTP_BATCH_MAX];
     block_t *out;
 
     while ((out = vlc_queue_DequeueKillable(&id->queue, &id->dead)) != NULL)
     {
+        vlc_tick_wait (out->i_dts + i_caching);
+
+        /* Packets due by now go out along with this one: the packets are
+         * the same for every sink, only the system calls are per sink. */
+        unsigned pktc = 0;
+        pktv[pktc++] = out;
+        vlc_queue_Lock(&id->queue);
+        while (pktc < RTP_BATCH_MAX && !vlc_queue_IsEmpty(&id->queue))
+        {
+            const block_t *next = (const block_t *)id->queue.first;
+            if (next->i_dts + i_caching > vlc_tick_now())
+                break;
+            pktv[pktc++] = vlc_queue_DequeueUnlocked(&id->queue);
+        }
+        vlc_queue_Unlock(&id->queue);
+
 #ifdef HAVE_SRTP
         if( id->srtp )
-        {   /* FIXME: this is awfully inefficient */
-            size_t len = out->i_buffer;
-            out = block_Realloc( out, 0, len + 10 );
-            out->i_buffer = len;
-
-            int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
-            if( val )
+        {   /* FIXME: SRTCP support */
+            unsigned n = 0;
+            for( unsigned i = 0; i < pktc; i++ )
             {
-                msg_Dbg( id->p_stream, "SRTP sending error: %s",
-                         vlc_strerror_c(val) );
-                block_Release( out );
-                continue;
+                block_t *pkt = rtp_protect( id, pktv[i] );
+                if( pkt != NULL )
+                    pktv[n++] = pkt;
             }
-            out->i_buffer = len;
+            pktc = n;
+            if( pktc == 0 )
+                continue;
         }
 #endif
-        vlc_tick_wait (out->i_dts + i_caching);
-
-        ssize_t len = out->i_buffer;
 
         vlc_mutex_lock( &id->lock_sink );
         unsigned deadc = 0; /* How many dead sockets? */
@@ -1346,28 +1572,19 @@ static void* ThreadSend( void *data )
         for( int i = 0; i < id->sinkc; i++ )
         {
 #ifdef HAVE_SRTP
-            if( !id->srtp ) /* FIXME: SRTCP support */
+            if( !id->srtp )
 #endif
-                SendRTCP( id->sinkv[i].rtcp, out );
+                for( unsigned j = 0; j < pktc; j++ )
+                    SendRTCP( id->sinkv[i].rtcp, pktv[j] );
 
-            if( send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 ) == -1
-             && net_errno != EAGAIN && net_errno != EWOULDBLOCK
-             && net_errno != ENOBUFS && net_errno != ENOMEM )
-            {
-                int type;
-                getsockopt( id->sinkv[i].rtp_fd, SOL_SOCKET, SO_TYPE,
-                            &type, &(socklen_t){ sizeof(type) });
-                if( type == SOCK_DGRAM )
-                    /* ICMP soft error: ignore and retry */
-                    send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 );
-                else
-                    /* Broken connection */
-                    deadv[deadc++] = id->sinkv[i].rtp_fd;
-            }
+            if( !rtp_sink_write( id->sinkv[i].rtp_fd, pktv, pktc ) )
+                deadv[deadc++] = id->sinkv[i].rtp_fd;
         }
-        id->i_seq_sent_next = ntohs(((uint16_t *) out->p_buffer)[1]) + 1;
+        id->i_seq_sent_next =
+            ntohs(((uint16_t *) pktv[pktc - 1]->p_buffer)[1]) + 1;
         vlc_mutex_unlock( &id->lock_sink );
-        block_Release( out );
+        for( unsigned j = 0; j < pktc; j++ )
+            block_Release( pktv[j] );
 
         for( unsigned i = 0; i < deadc; i++ )
         {
@@ -1620,7 +1837,7 @@ static ssize_t AccessOutGrabberWriteBuffer( sout_stream_t *p_stream,
         if( p_sys->packet == NULL )
         {
             /* allocate a new packet */
-            p_sys->packet = block_Alloc( id->i_mtu );
+            p_sys->packet = rtp_packetize_alloc( id, id->i_mtu );
             /* m-bit is discontinuity for MPEG1/2 PS and TS, RFC2250 2.1 */
             rtp_packetize_common( id, p_sys->packet, b_dis, i_dts );
             p_sys->packet->i_buffer = 12;
@@ -53,6 +53,7 @@ vlc_tick_t rtp_get_ts( const sout_stream_t *p_stream, const sout_stream_id_sys_t
 /* RTP packetization */
 void rtp_packetize_common (sout_stream_id_sys_t *id, block_t *out,
                            bool b_m_bit, vlc_tick_t i_pts);
+block_t *rtp_packetize_alloc (sout_stream_id_sys_t *id, size_t size);
 void rtp_packetize_send (sout_stream_id_sys_t *id, block_t *out);
 size_t rtp_mtu (const sout_stream_id_sys_t *id);
 
@@ -200,8 +200,20 @@ int transcode_audio_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
 
 void transcode_audio_clean( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
 {
-    /* Close encoder */
+    /* Close encoder: its thread, if any, encodes the buffers still queued */
+    bool b_threaded = id->p_enccfg->audio.threads.i_count >= 1 &&
+                      transcode_encoder_opened( id->encoder );
     transcode_encoder_close( id->encoder );
+
+    if( b_threaded )
+    {
+        /* Send what the thread output since the last Send() */
+        block_t *p_out = transcode_encoder_get_output_async( id->encoder );
+        if( p_out != NULL && !id->b_error && id->downstream_id != NULL )
+            sout_StreamIdSend( p_stream->p_next, id->downstream_id, p_out );
+        else
+            block_ChainRelease( p_out );
+    }
     transcode_encoder_delete( id->encoder );
 
     es_format_Clean( &id->decoder_out );
@@ -262,6 +274,8 @@ int transcode_audio_process( sout_stream_t *p_stream,
                 msg_Info( p_stream, "Audio changed, trying to reinitialize filters" );
                 if( id->p_af_chain != NULL )
                 {
+                    /* waits for the queued buffers to go through */
+                    transcode_encoder_audio_set_filters( id->encoder, NULL );
                     aout_FiltersDelete( p_stream, id->p_af_chain );
                     id->p_af_chain = NULL;
                 }
@@ -278,6 +292,7 @@ int transcode_audio_process( sout_stream_t *p_stream,
                 vlc_mutex_unlock(&id->fifo.lock);
                 goto error;
             }
+            transcode_encoder_audio_set_filters( id->encoder, id->p_af_chain );
 
             date_Init( &id->next_input_pts, id->decoder_out.audio.i_rate, 1 );
             date_Set( &id->next_input_pts, p_audio_buf->i_pts );
@@ -326,16 +341,8 @@ int transcode_audio_process( sout_stream_t *p_stream,
 
         p_audio_buf->i_dts = p_audio_buf->i_pts;
 
-        /* Run filter chain */
-        p_audio_buf = aout_FiltersPlay( id->p_af_chain, p_audio_buf, 1.f );
-        if( p_audio_buf  )
-        {
-            p_audio_buf->i_dts = p_audio_buf->i_pts;
-
-            block_t *p_block = transcode_encoder_encode( id->encoder, p_audio_buf );
-            block_ChainAppend( out, p_block );
-            block_Release( p_audio_buf );
-        }
+        /* Run filter chain and encode, on the encoder thread if any */
+        block_ChainAppend( out, transcode_encoder_encode( id->encoder, p_audio_buf ) );
         continue;
 error:
         if( p_audio_buf )
@@ -343,6 +350,13 @@ error:
         id->b_error = true;
     } while( p_audio_bufs );
 
+    if( id->p_enccfg->audio.threads.i_count >= 1 &&
+        transcode_encoder_opened( id->encoder ) )
+    {
+        /* Pick up any return data the encoder thread wants to output. */
+        block_ChainAppend( out, transcode_encoder_get_output_async( id->encoder ) );
+    }
+
     /* Drain encoder */
     if( unlikely( !id->b_error && in == NULL ) && transcode_encoder_opened( id->encoder ) )
     {
@@ -56,6 +56,8 @@ static const int pi_channels_maps[9] =
      | AOUT_CHAN_LFE,
 };
 
+static void *EncoderThread( void * );
+
 int transcode_encoder_audio_open( transcode_encoder_t *p_enc,
                                   const transcode_encoder_config_t *p_cfg )
 {
@@ -65,13 +67,31 @@ int transcode_encoder_audio_open( transcode_encoder_t *p_enc,
     p_enc->p_encoder->p_module = module_need( p_enc->p_encoder, "encoder",
                                               p_cfg->psz_name, true );
 
-    if( p_enc->p_encoder->p_module )
+    if( !p_enc->p_encoder->p_module )
+        return VLC_EGENERIC;
+
+    p_enc->p_encoder->fmt_out.i_codec =
+            vlc_fourcc_GetCodec( AUDIO_ES, p_enc->p_encoder->fmt_out.i_codec );
+
+    if( p_cfg->audio.threads.i_count > 0 )
     {
-        p_enc->p_encoder->fmt_out.i_codec =
-                vlc_fourcc_GetCodec( AUDIO_ES, p_enc->p_encoder->fmt_out.i_codec );
+        vlc_sem_init( &p_enc->picture_pool_has_room, p_cfg->audio.threads.pool_size );
+        vlc_cond_init( &p_enc->cond );
+        vlc_cond_init( &p_enc->cond_idle );
+        p_enc->b_abort = false;
+        p_enc->b_busy = false;
+
+        if( vlc_clone( &p_enc->thread, EncoderThread, p_enc,
+                       p_cfg->audio.threads.i_priority ) )
+        {
+            module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
+            p_enc->p_encoder->p_module = NULL;
+            return VLC_EGENERIC;
+        }
+        p_enc->b_threaded = true;
     }
 
-    return ( p_enc->p_encoder->p_module ) ? VLC_SUCCESS: VLC_EGENERIC;
+    return VLC_SUCCESS;
 }
 
 static int encoder_audio_configure( const transcode_encoder_config_t *p_cfg,
@@ -197,17 +217,137 @@ int transcode_encoder_audio_test( encoder_t *p_encoder,
     return p_module != NULL ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
+/* Filters, encodes and releases a decoded buffer */
+static block_t *EncodeBuffer( transcode_encoder_t *p_enc,
+                              aout_filters_t *p_filters, block_t *p_buf )
+{
+    if( p_filters )
+    {
+        p_buf = aout_FiltersPlay( p_filters, p_buf, 1.f );
+        if( !p_buf )
+            return NULL;
+        p_buf->i_dts = p_buf->i_pts;
+    }
+
+    vlc_tick_t i_start = vlc_tick_now();
+    block_t *p_block = p_enc->p_encoder->pf_encode_audio( p_enc->p_encoder, p_buf );
+    transcode_encoder_account( p_enc, i_start );
+
+    block_Release( p_buf );
+    return p_block;
+}
+
+static void *EncoderThread( void *obj )
+{
+    transcode_encoder_t *p_enc = obj;
+    int canc = vlc_savecancel();
+
+    vlc_mutex_lock( &p_enc->lock_out );
+
+    for( ;; )
+    {
+        while( !p_enc->b_abort && p_enc->p_blocks == NULL )
+            vlc_cond_wait( &p_enc->cond, &p_enc->lock_out );
+
+        /* Encode what we have in the queue on closing */
+        block_t *p_buf = p_enc->p_blocks;
+        if( p_buf == NULL )
+            break;
+
+        p_enc->p_blocks = p_buf->p_next;
+        if( p_enc->p_blocks == NULL )
+            p_enc->pp_blocks_last = &p_enc->p_blocks;
+        p_buf->p_next = NULL;
+        p_enc->b_busy = true;
+        vlc_sem_post( &p_enc->picture_pool_has_room );
+
+        /* The filters only change while the thread is idle */
+        aout_filters_t *p_filters = p_enc->p_afilters;
+
+        /* release lock while filtering and encoding */
+        vlc_mutex_unlock( &p_enc->lock_out );
+        block_t *p_block = EncodeBuffer( p_enc, p_filters, p_buf );
+        vlc_mutex_lock( &p_enc->lock_out );
+
+        block_ChainAppend( &p_enc->p_buffers, p_block );
+        p_enc->b_busy = false;
+        if( p_enc->p_blocks == NULL )
+            vlc_cond_signal( &p_enc->cond_idle );
+    }
+
+    vlc_mutex_unlock( &p_enc->lock_out );
+    vlc_restorecancel( canc );
+
+    return NULL;
+}
+
+/* Waits until the thread has filtered and encoded everything queued */
+static void WaitIdle( transcode_encoder_t *p_enc )
+{
+    while( p_enc->p_blocks != NULL || p_enc->b_busy )
+        vlc_cond_wait( &p_enc->cond_idle, &p_enc->lock_out );
+}
+
+void transcode_encoder_audio_set_filters( transcode_encoder_t *p_enc,
+                                          aout_filters_t *p_filters )
+{
+    if( !p_enc->b_threaded )
+    {
+        p_enc->p_afilters = p_filters;
+        return;
+    }
+
+    vlc_mutex_lock( &p_enc->lock_out );
+    WaitIdle( p_enc );
+    p_enc->p_afilters = p_filters;
+    vlc_mutex_unlock( &p_enc->lock_out );
+}
+
 block_t * transcode_encoder_audio_encode( transcode_encoder_t *p_enc, block_t *p_block )
 {
-    return p_enc->p_encoder->pf_encode_audio( p_enc->p_encoder, p_block );
+    if( !p_enc->b_threaded )
+        return EncodeBuffer( p_enc, p_enc->p_afilters, p_block );
+
+    vlc_sem_wait( &p_enc->picture_pool_has_room );
+    vlc_mutex_lock( &p_enc->lock_out );
+    *p_enc->pp_blocks_last = p_block;
+    p_enc->pp_blocks_last = &p_block->p_next;
+    vlc_cond_signal( &p_enc->cond );
+    vlc_mutex_unlock( &p_enc->lock_out );
+    return NULL;
 }
 
 int transcode_encoder_audio_drain( transcode_encoder_t *p_enc, block_t **out )
 {
+    if( p_enc->b_threaded )
+    {
+        /* The thread stays idle until more buffers get queued */
+        vlc_mutex_lock( &p_enc->lock_out );
+        WaitIdle( p_enc );
+        block_ChainAppend( out, p_enc->p_buffers );
+        p_enc->p_buffers = NULL;
+        vlc_mutex_unlock( &p_enc->lock_out );
+    }
+
     block_t *p_block;
     do {
-        p_block = transcode_encoder_audio_encode( p_enc, NULL );
+        p_block = p_enc->p_encoder->pf_encode_audio( p_enc->p_encoder, NULL );
         block_ChainAppend( out, p_block );
     } while( p_block );
     return VLC_SUCCESS;
 }
+
+void transcode_encoder_audio_close( transcode_encoder_t *p_enc )
+{
+    if( p_enc->b_threaded )
+    {
+        vlc_mutex_lock( &p_enc->lock_out );
+        p_enc->b_abort = true;
+        vlc_cond_signal( &p_enc->cond );
+        vlc_mutex_unlock( &p_enc->lock_out );
+        vlc_join( p_enc->thread, NULL );
+        p_enc->b_threaded = false;
+    }
+
+    module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
+}
@@ -40,6 +40,8 @@ void transcode_encoder_config_clean( transcode_encoder_config_t *p_cfg )
     free( p_cfg->psz_name );
     free( p_cfg->psz_lang );
     config_ChainDestroy( p_cfg->p_config_chain );
+    /* Only set on video configs, left NULL by init on the others */
+    free( p_cfg->video.keyframes.p_times );
 }
 
 void transcode_encoder_delete( transcode_encoder_t *p_enc )
@@ -51,6 +53,11 @@ void transcode_encoder_delete( transcode_encoder_t *p_enc )
             block_ChainRelease( p_enc->p_buffers );
             picture_fifo_Delete( p_enc->pp_pics );
         }
+        else if( p_enc->p_encoder->fmt_in.i_cat == AUDIO_ES )
+        {
+            block_ChainRelease( p_enc->p_buffers );
+            block_ChainRelease( p_enc->p_blocks );
+        }
         es_format_Clean( &p_enc->p_encoder->fmt_in );
         es_format_Clean( &p_enc->p_encoder->fmt_out );
         vlc_object_delete(p_enc->p_encoder);
@@ -93,6 +100,10 @@ transcode_encoder_t * transcode_encoder_new( encoder_t *p_encoder,
     if( p_enc->p_encoder->fmt_in.psz_language )
         p_enc->p_encoder->fmt_out.psz_language = strdup( p_enc->p_encoder->fmt_in.psz_language );
 
+    /* Per-track statistics, updated as frames get encoded */
+    var_Create( p_enc->p_encoder, "encoded-frames", VLC_VAR_INTEGER );
+    var_Create( p_enc->p_encoder, "encode-time", VLC_VAR_INTEGER );
+
     switch( p_fmt->i_cat )
     {
         case VIDEO_ES:
@@ -107,6 +118,10 @@ transcode_encoder_t * transcode_encoder_new( encoder_t *p_encoder,
             }
             vlc_mutex_init( &p_enc->lock_out );
             break;
+        case AUDIO_ES:
+            p_enc->pp_blocks_last = &p_enc->p_blocks;
+            vlc_mutex_init( &p_enc->lock_out );
+            break;
         default:
             break;
     }
@@ -157,6 +172,14 @@ block_t * transcode_encoder_encode( transcode_encoder_t *p_enc, void *in )
     }
 }
 
+void transcode_encoder_account( transcode_encoder_t *p_enc, vlc_tick_t i_start )
+{
+    p_enc->i_encode_time += vlc_tick_now() - i_start;
+    p_enc->i_encoded++;
+    var_SetInteger( p_enc->p_encoder, "encoded-frames", p_enc->i_encoded );
+    var_SetInteger( p_enc->p_encoder, "encode-time", p_enc->i_encode_time );
+}
+
 block_t * transcode_encoder_get_output_async( transcode_encoder_t *p_enc )
 {
     vlc_mutex_lock( &p_enc->lock_out );
@@ -176,11 +199,20 @@ void transcode_encoder_close( transcode_encoder_t *p_enc )
         case VIDEO_ES:
             transcode_encoder_video_close( p_enc );
             break;
+        case AUDIO_ES:
+            transcode_encoder_audio_close( p_enc );
+            break;
         default:
             module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
             break;
     }
 
+    if( p_enc->i_encoded > 0 )
+        msg_Dbg( p_enc->p_encoder, "encoded %"PRIu64" frames in %"PRId64" ms "
+                 "(%"PRId64" us per frame)", p_enc->i_encoded,
+                 MS_FROM_VLC_TICK(p_enc->i_encode_time),
+                 US_FROM_VLC_TICK(p_enc->i_encode_time) / (int64_t)p_enc->i_encoded );
+
     p_enc->p_encoder->p_module = NULL;
 }
 
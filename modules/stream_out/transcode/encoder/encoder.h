@@ -22,6 +22,7 @@
 #define FIRSTVALID(a,b,c) ( a ? a : ( b ? b : c ) )
 
 typedef struct transcode_encoder_t transcode_encoder_t;
+struct aout_filters;
 
 typedef struct
 {
@@ -39,6 +40,13 @@ typedef struct
             unsigned int    i_height, i_maxheight;
             bool            b_hurry_up;
             vlc_rational_t  fps;
+            bool            b_convert; /* ladder rung: scales its input */
+            struct
+            {
+                vlc_tick_t   i_interval; /* forced keyframe grid */
+                vlc_tick_t  *p_times; /* forced keyframes, ascending */
+                size_t       i_times;
+            } keyframes;
             struct
             {
                 unsigned int i_count;
@@ -51,6 +59,12 @@ typedef struct
             unsigned int    i_bitrate;
             uint32_t        i_sample_rate;
             uint32_t        i_channels;
+            struct
+            {
+                unsigned int i_count; /* filter and encode on a thread */
+                int          i_priority;
+                uint32_t     pool_size;
+            } threads;
         } audio;
         struct
         {
@@ -96,6 +110,9 @@ void transcode_video_framerate_apply( const video_format_t *p_src,
 void transcode_video_sar_apply( const video_format_t *p_src,
                                       video_format_t *p_dst );
 
+void transcode_encoder_audio_set_filters( transcode_encoder_t *,
+                                          struct aout_filters * );
+
 int transcode_encoder_audio_configure( const transcode_encoder_config_t *p_cfg,
                                        const audio_format_t *p_dec_out,
                                        transcode_encoder_t *p_enc, bool );
@@ -17,6 +17,7 @@
  * along with this program; if not, If not, see https://www.gnu.org/licenses/
  *****************************************************************************/
 #include <vlc_picture_fifo.h>
+#include <vlc_filter.h>
 
 struct transcode_encoder_t
 {
@@ -31,8 +32,27 @@ struct transcode_encoder_t
     /* output buffers */
     block_t         *p_buffers;
     bool b_threaded;
+
+    /* input conversion, on the encoder thread */
+    bool            b_convert;
+    filter_chain_t *p_conv;
+    video_format_t  conv_in;
+
+    /* audio input queue and filters, on the encoder thread */
+    block_t         *p_blocks;
+    block_t        **pp_blocks_last;
+    struct aout_filters *p_afilters;
+    bool            b_busy;
+    vlc_cond_t      cond_idle;
+
+    /* statistics */
+    vlc_tick_t      i_encode_time;
+    uint64_t        i_encoded;
 };
 
+/* Accounts one frame encoded since i_start */
+void transcode_encoder_account( transcode_encoder_t *p_enc, vlc_tick_t i_start );
+
 int transcode_encoder_audio_open( transcode_encoder_t *p_enc,
                                   const transcode_encoder_config_t *p_cfg );
 int transcode_encoder_video_open( transcode_encoder_t *p_enc,
@@ -41,6 +61,7 @@ int transcode_encoder_spu_open( transcode_encoder_t *p_enc,
                                 const transcode_encoder_config_t *p_cfg );
 
 void transcode_encoder_video_close( transcode_encoder_t *p_enc );
+void transcode_encoder_audio_close( transcode_encoder_t *p_enc );
 
 block_t * transcode_encoder_video_encode( transcode_encoder_t *p_enc, picture_t *p_pic );
 block_t * transcode_encoder_audio_encode( transcode_encoder_t *p_enc, block_t *p_block );
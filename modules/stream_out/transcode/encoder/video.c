@@ -350,6 +350,80 @@ int transcode_encoder_video_test( encoder_t *p_encoder,
     return p_module != NULL ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
+/* Converts the pictures to the encoder input format. The chain is (re)built
+ * from the first picture of each input format. */
+static picture_t *ConvertPicture( transcode_encoder_t *p_enc, picture_t *p_pic )
+{
+    const es_format_t *p_fmt_in = &p_enc->p_encoder->fmt_in;
+
+    if( p_enc->p_conv == NULL ||
+        !video_format_IsSimilar( &p_enc->conv_in, &p_pic->format ) )
+    {
+        es_format_t src;
+
+        if( p_enc->p_conv != NULL )
+        {
+            filter_chain_Delete( p_enc->p_conv );
+            video_format_Clean( &p_enc->conv_in );
+        }
+
+        p_enc->p_conv = filter_chain_NewVideo( p_enc->p_encoder, false, NULL );
+        if( unlikely(p_enc->p_conv == NULL) )
+        {
+            picture_Release( p_pic );
+            return NULL;
+        }
+        video_format_Copy( &p_enc->conv_in, &p_pic->format );
+
+        es_format_InitFromVideo( &src, &p_pic->format );
+        filter_chain_Reset( p_enc->p_conv, &src,
+                            picture_GetVideoContext( p_pic ), p_fmt_in );
+        es_format_Clean( &src );
+
+        if( !video_format_IsSimilar( &p_fmt_in->video, &p_pic->format ) &&
+            filter_chain_AppendConverter( p_enc->p_conv, p_fmt_in ) )
+            msg_Err( p_enc->p_encoder, "cannot convert %4.4s %ux%u to %4.4s %ux%u",
+                     (const char *)&p_pic->format.i_chroma,
+                     p_pic->format.i_visible_width,
+                     p_pic->format.i_visible_height,
+                     (const char *)&p_fmt_in->video.i_chroma,
+                     p_fmt_in->video.i_visible_width,
+                     p_fmt_in->video.i_visible_height );
+    }
+
+    if( filter_chain_IsEmpty( p_enc->p_conv ) &&
+        !video_format_IsSimilar( &p_fmt_in->video, &p_pic->format ) )
+    {   /* the chain could not be built */
+        picture_Release( p_pic );
+        return NULL;
+    }
+
+    return filter_chain_VideoFilter( p_enc->p_conv, p_pic );
+}
+
+static block_t *EncodeTimed( transcode_encoder_t *p_enc, picture_t *p_pic )
+{
+    vlc_tick_t i_start = vlc_tick_now();
+    block_t *p_block = p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+    transcode_encoder_account( p_enc, i_start );
+    return p_block;
+}
+
+/* Encodes and releases a picture */
+static block_t *EncodePicture( transcode_encoder_t *p_enc, picture_t *p_pic )
+{
+    if( p_enc->b_convert )
+    {
+        p_pic = ConvertPicture( p_enc, p_pic );
+        if( p_pic == NULL )
+            return NULL;
+    }
+
+    block_t *p_block = EncodeTimed( p_enc, p_pic );
+    picture_Release( p_pic );
+    return p_block;
+}
+
 static void* EncoderThread( void *obj )
 {
     transcode_encoder_t *p_enc = obj;
@@ -370,8 +444,7 @@ static void* EncoderThread( void *obj )
         {
             /* release lock while encoding */
             vlc_mutex_unlock( &p_enc->lock_out );
-            p_block = p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
-            picture_Release( p_pic );
+            p_block = EncodePicture( p_enc, p_pic );
             vlc_mutex_lock( &p_enc->lock_out );
 
             block_ChainAppend( &p_enc->p_buffers, p_block );
@@ -385,8 +458,7 @@ static void* EncoderThread( void *obj )
     while( (p_pic = picture_fifo_Pop( p_enc->pp_pics )) != NULL )
     {
         vlc_sem_post( &p_enc->picture_pool_has_room );
-        p_block = p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
-        picture_Release( p_pic );
+        p_block = EncodePicture( p_enc, p_pic );
         block_ChainAppend( &p_enc->p_buffers, p_block );
     }
 
@@ -439,6 +511,13 @@ void transcode_encoder_video_close( transcode_encoder_t *p_enc )
         vlc_join( p_enc->thread, NULL );
     }
 
+    if( p_enc->p_conv )
+    {
+        filter_chain_Delete( p_enc->p_conv );
+        video_format_Clean( &p_enc->conv_in );
+        p_enc->p_conv = NULL;
+    }
+
     /* Close encoder */
     module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
     p_enc->p_encoder->p_module = NULL;
@@ -465,8 +544,10 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
     vlc_cond_init( &p_enc->cond );
     p_enc->p_buffers = NULL;
     p_enc->b_abort = false;
+    p_enc->b_convert = p_cfg->video.b_convert;
 
-    if( p_cfg->video.threads.i_count > 0 )
+    /* Ladder rungs always scale and encode on their own thread */
+    if( p_cfg->video.threads.i_count > 0 || p_enc->b_convert )
     {
         if( vlc_clone( &p_enc->thread, EncoderThread, p_enc, p_cfg->video.threads.i_priority ) )
         {
@@ -484,7 +565,9 @@ block_t * transcode_encoder_video_encode( transcode_encoder_t *p_enc, picture_t
 {
     if( !p_enc->b_threaded )
     {
-        return p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+        if( p_pic == NULL )
+            return p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, NULL );
+        return EncodeTimed( p_enc, p_pic );
     }
 
     vlc_sem_wait( &p_enc->picture_pool_has_room );
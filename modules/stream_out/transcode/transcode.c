@@ -35,6 +35,7 @@
 #include <vlc_plugin.h>
 #include <vlc_sout.h>
 #include <vlc_spu.h>
+#include <vlc_charset.h>
 
 #include "transcode.h"
 
@@ -75,6 +76,22 @@
 #define MAXHEIGHT_TEXT N_("Maximum video height")
 #define MAXHEIGHT_LONGTEXT N_( \
     "Maximum output video height." )
+#define LADDER_TEXT N_("Video ladder")
+#define LADDER_LONGTEXT N_( \
+    "Comma-separated list of WIDTHxHEIGHT@KBPS renditions to encode the " \
+    "video to (eg: 1920x1080@6000,1280x720@3000). The video is decoded and " \
+    "filtered once, then scaled and encoded for each rendition on its own " \
+    "thread. Each rendition is a separate elementary stream, with the ID of " \
+    "the source plus 65536 times its index in the list." )
+#define KEYINT_TEXT N_("Keyframe interval")
+#define KEYINT_LONGTEXT N_( \
+    "Forces the video encoder to start a new GOP every given number of " \
+    "seconds from the first picture, so that segmenters can cut at the same " \
+    "times on every output (0 lets the encoder decide)." )
+#define KEYTIMES_TEXT N_("Keyframe times")
+#define KEYTIMES_LONGTEXT N_( \
+    "Comma-separated list of times, in seconds from the first picture, at " \
+    "which the video encoder is forced to start a new GOP." )
 #define VFILTER_TEXT N_("Video filter")
 #define VFILTER_LONGTEXT N_( \
     "Video filters will be applied to the video streams (after overlays " \
@@ -121,14 +138,15 @@
 
 #define THREADS_TEXT N_("Number of threads")
 #define THREADS_LONGTEXT N_( \
-    "Number of threads used for the transcoding." )
+    "Number of threads used for the transcoding. When set, audio is also " \
+    "filtered and encoded on a thread of its own." )
 #define HP_TEXT N_("High priority")
 #define HP_LONGTEXT N_( \
-    "Runs the optional encoder thread at the OUTPUT priority instead of " \
-    "VIDEO." )
+    "Runs the optional encoder threads at the OUTPUT priority instead of " \
+    "VIDEO or AUDIO." )
 #define POOL_TEXT N_("Picture pool size")
-#define POOL_LONGTEXT N_( "Defines how many pictures we allow to be in pool "\
-    "between decoder/encoder threads when threads > 0" )
+#define POOL_LONGTEXT N_( "Defines how many pictures (or audio buffers) we " \
+    "allow to be in pool between decoder/encoder threads when threads > 0" )
 
 
 static const char *const ppsz_deinterlace_type[] =
@@ -177,6 +195,12 @@ vlc_module_begin ()
                  MAXHEIGHT_LONGTEXT, true )
     add_module_list(SOUT_CFG_PREFIX "vfilter", "video filter", NULL,
                     VFILTER_TEXT, VFILTER_LONGTEXT)
+    add_string( SOUT_CFG_PREFIX "ladder", NULL, LADDER_TEXT,
+                LADDER_LONGTEXT, true )
+    add_float( SOUT_CFG_PREFIX "key-interval", 0., KEYINT_TEXT,
+               KEYINT_LONGTEXT, true )
+    add_string( SOUT_CFG_PREFIX "key-times", NULL, KEYTIMES_TEXT,
+                KEYTIMES_LONGTEXT, true )
 
     set_section( N_("Audio"), NULL )
     add_module(SOUT_CFG_PREFIX "aenc", "encoder", NULL,
@@ -224,7 +248,7 @@ static const char *const ppsz_sout_options[] = {
     "deinterlace-module", "threads", "aenc", "acodec", "ab", "alang",
     "afilter", "samplerate", "channels", "senc", "scodec", "soverlay",
     "sfilter", "high-priority", "maxwidth", "maxheight", "pool-size",
-    NULL
+    "ladder", "key-interval", "key-times", NULL
 };
 
 /*****************************************************************************
@@ -282,6 +306,60 @@ static void SetAudioEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
     }
 
     p_cfg->psz_lang = var_GetNonEmptyString( p_stream, SOUT_CFG_PREFIX "alang" );
+
+    /* Audio encoders are single-threaded: one thread per track is enough */
+    p_cfg->audio.threads.i_count =
+        var_GetInteger( p_stream, SOUT_CFG_PREFIX "threads" ) > 0 ? 1 : 0;
+    p_cfg->audio.threads.pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
+
+    if( var_GetBool( p_stream, SOUT_CFG_PREFIX "high-priority" ) )
+        p_cfg->audio.threads.i_priority = VLC_THREAD_PRIORITY_OUTPUT;
+    else
+        p_cfg->audio.threads.i_priority = VLC_THREAD_PRIORITY_AUDIO;
+}
+
+static void SetVideoKeyframeTimes( sout_stream_t *p_stream, transcode_encoder_config_t *p_cfg )
+{
+    char *psz_times = var_GetNonEmptyString( p_stream, SOUT_CFG_PREFIX "key-times" );
+    if( psz_times == NULL )
+        return;
+
+    size_t i_count = 1;
+    for( const char *p = psz_times; (p = strchr( p, ',' )) != NULL; p++ )
+        i_count++;
+
+    vlc_tick_t *p_times = vlc_alloc( i_count, sizeof(*p_times) );
+    if( unlikely(p_times == NULL) )
+    {
+        free( psz_times );
+        return;
+    }
+
+    size_t i_times = 0;
+    char *psz_save;
+    for( char *psz_time = strtok_r( psz_times, ",", &psz_save );
+         psz_time != NULL; psz_time = strtok_r( NULL, ",", &psz_save ) )
+    {
+        char *psz_end;
+        double f_time = us_strtod( psz_time, &psz_end );
+
+        if( psz_end == psz_time || f_time < 0. ||
+            ( i_times > 0 && vlc_tick_from_secf( f_time ) <= p_times[i_times - 1] ) )
+        {
+            msg_Warn( p_stream, "ignoring keyframe time \"%s\"", psz_time );
+            continue;
+        }
+        p_times[i_times++] = vlc_tick_from_secf( f_time );
+    }
+    free( psz_times );
+
+    if( i_times == 0 )
+    {
+        free( p_times );
+        return;
+    }
+    p_cfg->video.keyframes.p_times = p_times;
+    p_cfg->video.keyframes.i_times = i_times;
 }
 
 static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_config_t *p_cfg )
@@ -330,6 +408,64 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
         p_cfg->video.threads.i_priority = VLC_THREAD_PRIORITY_OUTPUT;
     else
         p_cfg->video.threads.i_priority = VLC_THREAD_PRIORITY_VIDEO;
+
+    float f_interval = var_GetFloat( p_stream, SOUT_CFG_PREFIX "key-interval" );
+    if( f_interval > 0.f )
+        p_cfg->video.keyframes.i_interval = vlc_tick_from_secf( f_interval );
+
+    SetVideoKeyframeTimes( p_stream, p_cfg );
+}
+
+static int SetVideoLadderConfig( sout_stream_t *p_stream, sout_stream_sys_t *p_sys )
+{
+    char *psz_ladder = var_GetNonEmptyString( p_stream, SOUT_CFG_PREFIX "ladder" );
+    if( psz_ladder == NULL )
+        return VLC_SUCCESS;
+
+    size_t i_count = 1;
+    for( const char *p = psz_ladder; (p = strchr( p, ',' )) != NULL; p++ )
+        i_count++;
+
+    p_sys->p_ladder = vlc_alloc( i_count, sizeof(*p_sys->p_ladder) );
+    if( unlikely(p_sys->p_ladder == NULL) )
+    {
+        free( psz_ladder );
+        return VLC_ENOMEM;
+    }
+
+    char *psz_save;
+    for( char *psz_rung = strtok_r( psz_ladder, ",", &psz_save );
+         psz_rung != NULL; psz_rung = strtok_r( NULL, ",", &psz_save ) )
+    {
+        unsigned i_width, i_height, i_bitrate;
+
+        if( sscanf( psz_rung, "%ux%u@%u", &i_width, &i_height, &i_bitrate ) != 3
+         || i_width < 2 || i_height < 2 )
+        {
+            msg_Err( p_stream, "invalid ladder rendition \"%s\"", psz_rung );
+            free( psz_ladder );
+            free( p_sys->p_ladder );
+            p_sys->p_ladder = NULL;
+            p_sys->i_ladder = 0;
+            return VLC_EGENERIC;
+        }
+
+        /* The renditions share the codec, encoder and its options */
+        transcode_encoder_config_t *p_cfg = &p_sys->p_ladder[p_sys->i_ladder++];
+        *p_cfg = p_sys->venc_cfg;
+        p_cfg->video.i_width = i_width;
+        p_cfg->video.i_height = i_height;
+        p_cfg->video.i_maxwidth = p_cfg->video.i_maxheight = 0;
+        p_cfg->video.f_scale = 0.f;
+        p_cfg->video.i_bitrate = i_bitrate * 1000;
+        p_cfg->video.b_convert = true;
+
+        msg_Dbg( p_stream, "ladder rendition %zu: %ux%u %ukb/s",
+                 p_sys->i_ladder - 1, i_width, i_height, i_bitrate );
+    }
+
+    free( psz_ladder );
+    return VLC_SUCCESS;
 }
 
 static void SetSPUEncoderConfig( sout_stream_t *p_stream, transcode_encoder_config_t *p_cfg )
@@ -409,6 +545,14 @@ static int Open( vlc_object_t *p_this )
     transcode_encoder_config_init( &p_sys->venc_cfg );
 
     SetVideoEncoderConfig( p_stream, &p_sys->venc_cfg );
+    if( SetVideoLadderConfig( p_stream, p_sys ) != VLC_SUCCESS )
+    {
+        transcode_encoder_config_clean( &p_sys->venc_cfg );
+        transcode_encoder_config_clean( &p_sys->aenc_cfg );
+        sout_filters_config_clean( &p_sys->afilters_cfg );
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
     p_sys->b_master_sync = (p_sys->venc_cfg.video.fps.num > 0);
     if( p_sys->venc_cfg.i_codec )
     {
@@ -482,6 +626,7 @@ static void Close( vlc_object_t * p_this )
 
     transcode_encoder_config_clean( &p_sys->venc_cfg );
     sout_filters_config_clean( &p_sys->vfilters_cfg );
+    free( p_sys->p_ladder ); /* shallow copies of venc_cfg */
 
     transcode_encoder_config_clean( &p_sys->aenc_cfg );
     sout_filters_config_clean( &p_sys->afilters_cfg );
@@ -610,7 +755,8 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
             break;
         case VIDEO_ES:
             id->p_filterscfg = &p_sys->vfilters_cfg;
-            id->p_enccfg = &p_sys->venc_cfg;
+            id->p_enccfg = p_sys->i_ladder ? &p_sys->p_ladder[0]
+                                           : &p_sys->venc_cfg;
             break;
         case SPU_ES:
             id->p_filterscfg = NULL;
@@ -693,7 +839,7 @@ static void Del( sout_stream_t *p_stream, void *_id )
             if( id == p_sys->id_video )
                 p_sys->id_video = NULL;
             vlc_mutex_unlock( &p_sys->lock );
-            transcode_video_clean( id );
+            transcode_video_clean( p_stream, id );
             break;
         case SPU_ES:
             decoder_Destroy( id->p_decoder );
@@ -726,6 +872,14 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
             goto error;
     }
 
+    /* Decoders own their input and may write to it */
+    if( p_buffer )
+    {
+        p_buffer = block_Unshare( p_buffer );
+        if( unlikely(p_buffer == NULL) )
+            return VLC_ENOMEM;
+    }
+
     int i_ret;
     switch( id->p_decoder->fmt_in.i_cat )
     {
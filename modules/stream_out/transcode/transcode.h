@@ -52,6 +52,8 @@ typedef struct
     /* Video */
     transcode_encoder_config_t venc_cfg;
     sout_filters_config_t vfilters_cfg;
+    transcode_encoder_config_t *p_ladder; /**< copies of venc_cfg per rung */
+    size_t i_ladder;
 
     /* SPU */
     transcode_encoder_config_t senc_cfg;
@@ -68,6 +70,18 @@ typedef struct
 
 struct aout_filters;
 
+/* Additional ladder rung: the decoded and filtered pictures are scaled and
+ * encoded again, as a separate elementary stream */
+struct transcode_rung
+{
+    const transcode_encoder_config_t *p_enccfg;
+    transcode_encoder_t *encoder;
+    void *downstream_id;
+};
+
+/* Offset between the ES IDs of consecutive ladder rungs */
+#define TRANSCODE_LADDER_ID_STEP 0x10000
+
 struct sout_stream_id_sys_t
 {
     bool            b_transcode;
@@ -130,6 +144,11 @@ struct sout_stream_id_sys_t
              spu_t           *p_spu;
              vlc_decoder_device *dec_dev;
              vlc_video_context *enc_vctx_in;
+             struct transcode_rung *p_rungs; /**< rungs after the first */
+             size_t i_rungs;
+             vlc_tick_t i_key_origin; /**< date of the first picture */
+             vlc_tick_t i_key_next; /**< next keyframe on the grid */
+             size_t i_key_time; /**< next keyframe in the list */
          };
          struct
          {
@@ -206,7 +225,7 @@ int  transcode_audio_init   ( sout_stream_t *, const es_format_t *,
 
 /* VIDEO */
 
-void transcode_video_clean  ( sout_stream_id_sys_t * );
+void transcode_video_clean  ( sout_stream_t *, sout_stream_id_sys_t * );
 int  transcode_video_process( sout_stream_t *, sout_stream_id_sys_t *,
                                      block_t *, block_t ** );
 int transcode_video_get_output_dimensions( sout_stream_id_sys_t *,
@@ -166,6 +166,137 @@ static picture_t *transcode_dequeue_all_pics( sout_stream_id_sys_t *id )
     return p_pics;
 }
 
+static void transcode_video_rungs_clean( sout_stream_t *p_stream,
+                                        sout_stream_id_sys_t *id )
+{
+    for( size_t i = 0; i < id->i_rungs; i++ )
+    {
+        struct transcode_rung *p_rung = &id->p_rungs[i];
+
+        transcode_encoder_close( p_rung->encoder );
+        transcode_encoder_delete( p_rung->encoder );
+        if( p_rung->downstream_id )
+            sout_StreamIdDel( p_stream->p_next, p_rung->downstream_id );
+    }
+    free( id->p_rungs );
+    id->p_rungs = NULL;
+    id->i_rungs = 0;
+}
+
+/* Creates the encoders of the ladder rungs after the first one, which uses
+ * the main encoder. The codec was already tested with the latter. */
+static int transcode_video_rungs_init( sout_stream_t *p_stream,
+                                       sout_stream_id_sys_t *id,
+                                       const es_format_t *p_fmt_in )
+{
+    const sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    id->p_rungs = NULL;
+    id->i_rungs = 0;
+    if( p_sys->i_ladder < 2 )
+        return VLC_SUCCESS;
+
+    id->p_rungs = vlc_alloc( p_sys->i_ladder - 1, sizeof(*id->p_rungs) );
+    if( unlikely(id->p_rungs == NULL) )
+        return VLC_ENOMEM;
+
+    for( size_t i = 1; i < p_sys->i_ladder; i++ )
+    {
+        struct transcode_rung *p_rung = &id->p_rungs[id->i_rungs];
+        struct encoder_owner *p_enc_owner =
+            (struct encoder_owner *)sout_EncoderCreate( p_stream, sizeof(*p_enc_owner) );
+        if( unlikely(p_enc_owner == NULL) )
+            goto error;
+
+        p_enc_owner->id = id;
+        p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
+
+        p_rung->p_enccfg = &p_sys->p_ladder[i];
+        p_rung->downstream_id = NULL;
+        p_rung->encoder = transcode_encoder_new( &p_enc_owner->enc, p_fmt_in );
+        if( p_rung->encoder == NULL )
+            goto error;
+        id->i_rungs++;
+    }
+    return VLC_SUCCESS;
+
+error:
+    transcode_video_rungs_clean( p_stream, id );
+    return VLC_EGENERIC;
+}
+
+/* Adds the output of a ladder rung, with an ES ID and description telling
+ * the renditions apart */
+static void *transcode_video_rung_add( sout_stream_t *p_stream,
+                                       sout_stream_id_sys_t *id,
+                                       const transcode_encoder_t *encoder,
+                                       size_t i_index )
+{
+    /* shallow copies, only read from */
+    es_format_t orig = id->p_decoder->fmt_in;
+    es_format_t fmt = *transcode_encoder_format_out( encoder );
+    char psz_desc[32];
+
+    if( orig.i_id >= 0 )
+        orig.i_id += i_index * TRANSCODE_LADDER_ID_STEP;
+    snprintf( psz_desc, sizeof(psz_desc), "%ux%u %ukb/s",
+              fmt.video.i_visible_width, fmt.video.i_visible_height,
+              fmt.i_bitrate / 1000 );
+    fmt.psz_description = psz_desc;
+
+    return id->pf_transcode_downstream_add( p_stream, &orig, &fmt );
+}
+
+/* Opens the encoders of the ladder rungs (after the first one) */
+static int transcode_video_rungs_open( sout_stream_t *p_stream,
+                                       sout_stream_id_sys_t *id,
+                                       picture_t *p_pic )
+{
+    for( size_t i = 0; i < id->i_rungs; i++ )
+    {
+        struct transcode_rung *p_rung = &id->p_rungs[i];
+
+        if( transcode_encoder_opened( p_rung->encoder ) )
+            continue;
+
+        transcode_encoder_video_configure( VLC_OBJECT(p_stream),
+                                           &id->p_decoder->fmt_out.video,
+                                           p_rung->p_enccfg,
+                                           &p_pic->format,
+                                           picture_GetVideoContext(p_pic),
+                                           p_rung->encoder );
+
+        if( transcode_encoder_open( p_rung->encoder, p_rung->p_enccfg ) )
+        {
+            msg_Err( p_stream, "cannot open video encoder for rendition %zu",
+                     i + 1 );
+            return VLC_EGENERIC;
+        }
+
+        if( !p_rung->downstream_id )
+            p_rung->downstream_id =
+                transcode_video_rung_add( p_stream, id, p_rung->encoder, i + 1 );
+        if( !p_rung->downstream_id )
+        {
+            msg_Err( p_stream, "cannot output rendition %zu", i + 1 );
+            return VLC_EGENERIC;
+        }
+    }
+    return VLC_SUCCESS;
+}
+
+static void transcode_video_rung_send( sout_stream_t *p_stream,
+                                       const struct transcode_rung *p_rung,
+                                       block_t *p_out )
+{
+    if( p_out == NULL )
+        return;
+    if( p_rung->downstream_id )
+        sout_StreamIdSend( p_stream->p_next, p_rung->downstream_id, p_out );
+    else
+        block_ChainRelease( p_out );
+}
+
 int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
                           sout_stream_id_sys_t *id )
 {
@@ -176,6 +307,9 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
     id->fifo.pic.first = NULL;
     id->fifo.pic.last = &id->fifo.pic.first;
     id->b_transcode = true;
+    id->i_key_origin = VLC_TICK_INVALID;
+    id->i_key_next = 0;
+    id->i_key_time = 0;
     es_format_Init( &id->decoder_out, VIDEO_ES, 0 );
 
     /* Open decoder
@@ -249,6 +383,13 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
     /* Will use this format as encoder input for now */
     transcode_encoder_update_format_in( id->encoder, &encoder_tested_fmt_in );
 
+    if( transcode_video_rungs_init( p_stream, id, &encoder_tested_fmt_in ) )
+    {
+        transcode_encoder_delete( id->encoder );
+        id->encoder = NULL;
+        goto error;
+    }
+
     es_format_Clean( &encoder_tested_fmt_in );
 
     return VLC_SUCCESS;
@@ -371,8 +512,10 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
         src_ctx = filter_chain_GetVideoCtxOut( id->p_f_chain );
     }
 
-    /* Chroma and other conversions */
-    if( transcode_video_set_conversions( p_stream, id, &p_src, &src_ctx, p_dst,
+    /* Chroma and other conversions, unless each ladder rung converts the
+     * pictures on its encoder thread (no destination format) */
+    if( p_dst != NULL &&
+        transcode_video_set_conversions( p_stream, id, &p_src, &src_ctx, p_dst,
                                          p_cfg->video.b_reorient ) != VLC_SUCCESS )
         return VLC_EGENERIC;
 
@@ -383,14 +526,16 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
         id->p_uf_chain = filter_chain_NewVideo( p_stream, true, &owner );
         if(!id->p_uf_chain)
             return VLC_EGENERIC;
-        filter_chain_Reset( id->p_uf_chain, p_src, src_ctx, p_dst );
+        filter_chain_Reset( id->p_uf_chain, p_src, src_ctx,
+                            p_dst ? p_dst : p_src );
         filter_chain_AppendFromString( id->p_uf_chain, p_cfg->psz_filters );
         p_src = filter_chain_GetFmtOut( id->p_uf_chain );
         debug_format( p_stream, p_src );
    }
 
     /* Update encoder so it matches filters output */
-    transcode_encoder_update_format_in( id->encoder, p_src );
+    if( p_dst != NULL )
+        transcode_encoder_update_format_in( id->encoder, p_src );
 
     /* SPU Sources */
     if( p_cfg->video.psz_spu_sources )
@@ -402,11 +547,12 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
     return VLC_SUCCESS;
 }
 
-void transcode_video_clean( sout_stream_id_sys_t *id )
+void transcode_video_clean( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
 {
-    /* Close encoder */
+    /* Close encoders */
     transcode_encoder_close( id->encoder );
     transcode_encoder_delete( id->encoder );
+    transcode_video_rungs_clean( p_stream, id );
 
     es_format_Clean( &id->decoder_out );
 
@@ -474,8 +620,11 @@ static picture_t * RenderSubpictures( sout_stream_id_sys_t *id, picture_t *p_pic
         if( filter_chain_IsEmpty( id->p_f_chain ) )
         {
             /* We can't modify the picture, we need to duplicate it,
-                 * in this point the picture is already p_encoder->fmt.in format*/
-            picture_t *p_tmp = video_new_buffer_encoder( id->encoder );
+                 * in this point the picture is already p_encoder->fmt.in format
+                 * unless the ladder rungs convert it */
+            picture_t *p_tmp = id->p_enccfg->video.b_convert
+                             ? picture_NewFromFormat( &p_pic->format )
+                             : video_new_buffer_encoder( id->encoder );
             if( likely( p_tmp ) )
             {
                 picture_Copy( p_tmp, p_pic );
@@ -506,12 +655,49 @@ static void tag_last_block_with_flag( block_t **out, int i_flag )
     }
 }
 
+/* Flags the pictures that must start a GOP, on the time grid and at the
+ * listed times, both counted from the first picture */
+static void transcode_video_mark_keyframe( sout_stream_id_sys_t *id,
+                                           picture_t *p_pic )
+{
+    const transcode_encoder_config_t *p_cfg = id->p_enccfg;
+    const vlc_tick_t i_interval = p_cfg->video.keyframes.i_interval;
+
+    if( i_interval == 0 && p_cfg->video.keyframes.i_times == 0 )
+        return;
+
+    /* filters may hand out recycled pictures */
+    p_pic->b_keyframe = false;
+    if( p_pic->date == VLC_TICK_INVALID )
+        return;
+
+    if( id->i_key_origin == VLC_TICK_INVALID )
+        id->i_key_origin = p_pic->date;
+
+    const vlc_tick_t i_time = p_pic->date - id->i_key_origin;
+
+    if( i_interval > 0 && i_time >= id->i_key_next )
+    {
+        p_pic->b_keyframe = true;
+        id->i_key_next = ( i_time / i_interval + 1 ) * i_interval;
+    }
+
+    while( id->i_key_time < p_cfg->video.keyframes.i_times &&
+           p_cfg->video.keyframes.p_times[id->i_key_time] <= i_time )
+    {
+        p_pic->b_keyframe = true;
+        id->i_key_time++;
+    }
+}
+
 int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                     block_t *in, block_t **out )
 {
     *out = NULL;
 
     bool b_eos = in && (in->i_flags & BLOCK_FLAG_END_OF_SEQUENCE);
+    /* Ladder: the filtered pictures are scaled on the encoder threads */
+    const bool b_ladder = id->p_enccfg->video.b_convert;
 
     int ret = id->p_decoder->pf_decode( id->p_decoder, in );
     if( ret != VLCDEC_SUCCESS )
@@ -578,6 +764,7 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                                  (id->p_enccfg->video.fps.num > 0),
                                                  &id->decoder_out,
                                                  picture_GetVideoContext(p_pic),
+                                                 b_ladder ? NULL :
                                                  transcode_encoder_format_in( id->encoder ),
                                                  id ) != VLC_SUCCESS )
                     goto error;
@@ -606,7 +793,7 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
 
             /* In case the encoder wasn't open yet, check if we need to add
              * a converter between last user filter and encoder. */
-            if( !is_encoder_open &&
+            if( !is_encoder_open && !b_ladder &&
                 filter_fmt_out.i_codec != encoder_fmt_in->i_codec )
             {
                 if ( !id->p_final_conv_static )
@@ -626,16 +813,20 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                transcode_encoder_format_in( id->encoder )->video.i_height );
 
             if( !id->downstream_id )
-                id->downstream_id =
-                    id->pf_transcode_downstream_add( p_stream,
-                                                     &id->p_decoder->fmt_in,
-                                                     transcode_encoder_format_out( id->encoder ) );
+                id->downstream_id = b_ladder
+                    ? transcode_video_rung_add( p_stream, id, id->encoder, 0 )
+                    : id->pf_transcode_downstream_add( p_stream,
+                                                       &id->p_decoder->fmt_in,
+                                                       transcode_encoder_format_out( id->encoder ) );
             if( !id->downstream_id )
             {
                 msg_Err( p_stream, "cannot output transcoded stream %4.4s",
                                    (char *) &id->p_enccfg->i_codec );
                 goto error;
             }
+
+            if( transcode_video_rungs_open( p_stream, id, p_pic ) != VLC_SUCCESS )
+                goto error;
         }
 
         /* Run the filter and output chains; first with the picture,
@@ -678,6 +869,21 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
 
                 if( p_in )
                 {
+                    /* before cloning, so that all rungs align */
+                    transcode_video_mark_keyframe( id, p_in );
+
+                    /* Each rung queues its own shallow clone: a picture can
+                     * only sit in one encoder FIFO at a time */
+                    for( size_t i = 0; i < id->i_rungs; i++ )
+                    {
+                        picture_t *p_clone = picture_Clone( p_in );
+                        if( unlikely(p_clone == NULL) )
+                            continue;
+                        picture_CopyProperties( p_clone, p_in );
+                        transcode_encoder_encode( id->p_rungs[i].encoder, p_clone );
+                        picture_Release( p_clone );
+                    }
+
                     block_t *p_encoded = transcode_encoder_encode( id->encoder, p_in );
                     if( p_encoded )
                         block_ChainAppend( out, p_encoded );
@@ -699,6 +905,15 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
             transcode_remove_filters( &id->p_uf_chain );
             transcode_remove_filters( &id->p_final_conv_static );
             tag_last_block_with_flag( out, BLOCK_FLAG_END_OF_SEQUENCE );
+            for( size_t i = 0; i < id->i_rungs; i++ )
+            {
+                block_t *p_drained = NULL;
+
+                transcode_encoder_drain( id->p_rungs[i].encoder, &p_drained );
+                transcode_encoder_close( id->p_rungs[i].encoder );
+                tag_last_block_with_flag( &p_drained, BLOCK_FLAG_END_OF_SEQUENCE );
+                transcode_video_rung_send( p_stream, &id->p_rungs[i], p_drained );
+            }
             b_eos = false;
         }
 
@@ -709,10 +924,13 @@ error:
         id->b_error = true;
     } while( p_pics );
 
-    if( id->p_enccfg->video.threads.i_count >= 1 )
+    if( id->p_enccfg->video.threads.i_count >= 1 || b_ladder )
     {
         /* Pick up any return data the encoder thread wants to output. */
         block_ChainAppend( out, transcode_encoder_get_output_async( id->encoder ) );
+        for( size_t i = 0; i < id->i_rungs; i++ )
+            transcode_video_rung_send( p_stream, &id->p_rungs[i],
+                transcode_encoder_get_output_async( id->p_rungs[i].encoder ) );
     }
 
     /* Drain encoder */
@@ -723,6 +941,14 @@ error:
             msg_Dbg( p_stream, "Flushing done");
         else
             msg_Warn( p_stream, "Flushing failed");
+
+        for( size_t i = 0; i < id->i_rungs; i++ )
+        {
+            block_t *p_drained = NULL;
+
+            transcode_encoder_drain( id->p_rungs[i].encoder, &p_drained );
+            transcode_video_rung_send( p_stream, &id->p_rungs[i], p_drained );
+        }
     }
 
     if( b_eos )
@@ -329,6 +329,15 @@ stream_t *stream_AccessNew(vlc_object_t *parent, input_thread_t *input,
         s->pf_control = AStreamControl;
         s->p_sys = access;
 
+        /* Keep the data already fetched for backward seeks. Block accesses
+         * are left to the block cache. */
+        if (access->pf_block == NULL)
+        {
+            stream_t *cache = vlc_stream_FilterNew(s, "cache_range");
+            if (cache != NULL)
+                s = cache;
+        }
+
         s = stream_FilterChainNew(s, "prefetch,cache");
     }
     else
@@ -42,12 +42,14 @@
 #include <vlc_dialog.h>
 #include <vlc_modules.h>
 #include <vlc_decoder.h>
+#include <vlc_interrupt.h>
 #include <vlc_picture_pool.h>
 
 #include "audio_output/aout_internal.h"
 #include "stream_output/stream_output.h"
 #include "../clock/clock.h"
 #include "decoder.h"
+#include "decoder_fifo.h"
 #include "resource.h"
 #include "libvlc.h"
 
@@ -96,6 +98,21 @@ struct vlc_input_decoder_t
     /* fifo */
     block_fifo_t *p_fifo;
 
+    /* Fifo budgets and statistics, protected by the fifo lock */
+    struct
+    {
+        size_t max_bytes; /* 0 if unlimited */
+        vlc_tick_t max_length; /* 0 if unlimited */
+        bool can_block; /* block the demuxer instead of dropping */
+
+        struct decoder_fifo_length length;
+
+        size_t peak_bytes;
+        unsigned blocked;
+        vlc_tick_t waited;
+        unsigned dropped;
+    } fifo;
+
     /* Lock for communication with decoder thread */
     vlc_mutex_t lock;
     vlc_cond_t  wait_request;
@@ -194,6 +211,21 @@ static inline vlc_input_decoder_t *dec_get_owner( decoder_t *p_dec )
     return container_of( p_dec, vlc_input_decoder_t, dec );
 }
 
+/**
+ * Checks if the fifo exceeds its size or duration budget.
+ * The fifo must be locked.
+ */
+static bool DecoderFifoIsFull( const vlc_input_decoder_t *p_owner )
+{
+    if( p_owner->fifo.max_bytes != 0
+     && vlc_fifo_GetBytes( p_owner->p_fifo ) > p_owner->fifo.max_bytes )
+        return true;
+    if( p_owner->fifo.max_length != 0
+     && p_owner->fifo.length.length > p_owner->fifo.max_length )
+        return true;
+    return false;
+}
+
 /**
  * Load a decoder module
  */
@@ -1019,6 +1051,8 @@ static int ModuleThread_PlayVideo( vlc_input_decoder_t *p_owner, picture_t *p_pi
     if( prerolled && p_owner->i_preroll_end > p_picture->date )
     {
         vlc_mutex_unlock( &p_owner->lock );
+        if( p_vout )
+            vout_NotifyDroppedPicture( p_vout, p_picture->date );
         picture_Release( p_picture );
         return VLC_SUCCESS;
     }
@@ -1468,6 +1502,12 @@ static void DecoderThread_Flush( vlc_input_decoder_t *p_owner )
     {
         if( p_owner->p_vout )
             vout_FlushAll( p_owner->p_vout );
+
+        /* Batched thumbnails seek the same input: the next picture after
+         * the flush is a new thumbnail, even if the es_out is still
+         * buffering and won't restart the wait */
+        if( p_dec->cbs->video.queue == ModuleThread_QueueThumbnail )
+            p_owner->b_first = true;
     }
     else if( p_dec->fmt_out.i_cat == SPU_ES )
     {
@@ -1667,7 +1707,13 @@ static void *DecoderThread( void *p_data )
         vlc_cond_signal( &p_owner->wait_fifo );
 
         block_t *p_block = vlc_fifo_DequeueUnlocked( p_owner->p_fifo );
-        if( p_block == NULL )
+        if( p_block != NULL )
+        {
+            decoder_fifo_length_Dequeue( &p_owner->fifo.length, p_block );
+            decoder_Notify( p_owner, on_new_fifo_stats, 0, p_block->i_buffer,
+                            0, 0 );
+        }
+        else
         {
             if( likely(!p_owner->b_draining) )
             {   /* Wait for a block to decode (or a request to drain) */
@@ -1820,6 +1866,17 @@ CreateDecoder( vlc_object_t *p_parent,
         return NULL;
     }
 
+    p_owner->fifo.max_bytes =
+        (size_t)var_InheritInteger( p_dec, "decoder-fifo-size" ) * 1024;
+    p_owner->fifo.max_length =
+        VLC_TICK_FROM_MS( var_InheritInteger( p_dec, "decoder-fifo-length" ) );
+    p_owner->fifo.can_block = false;
+    decoder_fifo_length_Reset( &p_owner->fifo.length );
+    p_owner->fifo.peak_bytes = 0;
+    p_owner->fifo.blocked = 0;
+    p_owner->fifo.waited = 0;
+    p_owner->fifo.dropped = 0;
+
     vlc_mutex_init( &p_owner->lock );
     vlc_mutex_init( &p_owner->mouse_lock );
     vlc_cond_init( &p_owner->wait_request );
@@ -1924,7 +1981,17 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
     if (p_owner->vctx)
         vlc_video_context_Release( p_owner->vctx );
 
+    if( p_owner->fifo.blocked > 0 || p_owner->fifo.dropped > 0 )
+        msg_Dbg( p_dec, "fifo peaked at %zu bytes, demuxer blocked %u times "
+                 "(%"PRId64" ms), %u resets", p_owner->fifo.peak_bytes,
+                 p_owner->fifo.blocked, MS_FROM_VLC_TICK(p_owner->fifo.waited),
+                 p_owner->fifo.dropped );
+
     /* Free all packets still in the decoder fifo. */
+    vlc_fifo_Lock( p_owner->p_fifo );
+    decoder_Notify( p_owner, on_new_fifo_stats, 0,
+                    vlc_fifo_GetBytes( p_owner->p_fifo ), 0, 0 );
+    vlc_fifo_Unlock( p_owner->p_fifo );
     block_FifoRelease( p_owner->p_fifo );
 
     /* Cleanup */
@@ -2188,14 +2255,32 @@ void vlc_input_decoder_Decode( vlc_input_decoder_t *p_owner, block_t *p_block,
     vlc_fifo_Lock( p_owner->p_fifo );
     if( !b_do_pace )
     {
-        /* FIXME: ideally we would check the time amount of data
-         * in the FIFO instead of its size. */
-        /* 400 MiB, i.e. ~ 50mb/s for 60s */
-        if( vlc_fifo_GetBytes( p_owner->p_fifo ) > 400*1024*1024 )
+        /* The FIFO is not consumed when waiting or paused, so blocking
+         * would deadlock VLC. */
+        if( p_owner->fifo.can_block && !p_owner->b_waiting
+         && !p_owner->paused && DecoderFifoIsFull( p_owner ) )
+        {
+            vlc_tick_t start = vlc_tick_now();
+
+            /* Wake up regularly in case the input is being stopped */
+            while( DecoderFifoIsFull( p_owner ) && !vlc_killed() )
+                vlc_fifo_TimedWaitCond( p_owner->p_fifo, &p_owner->wait_fifo,
+                                        vlc_tick_now() + VLC_TICK_FROM_MS(50) );
+
+            vlc_tick_t waited = vlc_tick_now() - start;
+            p_owner->fifo.blocked++;
+            p_owner->fifo.waited += waited;
+            decoder_Notify( p_owner, on_new_fifo_stats, 0, 0, waited, 0 );
+        }
+        else if( DecoderFifoIsFull( p_owner ) )
         {
             msg_Warn( &p_owner->dec, "decoder/packetizer fifo full (data not "
                       "consumed quickly enough), resetting fifo!" );
+            size_t dropped = vlc_fifo_GetBytes( p_owner->p_fifo );
             block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+            decoder_fifo_length_Reset( &p_owner->fifo.length );
+            p_owner->fifo.dropped++;
+            decoder_Notify( p_owner, on_new_fifo_stats, 0, dropped, 0, 1 );
             p_block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
         }
     }
@@ -2208,7 +2293,35 @@ void vlc_input_decoder_Decode( vlc_input_decoder_t *p_owner, block_t *p_block,
             vlc_fifo_WaitCond( p_owner->p_fifo, &p_owner->wait_fifo );
     }
 
+    decoder_fifo_length_Queue( &p_owner->fifo.length, p_block );
+    decoder_Notify( p_owner, on_new_fifo_stats, p_block->i_buffer, 0, 0, 0 );
+
     vlc_fifo_QueueUnlocked( p_owner->p_fifo, p_block );
+
+    size_t bytes = vlc_fifo_GetBytes( p_owner->p_fifo );
+    if( bytes > p_owner->fifo.peak_bytes )
+        p_owner->fifo.peak_bytes = bytes;
+    vlc_fifo_Unlock( p_owner->p_fifo );
+}
+
+void vlc_input_decoder_SetFifoBlocking( vlc_input_decoder_t *p_owner,
+                                        bool can_block )
+{
+    vlc_fifo_Lock( p_owner->p_fifo );
+    p_owner->fifo.can_block = can_block;
+    vlc_fifo_Unlock( p_owner->p_fifo );
+}
+
+void vlc_input_decoder_GetFifoStats( vlc_input_decoder_t *p_owner,
+                                     struct vlc_input_decoder_fifo_stats *st )
+{
+    vlc_fifo_Lock( p_owner->p_fifo );
+    st->bytes = vlc_fifo_GetBytes( p_owner->p_fifo );
+    st->length = p_owner->fifo.length.length;
+    st->peak_bytes = p_owner->fifo.peak_bytes;
+    st->blocked = p_owner->fifo.blocked;
+    st->waited = p_owner->fifo.waited;
+    st->dropped = p_owner->fifo.dropped;
     vlc_fifo_Unlock( p_owner->p_fifo );
 }
 
@@ -2268,7 +2381,10 @@ void vlc_input_decoder_Flush( vlc_input_decoder_t *p_owner )
     vlc_fifo_Lock( p_owner->p_fifo );
 
     /* Empty the fifo */
+    decoder_Notify( p_owner, on_new_fifo_stats, 0,
+                    vlc_fifo_GetBytes( p_owner->p_fifo ), 0, 0 );
     block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+    decoder_fifo_length_Reset( &p_owner->fifo.length );
 
     /* Don't need to wait for the DecoderThread to flush. Indeed, if called a
      * second time, this function will clear the FIFO again before anything was
@@ -43,6 +43,9 @@ struct vlc_input_decoder_callbacks {
                                void *userdata);
     void (*on_new_audio_stats)(vlc_input_decoder_t *decoder, unsigned decoded,
                                unsigned lost, unsigned played, void *userdata);
+    void (*on_new_fifo_stats)(vlc_input_decoder_t *decoder, size_t queued,
+                              size_t dequeued, vlc_tick_t waited,
+                              unsigned dropped, void *userdata);
 
     /* requests */
     int (*get_attachments)(vlc_input_decoder_t *decoder,
@@ -56,6 +59,34 @@ vlc_input_decoder_New( vlc_object_t *parent, es_format_t *, vlc_clock_t *,
                        const struct vlc_input_decoder_callbacks *cbs,
                        void *userdata ) VLC_USED;
 
+/**
+ * Selects what happens when the decoder fifo exceeds its budget
+ * ("decoder-fifo-size" and "decoder-fifo-length") in non-paced mode.
+ *
+ * \param can_block true to block vlc_input_decoder_Decode() until the
+ * decoder catches up, false to reset the fifo
+ */
+void vlc_input_decoder_SetFifoBlocking( vlc_input_decoder_t *, bool can_block );
+
+/**
+ * Decoder fifo statistics
+ */
+struct vlc_input_decoder_fifo_stats
+{
+    size_t bytes; /**< data currently queued */
+    vlc_tick_t length; /**< duration of the data currently queued */
+    size_t peak_bytes; /**< highest amount of data queued */
+    unsigned blocked; /**< times the demuxer was blocked */
+    vlc_tick_t waited; /**< total time the demuxer was blocked */
+    unsigned dropped; /**< number of fifo resets */
+};
+
+/**
+ * Gets the fifo statistics of a decoder.
+ */
+void vlc_input_decoder_GetFifoStats( vlc_input_decoder_t *,
+                                     struct vlc_input_decoder_fifo_stats * );
+
 /**
  * This function changes the pause state.
  * The date parameter MUST hold the exact date at which the change has been
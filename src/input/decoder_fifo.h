@@ -0,0 +1,82 @@
+/*****************************************************************************
+ * decoder_fifo.h: duration of the data queued to a decoder
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_INPUT_DECODER_FIFO_H
+#define LIBVLC_INPUT_DECODER_FIFO_H 1
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+
+/**
+ * Duration of the blocks in a decoder fifo.
+ *
+ * Each block counts for its length if known, or else for the time elapsed
+ * since the previous block. Nothing is counted across a discontinuity, so
+ * that a timestamp jump does not make the fifo look full. The duration of a
+ * block is computed again when it is dequeued, in the same order, so that
+ * exactly what was added is removed.
+ */
+struct decoder_fifo_length
+{
+    vlc_tick_t length;
+    vlc_tick_t in_date; /* date of the last queued block */
+    vlc_tick_t out_date; /* date of the last dequeued block */
+};
+
+static inline void decoder_fifo_length_Reset( struct decoder_fifo_length *f )
+{
+    f->length = 0;
+    f->in_date = f->out_date = VLC_TICK_INVALID;
+}
+
+static inline vlc_tick_t decoder_fifo_length_Block( vlc_tick_t *prev,
+                                                    const block_t *block )
+{
+    vlc_tick_t date = block->i_dts != VLC_TICK_INVALID ? block->i_dts
+                                                       : block->i_pts;
+    vlc_tick_t length = 0;
+
+    if( block->i_length > 0 )
+        length = block->i_length;
+    else if( date != VLC_TICK_INVALID && *prev != VLC_TICK_INVALID
+          && date > *prev
+          && !(block->i_flags & BLOCK_FLAG_DISCONTINUITY) )
+        length = date - *prev;
+
+    if( date != VLC_TICK_INVALID )
+        *prev = date;
+    return length;
+}
+
+static inline void decoder_fifo_length_Queue( struct decoder_fifo_length *f,
+                                              const block_t *block )
+{
+    f->length += decoder_fifo_length_Block( &f->in_date, block );
+}
+
+static inline void decoder_fifo_length_Dequeue( struct decoder_fifo_length *f,
+                                                const block_t *block )
+{
+    vlc_tick_t length = decoder_fifo_length_Block( &f->out_date, block );
+
+    f->length = length < f->length ? f->length - length : 0;
+}
+
+#endif
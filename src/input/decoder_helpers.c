@@ -26,6 +26,8 @@
 # include "config.h"
 #endif
 
+#include <assert.h>
+
 #include <vlc_common.h>
 #include <vlc_codec.h>
 #include <vlc_atomic.h>
@@ -76,6 +78,54 @@ void decoder_Destroy( decoder_t *p_dec )
     }
 }
 
+/* Process-wide decoding thread budget */
+static struct
+{
+    vlc_mutex_t lock;
+    unsigned used; /* threads in use */
+    unsigned users; /* decoders holding threads */
+} dec_threads = { VLC_STATIC_MUTEX, 0, 0 };
+
+unsigned decoder_AcquireThreads( decoder_t *dec, unsigned wanted )
+{
+    unsigned budget = var_InheritInteger( dec, "dec-threads" );
+    unsigned granted = wanted > 0 ? wanted : 1;
+
+    vlc_mutex_lock( &dec_threads.lock );
+    if( budget != 0 )
+    {
+        unsigned share = budget / (dec_threads.users + 1);
+        unsigned avail = budget > dec_threads.used ? budget - dec_threads.used
+                                                   : 0;
+
+        if( granted > share )
+            granted = share;
+        if( granted > avail )
+            granted = avail;
+        if( granted == 0 )
+            granted = 1;
+    }
+    dec_threads.used += granted;
+    dec_threads.users++;
+    vlc_mutex_unlock( &dec_threads.lock );
+
+    if( granted < wanted )
+        msg_Dbg( dec, "decoding thread budget: %u of %u thread(s) granted",
+                 granted, wanted );
+    return granted;
+}
+
+void decoder_ReleaseThreads( decoder_t *dec, unsigned count )
+{
+    VLC_UNUSED(dec);
+
+    vlc_mutex_lock( &dec_threads.lock );
+    assert( dec_threads.used >= count && dec_threads.users > 0 );
+    dec_threads.used -= count;
+    dec_threads.users--;
+    vlc_mutex_unlock( &dec_threads.lock );
+}
+
 int decoder_UpdateVideoFormat( decoder_t *dec )
 {
     return decoder_UpdateVideoOutput( dec, NULL );
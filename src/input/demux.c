@@ -138,6 +138,70 @@ static const char* DemuxNameFromExtension( char const* ext,
     return result ? result->name : NULL;
 }
 
+typedef const struct
+{
+    char const head[4]; /* magic bytes at the start of the stream */
+    uint8_t offset;
+    char const tag[4]; /* magic bytes at the given offset, if not empty */
+    char const name[8];
+
+} demux_signature;
+
+static const char *DemuxNameFromSignature( stream_t *s )
+{
+    /* NOTE: Add only signatures that no higher priority demux may claim:
+     * - no RIFF WAVE (a52 and dts as raw audio in them)
+     * - no ID3 tag, no playlist (HLS is handled by adaptive)
+     */
+    static demux_signature signatures[] =
+    {
+        { "\x1A\x45\xDF\xA3", 0, "",     "mkv" },
+        { "\x30\x26\xB2\x75", 0, "",     "asf" },
+        { ".snd",             0, "",     "au" },
+        { "Crea",             4, "tive", "voc" },
+        { "FORM",             8, "AIFC", "aiff" },
+        { "FORM",             8, "AIFF", "aiff" },
+        { "MThd",             0, "",     "smf" },
+        { "NSVf",             0, "",     "nsv" },
+        { "NSVs",             0, "",     "nsv" },
+        { "OggS",             0, "",     "ogg" },
+        { "RIFF",             8, "AVI ", "avi" },
+        { "\x00\x00\x01\xBA", 0, "",     "ps" },
+        { "caff",             0, "",     "caf" },
+        { "fLaC",             0, "",     "flac" },
+    };
+
+    const uint8_t *peek;
+    ssize_t size = vlc_stream_Peek( s, &peek, 3 * 188 + 16 );
+    if( size < 4 )
+        return NULL;
+
+    for( size_t i = 0; i < ARRAY_SIZE( signatures ); i++ )
+    {
+        demux_signature *sig = &signatures[i];
+
+        if( memcmp( peek, sig->head, 4 ) )
+            continue;
+        if( sig->tag[0] != '\0'
+         && ( size < sig->offset + 4
+           || memcmp( peek + sig->offset, sig->tag, 4 ) ) )
+            continue;
+        return sig->name;
+    }
+
+    /* Three consecutive TS (or M2TS) packets */
+    for( size_t skip = 0; skip <= 4; skip += 4 )
+    {
+        size_t packet = 188 + skip;
+
+        if( (size_t)size > 2 * packet + skip
+         && peek[skip] == 0x47 && peek[packet + skip] == 0x47
+         && peek[2 * packet + skip] == 0x47 )
+            return "ts";
+    }
+    return NULL;
+}
+
 demux_t *demux_New( vlc_object_t *p_obj, const char *psz_name,
                     stream_t *s, es_out_t *out )
 {
@@ -183,6 +247,13 @@ static int demux_Probe(void *func, bool forced, va_list ap)
     return ret;
 }
 
+static int demux_ProbeHint(void *func, bool forced, va_list ap)
+{
+    /* A signature match is only a hint: the demux shall check its input */
+    (void) forced;
+    return demux_Probe(func, false, ap);
+}
+
 demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
                             const char *psz_demux, const char *url,
                             stream_t *s, es_out_t *out, bool b_preparsing )
@@ -242,11 +313,24 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
             psz_module = DemuxNameFromExtension( psz_ext + 1, b_preparsing );
     }
 
+    priv->module = NULL;
+
+    if( psz_module == NULL && !strcmp( p_demux->psz_name, "any" ) )
+    {   /* Try the demux matching the stream signature first, it saves probing
+         * all the higher priority ones. */
+        const char *psz_hint = DemuxNameFromSignature( s );
+
+        if( psz_hint != NULL )
+            priv->module = vlc_module_load(p_demux, "demux", psz_hint, true,
+                                           demux_ProbeHint, p_demux);
+    }
+
     if( psz_module == NULL )
         psz_module = p_demux->psz_name;
 
-    priv->module = vlc_module_load(p_demux, "demux", psz_module,
-        !strcmp(psz_module, p_demux->psz_name), demux_Probe, p_demux);
+    if( priv->module == NULL )
+        priv->module = vlc_module_load(p_demux, "demux", psz_module,
+            !strcmp(psz_module, p_demux->psz_name), demux_Probe, p_demux);
 
     if (priv->module == NULL)
     {
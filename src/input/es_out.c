@@ -394,6 +394,42 @@ decoder_on_new_audio_stats(vlc_input_decoder_t *decoder, unsigned decoded, unsig
                               memory_order_relaxed);
 }
 
+static void
+decoder_on_new_fifo_stats(vlc_input_decoder_t *decoder, size_t queued,
+                          size_t dequeued, vlc_tick_t waited, unsigned dropped,
+                          void *userdata)
+{
+    (void) decoder;
+
+    es_out_id_t *id = userdata;
+    es_out_t *out = id->out;
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    if (!p_sys->p_input)
+        return;
+
+    struct input_stats *stats = input_priv(p_sys->p_input)->stats;
+    if (!stats)
+        return;
+
+    if (queued > 0)
+        atomic_fetch_add_explicit(&stats->decoder_fifo_in, queued,
+                                  memory_order_relaxed);
+    if (dequeued > 0)
+        atomic_fetch_add_explicit(&stats->decoder_fifo_out, dequeued,
+                                  memory_order_relaxed);
+    if (waited > 0)
+    {
+        atomic_fetch_add_explicit(&stats->decoder_fifo_blocked, 1,
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&stats->decoder_fifo_waited, waited,
+                                  memory_order_relaxed);
+    }
+    if (dropped > 0)
+        atomic_fetch_add_explicit(&stats->decoder_fifo_dropped, dropped,
+                                  memory_order_relaxed);
+}
+
 static int
 decoder_get_attachments(vlc_input_decoder_t *decoder,
                         input_attachment_t ***ppp_attachment,
@@ -417,6 +453,7 @@ static const struct vlc_input_decoder_callbacks decoder_cbs = {
     .on_thumbnail_ready = decoder_on_thumbnail_ready,
     .on_new_video_stats = decoder_on_new_video_stats,
     .on_new_audio_stats = decoder_on_new_audio_stats,
+    .on_new_fifo_stats = decoder_on_new_fifo_stats,
     .get_attachments = decoder_get_attachments,
 };
 
@@ -2186,6 +2223,7 @@ static void EsOutCreateDecoder( es_out_t *out, es_out_id_t *p_es )
     if( dec != NULL )
     {
         vlc_input_decoder_ChangeRate( dec, p_sys->rate );
+        vlc_input_decoder_SetFifoBlocking( dec, priv->b_can_pace_control );
 
         if( p_sys->b_buffering )
             vlc_input_decoder_StartWait( dec );
@@ -3418,6 +3456,28 @@ static int EsOutVaControlLocked( es_out_t *out, input_source_t *source,
         return VLC_SUCCESS;
     }
 
+    case ES_OUT_ADD_TRANSPORT_STATS:
+    {
+        unsigned lost = va_arg( args, unsigned );
+        unsigned reordered = va_arg( args, unsigned );
+        unsigned late = va_arg( args, unsigned );
+        unsigned recovered = va_arg( args, unsigned );
+
+        struct input_stats *stats = input_priv(p_sys->p_input)->stats;
+        if( stats == NULL )
+            return VLC_EGENERIC;
+
+        atomic_fetch_add_explicit( &stats->demux_lost, lost,
+                                   memory_order_relaxed );
+        atomic_fetch_add_explicit( &stats->demux_reordered, reordered,
+                                   memory_order_relaxed );
+        atomic_fetch_add_explicit( &stats->demux_late, late,
+                                   memory_order_relaxed );
+        atomic_fetch_add_explicit( &stats->demux_recovered, recovered,
+                                   memory_order_relaxed );
+        return VLC_SUCCESS;
+    }
+
     case ES_OUT_VOUT_SET_MOUSE_EVENT:
     {
         es_out_id_t *p_es = va_arg( args, es_out_id_t * );
@@ -3613,6 +3673,17 @@ static int EsOutVaPrivControlLocked( es_out_t *out, int query, va_list args )
         EsOutSetEsDelay(out, es, delay);
         return VLC_SUCCESS;
     }
+    case ES_OUT_PRIV_GET_ES_FIFO_STATS:
+    {
+        vlc_es_id_t *es_id = va_arg( args, vlc_es_id_t * );
+        es_out_id_t *es = vlc_es_id_get_out( es_id );
+        struct vlc_input_decoder_fifo_stats *st =
+            va_arg( args, struct vlc_input_decoder_fifo_stats * );
+        if( es->p_dec == NULL )
+            return VLC_EGENERIC;
+        vlc_input_decoder_GetFifoStats( es->p_dec, st );
+        return VLC_SUCCESS;
+    }
     case ES_OUT_PRIV_SET_DELAY:
     {
         const int i_cat = va_arg( args, int );
@@ -26,6 +26,8 @@
 
 #include <vlc_common.h>
 
+struct vlc_input_decoder_fifo_stats;
+
 enum es_out_mode_e
 {
     ES_OUT_MODE_NONE,   /* don't select anything */
@@ -92,6 +94,9 @@ enum es_out_query_private_e
     /* Set End Of Stream */
     ES_OUT_PRIV_SET_EOS,                            /* res=cannot fail */
 
+    /* Get the decoder fifo statistics of an ES */
+    ES_OUT_PRIV_GET_ES_FIFO_STATS,                  /* arg1=vlc_es_id_t * arg2=struct vlc_input_decoder_fifo_stats * res=can fail */
+
     /* Set a VBI/Teletext page */
     ES_OUT_PRIV_SET_VBI_PAGE,                       /* arg1=unsigned res=can fail */
 
@@ -187,6 +192,11 @@ static inline void es_out_SetDelay( es_out_t *p_out, int i_cat, vlc_tick_t i_del
     int i_ret = es_out_PrivControl( p_out, ES_OUT_PRIV_SET_DELAY, i_cat, i_delay );
     assert( !i_ret );
 }
+static inline int es_out_GetEsFifoStats( es_out_t *p_out, vlc_es_id_t *es,
+                                         struct vlc_input_decoder_fifo_stats *st )
+{
+    return es_out_PrivControl( p_out, ES_OUT_PRIV_GET_ES_FIFO_STATS, es, st );
+}
 static inline int es_out_SetRecordState( es_out_t *p_out, bool b_record )
 {
     return es_out_PrivControl( p_out, ES_OUT_PRIV_SET_RECORD_STATE, b_record );
@@ -740,6 +740,7 @@ static int ControlLocked( es_out_t *p_out, input_source_t *in, int i_query,
             return VLC_EGENERIC;
         /* fall through */
     case ES_OUT_POST_SUBNODE:
+    case ES_OUT_ADD_TRANSPORT_STATS:
         return es_out_in_vaControl( p_sys->p_out, in, i_query, args );
 
     case ES_OUT_MODIFY_PCR_SYSTEM:
@@ -838,6 +839,7 @@ static int PrivControlLocked( es_out_t *p_tsout, int i_query, va_list args )
     case ES_OUT_PRIV_STOP_ALL_ES:
     case ES_OUT_PRIV_START_ALL_ES:
     case ES_OUT_PRIV_SET_ES_DELAY:
+    case ES_OUT_PRIV_GET_ES_FIFO_STATS:
     case ES_OUT_PRIV_SET_DELAY:
     case ES_OUT_PRIV_SET_RECORD_STATE:
     case ES_OUT_PRIV_SET_VBI_PAGE:
@@ -725,6 +725,10 @@ struct input_stats {
     input_rate_t demux_bitrate;
     atomic_uintmax_t demux_corrupted;
     atomic_uintmax_t demux_discontinuity;
+    atomic_uintmax_t demux_lost;
+    atomic_uintmax_t demux_reordered;
+    atomic_uintmax_t demux_late;
+    atomic_uintmax_t demux_recovered;
     atomic_uintmax_t decoded_audio;
     atomic_uintmax_t decoded_video;
     atomic_uintmax_t played_abuffers;
@@ -732,6 +736,11 @@ struct input_stats {
     atomic_uintmax_t displayed_pictures;
     atomic_uintmax_t late_pictures;
     atomic_uintmax_t lost_pictures;
+    atomic_uintmax_t decoder_fifo_in;
+    atomic_uintmax_t decoder_fifo_out;
+    atomic_uintmax_t decoder_fifo_blocked;
+    atomic_uintmax_t decoder_fifo_waited;
+    atomic_uintmax_t decoder_fifo_dropped;
 };
 
 struct input_stats *input_stats_Create(void);
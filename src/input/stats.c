@@ -61,6 +61,10 @@ struct input_stats *input_stats_Create(void)
     input_rate_Init(&stats->demux_bitrate);
     atomic_init(&stats->demux_corrupted, 0);
     atomic_init(&stats->demux_discontinuity, 0);
+    atomic_init(&stats->demux_lost, 0);
+    atomic_init(&stats->demux_reordered, 0);
+    atomic_init(&stats->demux_late, 0);
+    atomic_init(&stats->demux_recovered, 0);
     atomic_init(&stats->decoded_audio, 0);
     atomic_init(&stats->decoded_video, 0);
     atomic_init(&stats->played_abuffers, 0);
@@ -68,6 +72,11 @@ struct input_stats *input_stats_Create(void)
     atomic_init(&stats->displayed_pictures, 0);
     atomic_init(&stats->late_pictures, 0);
     atomic_init(&stats->lost_pictures, 0);
+    atomic_init(&stats->decoder_fifo_in, 0);
+    atomic_init(&stats->decoder_fifo_out, 0);
+    atomic_init(&stats->decoder_fifo_blocked, 0);
+    atomic_init(&stats->decoder_fifo_waited, 0);
+    atomic_init(&stats->decoder_fifo_dropped, 0);
     return stats;
 }
 
@@ -93,6 +102,14 @@ void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
                                                  memory_order_relaxed);
     st->i_demux_discontinuity = atomic_load_explicit(
                     &stats->demux_discontinuity, memory_order_relaxed);
+    st->i_demux_lost = atomic_load_explicit(&stats->demux_lost,
+                                            memory_order_relaxed);
+    st->i_demux_reordered = atomic_load_explicit(&stats->demux_reordered,
+                                                 memory_order_relaxed);
+    st->i_demux_late = atomic_load_explicit(&stats->demux_late,
+                                            memory_order_relaxed);
+    st->i_demux_recovered = atomic_load_explicit(&stats->demux_recovered,
+                                                 memory_order_relaxed);
 
     /* Aout */
     st->i_decoded_audio = atomic_load_explicit(&stats->decoded_audio,
@@ -111,6 +128,19 @@ void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
                                                     memory_order_relaxed);
     st->i_lost_pictures = atomic_load_explicit(&stats->lost_pictures,
                                                memory_order_relaxed);
+
+    /* Decoder fifos */
+    uintmax_t fifo_out = atomic_load_explicit(&stats->decoder_fifo_out,
+                                              memory_order_relaxed);
+    uintmax_t fifo_in = atomic_load_explicit(&stats->decoder_fifo_in,
+                                             memory_order_relaxed);
+    st->i_decoder_fifo_bytes = fifo_in > fifo_out ? fifo_in - fifo_out : 0;
+    st->i_decoder_fifo_blocked = atomic_load_explicit(
+                    &stats->decoder_fifo_blocked, memory_order_relaxed);
+    st->i_decoder_fifo_waited = atomic_load_explicit(
+                    &stats->decoder_fifo_waited, memory_order_relaxed);
+    st->i_decoder_fifo_dropped = atomic_load_explicit(
+                    &stats->decoder_fifo_dropped, memory_order_relaxed);
 }
 
 /** Update a counter element with new values
@@ -490,6 +490,47 @@ ssize_t vlc_stream_Read(stream_t *s, void *buf, size_t len)
     return copied;
 }
 
+int vlc_stream_ReadRanges(stream_t *s, struct vlc_stream_range *ranges,
+                          size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        ranges[i].read = 0;
+
+    if (count == 0)
+        return VLC_SUCCESS;
+
+    if (vlc_stream_Control(s, STREAM_READ_RANGES, ranges, count)
+         == VLC_SUCCESS)
+        return VLC_SUCCESS;
+
+    /* Emulate with seeks, then return to the current offset */
+    uint64_t offset = vlc_stream_Tell(s);
+    int ret = VLC_SUCCESS;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        struct vlc_stream_range *range = &ranges[i];
+
+        if (vlc_stream_Seek(s, range->offset))
+        {
+            ret = VLC_EGENERIC;
+            break;
+        }
+
+        ssize_t val = vlc_stream_Read(s, range->buf, range->length);
+        if (val < 0)
+        {
+            ret = VLC_EGENERIC;
+            break;
+        }
+        range->read = val;
+    }
+
+    if (vlc_stream_Seek(s, offset))
+        ret = VLC_EGENERIC;
+    return ret;
+}
+
 ssize_t vlc_stream_Peek(stream_t *s, const uint8_t **restrict bufp, size_t len)
 {
     stream_priv_t *priv = (stream_priv_t *)s;
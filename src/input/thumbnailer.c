@@ -25,6 +25,7 @@
 #endif
 
 #include <vlc_thumbnailer.h>
+#include <vlc_image.h>
 #include "input_internal.h"
 #include "misc/background_worker.h"
 
@@ -55,6 +56,16 @@ typedef struct vlc_thumbnailer_params_t
     vlc_tick_t timeout;
     vlc_thumbnailer_cb cb;
     void* user_data;
+
+    /* Batch requests */
+    struct
+    {
+        vlc_tick_t *times; /* NULL for single requests */
+        size_t count;
+        unsigned width;
+        unsigned height;
+        vlc_thumbnailer_batch_cb cb;
+    } batch;
 } vlc_thumbnailer_params_t;
 
 struct vlc_thumbnailer_request_t
@@ -66,8 +77,92 @@ struct vlc_thumbnailer_request_t
 
     vlc_mutex_t lock;
     bool done;
+    size_t index; /* next batch thumbnail */
+    image_handler_t *image;
 };
 
+static picture_t *
+thumbnailer_request_Scale( vlc_thumbnailer_request_t *request, picture_t *pic )
+{
+    unsigned max_width = request->params.batch.width;
+    unsigned max_height = request->params.batch.height;
+    const video_format_t *fmt_in = &pic->format;
+
+    if( ( max_width == 0 || fmt_in->i_visible_width <= max_width ) &&
+        ( max_height == 0 || fmt_in->i_visible_height <= max_height ) )
+        return picture_Hold( pic );
+
+    if( request->image == NULL )
+    {
+        request->image = image_HandlerCreate( request->thumbnailer->parent );
+        if( unlikely( request->image == NULL ) )
+            return NULL;
+    }
+
+    /* Fit the picture into the requested box, keeping its aspect ratio */
+    unsigned width = fmt_in->i_visible_width;
+    unsigned height = fmt_in->i_visible_height;
+    if( max_width != 0 && width > max_width )
+    {
+        height = (uint64_t)height * max_width / width;
+        width = max_width;
+    }
+    if( max_height != 0 && height > max_height )
+    {
+        width = (uint64_t)width * max_height / height;
+        height = max_height;
+    }
+
+    video_format_t fmt_out;
+    video_format_Init( &fmt_out, fmt_in->i_chroma );
+    fmt_out.i_width = fmt_out.i_visible_width = __MAX( width, 1 );
+    fmt_out.i_height = fmt_out.i_visible_height = __MAX( height, 1 );
+    fmt_out.i_sar_num = fmt_out.i_sar_den = 1;
+
+    return image_Convert( request->image, pic, fmt_in, &fmt_out );
+}
+
+/* Must be called with the request lock held */
+static void thumbnailer_request_Deliver( vlc_thumbnailer_request_t *request,
+                                         picture_t *pic )
+{
+    if( request->params.batch.times == NULL )
+    {
+        if ( request->params.cb )
+        {
+            request->params.cb( request->params.user_data, pic );
+            request->params.cb = NULL;
+        }
+        return;
+    }
+
+    if( request->index >= request->params.batch.count )
+        return;
+
+    size_t index = request->index++;
+    if( request->params.batch.cb == NULL )
+        return;
+
+    picture_t *scaled = pic != NULL ? thumbnailer_request_Scale( request, pic )
+                                    : NULL;
+    request->params.batch.cb( request->params.user_data, index, scaled );
+    if( scaled != NULL )
+        picture_Release( scaled );
+}
+
+/* Must be called with the request lock held */
+static void thumbnailer_request_Complete( vlc_thumbnailer_request_t *request,
+                                          picture_t *pic )
+{
+    request->done = true;
+    thumbnailer_request_Deliver( request, pic );
+
+    /* Signal the thumbnails that were never reached */
+    if( request->params.batch.times != NULL )
+        while( request->index < request->params.batch.count )
+            thumbnailer_request_Deliver( request, NULL );
+}
+
 static void
 on_thumbnailer_input_event( input_thread_t *input,
                             const struct vlc_input_event *event, void *userdata )
@@ -83,24 +178,34 @@ on_thumbnailer_input_event( input_thread_t *input,
 
     if ( event->type == INPUT_EVENT_THUMBNAIL_READY )
     {
+        pic = event->thumbnail;
+
+        vlc_mutex_lock( &request->lock );
+        if ( request->params.batch.times != NULL &&
+             request->index + 1 < request->params.batch.count )
+        {
+            /* Seek to the next thumbnail, reusing the same input */
+            thumbnailer_request_Deliver( request, pic );
+            input_SetTime( request->input_thread,
+                           request->params.batch.times[request->index],
+                           request->params.fast_seek );
+            vlc_mutex_unlock( &request->lock );
+            return;
+        }
+        vlc_mutex_unlock( &request->lock );
+
         /*
          * Stop the input thread ASAP, delegate its release to
          * thumbnailer_request_Release
          */
         input_Stop( request->input_thread );
-        pic = event->thumbnail;
     }
     vlc_mutex_lock( &request->lock );
-    request->done = true;
     /*
      * If the request has not been cancelled, we can invoke the completion
      * callback.
      */
-    if ( request->params.cb )
-    {
-        request->params.cb( request->params.user_data, pic );
-        request->params.cb = NULL;
-    }
+    thumbnailer_request_Complete( request, pic );
     vlc_mutex_unlock( &request->lock );
     background_worker_RequestProbe( request->thumbnailer->worker );
 }
@@ -116,7 +221,10 @@ static void thumbnailer_request_Release( void* data )
     if ( request->input_thread )
         input_Close( request->input_thread );
 
+    if ( request->image )
+        image_HandlerDelete( request->image );
     input_item_Release( request->params.input_item );
+    free( request->params.batch.times );
     free( request );
 }
 
@@ -129,11 +237,13 @@ static int thumbnailer_request_Start( void* owner, void* entity, void** out )
                                      on_thumbnailer_input_event, request,
                                      request->params.input_item );
     if ( unlikely( input == NULL ) )
+        goto error;
+    if ( request->params.batch.times != NULL )
     {
-        request->params.cb( request->params.user_data, NULL );
-        return VLC_EGENERIC;
+        input_SetTime( input, request->params.batch.times[0],
+                       request->params.fast_seek );
     }
-    if ( request->params.type == VLC_THUMBNAILER_SEEK_TIME )
+    else if ( request->params.type == VLC_THUMBNAILER_SEEK_TIME )
     {
         input_SetTime( input, request->params.time,
                        request->params.fast_seek );
@@ -145,12 +255,15 @@ static int thumbnailer_request_Start( void* owner, void* entity, void** out )
                        request->params.fast_seek );
     }
     if ( input_Start( input ) != VLC_SUCCESS )
-    {
-        request->params.cb( request->params.user_data, NULL );
-        return VLC_EGENERIC;
-    }
+        goto error;
     *out = request;
     return VLC_SUCCESS;
+
+error:
+    vlc_mutex_lock( &request->lock );
+    thumbnailer_request_Complete( request, NULL );
+    vlc_mutex_unlock( &request->lock );
+    return VLC_EGENERIC;
 }
 
 static void thumbnailer_request_Stop( void* owner, void* handle )
@@ -163,11 +276,7 @@ static void thumbnailer_request_Stop( void* owner, void* handle )
      * If the callback hasn't been invoked yet, we assume a timeout and
      * signal it back to the user
      */
-    if ( request->params.cb != NULL )
-    {
-        request->params.cb( request->params.user_data, NULL );
-        request->params.cb = NULL;
-    }
+    thumbnailer_request_Complete( request, NULL );
     vlc_mutex_unlock( &request->lock );
     assert( request->input_thread != NULL );
     input_Stop( request->input_thread );
@@ -194,6 +303,20 @@ thumbnailer_RequestCommon( vlc_thumbnailer_t* thumbnailer,
     request->input_thread = NULL;
     request->params = *(vlc_thumbnailer_params_t*)params;
     request->done = false;
+    request->index = 0;
+    request->image = NULL;
+    if ( params->batch.times != NULL )
+    {
+        request->params.batch.times =
+            vlc_alloc( params->batch.count, sizeof( *params->batch.times ) );
+        if ( unlikely( request->params.batch.times == NULL ) )
+        {
+            free( request );
+            return NULL;
+        }
+        memcpy( request->params.batch.times, params->batch.times,
+                params->batch.count * sizeof( *params->batch.times ) );
+    }
     input_item_Hold( request->params.input_item );
     vlc_mutex_init( &request->lock );
 
@@ -245,12 +368,40 @@ vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
         });
 }
 
+vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestBatch( vlc_thumbnailer_t *thumbnailer,
+                              const vlc_tick_t *times, size_t count,
+                              enum vlc_thumbnailer_seek_speed speed,
+                              unsigned width, unsigned height,
+                              input_item_t *input_item, vlc_tick_t timeout,
+                              vlc_thumbnailer_batch_cb cb, void* user_data )
+{
+    if ( count == 0 )
+        return NULL;
+    return thumbnailer_RequestCommon( thumbnailer,
+            &(const vlc_thumbnailer_params_t){
+                .type = VLC_THUMBNAILER_SEEK_TIME,
+                .fast_seek = speed == VLC_THUMBNAILER_SEEK_FAST,
+                .input_item = input_item,
+                .timeout = timeout,
+                .user_data = user_data,
+                .batch = {
+                    .times = (vlc_tick_t *)times,
+                    .count = count,
+                    .width = width,
+                    .height = height,
+                    .cb = cb,
+                },
+        });
+}
+
 void vlc_thumbnailer_Cancel( vlc_thumbnailer_t* thumbnailer,
                              vlc_thumbnailer_request_t* req )
 {
     vlc_mutex_lock( &req->lock );
     /* Ensure we won't invoke the callback if the input was running. */
     req->params.cb = NULL;
+    req->params.batch.cb = NULL;
     vlc_mutex_unlock( &req->lock );
     background_worker_Cancel( thumbnailer->worker, req );
 }
@@ -263,7 +414,7 @@ vlc_thumbnailer_t *vlc_thumbnailer_Create( vlc_object_t* parent)
     thumbnailer->parent = parent;
     struct background_worker_config cfg = {
         .default_timeout = -1,
-        .max_threads = 1,
+        .max_threads = var_InheritInteger( parent, "thumbnailer-threads" ),
         .pf_release = thumbnailer_request_Release,
         .pf_hold = thumbnailer_request_Hold,
         .pf_start = thumbnailer_request_Start,
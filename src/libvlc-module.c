@@ -490,6 +490,11 @@ static const char *const screensaver_texts[] = {
     "This drops frames that are late (arrive to the video output after " \
     "their intended display date)." )
 
+#define VOUT_TELEMETRY_TEXT N_("Video frames telemetry")
+#define VOUT_TELEMETRY_LONGTEXT N_( \
+    "Number of pictures whose pacing (decoding, rendering, display dates " \
+    "and drop reason) is recorded by the video output. 0 disables it." )
+
 #define QUIET_SYNCHRO_TEXT N_("Quiet synchro")
 #define QUIET_SYNCHRO_LONGTEXT N_( \
     "This avoids flooding the message log with debug output from the " \
@@ -979,6 +984,24 @@ static const char *const ppsz_prefres[] = {
     "VLC will fallback automatically to software decoders in case of " \
     "hardware decoder failure." )
 
+#define DEC_FIFO_SIZE_TEXT N_("Decoder input queue size limit (KiB)")
+#define DEC_FIFO_SIZE_LONGTEXT N_( \
+    "Maximum amount of data queued in front of each decoder, in kibibytes. " \
+    "Inputs that can be paced block the demuxer when this limit is " \
+    "reached, other inputs discard the queue. 0 disables the limit." )
+
+#define DEC_FIFO_LENGTH_TEXT N_("Decoder input queue duration limit (ms)")
+#define DEC_FIFO_LENGTH_LONGTEXT N_( \
+    "Maximum duration of data queued in front of each decoder, in " \
+    "milliseconds. Inputs that can be paced block the demuxer when this " \
+    "limit is reached, other inputs discard the queue. 0 disables the limit." )
+
+#define DEC_THREADS_TEXT N_("Decoding threads budget")
+#define DEC_THREADS_LONGTEXT N_( \
+    "Maximum number of software decoding threads shared by all the " \
+    "decoders of the process. Each decoder gets a fair share of this " \
+    "budget. 0 means no limit." )
+
 #define ENCODER_TEXT N_("Preferred encoders list")
 #define ENCODER_LONGTEXT N_( \
     "This allows you to select a list of encoders that VLC will use in " \
@@ -1194,6 +1217,21 @@ static const char *const clock_sources_text[] = {
 #define PREPARSE_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to preparse items" )
 
+#define PREPARSE_CACHE_TEXT N_( "Preparsing cache" )
+#define PREPARSE_CACHE_LONGTEXT N_( \
+    "Store the preparsing results of local files on disk, and reuse them " \
+    "as long as the file modification time and size are unchanged." )
+
+#define PREPARSE_SCHEME_THREADS_TEXT N_( "Preparsing threads per scheme" )
+#define PREPARSE_SCHEME_THREADS_LONGTEXT N_( \
+    "Maximum number of items preparsed in parallel for a given access " \
+    "scheme, as a comma-separated list of scheme=count pairs. " \
+    "This avoids overloading network shares." )
+
+#define THUMBNAILER_THREADS_TEXT N_( "Thumbnailing threads" )
+#define THUMBNAILER_THREADS_LONGTEXT N_( \
+    "Maximum number of thumbnails generated in parallel" )
+
 #define FETCH_ART_THREADS_TEXT N_( "Fetch-art threads" )
 #define FETCH_ART_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to fetch art" )
@@ -1645,6 +1683,8 @@ vlc_module_begin ()
         change_private ()
     add_bool( "drop-late-frames", 1, DROP_LATE_FRAMES_TEXT,
               DROP_LATE_FRAMES_LONGTEXT, true )
+    add_integer_with_range( "vout-telemetry", 256, 0, 65536,
+                            VOUT_TELEMETRY_TEXT, VOUT_TELEMETRY_LONGTEXT, true )
     /* Used in vout_synchro */
     add_bool( "skip-frames", 1, SKIP_FRAMES_TEXT,
               SKIP_FRAMES_LONGTEXT, true )
@@ -2039,6 +2079,15 @@ vlc_module_begin ()
     add_string( "codec", NULL, CODEC_TEXT,
                 CODEC_LONGTEXT, true )
     add_bool( "hw-dec", true, HW_DEC_TEXT, HW_DEC_LONGTEXT, true )
+    add_integer( "decoder-fifo-size", 400 * 1024, DEC_FIFO_SIZE_TEXT,
+                 DEC_FIFO_SIZE_LONGTEXT, true )
+        change_integer_range( 0, INT_MAX )
+    add_integer( "decoder-fifo-length", 0, DEC_FIFO_LENGTH_TEXT,
+                 DEC_FIFO_LENGTH_LONGTEXT, true )
+        change_integer_range( 0, INT_MAX )
+    add_integer( "dec-threads", 0, DEC_THREADS_TEXT, DEC_THREADS_LONGTEXT,
+                 true )
+        change_integer_range( 0, 1024 )
     add_string( "encoder",  NULL, ENCODER_TEXT,
                 ENCODER_LONGTEXT, true )
     add_module("dec-dev", "decoder device", "any", DEC_DEV_TEXT, DEC_DEV_LONGTEXT)
@@ -2215,9 +2264,20 @@ vlc_module_begin ()
     add_integer( "preparse-threads", 1, PREPARSE_THREADS_TEXT,
                  PREPARSE_THREADS_LONGTEXT, false )
 
+    add_string( "preparse-scheme-threads", "smb=1,nfs=1,sftp=1,ftp=1",
+                PREPARSE_SCHEME_THREADS_TEXT, PREPARSE_SCHEME_THREADS_LONGTEXT,
+                true )
+
+    add_bool( "preparse-cache", false, PREPARSE_CACHE_TEXT,
+              PREPARSE_CACHE_LONGTEXT, false )
+
     add_integer( "fetch-art-threads", 1, FETCH_ART_THREADS_TEXT,
                  FETCH_ART_THREADS_LONGTEXT, false )
 
+    add_integer( "thumbnailer-threads", 1, THUMBNAILER_THREADS_TEXT,
+                 THUMBNAILER_THREADS_LONGTEXT, false )
+        change_integer_range( 1, 32 )
+
     add_obsolete_integer( "album-art" )
     add_bool( "metadata-network-access", false, METADATA_NETWORK_TEXT,
                  METADATA_NETWORK_TEXT, false )
@@ -33,6 +33,8 @@ struct task {
     void* id; /**< id associated with entity */
     void* entity; /**< the entity to process */
     vlc_tick_t timeout; /**< timeout duration in vlc_tick_t */
+    const void *class; /**< concurrency class, or NULL */
+    int class_limit; /**< maximum running tasks of the same class */
 };
 
 struct background_worker;
@@ -73,6 +75,11 @@ static struct task *task_Create(struct background_worker *worker, void *id,
     task->id = id;
     task->entity = entity;
     task->timeout = timeout < 0 ? worker->conf.default_timeout : VLC_TICK_FROM_MS(timeout);
+    task->class = NULL;
+    task->class_limit = 0;
+    if (worker->conf.pf_get_class != NULL)
+        task->class = worker->conf.pf_get_class(worker->owner, entity,
+                                                &task->class_limit);
     worker->conf.pf_hold(task->entity);
     return task;
 }
@@ -83,21 +90,49 @@ static void task_Destroy(struct background_worker *worker, struct task *task)
     free(task);
 }
 
+static bool TaskCanStart(struct background_worker *worker,
+                         const struct task *task)
+{
+    vlc_mutex_assert(&worker->lock);
+
+    if (task->class == NULL)
+        return true;
+
+    int running = 0;
+    struct background_thread *thread;
+    vlc_list_foreach(thread, &worker->threads, node)
+        if (thread->task != NULL && thread->task->class == task->class)
+            running++;
+
+    return running < task->class_limit;
+}
+
+static struct task *QueueFirstRunnable(struct background_worker *worker)
+{
+    vlc_mutex_assert(&worker->lock);
+
+    struct task *task;
+    vlc_list_foreach(task, &worker->queue, node)
+        if (TaskCanStart(worker, task))
+            return task;
+    return NULL;
+}
+
 static struct task *QueueTake(struct background_worker *worker, int timeout_ms)
 {
     vlc_mutex_assert(&worker->lock);
 
     vlc_tick_t deadline = vlc_tick_now() + VLC_TICK_FROM_MS(timeout_ms);
     bool timeout = false;
-    while (!timeout && !worker->closing && vlc_list_is_empty(&worker->queue))
+    struct task *task;
+    while (!timeout && !worker->closing
+        && (task = QueueFirstRunnable(worker)) == NULL)
         timeout = vlc_cond_timedwait(&worker->queue_wait,
                                      &worker->lock, deadline) != 0;
 
     if (worker->closing || timeout)
         return NULL;
 
-    struct task *task = vlc_list_first_entry_or_null(&worker->queue,
-                                                     struct task, node);
     assert(task);
     vlc_list_remove(&task->node);
 
@@ -179,6 +214,9 @@ static void TerminateTask(struct background_thread *thread, struct task *task)
     thread->task = NULL;
     worker->uncompleted--;
     assert(worker->uncompleted >= 0);
+    if (task->class != NULL)
+        /* A task of the same class may be waiting for this one */
+        vlc_cond_broadcast(&worker->queue_wait);
     vlc_mutex_unlock(&worker->lock);
 
     task_Destroy(worker, task);
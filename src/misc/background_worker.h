@@ -119,6 +119,23 @@ struct background_worker_config {
      * \parma handle the handle associated with the task to be stopped
      **/
     void( *pf_stop )( void* owner, void* handle );
+
+    /**
+     * Get the concurrency class of an entity (optional)
+     *
+     * This callback is called when an entity is pushed. Tasks returning the
+     * same non-NULL class are never executed by more than `*limit` threads at
+     * the same time, queued tasks of other classes being started first.
+     *
+     * This callback can be NULL if no per-class limits are needed.
+     *
+     * \param owner the owner of the background-worker
+     * \param entity the entity being pushed
+     * \param limit [out] the maximum number of running tasks of that class
+     * \return an opaque class identifier, valid for the lifetime of the
+     *         background-worker, or NULL for no limit.
+     **/
+    const void *( *pf_get_class )( void* owner, void* entity, int* limit );
 };
 
 /**
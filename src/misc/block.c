@@ -30,6 +30,7 @@
 #include <errno.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <stdatomic.h>
 
 #include <vlc_common.h>
 #include <vlc_block.h>
@@ -141,6 +142,124 @@ void block_Release(block_t *block)
     block->cbs->free(block);
 }
 
+/**
+ * Shared payload storage: the block owning the data, and the count of
+ * references (block_ref) to it.
+ */
+struct block_shared
+{
+    block_t *payload;
+    atomic_uint refs;
+};
+
+struct block_ref
+{
+    block_t self;
+    struct block_shared *shared;
+};
+
+static void block_shared_Release (block_t *block)
+{
+    struct block_ref *ref = container_of(block, struct block_ref, self);
+    struct block_shared *shared = ref->shared;
+
+    if (atomic_fetch_sub_explicit(&shared->refs, 1, memory_order_acq_rel) == 1)
+    {
+        block_Release(shared->payload);
+        free(shared);
+    }
+    free(ref);
+}
+
+static const struct vlc_block_callbacks block_shared_cbs =
+{
+    block_shared_Release,
+};
+
+static bool block_IsShared (const block_t *block)
+{
+    return block->cbs == &block_shared_cbs;
+}
+
+/**
+ * Turns the last reference to a shared payload back into the plain block
+ * owning it, keeping the view and the properties of the reference.
+ */
+static block_t *block_shared_Unwrap (block_t *block)
+{
+    struct block_ref *ref = container_of(block, struct block_ref, self);
+    block_t *payload = ref->shared->payload;
+
+    payload->p_next = block->p_next;
+    payload->p_buffer = block->p_buffer;
+    payload->i_buffer = block->i_buffer;
+    block_CopyProperties(payload, block);
+    free(ref->shared);
+    free(ref);
+    return payload;
+}
+
+block_t *block_Share (block_t *block)
+{
+    if (block_IsShared(block))
+        return block;
+
+    struct block_shared *shared = malloc(sizeof (*shared));
+    struct block_ref *ref = malloc(sizeof (*ref));
+    if (unlikely(shared == NULL || ref == NULL))
+    {   /* Keep the plain block: block_Clone() will duplicate it. */
+        free(shared);
+        free(ref);
+        return block;
+    }
+
+    shared->payload = block;
+    atomic_init(&shared->refs, 1);
+
+    /* The view has no slack: the data around it belongs to every reference,
+     * so nothing may be prepended or appended in place. */
+    block_Init(&ref->self, &block_shared_cbs, block->p_buffer, block->i_buffer);
+    block_CopyProperties(&ref->self, block);
+    ref->self.p_next = block->p_next;
+    ref->shared = shared;
+    block->p_next = NULL;
+    return &ref->self;
+}
+
+block_t *block_Clone (const block_t *block)
+{
+    if (!block_IsShared(block))
+        return block_Duplicate(block);
+
+    const struct block_ref *ref = container_of(block, struct block_ref, self);
+    struct block_ref *clone = malloc(sizeof (*clone));
+    if (unlikely(clone == NULL))
+        return NULL;
+
+    block_Init(&clone->self, &block_shared_cbs, block->p_buffer,
+               block->i_buffer);
+    block_CopyProperties(&clone->self, block);
+    clone->shared = ref->shared;
+    atomic_fetch_add_explicit(&clone->shared->refs, 1, memory_order_relaxed);
+    return &clone->self;
+}
+
+block_t *block_Unshare (block_t *block)
+{
+    if (!block_IsShared(block))
+        return block;
+
+    struct block_ref *ref = container_of(block, struct block_ref, self);
+    if (atomic_load_explicit(&ref->shared->refs, memory_order_acquire) == 1)
+        return block_shared_Unwrap(block);
+
+    block_t *dup = block_Duplicate(block);
+    if (likely(dup != NULL))
+        dup->p_next = block->p_next;
+    block_Release(block);
+    return dup;
+}
+
 block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
 {
     block_Check( p_block );
@@ -173,6 +292,21 @@ block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
     if( p_block->i_buffer > i_body )
         p_block->i_buffer = i_body;
 
+    if( block_IsShared( p_block ) )
+    {
+        struct block_ref *ref = container_of( p_block, struct block_ref, self );
+
+        if( atomic_load_explicit( &ref->shared->refs,
+                                  memory_order_acquire ) == 1 )
+            p_block = block_shared_Unwrap( p_block );
+        else
+        {   /* Other references read the data around the view: any growth
+             * below shall copy. */
+            p_block->p_start = p_block->p_buffer;
+            p_block->i_size = p_block->i_buffer;
+        }
+    }
+
     size_t requested = i_prebody + i_body;
 
     if( p_block->i_buffer == 0 )
@@ -47,6 +47,7 @@ void vlc_global_mutex (unsigned n, bool acquire)
         VLC_STATIC_MUTEX,
         VLC_STATIC_MUTEX,
         VLC_STATIC_MUTEX,
+        VLC_STATIC_MUTEX,
 #ifdef _WIN32
         VLC_STATIC_MUTEX, // For MTA holder
 #endif
@@ -204,9 +204,8 @@ static int vlc_cache_load_config(module_config_t *cfg, block_t *file)
         for (unsigned i = 0; i < cfg->list_count; i++)
         {
             LOAD_STRING (cfg->list.psz[i]);
-            if (cfg->list.psz[i] == NULL /* NULL -> empty string */
-             && (cfg->list.psz[i] = calloc (1, 1)) == NULL)
-                goto error;
+            if (cfg->list.psz[i] == NULL) /* NULL -> empty string */
+                cfg->list.psz[i] = "";
         }
     }
     else
@@ -224,13 +223,18 @@ static int vlc_cache_load_config(module_config_t *cfg, block_t *file)
         LOAD_ARRAY(cfg->list.i, cfg->list_count);
     }
 
+    if (cfg->list_count == 0)
+    {
+        cfg->list_text = NULL;
+        return 0;
+    }
+
     cfg->list_text = xmalloc (cfg->list_count * sizeof (char *));
     for (unsigned i = 0; i < cfg->list_count; i++)
     {
         LOAD_STRING (cfg->list_text[i]);
-        if (cfg->list_text[i] == NULL /* NULL -> empty string */
-         && (cfg->list_text[i] = calloc (1, 1)) == NULL)
-            goto error;
+        if (cfg->list_text[i] == NULL) /* NULL -> empty string */
+            cfg->list_text[i] = "";
     }
 
     return 0;
@@ -432,7 +436,7 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
         return NULL;
     }
 
-    vlc_plugin_t *cache = NULL;
+    vlc_plugin_t *cache = NULL, **pp = &cache;
 
     while (file->i_buffer > 0)
     {
@@ -448,8 +452,11 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
             goto error;
         }
 
-        plugin->next = cache;
-        cache = plugin;
+        /* Keep the file order: it matches the directory scan order, so that
+         * vlc_cache_lookup() usually finds the plugin at the head. */
+        plugin->next = NULL;
+        *pp = plugin;
+        pp = &plugin->next;
     }
 
     file->p_next = *backingp;
@@ -0,0 +1,680 @@
+/*****************************************************************************
+ * cache.c: persistent preparser results cache
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include <vlc_common.h>
+#include <vlc_arrays.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include <vlc_memstream.h>
+#include <vlc_meta.h>
+#include <vlc_url.h>
+
+#include "input/item.h"
+#include "cache.h"
+
+#define CACHE_HEADER "vlc-preparser-cache 1"
+#define CACHE_NAME "preparser.cache"
+#ifdef TEST_PREPARSER_CACHE
+# define vlc_module_name "test"
+# define CACHE_MAX_ENTRIES 16
+#else
+# define CACHE_MAX_ENTRIES 10000
+#endif
+#define CACHE_MAX_AGE (90 * 24 * 3600) /* seconds since the last use */
+#define CACHE_SAVE_INTERVAL VLC_TICK_FROM_SEC(300)
+
+struct cache_entry
+{
+    int64_t used; /* last store or lookup, in seconds since the epoch */
+    int64_t mtime;
+    uint64_t size;
+    vlc_tick_t duration;
+    vlc_meta_t *meta;
+    int es_count;
+    es_format_t *es;
+};
+
+struct input_preparser_cache_t
+{
+    vlc_object_t *owner;
+    char *path;
+
+    vlc_mutex_t lock;
+    vlc_dictionary_t entries; /* struct cache_entry, keyed on the URI */
+    int count;
+    bool dirty;
+    bool saving;
+    vlc_tick_t saved; /* last save attempt */
+};
+
+static struct cache_entry *EntryNew( void )
+{
+    struct cache_entry *entry = malloc( sizeof( *entry ) );
+    if( unlikely(entry == NULL) )
+        return NULL;
+
+    entry->meta = vlc_meta_New();
+    if( unlikely(entry->meta == NULL) )
+    {
+        free( entry );
+        return NULL;
+    }
+    entry->used = time( NULL );
+    entry->mtime = 0;
+    entry->size = 0;
+    entry->duration = INPUT_DURATION_UNSET;
+    entry->es_count = 0;
+    entry->es = NULL;
+    return entry;
+}
+
+static void EntryDelete( void *data, void *opaque )
+{
+    struct cache_entry *entry = data;
+    VLC_UNUSED(opaque);
+
+    for( int i = 0; i < entry->es_count; i++ )
+        es_format_Clean( &entry->es[i] );
+    free( entry->es );
+    vlc_meta_Delete( entry->meta );
+    free( entry );
+}
+
+static void EntryInsert( input_preparser_cache_t *cache, const char *uri,
+                         struct cache_entry *entry )
+{
+    if( vlc_dictionary_has_key( &cache->entries, uri ) )
+        vlc_dictionary_remove_value_for_key( &cache->entries, uri,
+                                             EntryDelete, NULL );
+    else
+        cache->count++;
+    vlc_dictionary_insert( &cache->entries, uri, entry );
+}
+
+struct cache_age
+{
+    const char *uri;
+    int64_t used;
+};
+
+static int AgeCmp( const void *a, const void *b )
+{
+    const struct cache_age *x = a, *y = b;
+    return (x->used > y->used) - (x->used < y->used);
+}
+
+/**
+ * Removes the entries not used for CACHE_MAX_AGE and, above
+ * CACHE_MAX_ENTRIES, the least recently used ones with some margin, so that
+ * this does not run on every store.
+ */
+static void CachePrune( input_preparser_cache_t *cache )
+{
+    if( cache->count == 0 )
+        return;
+
+    struct cache_age *tab = vlc_alloc( cache->count, sizeof( *tab ) );
+    if( unlikely(tab == NULL) )
+        return;
+
+    int n = 0;
+    for( int i = 0; i < cache->entries.i_size; i++ )
+        for( vlc_dictionary_entry_t *e = cache->entries.p_entries[i];
+             e != NULL; e = e->p_next )
+        {
+            const struct cache_entry *entry = e->p_value;
+            tab[n].uri = e->psz_key;
+            tab[n].used = entry->used;
+            n++;
+        }
+    assert( n == cache->count );
+    qsort( tab, n, sizeof( *tab ), AgeCmp );
+
+    const int64_t oldest = (int64_t)time( NULL ) - CACHE_MAX_AGE;
+    const int excess = n > CACHE_MAX_ENTRIES
+                     ? n - CACHE_MAX_ENTRIES + CACHE_MAX_ENTRIES / 8 : 0;
+    int i = 0;
+
+    while( i < n && ( i < excess || tab[i].used < oldest ) )
+        /* This frees the key string only after comparing it */
+        vlc_dictionary_remove_value_for_key( &cache->entries, tab[i++].uri,
+                                             EntryDelete, NULL );
+    free( tab );
+
+    if( i > 0 )
+    {
+        msg_Dbg( cache->owner, "pruned %d preparser cache entries", i );
+        cache->count -= i;
+        cache->dirty = true;
+    }
+}
+
+/**
+ * Gets the modification time and size of a local regular file.
+ */
+static int FileStat( const char *uri, int64_t *mtime, uint64_t *size )
+{
+    char *path = vlc_uri2path( uri );
+    if( path == NULL )
+        return VLC_EGENERIC;
+
+    struct stat st;
+    int ret = vlc_stat( path, &st );
+    free( path );
+    if( ret != 0 || !S_ISREG( st.st_mode ) )
+        return VLC_EGENERIC;
+
+    *mtime = st.st_mtime;
+    *size = st.st_size;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Serialization
+ *****************************************************************************/
+
+/* Strings are URI-encoded and prefixed with '=', NULL is written as '-' */
+static void WriteString( struct vlc_memstream *out, const char *str )
+{
+    char *enc = str != NULL ? vlc_uri_encode( str ) : NULL;
+
+    if( enc != NULL )
+        vlc_memstream_printf( out, " =%s", enc );
+    else
+        vlc_memstream_puts( out, " -" );
+    free( enc );
+}
+
+static char *ReadString( char **saveptr )
+{
+    char *token = strtok_r( NULL, " ", saveptr );
+    if( token == NULL || token[0] != '=' )
+        return NULL;
+    return vlc_uri_decode_duplicate( token + 1 );
+}
+
+static int64_t ReadInteger( char **saveptr )
+{
+    char *token = strtok_r( NULL, " ", saveptr );
+    return token != NULL ? strtoll( token, NULL, 10 ) : 0;
+}
+
+static void WriteEntry( struct vlc_memstream *out, const char *uri,
+                        const struct cache_entry *entry )
+{
+    vlc_memstream_putc( out, 'I' );
+    WriteString( out, uri );
+    vlc_memstream_printf( out, " %"PRId64" %"PRIu64" %"PRId64" %"PRId64"\n",
+                          entry->mtime, entry->size, entry->duration,
+                          entry->used );
+
+    for( int i = 0; i < VLC_META_TYPE_COUNT; i++ )
+    {
+        const char *value = vlc_meta_Get( entry->meta, i );
+        if( value == NULL )
+            continue;
+        vlc_memstream_printf( out, "M %d", i );
+        WriteString( out, value );
+        vlc_memstream_putc( out, '\n' );
+    }
+
+    char **names = vlc_meta_CopyExtraNames( entry->meta );
+    if( names != NULL )
+    {
+        for( size_t i = 0; names[i] != NULL; i++ )
+        {
+            vlc_memstream_putc( out, 'X' );
+            WriteString( out, names[i] );
+            WriteString( out, vlc_meta_GetExtra( entry->meta, names[i] ) );
+            vlc_memstream_putc( out, '\n' );
+            free( names[i] );
+        }
+        free( names );
+    }
+
+    for( int i = 0; i < entry->es_count; i++ )
+    {
+        const es_format_t *es = &entry->es[i];
+
+        vlc_memstream_printf( out, "E %d %"PRIu32" %"PRIu32" %d %d %u",
+                              es->i_cat, es->i_codec, es->i_original_fourcc,
+                              es->i_id, es->i_group, es->i_bitrate );
+        WriteString( out, es->psz_language );
+        WriteString( out, es->psz_description );
+        switch( es->i_cat )
+        {
+            case AUDIO_ES:
+                vlc_memstream_printf( out, " %u %u %u\n",
+                                      es->audio.i_channels, es->audio.i_rate,
+                                      es->audio.i_bitspersample );
+                break;
+            case VIDEO_ES:
+                vlc_memstream_printf( out, " %u %u %u %u %u %u %u %u %d\n",
+                                      es->video.i_width, es->video.i_height,
+                                      es->video.i_visible_width,
+                                      es->video.i_visible_height,
+                                      es->video.i_sar_num, es->video.i_sar_den,
+                                      es->video.i_frame_rate,
+                                      es->video.i_frame_rate_base,
+                                      (int)es->video.orientation );
+                break;
+            default:
+                vlc_memstream_putc( out, '\n' );
+                break;
+        }
+    }
+}
+
+static void ReadEs( struct cache_entry *entry, char **saveptr )
+{
+    es_format_t *tab = realloc( entry->es,
+                                (entry->es_count + 1) * sizeof( *tab ) );
+    if( unlikely(tab == NULL) )
+        return;
+    entry->es = tab;
+
+    es_format_t *es = &tab[entry->es_count++];
+    int cat = ReadInteger( saveptr );
+    if( cat != VIDEO_ES && cat != AUDIO_ES && cat != SPU_ES && cat != DATA_ES )
+        cat = UNKNOWN_ES;
+
+    es_format_Init( es, cat, ReadInteger( saveptr ) );
+    es->i_original_fourcc = ReadInteger( saveptr );
+    es->i_id = ReadInteger( saveptr );
+    es->i_group = ReadInteger( saveptr );
+    es->i_bitrate = ReadInteger( saveptr );
+    es->psz_language = ReadString( saveptr );
+    es->psz_description = ReadString( saveptr );
+    switch( cat )
+    {
+        case AUDIO_ES:
+            es->audio.i_channels = ReadInteger( saveptr );
+            es->audio.i_rate = ReadInteger( saveptr );
+            es->audio.i_bitspersample = ReadInteger( saveptr );
+            break;
+        case VIDEO_ES:
+        {
+            es->video.i_width = ReadInteger( saveptr );
+            es->video.i_height = ReadInteger( saveptr );
+            es->video.i_visible_width = ReadInteger( saveptr );
+            es->video.i_visible_height = ReadInteger( saveptr );
+            es->video.i_sar_num = ReadInteger( saveptr );
+            es->video.i_sar_den = ReadInteger( saveptr );
+            es->video.i_frame_rate = ReadInteger( saveptr );
+            es->video.i_frame_rate_base = ReadInteger( saveptr );
+            int64_t orientation = ReadInteger( saveptr );
+            if( orientation >= ORIENT_TOP_LEFT
+             && orientation <= ORIENT_RIGHT_BOTTOM )
+                es->video.orientation = orientation;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void CacheLoad( input_preparser_cache_t *cache )
+{
+    FILE *file = vlc_fopen( cache->path, "rt" );
+    if( file == NULL )
+        return;
+
+    char *line = NULL;
+    size_t linesize = 0;
+    ssize_t len = getline( &line, &linesize, file );
+    if( len <= 0 || strncmp( line, CACHE_HEADER, strlen( CACHE_HEADER ) ) )
+    {
+        msg_Warn( cache->owner, "ignoring invalid preparser cache %s",
+                  cache->path );
+        goto out;
+    }
+
+    struct cache_entry *entry = NULL;
+    while( ( len = getline( &line, &linesize, file ) ) > 0 )
+    {
+        if( line[len - 1] == '\n' )
+            line[len - 1] = '\0';
+
+        char *saveptr;
+        char *type = strtok_r( line, " ", &saveptr );
+        if( type == NULL )
+            continue;
+
+        if( !strcmp( type, "I" ) )
+        {
+            char *uri = ReadString( &saveptr );
+            entry = uri != NULL ? EntryNew() : NULL;
+            if( entry == NULL )
+            {
+                free( uri );
+                continue;
+            }
+            entry->mtime = ReadInteger( &saveptr );
+            entry->size = ReadInteger( &saveptr );
+            entry->duration = ReadInteger( &saveptr );
+            /* Older caches have no use time: count from now */
+            int64_t used = ReadInteger( &saveptr );
+            if( used > 0 )
+                entry->used = used;
+            EntryInsert( cache, uri, entry );
+            free( uri );
+        }
+        else if( entry == NULL )
+            continue;
+        else if( !strcmp( type, "M" ) )
+        {
+            int meta_type = ReadInteger( &saveptr );
+            char *value = ReadString( &saveptr );
+            if( meta_type >= 0 && meta_type < VLC_META_TYPE_COUNT )
+                vlc_meta_Set( entry->meta, meta_type, value );
+            free( value );
+        }
+        else if( !strcmp( type, "X" ) )
+        {
+            char *name = ReadString( &saveptr );
+            char *value = ReadString( &saveptr );
+            if( name != NULL )
+                vlc_meta_AddExtra( entry->meta, name, value );
+            free( name );
+            free( value );
+        }
+        else if( !strcmp( type, "E" ) )
+            ReadEs( entry, &saveptr );
+    }
+
+    msg_Dbg( cache->owner, "loaded %d preparser cache entries",
+             cache->count );
+    CachePrune( cache );
+out:
+    free( line );
+    fclose( file );
+}
+
+/**
+ * Writes a serialized cache to disk, without holding the cache lock.
+ */
+static int CacheWrite( input_preparser_cache_t *cache, const char *data,
+                       size_t length )
+{
+    /* Other instances may be saving the same cache concurrently: each writes
+     * its own file, and the last rename wins. */
+    char *tmp;
+    if( asprintf( &tmp, "%s.XXXXXX", cache->path ) == -1 )
+        return VLC_ENOMEM;
+
+    int fd = vlc_mkstemp( tmp );
+    FILE *file = fd != -1 ? fdopen( fd, "wb" ) : NULL;
+    if( file == NULL )
+    {
+        msg_Warn( cache->owner, "cannot create %s: %s", tmp,
+                  vlc_strerror_c( errno ) );
+        if( fd != -1 )
+        {
+            vlc_close( fd );
+            vlc_unlink( tmp );
+        }
+        free( tmp );
+        return VLC_EGENERIC;
+    }
+
+    int ret = VLC_EGENERIC;
+    if( (fwrite( data, 1, length, file ) != length) | fclose( file ) )
+    {
+        msg_Warn( cache->owner, "cannot write %s", tmp );
+        vlc_unlink( tmp );
+    }
+    else if( vlc_rename( tmp, cache->path ) )
+    {
+        msg_Warn( cache->owner, "cannot rename %s: %s", tmp,
+                  vlc_strerror_c( errno ) );
+        vlc_unlink( tmp );
+    }
+    else
+        ret = VLC_SUCCESS;
+    free( tmp );
+    return ret;
+}
+
+/**
+ * Saves the cache. The entries are serialized under the lock, but the file is
+ * written without it, not to block the lookups on the I/O.
+ */
+static void CacheSave( input_preparser_cache_t *cache )
+{
+    struct vlc_memstream stream;
+
+    vlc_mutex_lock( &cache->lock );
+    cache->saved = vlc_tick_now();
+    /* A concurrent save will be followed by another one, as still dirty */
+    if( cache->saving || vlc_memstream_open( &stream ) )
+    {
+        vlc_mutex_unlock( &cache->lock );
+        return;
+    }
+
+    CachePrune( cache );
+    vlc_memstream_puts( &stream, CACHE_HEADER "\n" );
+    for( int i = 0; i < cache->entries.i_size; i++ )
+        for( vlc_dictionary_entry_t *e = cache->entries.p_entries[i];
+             e != NULL; e = e->p_next )
+            WriteEntry( &stream, e->psz_key, e->p_value );
+    cache->dirty = false;
+    cache->saving = true;
+    vlc_mutex_unlock( &cache->lock );
+
+    bool saved = false;
+    if( vlc_memstream_close( &stream ) == 0 )
+    {
+        saved = CacheWrite( cache, stream.ptr, stream.length ) == VLC_SUCCESS;
+        free( stream.ptr );
+    }
+
+    vlc_mutex_lock( &cache->lock );
+    cache->saving = false;
+    if( !saved )
+        cache->dirty = true;
+    vlc_mutex_unlock( &cache->lock );
+}
+
+/*****************************************************************************
+ * Public functions
+ *****************************************************************************/
+
+input_preparser_cache_t *input_preparser_cache_New( vlc_object_t *owner )
+{
+    char *dir = config_GetUserDir( VLC_CACHE_DIR );
+    if( dir == NULL )
+        return NULL;
+
+    input_preparser_cache_t *cache = malloc( sizeof( *cache ) );
+    if( unlikely(cache == NULL) )
+    {
+        free( dir );
+        return NULL;
+    }
+
+    /* The user cache directory itself may not exist yet */
+    char *sep = strrchr( dir, DIR_SEP_CHAR );
+    if( sep != NULL && sep != dir )
+    {
+        *sep = '\0';
+        vlc_mkdir( dir, 0700 );
+        *sep = DIR_SEP_CHAR;
+    }
+    vlc_mkdir( dir, 0700 );
+
+    int ret = asprintf( &cache->path, "%s"DIR_SEP CACHE_NAME, dir );
+    free( dir );
+    if( ret == -1 )
+    {
+        free( cache );
+        return NULL;
+    }
+
+    cache->owner = owner;
+    cache->count = 0;
+    cache->dirty = false;
+    cache->saving = false;
+    cache->saved = vlc_tick_now();
+    vlc_mutex_init( &cache->lock );
+    vlc_dictionary_init( &cache->entries, 0 );
+
+    CacheLoad( cache );
+    return cache;
+}
+
+bool input_preparser_cache_Lookup( input_preparser_cache_t *cache,
+                                   input_item_t *item )
+{
+    int64_t mtime;
+    uint64_t size;
+
+    vlc_mutex_lock( &item->lock );
+    char *uri = strdup( item->psz_uri );
+    vlc_mutex_unlock( &item->lock );
+
+    if( unlikely(uri == NULL) || FileStat( uri, &mtime, &size ) )
+    {
+        free( uri );
+        return false;
+    }
+
+    vlc_mutex_lock( &cache->lock );
+    struct cache_entry *entry =
+        vlc_dictionary_value_for_key( &cache->entries, uri );
+    free( uri );
+
+    if( entry == kVLCDictionaryNotFound || entry->mtime != mtime
+     || entry->size != size )
+    {
+        vlc_mutex_unlock( &cache->lock );
+        return false;
+    }
+
+    /* Only refresh the age once a day, not to save on every lookup */
+    int64_t now = time( NULL );
+    if( now - entry->used > 24 * 3600 )
+    {
+        entry->used = now;
+        cache->dirty = true;
+    }
+
+    input_item_SetDuration( item, entry->duration );
+    for( int i = 0; i < VLC_META_TYPE_COUNT; i++ )
+    {
+        const char *value = vlc_meta_Get( entry->meta, i );
+        if( value != NULL )
+            input_item_SetMeta( item, i, value );
+    }
+
+    vlc_mutex_lock( &item->lock );
+    if( item->p_meta == NULL )
+        item->p_meta = vlc_meta_New();
+    if( item->p_meta != NULL )
+    {
+        char **names = vlc_meta_CopyExtraNames( entry->meta );
+        if( names != NULL )
+        {
+            for( size_t i = 0; names[i] != NULL; i++ )
+            {
+                vlc_meta_AddExtra( item->p_meta, names[i],
+                                   vlc_meta_GetExtra( entry->meta, names[i] ) );
+                free( names[i] );
+            }
+            free( names );
+        }
+    }
+    vlc_mutex_unlock( &item->lock );
+
+    for( int i = 0; i < entry->es_count; i++ )
+        input_item_UpdateTracksInfo( item, &entry->es[i] );
+
+    vlc_mutex_unlock( &cache->lock );
+    return true;
+}
+
+void input_preparser_cache_Store( input_preparser_cache_t *cache,
+                                  input_item_t *item )
+{
+    struct cache_entry *entry = EntryNew();
+    if( unlikely(entry == NULL) )
+        return;
+
+    vlc_mutex_lock( &item->lock );
+    char *uri = strdup( item->psz_uri );
+    entry->duration = item->i_duration;
+    if( item->p_meta != NULL )
+        vlc_meta_Merge( entry->meta, item->p_meta );
+    if( item->i_es > 0 )
+    {
+        entry->es = vlc_alloc( item->i_es, sizeof( *entry->es ) );
+        if( likely(entry->es != NULL) )
+        {
+            for( int i = 0; i < item->i_es; i++ )
+                es_format_Copy( &entry->es[i], item->es[i] );
+            entry->es_count = item->i_es;
+        }
+    }
+    vlc_mutex_unlock( &item->lock );
+
+    if( unlikely(uri == NULL)
+     || FileStat( uri, &entry->mtime, &entry->size ) )
+    {
+        EntryDelete( entry, NULL );
+        free( uri );
+        return;
+    }
+
+    /* The preparsing status is not a property of the file */
+    vlc_meta_SetStatus( entry->meta, 0 );
+
+    vlc_mutex_lock( &cache->lock );
+    EntryInsert( cache, uri, entry );
+    cache->dirty = true;
+    if( cache->count > CACHE_MAX_ENTRIES )
+        CachePrune( cache );
+    /* Do not lose everything if the process does not exit cleanly */
+    bool save = vlc_tick_now() - cache->saved >= CACHE_SAVE_INTERVAL;
+    vlc_mutex_unlock( &cache->lock );
+    free( uri );
+
+    if( save )
+        CacheSave( cache );
+}
+
+void input_preparser_cache_Delete( input_preparser_cache_t *cache )
+{
+    if( cache->dirty )
+        CacheSave( cache );
+
+    vlc_dictionary_clear( &cache->entries, EntryDelete, NULL );
+    free( cache->path );
+    free( cache );
+}
@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * cache.h: persistent preparser results cache
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef _INPUT_PREPARSER_CACHE_H
+#define _INPUT_PREPARSER_CACHE_H 1
+
+#include <vlc_input_item.h>
+
+/**
+ * Preparser cache opaque structure.
+ *
+ * The preparser cache stores the results of successful preparsing of local
+ * files (duration, meta data and tracks), keyed on the item URI and
+ * validated against the file modification time and size, so that unchanged
+ * files can be answered without opening them.
+ *
+ * The cache is loaded from and saved to the user cache directory. It is
+ * saved periodically while entries are stored, and when destroyed. Entries
+ * not used for a long time, or the least recently used above a fixed count,
+ * are dropped.
+ */
+typedef struct input_preparser_cache_t input_preparser_cache_t;
+
+/**
+ * Creates the cache object and loads it from disk.
+ */
+input_preparser_cache_t *input_preparser_cache_New( vlc_object_t * );
+
+/**
+ * Fills the item from the cache.
+ *
+ * \return true if a valid entry was found and applied to the item, false if
+ * the item must be preparsed
+ */
+bool input_preparser_cache_Lookup( input_preparser_cache_t *, input_item_t * );
+
+/**
+ * Stores the preparsing results of an item in the cache.
+ */
+void input_preparser_cache_Store( input_preparser_cache_t *, input_item_t * );
+
+/**
+ * Saves the cache to disk if it was modified, and destroys it.
+ */
+void input_preparser_cache_Delete( input_preparser_cache_t * );
+
+#endif
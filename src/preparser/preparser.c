@@ -30,13 +30,24 @@
 #include "input/input_internal.h"
 #include "preparser.h"
 #include "fetcher.h"
+#include "cache.h"
+
+struct preparser_scheme_limit
+{
+    char scheme[16];
+    int limit;
+};
 
 struct input_preparser_t
 {
     vlc_object_t* owner;
     input_fetcher_t* fetcher;
+    input_preparser_cache_t* cache;
     struct background_worker* worker;
     atomic_bool deactivated;
+
+    struct preparser_scheme_limit *limits;
+    size_t limit_count;
 };
 
 typedef struct input_preparser_req_t
@@ -45,6 +56,7 @@ typedef struct input_preparser_req_t
     input_item_meta_request_option_t options;
     const input_preparser_callbacks_t *cbs;
     void *userdata;
+    bool cacheable; /* unchanged local files are answered from the cache */
     vlc_atomic_rc_t rc;
 } input_preparser_req_t;
 
@@ -56,6 +68,8 @@ typedef struct input_preparser_task_t
     input_item_parser_id_t *parser;
     atomic_int state;
     atomic_bool done;
+    atomic_bool subtree;
+    bool cached;
 } input_preparser_task_t;
 
 static input_preparser_req_t *ReqCreate(input_item_t *item,
@@ -71,6 +85,7 @@ static input_preparser_req_t *ReqCreate(input_item_t *item,
     req->options = options;
     req->cbs = cbs;
     req->userdata = userdata;
+    req->cacheable = false;
     vlc_atomic_rc_init(&req->rc);
 
     input_item_Hold(item);
@@ -109,6 +124,7 @@ static void OnParserSubtreeAdded(input_item_t *item, input_item_node_t *subtree,
     input_preparser_task_t* task = task_;
     input_preparser_req_t *req = task->req;
 
+    atomic_store( &task->subtree, true );
     if (req->cbs && req->cbs->on_subtree_added)
         req->cbs->on_subtree_added(req->item, subtree, req->userdata);
 }
@@ -129,10 +145,27 @@ static int PreparserOpenInput( void* preparser_, void* req_, void** out )
 
     atomic_init( &task->state, VLC_ETIMEOUT );
     atomic_init( &task->done, false );
+    atomic_init( &task->subtree, false );
 
     task->preparser = preparser_;
     task->req = req;
     task->preparse_status = -1;
+    task->cached = false;
+
+    /* A cache hit completes at once, but still from the worker thread: the
+     * callers may hold locks that the callback needs. */
+    if( preparser->cache && req->cacheable
+     && input_preparser_cache_Lookup( preparser->cache, req->item ) )
+    {
+        task->parser = NULL;
+        task->cached = true;
+        atomic_store( &task->state, VLC_SUCCESS );
+        atomic_store( &task->done, true );
+        background_worker_RequestProbe( preparser->worker );
+        *out = task;
+        return VLC_SUCCESS;
+    }
+
     task->parser = input_item_Parse( req->item, preparser->owner, &cbs,
                                      task );
     if( !task->parser )
@@ -198,7 +231,12 @@ static void PreparserCloseInput( void* preparser_, void* task_ )
             break;
     }
 
-    input_item_parser_id_Release( task->parser );
+    if( task->parser != NULL )
+        input_item_parser_id_Release( task->parser );
+
+    if( preparser->cache && status == ITEM_PREPARSE_DONE && !task->cached
+     && !atomic_load( &task->subtree ) )
+        input_preparser_cache_Store( preparser->cache, item );
 
     if( preparser->fetcher && (req->options & META_REQUEST_OPTION_FETCH_ANY) )
     {
@@ -223,6 +261,74 @@ static void PreparserCloseInput( void* preparser_, void* task_ )
 static void ReqHoldVoid(void *item) { ReqHold(item); }
 static void ReqReleaseVoid(void *item) { ReqRelease(item); }
 
+static const void *PreparserGetClass( void* preparser_, void* req_,
+                                      int* limit )
+{
+    input_preparser_t* preparser = preparser_;
+    input_preparser_req_t *req = req_;
+    const void *class = NULL;
+
+    vlc_mutex_lock( &req->item->lock );
+    const char *uri = req->item->psz_uri;
+    const char *end = strstr( uri, "://" );
+    if( end != NULL )
+    {
+        size_t len = end - uri;
+        for( size_t i = 0; i < preparser->limit_count; i++ )
+        {
+            struct preparser_scheme_limit *l = &preparser->limits[i];
+            if( strlen( l->scheme ) == len
+             && !strncasecmp( l->scheme, uri, len ) )
+            {
+                *limit = l->limit;
+                class = l;
+                break;
+            }
+        }
+    }
+    vlc_mutex_unlock( &req->item->lock );
+    return class;
+}
+
+/**
+ * Parses the per-scheme concurrency limits, formatted as a comma-separated
+ * list of scheme=limit pairs (e.g. "smb=1,nfs=2").
+ */
+static void PreparserParseLimits( input_preparser_t *preparser,
+                                  const char *str )
+{
+    preparser->limits = NULL;
+    preparser->limit_count = 0;
+
+    char *dup = str != NULL ? strdup( str ) : NULL;
+    if( dup == NULL )
+        return;
+
+    char *saveptr;
+    for( char *tok = strtok_r( dup, ",", &saveptr ); tok != NULL;
+         tok = strtok_r( NULL, ",", &saveptr ) )
+    {
+        char scheme[16];
+        int limit;
+        if( sscanf( tok, " %15[^= ] = %d", scheme, &limit ) != 2 || limit <= 0 )
+        {
+            msg_Warn( preparser->owner, "invalid preparser limit: %s", tok );
+            continue;
+        }
+
+        struct preparser_scheme_limit *tab =
+            realloc( preparser->limits,
+                     (preparser->limit_count + 1) * sizeof( *tab ) );
+        if( unlikely( tab == NULL ) )
+            break;
+        preparser->limits = tab;
+        strcpy( tab[preparser->limit_count].scheme, scheme );
+        tab[preparser->limit_count].limit = limit;
+        preparser->limit_count++;
+    }
+    free( dup );
+}
+
 input_preparser_t* input_preparser_New( vlc_object_t *parent )
 {
     input_preparser_t* preparser = malloc( sizeof *preparser );
@@ -234,7 +340,8 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
         .pf_probe = PreparserProbeInput,
         .pf_stop = PreparserCloseInput,
         .pf_release = ReqReleaseVoid,
-        .pf_hold = ReqHoldVoid
+        .pf_hold = ReqHoldVoid,
+        .pf_get_class = PreparserGetClass,
     };
 
 
@@ -254,6 +361,18 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
     if( unlikely( !preparser->fetcher ) )
         msg_Warn( parent, "unable to create art fetcher" );
 
+    preparser->cache = NULL;
+    if( var_InheritBool( parent, "preparse-cache" ) )
+    {
+        preparser->cache = input_preparser_cache_New( parent );
+        if( unlikely( !preparser->cache ) )
+            msg_Warn( parent, "unable to create preparser cache" );
+    }
+
+    char *limits = var_InheritString( parent, "preparse-scheme-threads" );
+    PreparserParseLimits( preparser, limits );
+    free( limits );
+
     return preparser;
 }
 
@@ -289,6 +408,14 @@ void input_preparser_Push( input_preparser_t *preparser,
 
     struct input_preparser_req_t *req = ReqCreate(item, i_options,
                                                   cbs, cbs_userdata);
+    if (unlikely(!req))
+    {
+        if (cbs && cbs->on_preparse_ended)
+            cbs->on_preparse_ended(item, ITEM_PREPARSE_FAILED, cbs_userdata);
+        return;
+    }
+
+    req->cacheable = i_type == ITEM_TYPE_FILE && !b_net;
 
     if (background_worker_Push(preparser->worker, req, id, timeout))
         if (req->cbs && cbs->on_preparse_ended)
@@ -324,5 +451,9 @@ void input_preparser_Delete( input_preparser_t *preparser )
     if( preparser->fetcher )
         input_fetcher_Delete( preparser->fetcher );
 
+    if( preparser->cache )
+        input_preparser_cache_Delete( preparser->cache );
+
+    free( preparser->limits );
     free( preparser );
 }
@@ -0,0 +1,228 @@
+/*****************************************************************************
+ * preparser/test.c
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_input_item.h>
+#include <vlc_url.h>
+
+#include "input/item.h"
+#include "cache.h"
+
+/* The test cache is bounded to 16 entries, pruned down to 14 */
+#define FILES 26
+#define DAY (24 * 3600)
+
+/* Not exported, and the test entries have no tracks */
+void input_item_UpdateTracksInfo(input_item_t *item, const es_format_t *fmt)
+{
+    VLC_UNUSED(item);
+    VLC_UNUSED(fmt);
+}
+
+static char dir[] = "/tmp/vlc-preparser-cache-XXXXXX";
+
+static char *
+FilePath(int i)
+{
+    char *path;
+    int ret = asprintf(&path, "%s/%02d.ogg", dir, i);
+    assert(ret != -1);
+    return path;
+}
+
+static char *
+FileUri(int i)
+{
+    char *path = FilePath(i);
+    char *uri = vlc_path2uri(path, "file");
+    assert(uri != NULL);
+    free(path);
+    return uri;
+}
+
+static void
+FileCreate(int i, size_t size)
+{
+    char *path = FilePath(i);
+    FILE *file = fopen(path, "wb");
+    assert(file != NULL);
+    for (size_t j = 0; j < size; j++)
+        fputc(j, file);
+    fclose(file);
+    free(path);
+}
+
+static bool
+Lookup(input_preparser_cache_t *cache, int i)
+{
+    char *uri = FileUri(i);
+    input_item_t *item = input_item_New(uri, NULL);
+    assert(item != NULL);
+    free(uri);
+
+    bool hit = input_preparser_cache_Lookup(cache, item);
+    if (hit)
+        assert(input_item_GetDuration(item) == VLC_TICK_FROM_SEC(i));
+    input_item_Release(item);
+    return hit;
+}
+
+static void
+Store(input_preparser_cache_t *cache, int i)
+{
+    char *uri = FileUri(i);
+    input_item_t *item = input_item_New(uri, NULL);
+    assert(item != NULL);
+    free(uri);
+
+    input_item_SetDuration(item, VLC_TICK_FROM_SEC(i));
+    input_item_SetTitle(item, "title");
+    input_preparser_cache_Store(cache, item);
+    input_item_Release(item);
+}
+
+/* Writes a cache where file i was last used i days ago, except for the
+ * last one, unused for longer than the maximum age */
+static void
+WriteCache(const char *path, int count)
+{
+    FILE *file = fopen(path, "wt");
+    assert(file != NULL);
+    fputs("vlc-preparser-cache 1\n", file);
+
+    int64_t now = time(NULL);
+    for (int i = 0; i < count; i++)
+    {
+        char *fpath = FilePath(i);
+        struct stat st;
+        int ret = stat(fpath, &st);
+        assert(ret == 0);
+        free(fpath);
+
+        char *uri = FileUri(i);
+        char *enc = vlc_uri_encode(uri);
+        assert(enc != NULL);
+        free(uri);
+
+        int64_t used = now - (i < count - 1 ? i : 100) * DAY;
+        fprintf(file, "I =%s %"PRId64" %"PRIu64" %"PRId64" %"PRId64"\n", enc,
+                (int64_t)st.st_mtime, (uint64_t)st.st_size,
+                VLC_TICK_FROM_SEC(i), used);
+        fputs("M 0 =title\n", file);
+        free(enc);
+    }
+    fclose(file);
+}
+
+int
+main(void)
+{
+    char *ret = mkdtemp(dir);
+    assert(ret != NULL);
+    setenv("XDG_CACHE_HOME", dir, 1);
+
+    char *vlcdir, *path;
+    int len = asprintf(&vlcdir, "%s/vlc", dir);
+    assert(len != -1);
+    len = asprintf(&path, "%s/preparser.cache", vlcdir);
+    assert(len != -1);
+
+    vlc_object_t *obj = (vlc_object_create)(NULL, sizeof (*obj));
+    assert(obj != NULL);
+
+    for (int i = 0; i < FILES; i++)
+        FileCreate(i, i + 1);
+
+    /* The cache directory is created, and the cache starts empty */
+    input_preparser_cache_t *cache = input_preparser_cache_New(obj);
+    assert(cache != NULL);
+    for (int i = 0; i < FILES; i++)
+        assert(!Lookup(cache, i));
+    input_preparser_cache_Delete(cache);
+
+    /* Loading drops the expired entry, then the least recently used ones
+     * above the bound: 19 days old to 14 days old */
+    WriteCache(path, 20);
+    cache = input_preparser_cache_New(obj);
+    assert(cache != NULL);
+    assert(!Lookup(cache, 19));
+    for (int i = 14; i < 19; i++)
+        assert(!Lookup(cache, i));
+
+    /* A lookup refreshes the oldest remaining entry... */
+    assert(Lookup(cache, 13));
+
+    /* ...so that new entries above the bound drop the next oldest ones:
+     * 12 days old to 10 days old */
+    for (int i = 20; i < 25; i++)
+        Store(cache, i);
+    assert(Lookup(cache, 13));
+    for (int i = 10; i < 13; i++)
+        assert(!Lookup(cache, i));
+    for (int i = 0; i < 10; i++)
+        assert(Lookup(cache, i));
+    for (int i = 20; i < 25; i++)
+        assert(Lookup(cache, i));
+    input_preparser_cache_Delete(cache);
+
+    /* The saved cache is reloaded as is, and modified files are missed */
+    FileCreate(0, 100);
+    cache = input_preparser_cache_New(obj);
+    assert(cache != NULL);
+    assert(!Lookup(cache, 0));
+    for (int i = 1; i < 10; i++)
+        assert(Lookup(cache, i));
+    for (int i = 10; i < 13; i++)
+        assert(!Lookup(cache, i));
+    assert(Lookup(cache, 13));
+    for (int i = 14; i < 20; i++)
+        assert(!Lookup(cache, i));
+    for (int i = 20; i < 25; i++)
+        assert(Lookup(cache, i));
+    assert(!Lookup(cache, 25));
+    input_preparser_cache_Delete(cache);
+
+    for (int i = 0; i < FILES; i++)
+    {
+        char *fpath = FilePath(i);
+        unlink(fpath);
+        free(fpath);
+    }
+    unlink(path);
+    rmdir(vlcdir);
+    rmdir(dir);
+    free(path);
+    free(vlcdir);
+    vlc_object_delete(obj);
+    return 0;
+}
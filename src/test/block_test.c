@@ -86,11 +86,57 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void test_block_Share (void)
+{
+    block_t *block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    block->i_pts = VLC_TICK_0;
+
+    block = block_Share (block);
+    assert (block != NULL);
+
+    block_t *clone = block_Clone (block);
+    assert (clone != NULL);
+    assert (clone->p_buffer == block->p_buffer);
+    assert (clone->i_buffer == sizeof (text));
+    assert (clone->i_pts == VLC_TICK_0);
+
+    /* Growing a shared block must not write over the other references */
+    clone = block_Realloc (clone, 4, clone->i_buffer);
+    assert (clone != NULL);
+    assert (clone->p_buffer != block->p_buffer + 4);
+    memcpy (clone->p_buffer, "ABCD", 4);
+    assert (!memcmp (clone->p_buffer + 4, text, sizeof (text)));
+    assert (!memcmp (block->p_buffer, text, sizeof (text)));
+    block_Release (clone);
+
+    clone = block_Clone (block);
+    assert (clone != NULL);
+    clone->p_buffer += 5;
+    clone->i_buffer -= 5;
+    clone = block_Unshare (clone);
+    assert (clone != NULL);
+    assert (clone->p_buffer != block->p_buffer + 5);
+    memset (clone->p_buffer, 'A', clone->i_buffer);
+    assert (!memcmp (block->p_buffer, text, sizeof (text)));
+    block_Release (clone);
+
+    /* The last reference owns the data again */
+    unsigned char *data = block->p_buffer;
+    block = block_Unshare (block);
+    assert (block != NULL);
+    assert (block->p_buffer == data);
+    assert (block->i_pts == VLC_TICK_0);
+    block_Release (block);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_Share ();
     return 0;
 }
 
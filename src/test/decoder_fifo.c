@@ -0,0 +1,95 @@
+/*****************************************************************************
+ * decoder_fifo.c: test src/input/decoder_fifo.h
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include "../input/decoder_fifo.h"
+
+#define FRAME VLC_TICK_FROM_MS(40)
+
+static block_t blocks[100];
+
+static void queue(struct decoder_fifo_length *f, unsigned i, vlc_tick_t dts,
+                  vlc_tick_t length, uint32_t flags)
+{
+    block_t *b = &blocks[i];
+
+    b->i_dts = dts;
+    b->i_pts = VLC_TICK_INVALID;
+    b->i_length = length;
+    b->i_flags = flags;
+    decoder_fifo_length_Queue(f, b);
+}
+
+int main(void)
+{
+    struct decoder_fifo_length f;
+
+    /* Timestamps only: the first block does not count */
+    decoder_fifo_length_Reset(&f);
+    for (unsigned i = 0; i < 10; i++)
+        queue(&f, i, VLC_TICK_0 + i * FRAME, 0, 0);
+    assert(f.length == 9 * FRAME);
+    for (unsigned i = 0; i < 5; i++)
+        decoder_fifo_length_Dequeue(&f, &blocks[i]);
+    assert(f.length == 5 * FRAME);
+
+    /* A forward jump flagged as a discontinuity counts for nothing */
+    queue(&f, 10, VLC_TICK_FROM_SEC(3600), 0, BLOCK_FLAG_DISCONTINUITY);
+    assert(f.length == 5 * FRAME);
+    queue(&f, 11, VLC_TICK_FROM_SEC(3600) + FRAME, 0, 0);
+    assert(f.length == 6 * FRAME);
+
+    /* ...including once dequeued */
+    for (unsigned i = 5; i < 11; i++)
+        decoder_fifo_length_Dequeue(&f, &blocks[i]);
+    assert(f.length == FRAME);
+    decoder_fifo_length_Dequeue(&f, &blocks[11]);
+    assert(f.length == 0);
+
+    /* A backward jump counts for nothing either */
+    queue(&f, 12, VLC_TICK_0, 0, 0);
+    assert(f.length == 0);
+
+    /* Known lengths are counted as is, even without timestamps */
+    decoder_fifo_length_Reset(&f);
+    for (unsigned i = 0; i < 10; i++)
+        queue(&f, i, i & 1 ? VLC_TICK_INVALID : VLC_TICK_0 + i * FRAME,
+              FRAME, 0);
+    assert(f.length == 10 * FRAME);
+    for (unsigned i = 0; i < 10; i++)
+        decoder_fifo_length_Dequeue(&f, &blocks[i]);
+    assert(f.length == 0);
+
+    /* Dequeuing after a reset never underflows */
+    decoder_fifo_length_Reset(&f);
+    queue(&f, 0, VLC_TICK_0, 0, 0);
+    queue(&f, 1, VLC_TICK_0 + FRAME, 0, 0);
+    decoder_fifo_length_Reset(&f);
+    decoder_fifo_length_Dequeue(&f, &blocks[1]);
+    assert(f.length == 0);
+    return 0;
+}
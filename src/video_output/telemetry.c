@@ -0,0 +1,208 @@
+/*****************************************************************************
+ * telemetry.c : vout per-picture pacing records
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_vout.h>
+
+#include "telemetry.h"
+
+struct vout_telemetry {
+    vlc_mutex_t lock;
+    uint64_t    next_id; /* identifier of the next record, starts at 1 */
+    size_t      size;
+    vout_frame_telemetry_t records[];
+};
+
+vout_telemetry_t *vout_telemetry_New(size_t size)
+{
+    if (size == 0)
+        return NULL;
+
+    vout_telemetry_t *tm = malloc(sizeof (*tm) + size * sizeof (tm->records[0]));
+    if (unlikely(tm == NULL))
+        return NULL;
+
+    vlc_mutex_init(&tm->lock);
+    tm->next_id = 1;
+    tm->size = size;
+    return tm;
+}
+
+void vout_telemetry_Destroy(vout_telemetry_t *tm)
+{
+    free(tm);
+}
+
+static uint64_t FirstId(const vout_telemetry_t *tm)
+{
+    return tm->next_id > tm->size ? tm->next_id - tm->size : 1;
+}
+
+static vout_frame_telemetry_t *Record(vout_telemetry_t *tm, uint64_t id)
+{
+    return &tm->records[(id - 1) % tm->size];
+}
+
+static vout_frame_telemetry_t *Append(vout_telemetry_t *tm, vlc_tick_t pts)
+{
+    vout_frame_telemetry_t *rec = Record(tm, tm->next_id);
+
+    rec->id = tm->next_id++;
+    rec->pts = pts;
+    rec->decoded = VLC_TICK_INVALID;
+    rec->prepared = VLC_TICK_INVALID;
+    rec->rendered = VLC_TICK_INVALID;
+    rec->displayed = VLC_TICK_INVALID;
+    rec->status = VOUT_FRAME_PENDING;
+    return rec;
+}
+
+/* Looks for the most recent pending record of a picture */
+static vout_frame_telemetry_t *Find(vout_telemetry_t *tm, vlc_tick_t pts)
+{
+    for (uint64_t id = tm->next_id; id > FirstId(tm); id--)
+    {
+        vout_frame_telemetry_t *rec = Record(tm, id - 1);
+        if (rec->status == VOUT_FRAME_PENDING && rec->pts == pts)
+            return rec;
+    }
+    return NULL;
+}
+
+void vout_telemetry_Queued(vout_telemetry_t *tm, vlc_tick_t pts)
+{
+    if (tm == NULL)
+        return;
+
+    vlc_mutex_lock(&tm->lock);
+    Append(tm, pts)->decoded = vlc_tick_now();
+    vlc_mutex_unlock(&tm->lock);
+}
+
+void vout_telemetry_Prepared(vout_telemetry_t *tm, vlc_tick_t pts)
+{
+    if (tm == NULL)
+        return;
+
+    vlc_mutex_lock(&tm->lock);
+    vout_frame_telemetry_t *rec = Find(tm, pts);
+    if (rec != NULL && rec->prepared == VLC_TICK_INVALID)
+        rec->prepared = vlc_tick_now();
+    vlc_mutex_unlock(&tm->lock);
+}
+
+void vout_telemetry_Rendered(vout_telemetry_t *tm, vlc_tick_t pts)
+{
+    if (tm == NULL)
+        return;
+
+    vlc_mutex_lock(&tm->lock);
+    vout_frame_telemetry_t *rec = Find(tm, pts);
+    if (rec != NULL)
+        rec->rendered = vlc_tick_now();
+    vlc_mutex_unlock(&tm->lock);
+}
+
+void vout_telemetry_Displayed(vout_telemetry_t *tm, vlc_tick_t pts)
+{
+    if (tm == NULL)
+        return;
+
+    vlc_mutex_lock(&tm->lock);
+    vout_frame_telemetry_t *rec = Find(tm, pts);
+    if (rec != NULL)
+    {
+        rec->displayed = vlc_tick_now();
+        rec->status = VOUT_FRAME_DISPLAYED;
+
+        /* Pictures are displayed in queuing order: the older pending ones
+         * were swallowed by the static filters (rate conversion, etc). */
+        for (uint64_t id = FirstId(tm); id < rec->id; id++)
+        {
+            vout_frame_telemetry_t *old = Record(tm, id);
+            if (old->status == VOUT_FRAME_PENDING)
+                old->status = VOUT_FRAME_DROPPED_FILTER;
+        }
+    }
+    vlc_mutex_unlock(&tm->lock);
+}
+
+void vout_telemetry_Dropped(vout_telemetry_t *tm, vlc_tick_t pts,
+                            enum vout_frame_status status)
+{
+    if (tm == NULL)
+        return;
+
+    vlc_mutex_lock(&tm->lock);
+    vout_frame_telemetry_t *rec = Find(tm, pts);
+    if (rec == NULL && status == VOUT_FRAME_DROPPED_DECODER)
+        rec = Append(tm, pts);
+    if (rec != NULL)
+        rec->status = status;
+    vlc_mutex_unlock(&tm->lock);
+}
+
+void vout_telemetry_Flush(vout_telemetry_t *tm, vlc_tick_t date, bool below)
+{
+    if (tm == NULL)
+        return;
+
+    vlc_mutex_lock(&tm->lock);
+    for (uint64_t id = FirstId(tm); id < tm->next_id; id++)
+    {
+        vout_frame_telemetry_t *rec = Record(tm, id);
+        if (rec->status != VOUT_FRAME_PENDING)
+            continue;
+
+        /* Prepared pictures are always flushed, queued ones only if they
+         * match the picture fifo flush. */
+        if (rec->prepared != VLC_TICK_INVALID || date == VLC_TICK_INVALID
+         || ( below && rec->pts <= date)
+         || (!below && rec->pts >= date))
+            rec->status = VOUT_FRAME_FLUSHED;
+    }
+    vlc_mutex_unlock(&tm->lock);
+}
+
+size_t vout_telemetry_Read(vout_telemetry_t *tm, uint64_t *cursor,
+                           vout_frame_telemetry_t *frames, size_t count)
+{
+    if (tm == NULL)
+        return 0;
+
+    size_t n = 0;
+
+    vlc_mutex_lock(&tm->lock);
+    uint64_t id = __MAX(*cursor + 1, FirstId(tm));
+    for (; id < tm->next_id && n < count; id++)
+    {
+        const vout_frame_telemetry_t *rec = Record(tm, id);
+        if (rec->status == VOUT_FRAME_PENDING)
+            break; /* keep the order, resume from here next time */
+        frames[n++] = *rec;
+        *cursor = id;
+    }
+    vlc_mutex_unlock(&tm->lock);
+    return n;
+}
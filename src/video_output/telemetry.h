@@ -0,0 +1,68 @@
+/*****************************************************************************
+ * telemetry.h : vout per-picture pacing records
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_VOUT_TELEMETRY_H
+#define LIBVLC_VOUT_TELEMETRY_H
+
+#include <vlc_vout.h>
+
+/**
+ * Ring of the last pictures handed to the vout, identified by their
+ * timestamp. All the functions accept a NULL ring (telemetry disabled).
+ */
+typedef struct vout_telemetry vout_telemetry_t;
+
+/* */
+vout_telemetry_t *vout_telemetry_New(size_t size);
+void vout_telemetry_Destroy(vout_telemetry_t *);
+
+/**
+ * It records a new picture queued by the decoder.
+ */
+void vout_telemetry_Queued(vout_telemetry_t *, vlc_tick_t pts);
+
+/**
+ * It records the dates a pending picture reached the given stage.
+ */
+void vout_telemetry_Prepared(vout_telemetry_t *, vlc_tick_t pts);
+void vout_telemetry_Rendered(vout_telemetry_t *, vlc_tick_t pts);
+void vout_telemetry_Displayed(vout_telemetry_t *, vlc_tick_t pts);
+
+/**
+ * It records that a picture was dropped.
+ *
+ * A new record is created for pictures that never reached the vout.
+ */
+void vout_telemetry_Dropped(vout_telemetry_t *, vlc_tick_t pts,
+                            enum vout_frame_status);
+
+/**
+ * It marks the pending pictures discarded by vout_Flush() with the same
+ * parameters as flushed.
+ */
+void vout_telemetry_Flush(vout_telemetry_t *, vlc_tick_t date, bool below);
+
+/**
+ * See vout_GetFrameTelemetry().
+ */
+size_t vout_telemetry_Read(vout_telemetry_t *, uint64_t *cursor,
+                           vout_frame_telemetry_t *, size_t count);
+
+#endif
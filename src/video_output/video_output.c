@@ -59,6 +59,7 @@
 #include "../misc/variables.h"
 #include "../clock/clock.h"
 #include "statistic.h"
+#include "telemetry.h"
 #include "chrono.h"
 #include "control.h"
 
@@ -113,6 +114,7 @@ typedef struct vout_thread_sys_t
 
     /* Statistics */
     vout_statistic_t statistic;
+    vout_telemetry_t *telemetry;
 
     /* Subpicture unit */
     spu_t           *spu;
@@ -357,6 +359,22 @@ void vout_GetResetStatistic(vout_thread_t *vout, unsigned *restrict displayed,
     vout_statistic_GetReset( &sys->statistic, displayed, lost, late );
 }
 
+void vout_NotifyDroppedPicture(vout_thread_t *vout, vlc_tick_t pts)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+    assert(!sys->dummy);
+    vout_telemetry_Dropped(sys->telemetry, pts, VOUT_FRAME_DROPPED_DECODER);
+}
+
+size_t vout_GetFrameTelemetry(vout_thread_t *vout, uint64_t *cursor,
+                              vout_frame_telemetry_t *frames, size_t count)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+    if (sys->dummy)
+        return 0;
+    return vout_telemetry_Read(sys->telemetry, cursor, frames, count);
+}
+
 bool vout_IsEmpty(vout_thread_t *vout)
 {
     vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
@@ -499,6 +517,7 @@ void vout_PutPicture(vout_thread_t *vout, picture_t *picture)
     vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
     assert(!sys->dummy);
     picture->p_next = NULL;
+    vout_telemetry_Queued(sys->telemetry, picture->date);
     picture_fifo_Push(sys->decoder_fifo, picture);
     vout_control_Wake(&sys->control);
 }
@@ -1111,6 +1130,8 @@ static int ThreadDisplayPreparePicture(vout_thread_sys_t *vout, bool reuse,
                         late_threshold = VOUT_DISPLAY_LATE_THRESHOLD;
                     if (late > late_threshold) {
                         msg_Warn(&vout->obj, "picture is too late to be displayed (missing %"PRId64" ms)", MS_FROM_VLC_TICK(late));
+                        vout_telemetry_Dropped(sys->telemetry, decoded->date,
+                                               VOUT_FRAME_DROPPED_LATE);
                         picture_Release(decoded);
                         vout_statistic_AddLost(&sys->statistic, 1);
                         continue;
@@ -1154,6 +1175,8 @@ static int ThreadDisplayPreparePicture(vout_thread_sys_t *vout, bool reuse,
     if (!picture)
         return VLC_EGENERIC;
 
+    vout_telemetry_Prepared(sys->telemetry, picture->date);
+
     assert(!sys->displayed.next);
     if (!sys->displayed.current)
         sys->displayed.current = picture;
@@ -1231,6 +1254,7 @@ static int ThreadDisplayRenderPicture(vout_thread_sys_t *vout, bool is_forced)
     vout_thread_sys_t *sys = vout;
 
     picture_t *torender = picture_Hold(sys->displayed.current);
+    const vlc_tick_t current_pts = torender->date;
 
     vout_chrono_Start(&sys->render);
 
@@ -1239,7 +1263,11 @@ static int ThreadDisplayRenderPicture(vout_thread_sys_t *vout, bool is_forced)
     vlc_mutex_unlock(&sys->filter.lock);
 
     if (!filtered)
+    {
+        vout_telemetry_Dropped(sys->telemetry, current_pts,
+                               VOUT_FRAME_DROPPED_FILTER);
         return VLC_EGENERIC;
+    }
 
     if (filtered->date != sys->displayed.current->date)
         msg_Warn(&vout->obj, "Unsupported timestamp modifications done by chain_interactive");
@@ -1389,6 +1417,9 @@ static int ThreadDisplayRenderPicture(vout_thread_sys_t *vout, bool is_forced)
     if (todisplay == NULL) {
         vlc_mutex_unlock(&sys->display_lock);
 
+        vout_telemetry_Dropped(sys->telemetry, current_pts,
+                               VOUT_FRAME_DROPPED_POOL);
+
         if (subpic != NULL)
             subpicture_Delete(subpic);
         return VLC_EGENERIC;
@@ -1417,6 +1448,7 @@ static int ThreadDisplayRenderPicture(vout_thread_sys_t *vout, bool is_forced)
         vd->ops->prepare(vd, todisplay, do_dr_spu ? subpic : NULL, system_pts);
 
     vout_chrono_Stop(&sys->render);
+    vout_telemetry_Rendered(sys->telemetry, current_pts);
 #if 0
         {
         static int i = 0;
@@ -1459,6 +1491,8 @@ static int ThreadDisplayRenderPicture(vout_thread_sys_t *vout, bool is_forced)
     vout_display_Display(vd, todisplay);
     vlc_mutex_unlock(&sys->display_lock);
 
+    vout_telemetry_Displayed(sys->telemetry, current_pts);
+
     if (subpic)
         subpicture_Delete(subpic);
 
@@ -1550,6 +1584,11 @@ static int ThreadDisplayPicture(vout_thread_sys_t *vout, vlc_tick_t *deadline)
     }
 
     if (drop_next_frame) {
+        /* No-op if the current picture was already displayed */
+        if (sys->displayed.current)
+            vout_telemetry_Dropped(sys->telemetry,
+                                   sys->displayed.current->date,
+                                   VOUT_FRAME_DROPPED_LATE);
         picture_Release(sys->displayed.current);
         sys->displayed.current = sys->displayed.next;
         sys->displayed.next    = NULL;
@@ -1610,6 +1649,7 @@ static void vout_FlushUnlocked(vout_thread_sys_t *vout, bool below,
         }
     }
 
+    vout_telemetry_Flush(sys->telemetry, date, below);
     picture_fifo_Flush(sys->decoder_fifo, date, below);
 
     vlc_mutex_lock(&sys->display_lock);
@@ -2036,6 +2076,7 @@ void vout_Release(vout_thread_t *vout)
 
     /* */
     vout_statistic_Clean(&sys->statistic);
+    vout_telemetry_Destroy(sys->telemetry);
 
     /* */
     vout_snapshot_Destroy(sys->snapshot);
@@ -2103,6 +2144,7 @@ vout_thread_t *vout_Create(vlc_object_t *object)
     sys->source.crop.mode = VOUT_CROP_NONE;
     sys->snapshot = vout_snapshot_New();
     vout_statistic_Init(&sys->statistic);
+    sys->telemetry = vout_telemetry_New(var_InheritInteger(vout, "vout-telemetry"));
 
     /* Initialize subpicture unit */
     sys->spu = var_InheritBool(vout, "spu") || var_InheritBool(vout, "osd") ?
@@ -186,6 +186,11 @@ void vout_MouseState(vout_thread_t *, const vlc_mouse_t *);
 void vout_GetResetStatistic( vout_thread_t *p_vout, unsigned *pi_displayed,
                              unsigned *pi_lost, unsigned *pi_late );
 
+/**
+ * This function will record a picture dropped before reaching the vout.
+ */
+void vout_NotifyDroppedPicture( vout_thread_t *p_vout, vlc_tick_t i_pts );
+
 /**
  * This function will force to display the next picture while paused
  */
@@ -0,0 +1,209 @@
+/*****************************************************************************
+ * srt.c: test the SRT stream output socket groups
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* A broadcast group is connected to an IPv4 and an IPv6 loopback listener,
+ * the latter given as a bracketed group link. Both links must join the
+ * group, and the messages must come out once and in order. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_modules.h>
+#include <vlc_network.h>
+#include <vlc_sout.h>
+
+#include <srt/srt.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#if SRT_VERSION_VALUE >= SRT_MAKE_VERSION_VALUE(1, 5, 0)
+
+#define MESSAGES 50
+#define MESSAGE_SIZE 1316
+#define PROBE 0xff /* sent until the group is connected */
+
+static SRTSOCKET listen_loopback(int family, int *port)
+{
+    struct sockaddr_storage addr;
+    int len;
+
+    memset(&addr, 0, sizeof (addr));
+    if (family == AF_INET6)
+    {
+        struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)&addr;
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_addr = in6addr_loopback;
+        len = sizeof (*sin6);
+    }
+    else
+    {
+        struct sockaddr_in *sin = (struct sockaddr_in *)&addr;
+        sin->sin_family = AF_INET;
+        sin->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        len = sizeof (*sin);
+    }
+
+    SRTSOCKET s = srt_create_socket();
+    assert(s != SRT_INVALID_SOCK);
+
+    int val = 1;
+    srt_setsockflag(s, SRTO_GROUPCONNECT, &val, sizeof (val));
+    val = 5000;
+    srt_setsockflag(s, SRTO_RCVTIMEO, &val, sizeof (val));
+
+    if (srt_bind(s, (struct sockaddr *)&addr, len) == SRT_ERROR)
+    {   /* no IPv6 loopback, most likely */
+        srt_close(s);
+        return SRT_INVALID_SOCK;
+    }
+
+    assert(srt_getsockname(s, (struct sockaddr *)&addr, &len) == 0);
+    if (family == AF_INET6)
+        *port = ntohs(((struct sockaddr_in6 *)&addr)->sin6_port);
+    else
+        *port = ntohs(((struct sockaddr_in *)&addr)->sin_port);
+
+    assert(srt_listen(s, 2) == 0);
+    return s;
+}
+
+static int send_message(sout_access_out_t *out, uint8_t value)
+{
+    block_t *block = block_Alloc(MESSAGE_SIZE);
+    assert(block != NULL);
+    memset(block->p_buffer, value, MESSAGE_SIZE);
+    return sout_AccessOutWrite(out, block) == MESSAGE_SIZE ? 0 : -1;
+}
+
+static void test_group(vlc_object_t *obj, SRTSOCKET l4, int port4,
+                       SRTSOCKET l6, int port6)
+{
+    char dst[32], links[32];
+
+    snprintf(dst, sizeof (dst), "127.0.0.1:%d", port4);
+    snprintf(links, sizeof (links), "[::1]:%d", port6);
+    test_log("srt://%s with group link %s\n", dst, links);
+
+    var_Create(obj, "group", VLC_VAR_STRING);
+    var_SetString(obj, "group", "broadcast");
+    var_Create(obj, "group-links", VLC_VAR_STRING);
+    var_SetString(obj, "group-links", links);
+    var_Create(obj, "stats-interval", VLC_VAR_INTEGER);
+    var_SetInteger(obj, "stats-interval", 1);
+
+    sout_access_out_t *out = sout_AccessOutNew(obj, "srt", dst);
+    assert(out != NULL);
+
+    /* Messages are dropped until the group is connected */
+    unsigned tries = 0;
+    while (send_message(out, PROBE))
+    {
+        assert(++tries < 500);
+        vlc_tick_sleep(VLC_TICK_FROM_MS(10));
+    }
+
+    SRTSOCKET group = srt_accept_bond((SRTSOCKET[]){ l4, l6 }, 2, 5000);
+    assert(group != SRT_INVALID_SOCK);
+    assert(group & SRTGROUP_MASK);
+
+    for (unsigned i = 0; i < MESSAGES; i++)
+        assert(send_message(out, i) == 0);
+
+    /* Both links join the group */
+    SRT_SOCKGROUPDATA members[2];
+    size_t count = ARRAY_SIZE(members);
+    for (tries = 0; srt_group_data(group, members, &count) != 2; tries++)
+    {
+        assert(tries < 500);
+        count = ARRAY_SIZE(members);
+        vlc_tick_sleep(VLC_TICK_FROM_MS(10));
+    }
+
+    /* Each message is received once, in order */
+    uint8_t buf[MESSAGE_SIZE];
+    unsigned next = 0;
+    while (next < MESSAGES)
+    {
+        int len = srt_recvmsg(group, (char *)buf, sizeof (buf));
+        assert(len == MESSAGE_SIZE);
+        if (buf[0] == PROBE)
+        {
+            assert(next == 0);
+            continue;
+        }
+        assert(buf[0] == next);
+        assert(buf[MESSAGE_SIZE - 1] == next);
+        next++;
+    }
+
+    /* The sender statistics were updated */
+    vlc_tick_sleep(VLC_TICK_FROM_MS(100));
+    assert(send_message(out, PROBE) == 0);
+    int64_t sent = var_GetInteger(out, "srt-packets-sent");
+    test_log("%"PRId64" packets sent\n", sent);
+    assert(sent >= MESSAGES);
+
+    sout_AccessOutDelete(out);
+    srt_close(group);
+}
+
+int main(void)
+{
+    test_init();
+    srt_startup();
+
+    int port4, port6;
+    SRTSOCKET l4 = listen_loopback(AF_INET, &port4);
+    SRTSOCKET l6 = listen_loopback(AF_INET6, &port6);
+    int ret = 77;
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    if (l4 != SRT_INVALID_SOCK && l6 != SRT_INVALID_SOCK
+     && module_exists("access_output_srt"))
+    {
+        test_group(VLC_OBJECT(vlc->p_libvlc_int), l4, port4, l6, port6);
+        ret = 0;
+    }
+
+    libvlc_release(vlc);
+    if (l4 != SRT_INVALID_SOCK)
+        srt_close(l4);
+    if (l6 != SRT_INVALID_SOCK)
+        srt_close(l6);
+    srt_cleanup();
+    return ret;
+}
+
+#else
+int main(void)
+{
+    return 77; /* no socket groups before libsrt 1.5.0 */
+}
+#endif
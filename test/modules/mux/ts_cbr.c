@@ -0,0 +1,218 @@
+/*****************************************************************************
+ * ts_cbr.c: test the constant bitrate mode of the TS mux
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* With a mux rate, each packet is dated from its position in the stream:
+ * the PCRs must follow the byte count exactly, and be sent at least every
+ * 40ms whatever the requested PCR interval. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_es.h>
+#include <vlc_fs.h>
+#include <vlc_modules.h>
+#include <vlc_sout.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define FRAMES 100
+#define FRAME_DURATION VLC_TICK_FROM_MS(40)
+#define MUX_RATE 2000000
+
+/* 16x16 SPS and PPS, with 4 bytes start codes */
+static const uint8_t sps[] = {
+    0x00, 0x00, 0x00, 0x01, 0x67, 0xf4, 0x00, 0x0a, 0x91, 0x9b, 0x2b, 0xd0,
+    0x80, 0x00, 0x00, 0x03, 0x00, 0x80, 0x00, 0x00, 0x19, 0x07, 0x89, 0x12,
+    0xcb,
+};
+static const uint8_t pps[] = {
+    0x00, 0x00, 0x00, 0x01, 0x68, 0xeb, 0xec, 0x44, 0x84, 0x40,
+};
+
+#define NAL_SIZE 1000
+
+static bool has_mux(const char *name)
+{
+    size_t count;
+    module_t **list = module_list_get(&count);
+    bool found = false;
+
+    for (size_t i = 0; i < count && !found; i++)
+        found = module_provides(list[i], "sout mux")
+             && !strcmp(module_get_object(list[i]), name);
+    module_list_free(list);
+    return found;
+}
+
+static void mux_frames(libvlc_instance_t *vlc, const char *path)
+{
+    char chain[512];
+
+    /* The requested PCR interval exceeds the constant bitrate limit */
+    snprintf(chain, sizeof (chain),
+             "std{access=file,mux=ts{muxrate=%d,pcr=70},dst=%s}",
+             MUX_RATE, path);
+    test_log("%s\n", chain);
+
+    sout_instance_t *sout = vlc_object_create(vlc->p_libvlc_int,
+                                              sizeof (*sout));
+    assert(sout != NULL);
+    vlc_mutex_init(&sout->lock);
+    sout->psz_sout = NULL;
+    sout->i_out_pace_nocontrol = 0;
+    sout->b_wants_substreams = false;
+
+    sout_stream_t *stream = sout_StreamChainNew(sout, chain, NULL, NULL);
+    assert(stream != NULL);
+
+    es_format_t fmt;
+    es_format_Init(&fmt, VIDEO_ES, VLC_CODEC_H264);
+    fmt.video.i_width = fmt.video.i_visible_width = 16;
+    fmt.video.i_height = fmt.video.i_visible_height = 16;
+    fmt.video.i_frame_rate = 25;
+    fmt.video.i_frame_rate_base = 1;
+    fmt.b_packetized = true;
+
+    void *id = sout_StreamIdAdd(stream, &fmt);
+    assert(id != NULL);
+
+    for (unsigned i = 0; i < FRAMES; i++)
+    {
+        size_t len = NAL_SIZE + (i ? 0 : sizeof (sps) + sizeof (pps));
+        block_t *block = block_Alloc(len);
+        assert(block != NULL);
+
+        uint8_t *p = block->p_buffer;
+        if (i == 0)
+        {
+            memcpy(p, sps, sizeof (sps));
+            p += sizeof (sps);
+            memcpy(p, pps, sizeof (pps));
+            p += sizeof (pps);
+        }
+        SetDWBE(p, 1);
+        p[4] = i ? 0x41 : 0x65;
+        memset(p + 5, 1 + i % 254, NAL_SIZE - 5);
+
+        block->i_dts = block->i_pts = VLC_TICK_0 + i * FRAME_DURATION;
+        block->i_length = FRAME_DURATION;
+        block->i_flags = i ? BLOCK_FLAG_TYPE_P : BLOCK_FLAG_TYPE_I;
+        sout_StreamIdSend(stream, id, block);
+    }
+
+    sout_StreamIdDel(stream, id);
+    sout_StreamChainDelete(stream, NULL);
+    vlc_object_delete(sout);
+    es_format_Clean(&fmt);
+}
+
+/* Checks the PCRs against the packet positions, returns their count */
+static unsigned check_pcr(FILE *file)
+{
+    const int64_t wrap = INT64_C(300) << 33;
+    const int64_t packet = INT64_C(188 * 8 * 27000000) / MUX_RATE;
+    int64_t origin = -1, last = -1;
+    uint64_t n = 0, n0 = 0;
+    unsigned count = 0;
+    uint8_t pkt[188];
+
+    while (fread(pkt, 1, sizeof (pkt), file) == sizeof (pkt))
+    {
+        assert(pkt[0] == 0x47);
+
+        if ((pkt[3] & 0x20) && pkt[4] >= 7 && (pkt[5] & 0x10))
+        {
+            int64_t base = ((int64_t)pkt[6] << 25) | (pkt[7] << 17)
+                         | (pkt[8] << 9) | (pkt[9] << 1) | (pkt[10] >> 7);
+            int64_t pcr = base * 300 + (((pkt[10] & 1) << 8) | pkt[11]);
+
+            /* A discontinuity restarts the timeline */
+            if (origin < 0 || (pkt[5] & 0x80))
+            {
+                origin = pcr;
+                n0 = n;
+            }
+            else
+            {
+                int64_t expected = (int64_t)(((n - n0) * UINT64_C(188 * 8 *
+                                            27000000)) / MUX_RATE);
+                int64_t diff = (pcr - origin - expected) % wrap;
+
+                if (diff > wrap / 2)
+                    diff -= wrap;
+                else if (diff < -wrap / 2)
+                    diff += wrap;
+                assert(diff >= -1 && diff <= 1);
+
+                int64_t gap = (pcr - last + wrap) % wrap;
+                assert(gap <= 40 * 27000 + packet);
+            }
+            last = pcr;
+            count++;
+        }
+        n++;
+    }
+    assert(feof(file));
+    return count;
+}
+
+int main(void)
+{
+    test_init();
+
+    char path[] = "/tmp/vlc-test-ts-cbr-XXXXXX";
+    int fd = vlc_mkstemp(path);
+    if (fd == -1)
+        return 77;
+    close(fd);
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    if (!has_mux("ts"))
+    {
+        libvlc_release(vlc);
+        unlink(path);
+        return 77;
+    }
+
+    mux_frames(vlc, path);
+    libvlc_release(vlc);
+
+    FILE *file = fopen(path, "rb");
+    assert(file != NULL);
+
+    /* The mux may hold back the end of the stream */
+    unsigned count = check_pcr(file);
+    test_log("%u PCRs\n", count);
+    assert(count >= 2000 / 40);
+
+    fclose(file);
+    unlink(path);
+    return 0;
+}
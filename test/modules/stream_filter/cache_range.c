@@ -0,0 +1,215 @@
+/*****************************************************************************
+ * cache_range.c: test backward seeks through the byte range cache
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vlc_common.h>
+#include <vlc_stream.h>
+
+/* The memory stream stands for a seekable network stream: it must not
+ * report fast seeking, or the filter would refuse it. */
+static int TestStreamControl(stream_t *s, int query, ...)
+{
+    va_list ap;
+    int ret;
+
+    va_start(ap, query);
+    if (query == STREAM_CAN_FASTSEEK)
+    {
+        *va_arg(ap, bool *) = false;
+        ret = VLC_SUCCESS;
+    }
+    else
+        ret = vlc_stream_vaControl(s, query, ap);
+    va_end(ap);
+    return ret;
+}
+
+#define MODULE_NAME cache_range
+#define MODULE_STRING "cache_range"
+const char vlc_module_name[] = MODULE_STRING;
+
+#define vlc_stream_Control TestStreamControl
+#include "../modules/stream_filter/cache_range.c"
+#undef vlc_stream_Control
+
+#define CHUNKS 16
+#define DATA_SIZE (CHUNKS * CHUNK_SIZE)
+
+static uint8_t data[DATA_SIZE];
+
+static void test_read(stream_t *s, uint64_t offset, size_t len)
+{
+    uint8_t buf[4096];
+
+    assert(len <= sizeof (buf));
+    int ret = s->pf_seek(s, offset);
+    assert(ret == VLC_SUCCESS);
+
+    for (size_t done = 0; done < len;)
+    {
+        ssize_t val = s->pf_read(s, buf + done, len - done);
+        assert(val > 0);
+        done += val;
+    }
+    assert(memcmp(buf, data + offset, len) == 0);
+}
+
+static void test_read_all(stream_t *s)
+{
+    for (uint64_t offset = 0; offset < DATA_SIZE; offset += 4096)
+        test_read(s, offset, 4096);
+}
+
+static stream_t *test_open(stream_t *source, int memory_mib, int disk_mib)
+{
+    stream_t *s = vlc_object_create(source, sizeof (*s));
+    assert(s != NULL);
+
+    s->s = source;
+    var_Create(s, "cache-range-size", VLC_VAR_INTEGER);
+    var_SetInteger(s, "cache-range-size", memory_mib);
+    var_Create(s, "cache-range-disk-size", VLC_VAR_INTEGER);
+    var_SetInteger(s, "cache-range-disk-size", disk_mib);
+
+    int ret = vlc_stream_Seek(source, 0);
+    assert(ret == VLC_SUCCESS);
+    if (Open(VLC_OBJECT(s)) != VLC_SUCCESS)
+    {
+        vlc_object_delete(s);
+        return NULL;
+    }
+    return s;
+}
+
+static void test_close(stream_t *s)
+{
+    Close(VLC_OBJECT(s));
+    vlc_object_delete(s);
+}
+
+static block_t *test_read_block(stream_t *s, bool *eof)
+{
+    (void) s;
+    *eof = true;
+    return NULL;
+}
+
+int main(void)
+{
+    char dir[] = "/tmp/vlc-cache-range-XXXXXX";
+    char *vlcdir;
+
+    char *ret = mkdtemp(dir);
+    assert(ret != NULL);
+    setenv("XDG_CACHE_HOME", dir, 1);
+    int len = asprintf(&vlcdir, "%s/vlc", dir);
+    assert(len != -1);
+
+    for (size_t i = 0; i < DATA_SIZE; i++)
+        data[i] = i * 7 + i / 251;
+
+    vlc_object_t *root = (vlc_object_create)(NULL, sizeof (*root));
+    assert(root != NULL);
+    stream_t *source = vlc_stream_MemoryNew(root, data, DATA_SIZE, true);
+    assert(source != NULL);
+
+    /* Block streams are left to the block cache */
+    source->pf_block = test_read_block;
+    assert(test_open(source, 32, 0) == NULL);
+    source->pf_block = NULL;
+
+    /* Disabled cache */
+    assert(test_open(source, 0, 0) == NULL);
+
+    /* Everything fits in memory: backward seeks never seek upstream */
+    stream_t *s = test_open(source, 32, 0);
+    assert(s != NULL);
+    stream_sys_t *sys = s->p_sys;
+
+    test_read_all(s);
+    assert(sys->stat.miss_bytes == DATA_SIZE);
+    assert(sys->stat.seeks == 0);
+
+    test_read(s, 0, 100);
+    test_read(s, DATA_SIZE / 2 - 50, 100);
+    test_read(s, CHUNK_SIZE - 10, 20); /* across chunks */
+    test_read(s, 3, 4096);
+    assert(sys->stat.miss_bytes == DATA_SIZE);
+    assert(sys->stat.seeks == 0);
+    test_close(s);
+
+    /* 4 chunks in memory: the first chunks are fetched again */
+    s = test_open(source, 1, 0);
+    assert(s != NULL);
+    sys = s->p_sys;
+
+    test_read_all(s);
+    assert(sys->memory_count == 4);
+    assert(sys->stat.seeks == 0);
+
+    test_read(s, (CHUNKS - 2) * CHUNK_SIZE + 1000, 100);
+    assert(sys->stat.seeks == 0);
+    test_read(s, 1000, 100);
+    assert(sys->stat.seeks == 1);
+    assert(sys->stat.miss_bytes > DATA_SIZE);
+    test_close(s);
+
+    /* 4 chunks in memory, and 8 spilled to disk */
+    s = test_open(source, 1, 2);
+    assert(s != NULL);
+    sys = s->p_sys;
+
+    if (sys->fd != -1)
+    {
+        test_read_all(s);
+        assert(sys->memory_count == 4);
+        assert(sys->disk_count == 8);
+
+        uint64_t miss_bytes = sys->stat.miss_bytes;
+        test_read(s, (CHUNKS - 12) * CHUNK_SIZE + 1000, 4096);
+        test_read(s, (CHUNKS - 6) * CHUNK_SIZE - 10, 20);
+        assert(sys->stat.seeks == 0);
+        assert(sys->stat.miss_bytes == miss_bytes);
+
+        test_read(s, 1000, 100);
+        assert(sys->stat.seeks == 1);
+    }
+    else
+        fprintf(stderr, "cannot create the spill file, skipped\n");
+    test_close(s);
+
+    vlc_stream_Delete(source);
+    vlc_object_delete(root);
+    rmdir(vlcdir);
+    rmdir(dir);
+    free(vlcdir);
+    return 0;
+}
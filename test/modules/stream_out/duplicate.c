@@ -0,0 +1,362 @@
+/*****************************************************************************
+ * duplicate.c: test the duplicate stream output with in-place writers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* The duplicate branches share the data of the blocks. The MP4 mux rewrites
+ * H.264 start codes into NAL lengths in place, and the WAV mux reorders the
+ * audio channels in place: neither must be seen by the other branches. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_es.h>
+#include <vlc_modules.h>
+#include <vlc_sout.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define FRAMES 50
+#define FRAME_DURATION VLC_TICK_FROM_MS(40)
+
+/* 16x16 SPS and PPS, with 4 bytes start codes */
+static const uint8_t sps[] = {
+    0x00, 0x00, 0x00, 0x01, 0x67, 0xf4, 0x00, 0x0a, 0x91, 0x9b, 0x2b, 0xd0,
+    0x80, 0x00, 0x00, 0x03, 0x00, 0x80, 0x00, 0x00, 0x19, 0x07, 0x89, 0x12,
+    0xcb,
+};
+static const uint8_t pps[] = {
+    0x00, 0x00, 0x00, 0x01, 0x68, 0xeb, 0xec, 0x44, 0x84, 0x40,
+};
+
+#define NAL_SIZE 64
+
+/* A slice NAL with a start code, unique to each frame */
+static void make_nal(uint8_t *nal, unsigned frame)
+{
+    SetDWBE(nal, 1);
+    nal[4] = frame ? 0x41 : 0x65;
+    for (unsigned i = 5; i < NAL_SIZE; i++)
+        nal[i] = 1 + (frame * 7 + i) % 254;
+}
+
+static bool has_mux(const char *name)
+{
+    size_t count;
+    module_t **list = module_list_get(&count);
+    bool found = false;
+
+    for (size_t i = 0; i < count && !found; i++)
+        found = module_provides(list[i], "sout mux")
+             && !strcmp(module_get_object(list[i]), name);
+    module_list_free(list);
+    return found;
+}
+
+static uint8_t *read_file(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return NULL;
+
+    uint8_t *data = NULL;
+    size_t len = 0;
+    for (;;)
+    {
+        uint8_t *grown = realloc(data, len + 65536);
+        assert(grown != NULL);
+        data = grown;
+
+        size_t ret = fread(data + len, 1, 65536, file);
+        len += ret;
+        if (ret < 65536)
+            break;
+    }
+    fclose(file);
+    *size = len;
+    return data;
+}
+
+/* Concatenates the payloads of the TS packets of a PID */
+static size_t ts_payload(uint8_t *data, size_t size, unsigned pid)
+{
+    size_t out = 0;
+
+    for (size_t i = 0; i + 188 <= size; i += 188)
+    {
+        const uint8_t *pkt = &data[i];
+        assert(pkt[0] == 0x47);
+        if ((unsigned)(((pkt[1] & 0x1f) << 8) | pkt[2]) != pid
+         || !(pkt[3] & 0x10))
+            continue;
+
+        size_t offset = 4;
+        if (pkt[3] & 0x20)
+            offset += 1 + pkt[4];
+        if (offset < 188)
+        {
+            memmove(&data[out], &pkt[offset], 188 - offset);
+            out += 188 - offset;
+        }
+    }
+    return out;
+}
+
+static void test_duplicate(libvlc_instance_t *vlc, const char *mux,
+                           const char *dir)
+{
+    char mp4_path[256], mpeg_path[256], chain[700];
+
+    snprintf(mp4_path, sizeof (mp4_path), "%s/out.mp4", dir);
+    snprintf(mpeg_path, sizeof (mpeg_path), "%s/out.%s", dir, mux);
+    snprintf(chain, sizeof (chain),
+             "duplicate{dst=std{access=file,mux=mp4,dst=%s},"
+                       "dst=std{access=file,mux=%s,dst=%s}}",
+             mp4_path, mux, mpeg_path);
+    test_log("%s\n", chain);
+
+    sout_instance_t *sout = vlc_object_create(vlc->p_libvlc_int,
+                                              sizeof (*sout));
+    assert(sout != NULL);
+    vlc_mutex_init(&sout->lock);
+    sout->psz_sout = NULL;
+    sout->i_out_pace_nocontrol = 0;
+    sout->b_wants_substreams = false;
+
+    sout_stream_t *stream = sout_StreamChainNew(sout, chain, NULL, NULL);
+    assert(stream != NULL);
+
+    es_format_t fmt;
+    es_format_Init(&fmt, VIDEO_ES, VLC_CODEC_H264);
+    fmt.video.i_width = fmt.video.i_visible_width = 16;
+    fmt.video.i_height = fmt.video.i_visible_height = 16;
+    fmt.video.i_frame_rate = 25;
+    fmt.video.i_frame_rate_base = 1;
+    fmt.b_packetized = true;
+
+    void *id = sout_StreamIdAdd(stream, &fmt);
+    assert(id != NULL);
+
+    for (unsigned i = 0; i < FRAMES; i++)
+    {
+        size_t len = NAL_SIZE + (i ? 0 : sizeof (sps) + sizeof (pps));
+        block_t *block = block_Alloc(len);
+        assert(block != NULL);
+
+        uint8_t *p = block->p_buffer;
+        if (i == 0)
+        {
+            memcpy(p, sps, sizeof (sps));
+            p += sizeof (sps);
+            memcpy(p, pps, sizeof (pps));
+            p += sizeof (pps);
+        }
+        make_nal(p, i);
+
+        block->i_dts = block->i_pts = VLC_TICK_0 + i * FRAME_DURATION;
+        block->i_length = FRAME_DURATION;
+        block->i_flags = i ? BLOCK_FLAG_TYPE_P : BLOCK_FLAG_TYPE_I;
+        sout_StreamIdSend(stream, id, block);
+    }
+
+    sout_StreamIdDel(stream, id);
+    sout_StreamChainDelete(stream, NULL);
+    vlc_object_delete(sout);
+    es_format_Clean(&fmt);
+
+    size_t mp4_size, mpeg_size;
+    uint8_t *mp4 = read_file(mp4_path, &mp4_size);
+    uint8_t *mpeg = read_file(mpeg_path, &mpeg_size);
+    assert(mp4 != NULL && mpeg != NULL);
+
+    /* The TS mux puts the video on the "pid-video" PID (100) */
+    if (!strcmp(mux, "ts"))
+        mpeg_size = ts_payload(mpeg, mpeg_size, 100);
+
+    /* The MPEG muxes may hold back the end of the stream */
+    for (unsigned i = 0; i < FRAMES - 10; i++)
+    {
+        uint8_t nal[NAL_SIZE];
+        make_nal(nal, i);
+
+        /* Annex B in the MPEG stream */
+        assert(memmem(mpeg, mpeg_size, nal, NAL_SIZE) != NULL);
+
+        /* NAL length in the MP4 samples */
+        SetDWBE(nal, NAL_SIZE - 4);
+        assert(memmem(mp4, mp4_size, nal, NAL_SIZE) != NULL);
+    }
+
+    free(mp4);
+    free(mpeg);
+    unlink(mp4_path);
+    unlink(mpeg_path);
+}
+
+#define AUDIO_CHANNELS 6
+#define AUDIO_FRAMES 4800
+
+static void make_samples(int16_t *samples, unsigned frame)
+{
+    /* Each channel has its own range, to tell them apart */
+    for (unsigned c = 0; c < AUDIO_CHANNELS; c++)
+        samples[c] = c * 5000 + frame % 5000;
+}
+
+static int cmp_sample(const void *a, const void *b)
+{
+    return *(const int16_t *)a - *(const int16_t *)b;
+}
+
+static void test_duplicate_wav(libvlc_instance_t *vlc, const char *dir)
+{
+    char wav_path[256], raw_path[256], chain[700];
+
+    snprintf(wav_path, sizeof (wav_path), "%s/out.wav", dir);
+    snprintf(raw_path, sizeof (raw_path), "%s/out.raw", dir);
+    snprintf(chain, sizeof (chain),
+             "duplicate{dst=std{access=file,mux=wav,dst=%s},"
+                       "dst=std{access=file,mux=raw,dst=%s}}",
+             wav_path, raw_path);
+    test_log("%s\n", chain);
+
+    sout_instance_t *sout = vlc_object_create(vlc->p_libvlc_int,
+                                              sizeof (*sout));
+    assert(sout != NULL);
+    vlc_mutex_init(&sout->lock);
+    sout->psz_sout = NULL;
+    sout->i_out_pace_nocontrol = 0;
+    sout->b_wants_substreams = false;
+
+    sout_stream_t *stream = sout_StreamChainNew(sout, chain, NULL, NULL);
+    assert(stream != NULL);
+
+    /* The side channels come last in WAV files, before the rear ones in VLC */
+    es_format_t fmt;
+    es_format_Init(&fmt, AUDIO_ES, VLC_CODEC_S16N);
+    fmt.audio.i_format = VLC_CODEC_S16N;
+    fmt.audio.i_rate = 48000;
+    fmt.audio.i_channels = AUDIO_CHANNELS;
+    fmt.audio.i_physical_channels = AOUT_CHANS_6_0;
+    fmt.audio.i_bitspersample = 16;
+    fmt.audio.i_blockalign = 2 * AUDIO_CHANNELS;
+    fmt.b_packetized = true;
+
+    void *id = sout_StreamIdAdd(stream, &fmt);
+    assert(id != NULL);
+
+    const unsigned per_block = 480;
+    for (unsigned i = 0; i < AUDIO_FRAMES; i += per_block)
+    {
+        block_t *block = block_Alloc(per_block * 2 * AUDIO_CHANNELS);
+        assert(block != NULL);
+
+        for (unsigned j = 0; j < per_block; j++)
+            make_samples((int16_t *)block->p_buffer + j * AUDIO_CHANNELS,
+                         i + j);
+
+        block->i_dts = block->i_pts = VLC_TICK_0
+                                    + vlc_tick_from_samples(i, 48000);
+        block->i_length = vlc_tick_from_samples(per_block, 48000);
+        block->i_nb_samples = per_block;
+        sout_StreamIdSend(stream, id, block);
+    }
+
+    sout_StreamIdDel(stream, id);
+    sout_StreamChainDelete(stream, NULL);
+    vlc_object_delete(sout);
+    es_format_Clean(&fmt);
+
+    size_t wav_size, raw_size;
+    uint8_t *wav = read_file(wav_path, &wav_size);
+    uint8_t *raw = read_file(raw_path, &raw_size);
+    assert(wav != NULL && raw != NULL);
+
+    /* The raw output has the samples as sent */
+    assert(raw_size == AUDIO_FRAMES * 2 * AUDIO_CHANNELS);
+    for (unsigned i = 0; i < AUDIO_FRAMES; i++)
+    {
+        int16_t frame[AUDIO_CHANNELS];
+        make_samples(frame, i);
+        assert(!memcmp(raw + i * sizeof (frame), frame, sizeof (frame)));
+    }
+
+    /* The WAV output has the same samples in another order */
+    const uint8_t *data = memmem(wav, wav_size, "data", 4);
+    assert(data != NULL);
+    data += 8;
+    assert((size_t)(wav + wav_size - data) == raw_size);
+
+    bool reordered = false;
+    for (unsigned i = 0; i < AUDIO_FRAMES; i++)
+    {
+        int16_t frame[AUDIO_CHANNELS], expected[AUDIO_CHANNELS];
+        memcpy(frame, data + i * sizeof (frame), sizeof (frame));
+        make_samples(expected, i);
+
+        reordered = reordered || memcmp(frame, expected, sizeof (frame));
+        qsort(frame, AUDIO_CHANNELS, sizeof (*frame), cmp_sample);
+        assert(!memcmp(frame, expected, sizeof (frame)));
+    }
+    assert(reordered);
+
+    free(wav);
+    free(raw);
+    unlink(wav_path);
+    unlink(raw_path);
+}
+
+int main(void)
+{
+    test_init();
+
+    char dir[] = "/tmp/vlc-test-duplicate-XXXXXX";
+    if (mkdtemp(dir) == NULL)
+        return 77;
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    unsigned tested = 0;
+    static const char *const muxes[] = { "ts", "ps" };
+    for (size_t i = 0; i < ARRAY_SIZE(muxes) && has_mux("mp4"); i++)
+    {
+        if (!has_mux(muxes[i]))
+            continue;
+        test_duplicate(vlc, muxes[i], dir);
+        tested++;
+    }
+
+    if (has_mux("wav") && has_mux("dummy"))
+    {
+        test_duplicate_wav(vlc, dir);
+        tested++;
+    }
+
+    libvlc_release(vlc);
+    rmdir(dir);
+    return tested ? 0 : 77;
+}
@@ -0,0 +1,199 @@
+/*****************************************************************************
+ * transcode_ladder.c: test the video ladder of the transcode stream output
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* The video is decoded once, and encoded for each rendition of the ladder
+ * into its own elementary stream. The raw RTP video encoder is used as it
+ * has no dependencies: each rendition is written to a file of concatenated
+ * pictures, the size of which tells the dimensions of the rendition. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_es.h>
+#include <vlc_modules.h>
+#include <vlc_sout.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FRAMES 10
+#define FRAME_DURATION VLC_TICK_FROM_MS(40)
+#define WIDTH 64
+#define HEIGHT 48
+
+static const struct
+{
+    unsigned width;
+    unsigned height;
+} renditions[] = {
+    { 64, 48 }, { 32, 24 }, { 16, 12 },
+};
+
+static bool has_module(const char *capability, const char *name)
+{
+    size_t count;
+    module_t **list = module_list_get(&count);
+    bool found = false;
+
+    for (size_t i = 0; i < count && !found; i++)
+        found = module_provides(list[i], capability)
+             && !strcmp(module_get_object(list[i]), name);
+    module_list_free(list);
+    return found;
+}
+
+static uint8_t *read_file(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return NULL;
+
+    uint8_t *data = NULL;
+    size_t len = 0;
+    for (;;)
+    {
+        uint8_t *grown = realloc(data, len + 65536);
+        assert(grown != NULL);
+        data = grown;
+
+        size_t ret = fread(data + len, 1, 65536, file);
+        len += ret;
+        if (ret < 65536)
+            break;
+    }
+    fclose(file);
+    *size = len;
+    return data;
+}
+
+/* Checks that a file holds the given number of pictures of the given size */
+static void check_pictures(const char *path, unsigned count,
+                           unsigned width, unsigned height)
+{
+    size_t size;
+    uint8_t *data = read_file(path, &size);
+    assert(data != NULL);
+
+    test_log("%s: %zu bytes\n", path, size);
+    assert(size == count * width * height * 3 / 2);
+
+    free(data);
+    unlink(path);
+}
+
+static void test_ladder(libvlc_instance_t *vlc, const char *dir)
+{
+    char ladder[100] = "", chain[400];
+
+    for (size_t i = 0; i < ARRAY_SIZE(renditions); i++)
+    {
+        size_t len = strlen(ladder);
+        snprintf(ladder + len, sizeof (ladder) - len, "%s%ux%u@%u",
+                 i ? "," : "", renditions[i].width, renditions[i].height,
+                 100 * (unsigned)(ARRAY_SIZE(renditions) - i));
+    }
+    snprintf(chain, sizeof (chain),
+             "transcode{vcodec=r420,ladder=\"%s\"}:"
+             "es{access=file,mux=raw,dst=%s/out-%%n.yuv}", ladder, dir);
+    test_log("%s\n", chain);
+
+    sout_instance_t *sout = vlc_object_create(vlc->p_libvlc_int,
+                                              sizeof (*sout));
+    assert(sout != NULL);
+    vlc_mutex_init(&sout->lock);
+    sout->psz_sout = NULL;
+    sout->i_out_pace_nocontrol = 0;
+    sout->b_wants_substreams = false;
+
+    sout_stream_t *stream = sout_StreamChainNew(sout, chain, NULL, NULL);
+    assert(stream != NULL);
+
+    es_format_t fmt;
+    es_format_Init(&fmt, VIDEO_ES, VLC_CODEC_I420);
+    fmt.video.i_chroma = VLC_CODEC_I420;
+    fmt.video.i_width = fmt.video.i_visible_width = WIDTH;
+    fmt.video.i_height = fmt.video.i_visible_height = HEIGHT;
+    fmt.video.i_sar_num = fmt.video.i_sar_den = 1;
+    fmt.video.i_frame_rate = 25;
+    fmt.video.i_frame_rate_base = 1;
+    fmt.i_id = 1;
+
+    void *id = sout_StreamIdAdd(stream, &fmt);
+    assert(id != NULL);
+
+    const size_t frame_size = WIDTH * HEIGHT * 3 / 2;
+    for (unsigned i = 0; i < FRAMES; i++)
+    {
+        block_t *block = block_Alloc(frame_size);
+        assert(block != NULL);
+
+        for (size_t j = 0; j < frame_size; j++)
+            block->p_buffer[j] = (i * 16 + j) & 0xff;
+        block->i_dts = block->i_pts = VLC_TICK_0 + i * FRAME_DURATION;
+        block->i_length = FRAME_DURATION;
+        sout_StreamIdSend(stream, id, block);
+    }
+
+    sout_StreamIdDel(stream, id);
+    sout_StreamChainDelete(stream, NULL);
+    vlc_object_delete(sout);
+    es_format_Clean(&fmt);
+
+    /* One output per rendition, numbered from 0 in the order of the ladder */
+    for (size_t i = 0; i < ARRAY_SIZE(renditions); i++)
+    {
+        char path[256];
+
+        snprintf(path, sizeof (path), "%s/out-%zu.yuv", dir, i);
+        check_pictures(path, FRAMES, renditions[i].width,
+                       renditions[i].height);
+    }
+}
+
+int main(void)
+{
+    test_init();
+
+    char dir[] = "/tmp/vlc-test-ladder-XXXXXX";
+    if (mkdtemp(dir) == NULL)
+        return 77;
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    int ret = 77;
+    if (has_module("encoder", "rtpvideo") && has_module("sout mux", "dummy"))
+    {
+        test_ladder(vlc, dir);
+        ret = 0;
+    }
+
+    libvlc_release(vlc);
+    rmdir(dir);
+    return ret;
+}
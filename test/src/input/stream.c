@@ -342,6 +342,47 @@ test( struct reader **pp_readers, unsigned int i_readers, const char *psz_md5 )
 }
 
 #ifndef TEST_NET
+static void
+test_ranges( stream_t *s, int i_fd )
+{
+    uint64_t i_size;
+    assert( vlc_stream_GetSize( s, &i_size ) == 0 );
+
+    /* Out of order, overlapping, and past the end */
+    const uint64_t offsets[] = {
+        i_size / 2, 0, 4095, i_size / 2 + 1000, i_size - 100, i_size + 10,
+    };
+    const size_t lengths[] = { 5000, 100, 8193, 1, 300, 10 };
+    uint8_t p_bufs[ARRAY_SIZE(offsets)][8193], p_cmp[8193];
+    struct vlc_stream_range ranges[ARRAY_SIZE(offsets)];
+
+    for( size_t i = 0; i < ARRAY_SIZE(ranges); ++i )
+    {
+        ranges[i].offset = offsets[i];
+        ranges[i].buf = p_bufs[i];
+        ranges[i].length = lengths[i];
+    }
+
+    assert( vlc_stream_Seek( s, 42 ) == 0 );
+    assert( vlc_stream_ReadRanges( s, ranges, ARRAY_SIZE(ranges) ) == 0 );
+    assert( vlc_stream_Tell( s ) == 42 );
+
+    for( size_t i = 0; i < ARRAY_SIZE(ranges); ++i )
+    {
+        ssize_t i_ret = pread( i_fd, p_cmp, lengths[i], offsets[i] );
+
+        test_log( "range %zu @ %"PRIu64": %zu/%zu\n", i, offsets[i],
+                  ranges[i].read, lengths[i] );
+        assert( i_ret >= 0 && ranges[i].read == (size_t)i_ret );
+        assert( memcmp( p_bufs[i], p_cmp, i_ret ) == 0 );
+    }
+
+    /* The sequential read offset was preserved */
+    assert( vlc_stream_Read( s, p_bufs[0], 100 ) == 100 );
+    assert( pread( i_fd, p_cmp, 100, 42 ) == 100 );
+    assert( memcmp( p_bufs[0], p_cmp, 100 ) == 0 );
+}
+
 static void
 fill_rand( int i_fd, size_t i_size )
 {
@@ -383,6 +424,22 @@ main( void )
     assert( ( pp_readers[1] = stream_open( psz_url ) ) );
 
     test( pp_readers, 2, NULL );
+
+    test_log( "Testing vectored reads...\n" );
+    test_ranges( pp_readers[1]->u.s, i_tmp_fd );
+
+    /* Memory streams emulate them with seeks */
+    uint8_t *p_mem = malloc( RAND_FILE_SIZE );
+    assert( p_mem != NULL );
+    assert( pread( i_tmp_fd, p_mem, RAND_FILE_SIZE, 0 ) == RAND_FILE_SIZE );
+
+    libvlc_instance_t *p_vlc = pp_readers[1]->p_data;
+    stream_t *p_mem_stream = vlc_stream_MemoryNew( p_vlc->p_libvlc_int, p_mem,
+                                                  RAND_FILE_SIZE, false );
+    assert( p_mem_stream != NULL );
+    test_ranges( p_mem_stream, i_tmp_fd );
+    vlc_stream_Delete( p_mem_stream );
+
     for( unsigned int i = 0; i < 2; ++i )
         pp_readers[i]->pf_close( pp_readers[i] );
     free( psz_url );
@@ -207,6 +207,72 @@ static void test_cancel_thumbnail( libvlc_instance_t* p_vlc )
     vlc_thumbnailer_Release( p_thumbnailer );
 }
 
+struct test_batch_ctx
+{
+    vlc_cond_t cond;
+    vlc_mutex_t lock;
+    size_t next_idx;
+};
+
+static const vlc_tick_t batch_times[] = {
+    VLC_TICK_FROM_SEC( 10 ), VLC_TICK_FROM_SEC( 60 ), VLC_TICK_FROM_SEC( 120 ),
+};
+
+static void thumbnailer_callback_batch( void* data, size_t idx,
+                                        picture_t* thumbnail )
+{
+    struct test_batch_ctx* p_ctx = data;
+    vlc_mutex_lock( &p_ctx->lock );
+
+    assert( idx == p_ctx->next_idx && "Thumbnails out of order" );
+    assert( thumbnail != NULL && "Expected a thumbnail but got a failure" );
+    assert( thumbnail->format.i_visible_width <= 64 );
+    assert( thumbnail->format.i_visible_height <= 64 );
+
+    p_ctx->next_idx++;
+    vlc_cond_signal( &p_ctx->cond );
+    vlc_mutex_unlock( &p_ctx->lock );
+}
+
+static void test_batch_thumbnails( libvlc_instance_t* p_vlc )
+{
+    vlc_thumbnailer_t* p_thumbnailer = vlc_thumbnailer_Create(
+                VLC_OBJECT( p_vlc->p_libvlc_int ) );
+    assert( p_thumbnailer != NULL );
+
+    struct test_batch_ctx ctx;
+    vlc_cond_init( &ctx.cond );
+    vlc_mutex_init( &ctx.lock );
+    ctx.next_idx = 0;
+
+    char* psz_mrl;
+    if ( asprintf( &psz_mrl, "mock://video_track_count=1;audio_track_count=0"
+                   ";length=%" PRId64 ";video_chroma=ARGB", MOCK_DURATION ) < 0 )
+        assert( !"Failed to allocate mock mrl" );
+    input_item_t* p_item = input_item_New( psz_mrl, "mock item" );
+    assert( p_item != NULL );
+
+    vlc_mutex_lock( &ctx.lock );
+    vlc_thumbnailer_request_t* p_req = vlc_thumbnailer_RequestBatch(
+        p_thumbnailer, batch_times, ARRAY_SIZE(batch_times),
+        VLC_THUMBNAILER_SEEK_FAST, 64, 64, p_item, VLC_TICK_FROM_SEC( 2 ),
+        thumbnailer_callback_batch, &ctx );
+    assert( p_req != NULL );
+
+    while ( ctx.next_idx < ARRAY_SIZE(batch_times) )
+    {
+        vlc_tick_t timeout = vlc_tick_now() + VLC_TICK_FROM_SEC( 3 );
+        int res = vlc_cond_timedwait( &ctx.cond, &ctx.lock, timeout );
+        assert( res != ETIMEDOUT );
+    }
+    vlc_mutex_unlock( &ctx.lock );
+
+    input_item_Release( p_item );
+    free( psz_mrl );
+
+    vlc_thumbnailer_Release( p_thumbnailer );
+}
+
 int main()
 {
     test_init();
@@ -220,6 +286,7 @@ int main()
 
     test_thumbnails( vlc );
     test_cancel_thumbnail( vlc );
+    test_batch_thumbnails( vlc );
 
     libvlc_release( vlc );
 }